@@ -15,6 +15,10 @@ void BoxApp::OnInitialize() {
     BuildBoxGeometry();
     BuildPso();
 
+    // The staging copies are dropped once the uploads have executed.
+    vbuffer_->ResetUploader(*deferredReleases_, GetNextFenceValue());
+    ibuffer_->ResetUploader(*deferredReleases_, GetNextFenceValue());
+
     // Execute the initialization commands
     ThrowIfFailed(commandList_->Close());
     ExecuteCommandList();
@@ -86,10 +90,8 @@ void BoxApp::Draw() {
     SetViewportAndScissorRects();
 
     // Transition of back buffer to render target state
-    auto transition = CD3DX12_RESOURCE_BARRIER::Transition(swapChain_->GetCurrentBackBuffer(),
-                                                           D3D12_RESOURCE_STATE_PRESENT,
-                                                           D3D12_RESOURCE_STATE_RENDER_TARGET);
-    commandList_->ResourceBarrier(1, &transition);
+    Transition(swapChain_->GetCurrentBackBuffer(), D3D12_RESOURCE_STATE_RENDER_TARGET);
+    FlushBarriers();
 
     auto rtv = swapChain_->GetCurrentBackBufferView();
     commandList_->ClearRenderTargetView(rtv, Colors::LightSteelBlue, 0, nullptr);
@@ -124,18 +126,15 @@ void BoxApp::Draw() {
 
     commandList_->DrawIndexedInstanced(boxGeo_->DrawArgs["box"].IndexCount, 1, 0, 0, 0);
 
-    transition = CD3DX12_RESOURCE_BARRIER::Transition(swapChain_->GetCurrentBackBuffer(),
-                                                      D3D12_RESOURCE_STATE_RENDER_TARGET,
-                                                      D3D12_RESOURCE_STATE_PRESENT);
-    commandList_->ResourceBarrier(1, &transition);
+    Transition(swapChain_->GetCurrentBackBuffer(), D3D12_RESOURCE_STATE_PRESENT);
+    FlushBarriers();
 
     ThrowIfFailed(commandList_->Close());
 
     ExecuteCommandList();
 
     // Swap back and front buffers
-    ThrowIfFailed(swapChain_->Present());
-    swapChain_->SwapBuffers();
+    PresentFrame();
 
     FlushCommandQueue();
 }
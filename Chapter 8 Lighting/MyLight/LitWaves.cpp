@@ -123,6 +123,11 @@ void LandAndWaves::OnInitialize() {
   ThrowIfFailed(device_->CreateGraphicsPipelineState(&psoWireframeDesc,
                                                      IID_PPV_ARGS(psoWireframe_.GetAddressOf())));
 
+  // The staging copies are dropped once the uploads have executed.
+  landVbuffer_->ResetUploader(*deferredReleases_, GetNextFenceValue());
+  landIbuffer_->ResetUploader(*deferredReleases_, GetNextFenceValue());
+  wavesIbuffer_->ResetUploader(*deferredReleases_, GetNextFenceValue());
+
   ThrowIfFailed(commandList_->Close());
   ExecuteCommandList();
   FlushCommandQueue();
@@ -223,9 +228,8 @@ void LandAndWaves::Draw() {
 
   SetViewportAndScissorRects();
 
-  Transition(swapChain_->GetCurrentBackBuffer(),
-             D3D12_RESOURCE_STATE_PRESENT,
-             D3D12_RESOURCE_STATE_RENDER_TARGET);
+  Transition(swapChain_->GetCurrentBackBuffer(), D3D12_RESOURCE_STATE_RENDER_TARGET);
+  FlushBarriers();
 
   auto rtv = swapChain_->GetCurrentBackBufferView();
   commandList_->ClearRenderTargetView(rtv, Colors::LightSteelBlue, 0, nullptr);
@@ -249,15 +253,13 @@ void LandAndWaves::Draw() {
 
   DrawAllRenderItems();
 
-  Transition(swapChain_->GetCurrentBackBuffer(),
-             D3D12_RESOURCE_STATE_RENDER_TARGET,
-             D3D12_RESOURCE_STATE_PRESENT);
+  Transition(swapChain_->GetCurrentBackBuffer(), D3D12_RESOURCE_STATE_PRESENT);
+  FlushBarriers();
 
   ThrowIfFailed(commandList_->Close());
   ExecuteCommandList();
 
-  ThrowIfFailed(swapChain_->Present());
-  swapChain_->SwapBuffers();
+  PresentFrame();
 
   currentFrameResource_->fence = ++nextFenceValue_;
   commandQueue_->Signal(fence_.Get(), nextFenceValue_);
@@ -1,15 +1,28 @@
 #include "FrameResource.h"
 
+DrawConstant DrawConstant::FromMatrices(const DirectX::XMFLOAT4X4& world,
+                                        const DirectX::XMFLOAT4X4& texTransform) {
+  // The shaders multiply column vectors, so row i here is column i of the row-vector matrix.
+  DrawConstant c;
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      c.world[i][j] = world.m[j][i];
+    }
+  }
+  for (int i = 0; i < 2; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      c.texTransform[i][j] = texTransform.m[j][i];
+    }
+  }
+  return c;
+}
+
 FrameResource::FrameResource(ID3D12Device* device,
-                             UINT passCount,
+                             UploadMemoryBackend* uploadBackend,
+                             UINT64 uploadPageSize,
                              UINT objectCount,
-                             UINT waveVertexCount,
-                             UINT materialCount) {
-  ThrowIfFailed(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT,
-                                               IID_PPV_ARGS(alloc.ReleaseAndGetAddressOf())));
-
-  passCbuffer = std::make_unique<ConstantBuffer<PassConstant>>(device, passCount);
-  objectCbuffer = std::make_unique<ConstantBuffer<ObjectConstant>>(device, objectCount);
+                             UINT waveVertexCount) {
+  uploadAllocator = std::make_unique<LinearUploadAllocator>(uploadBackend, uploadPageSize);
+  objectBuffer = std::make_unique<UploadBuffer<ObjectConstant>>(device, objectCount);
   waveVbuffer = std::make_unique<UploadBuffer<Vertex>>(device, waveVertexCount);
-  materialCbuffer = std::make_unique<ConstantBuffer<MaterialConstants>>(device, materialCount);
 }
\ No newline at end of file
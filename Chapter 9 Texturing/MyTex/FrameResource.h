@@ -1,6 +1,7 @@
 #pragma once
 #include <memory>
 
+#include "MyApp/LinearUploadAllocator.h"
 #include "MyApp/UploadHeapBuffers.h"
 
 struct Vertex {
@@ -14,6 +15,17 @@ struct ObjectConstant {
   DirectX::XMFLOAT4X4 texTransform = MathHelper::Identity4x4();
 };
 
+// Per-draw data small enough for root constants. Only the rows of the transposed matrices that
+// affine transforms use are kept: the world matrix as row_major float3x4 and the texture
+// transform, which only produces uv, as row_major float2x4.
+struct DrawConstant {
+  float world[3][4];
+  float texTransform[2][4];
+
+  static DrawConstant FromMatrices(const DirectX::XMFLOAT4X4& world,
+                                   const DirectX::XMFLOAT4X4& texTransform);
+};
+
 struct PassConstant {
   DirectX::XMFLOAT4X4 view;
   DirectX::XMFLOAT4X4 invView;
@@ -34,7 +46,11 @@ struct PassConstant {
 };
 
 struct FrameResource {
-  FrameResource(ID3D12Device* device, UINT passCount, UINT objectCount, UINT waveVertexCount, UINT materialCount);
+  FrameResource(ID3D12Device* device,
+                UploadMemoryBackend* uploadBackend,
+                UINT64 uploadPageSize,
+                UINT objectCount,
+                UINT waveVertexCount);
 
   FrameResource(const FrameResource& other) = delete;
   FrameResource(FrameResource&& other) noexcept = delete;
@@ -42,11 +58,18 @@ struct FrameResource {
   FrameResource& operator=(FrameResource&& other) noexcept = delete;
   ~FrameResource() = default;
 
-  Microsoft::WRL::ComPtr<ID3D12CommandAllocator> alloc;
+  // Transient constants for this frame; reset once the frame's fence has completed.
+  std::unique_ptr<LinearUploadAllocator> uploadAllocator;
+
+  D3D12_GPU_VIRTUAL_ADDRESS passCbAddress = 0;
+  std::vector<DrawConstant> drawConstants;                     // by RenderItem::objectCbufferIndex
+  std::vector<D3D12_GPU_VIRTUAL_ADDRESS> objectCbAddresses;    // only when not in root constants
+  std::vector<D3D12_GPU_VIRTUAL_ADDRESS> materialCbAddresses;  // by Material::MatCBIndex
 
-  std::unique_ptr<ConstantBuffer<PassConstant>> passCbuffer;
-  std::unique_ptr<ConstantBuffer<ObjectConstant>> objectCbuffer;
-  std::unique_ptr<ConstantBuffer<MaterialConstants>> materialCbuffer;
+  // Bindless mode: structured buffers indexed the same way. The object buffer persists across
+  // frames and only receives the ranges that changed since this frame resource was last used.
+  std::unique_ptr<UploadBuffer<ObjectConstant>> objectBuffer;
+  D3D12_GPU_VIRTUAL_ADDRESS materialBufferAddress = 0;
 
   std::unique_ptr<UploadBuffer<Vertex>> waveVbuffer;
 
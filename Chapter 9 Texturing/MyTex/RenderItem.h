@@ -5,6 +5,7 @@
 struct RenderItem {
     DirectX::XMFLOAT4X4 modelToWorld;
 
+    // Nonzero while the object data has changes the object mirror has not picked up yet.
     int dirtyFrameCount = 3;
 
     UINT objectCbufferIndex = -1;
@@ -17,6 +18,7 @@ struct RenderItem {
 
     VertexBuffer* vbuffer = nullptr;
     IndexBuffer* ibuffer = nullptr;
+    CopyUploader::Ticket upload;  // copy batch the geometry came in
   
     Material* mat;
 
@@ -1,11 +1,26 @@
 #include "TexCrate.h"
 
 #include "Common/GeometryGenerator.h"
+#include "Common/TexturePacker.h"
 
 using namespace DirectX;
 using namespace Microsoft::WRL;
 
-const int gNumFrameResources = 3;
+// Read only by the default member initializer of Material in d3dUtil.h; material constants are
+// rewritten every frame here, so nothing counts dirty frames.
+const int gNumFrameResources = TexCrate::s_frameResourceCount;
+
+namespace {
+
+// printf to the debugger output, at any length.
+template <typename... Args>
+void DebugPrint(const char* format, Args... args) {
+  std::string text(static_cast<size_t>(std::snprintf(nullptr, 0, format, args...)), '\0');
+  std::snprintf(text.data(), text.size() + 1, format, args...);
+  ::OutputDebugStringA(text.c_str());
+}
+
+}  // namespace
 
 void TexCrate::OnKeyDown() {
   if (IsKeyDown('W')) {
@@ -34,88 +49,88 @@ void TexCrate::OnMouseMove() {
 }
 
 void TexCrate::OnInitialize() {
-  ThrowIfFailed(commandList_->Reset(commandAllocator_.Get(), nullptr));
+  // Geometry and textures go up on a copy queue while the rest of initialization continues;
+  // the first frame waits on the GPU for what it draws.
+  copyQueueBackend_ = std::make_unique<D3D12CopyQueueBackend>(device_.Get(),
+                                                              commandContextPool_.get(),
+                                                              s_copyRingSize);
+  copyUploader_ = std::make_unique<CopyUploader>(copyQueueBackend_.get());
+
+  // Static meshes share default-heap blocks instead of a 64 KB-aligned resource each.
+  staticBufferBackend_ = std::make_unique<D3D12DefaultHeapBackend>(device_.Get());
+  staticBufferAllocator_ = std::make_unique<DefaultHeapAllocator>(staticBufferBackend_.get(),
+                                                                  s_staticBufferBlockSize);
 
   BuildMaterials();
+
+  // Land and crate are appended to one vertex/index buffer pair, bound once per frame.
+  staticGeometry_ = std::make_unique<GeometryPool>(sizeof(Vertex), DXGI_FORMAT_R16_UINT);
   BuildLandGeometry();
   BuildWavesGeometry();
   BuildCrateGeometry();
+  staticGeometry_->Upload(copyUploader_->GetCommandList(),
+                          copyQueueBackend_->GetUploadRing(),
+                          *staticBufferAllocator_);
+  auto geometryUpload = copyUploader_->Commit(staticGeometry_->GetVertexCount() * sizeof(Vertex) +
+                                              staticGeometry_->GetIndexCount() * sizeof(std::uint16_t));
+  for (auto& item : renderItems_) {
+    item.vbuffer = staticGeometry_->GetVertexBuffer();
+    item.ibuffer = staticGeometry_->GetIndexBuffer();
+    item.upload = geometryUpload;
+  }
 
   LoadTexture();
 
-  // Build frame resources
+  // Every draw, the waves included, has its own slot in the object buffers.
+  for (auto& item : renderItems_) {
+    drawItems_.push_back(&item);
+  }
+  drawItems_.push_back(&waveRenderItem_);
+
+  // Build frame resources. Constants come from each frame's linear allocator, so render items
+  // and materials can be added later without resizing anything.
+  auto objectCount = static_cast<UINT>(drawItems_.size());
+  uploadBackend_ = std::make_unique<D3D12UploadBackend>(device_.Get());
+  frameResources_.resize(framesInFlight_);
   for (auto& frameRes : frameResources_) {
     frameRes = std::make_unique<FrameResource>(device_.Get(),
-                                               1,
-                                               renderItems_.size(),
-                                               waves_->VertexCount(),
-                                               materials_.size());
-  }
-
-  // Sampler descriptor heap
-  // {
-  //   D3D12_DESCRIPTOR_HEAP_DESC desc{};
-  //   desc.NumDescriptors = 1;
-  //   desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER;
-  //   desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-  //   samplerHeap_ = std::make_unique<DescriptorHeap>(device_.Get(), desc);
-  // }
-
-  // Sampler view
-  // {
-  //   D3D12_SAMPLER_DESC desc{};
-  //   desc.Filter = D3D12_FILTER_MIN_MAG_MIP_LINEAR;
-  //   desc.AddressU = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
-  //   desc.AddressV = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
-  //   desc.AddressW = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
-  //   desc.MinLOD = 0;
-  //   desc.MaxLOD = D3D12_FLOAT32_MAX;
-  //   desc.MipLODBias = 0.0f;
-  //   desc.MaxAnisotropy = 1;
-  //   desc.ComparisonFunc = D3D12_COMPARISON_FUNC_ALWAYS;
-  //
-  //   device_->CreateSampler(&desc, samplerHeap_->GetDescriptorHandleCpu(0));
-  // }
+                                               uploadBackend_.get(),
+                                               s_uploadPageSize,
+                                               objectCount,
+                                               waves_->VertexCount());
+  }
+  objectMirror_ = std::make_unique<StructuredBufferMirror>(sizeof(ObjectConstant),
+                                                           objectCount,
+                                                           framesInFlight_);
+  framePacer_ = std::make_unique<FramePacer>(fenceBackend_.get(), framesInFlight_);
+
+  // Draws are recorded in parallel into lists from the context pool.
+  commandListBackend_ = std::make_unique<D3D12CommandListBackend>(commandContextPool_.get(),
+                                                                  commandQueue_.Get());
+  recorder_ = std::make_unique<ParallelRecorder>(commandListBackend_.get(), 0, s_minDrawsPerList);
+  frameGraphBackend_ = std::make_unique<D3D12FrameGraphBackend>(device_.Get(), fenceBackend_.get());
+  frameGraph_ = std::make_unique<FrameGraph>(frameGraphBackend_.get());
+  for (const auto* item : drawItems_) {
+    gameItems_.push_back({item->modelToWorld, static_cast<UINT>(item->mat->MatCBIndex)});
+  }
 
   // Use static samplers
 
-  // Build root signature
-  CD3DX12_DESCRIPTOR_RANGE texRange[1];
-  texRange[0].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0);  // t0
-
-  CD3DX12_ROOT_PARAMETER rootParams[4];
-  rootParams[0].InitAsConstantBufferView(0);                                            // b0
-  rootParams[1].InitAsConstantBufferView(1);                                            // b1
-  rootParams[2].InitAsConstantBufferView(2);                                            // b2
-  rootParams[3].InitAsDescriptorTable(1, &texRange[0], D3D12_SHADER_VISIBILITY_PIXEL);  // t0
-
-  auto staticSamplers = GetStaticSamplers();
-
-  CD3DX12_ROOT_SIGNATURE_DESC desc = {4,
-                                      rootParams,
-                                      staticSamplers.size(),
-                                      staticSamplers.data(),
-                                      D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT};
-
-  ComPtr<ID3DBlob> serializedRootSignature;
-  ComPtr<ID3DBlob> error;
-  auto hr = D3D12SerializeRootSignature(&desc,
-                                        D3D_ROOT_SIGNATURE_VERSION_1,
-                                        serializedRootSignature.GetAddressOf(),
-                                        error.GetAddressOf());
-  if (error) {
-    ::OutputDebugStringA(static_cast<LPCSTR>(error->GetBufferPointer()));
-  }
-  ThrowIfFailed(hr);
-
-  ThrowIfFailed(device_->CreateRootSignature(0,
-                                             serializedRootSignature->GetBufferPointer(),
-                                             serializedRootSignature->GetBufferSize(),
-                                             IID_PPV_ARGS(rootSignature_.GetAddressOf())));
+  BuildRootSignature();
 
   // Build shaders
-  vertexShader_ = d3dUtil::CompileShader(L"shaders.hlsl", nullptr, "VS", "vs_5_0");
-  pixelShader_ = d3dUtil::CompileShader(L"shaders.hlsl", nullptr, "PS", "ps_5_0");
+  if (bindless_) {
+    const D3D_SHADER_MACRO defines[] = {{"BINDLESS", "1"},
+                                        {"ROOT_CBUFFERS", rootCbufferDeclarations_.c_str()},
+                                        {nullptr, nullptr}};
+    vertexShader_ = d3dUtil::CompileShader(L"shaders.hlsl", defines, "VS", "vs_5_1");
+    pixelShader_ = d3dUtil::CompileShader(L"shaders.hlsl", defines, "PS", "ps_5_1");
+  } else {
+    const D3D_SHADER_MACRO defines[] = {{"ROOT_CBUFFERS", rootCbufferDeclarations_.c_str()},
+                                        {nullptr, nullptr}};
+    vertexShader_ = d3dUtil::CompileShader(L"shaders.hlsl", defines, "VS", "vs_5_0");
+    pixelShader_ = d3dUtil::CompileShader(L"shaders.hlsl", defines, "PS", "ps_5_0");
+  }
 
   // Input layout
   inputLayout_ = {{"POSITION",
@@ -166,41 +181,137 @@ void TexCrate::OnInitialize() {
   ThrowIfFailed(device_->CreateGraphicsPipelineState(&psoWireframeDesc,
                                                      IID_PPV_ARGS(psoWireframe_.GetAddressOf())));
 
-  ThrowIfFailed(commandList_->Close());
-  ExecuteCommandList();
-  FlushCommandQueue();
+  // The packing batch keeps the individually loaded textures alive until it has executed.
+  crateTex_.reset();
+  grassTex_.reset();
+  stoneTex_.reset();
+  waterTex_.reset();
+  textureCache_->Trim(0);
+
+  ReportResourceStats();
+
+  // From here on the render thread owns the GPU side; OnUpdate() only simulates.
+  StartRenderThread();
+}
+
+void TexCrate::OnResize() {
+  // The swap chain and depth buffer are recreated under the render thread otherwise.
+  bool rendering = renderThread_.joinable();
+  StopRenderThread();
+  D3DApp::OnResize();
+  if (rendering && !renderError_) {
+    StartRenderThread();
+  }
+}
+
+void TexCrate::StartRenderThread() {
+  sceneChannel_ = std::make_unique<SceneChannel>(s_renderPacketCapacity);
+  renderThread_ = std::thread([this] { RenderLoop(); });
+}
+
+void TexCrate::StopRenderThread() {
+  if (!renderThread_.joinable()) {
+    return;
+  }
+  sceneChannel_->Close();
+  renderThread_.join();
+}
+
+void TexCrate::RenderLoop() {
+  try {
+    while (const auto* snapshot = sceneChannel_->Acquire()) {
+      BeginRenderFrame(*snapshot);
+      DrawFrame(*snapshot);
+      sceneChannel_->Release();
+    }
+  } catch (...) {
+    // Rethrown on the game thread, which stops publishing once the channel is closed.
+    renderError_ = std::current_exception();
+    sceneChannel_->Close();
+  }
+}
+
+void TexCrate::BuildRootSignature() {
+  // Bindless needs unbounded SRV tables whose unused descriptors may stay uninitialized.
+  D3D12_FEATURE_DATA_D3D12_OPTIONS options{};
+  ThrowIfFailed(device_->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options)));
+  bindless_ = options.ResourceBindingTier >= D3D12_RESOURCE_BINDING_TIER_2;
+
+  // The builder picks root constants or a root CBV from each block's size and update rate.
+  RootSignatureBuilder builder;
+  if (bindless_) {
+    drawRootParam_ = builder.AddConstants("cbDraw",
+                                          0,
+                                          2 * sizeof(UINT),
+                                          UpdateFrequency::PerDraw,
+                                          {{"uint", "gObjectIndex"}, {"uint", "gMaterialIndex"}});
+    passRootParam_ = builder.AddConstants<PassConstant>("cbPass", 2, UpdateFrequency::PerFrame);
+    objectBufferRootParam_ = builder.AddShaderResourceView("gObjects", 0, UpdateFrequency::PerFrame);
+    materialBufferRootParam_ = builder.AddShaderResourceView("gMaterials", 1, UpdateFrequency::PerFrame);
+    textureRootParam_ = builder.AddTable("gTextures",
+                                         D3D12_DESCRIPTOR_RANGE_TYPE_SRV,
+                                         UINT_MAX,
+                                         0,
+                                         UpdateFrequency::PerFrame,
+                                         D3D12_SHADER_VISIBILITY_PIXEL,
+                                         1);
+  } else {
+    drawRootParam_ = builder.AddConstants<DrawConstant>("cbPerObject",
+                                                        0,
+                                                        UpdateFrequency::PerDraw,
+                                                        {{"row_major float3x4", "gWorld"},
+                                                         {"row_major float2x4", "gTexTransform"}});
+    materialRootParam_ = builder.AddConstants<MaterialConstants>("cbMaterial",
+                                                                 1,
+                                                                 UpdateFrequency::PerMaterial,
+                                                                 {{"float4", "gDiffuseAlbedo"},
+                                                                  {"float3", "gFresnelR0"},
+                                                                  {"float", "gRoughness"},
+                                                                  {"float4x4", "gMatTransform"}});
+    passRootParam_ = builder.AddConstants<PassConstant>("cbPass", 2, UpdateFrequency::PerFrame);
+    textureRootParam_ = builder.AddTable("gDiffuseMap",
+                                         D3D12_DESCRIPTOR_RANGE_TYPE_SRV,
+                                         1,
+                                         0,
+                                         UpdateFrequency::PerMaterial,
+                                         D3D12_SHADER_VISIBILITY_PIXEL);
+  }
+  drawConstantsInRoot_ = builder.GetParameter(drawRootParam_).kind == RootParameterKind::Constants;
+  assert((drawConstantsInRoot_ || !bindless_) && "Bindless draws pass their indices as root constants.");
+
+  auto staticSamplers = GetStaticSamplers();
+  rootSignature_ = builder.Build(device_.Get(),
+                                 static_cast<UINT>(staticSamplers.size()),
+                                 staticSamplers.data(),
+                                 D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
+  rootCbufferDeclarations_ = builder.GetHlslDeclarations();
 }
 
 void TexCrate::WaterTextureAnimation() {
-  Material* waterMat = materials_["water"].get();
-  float& u = waterMat->MatTransform(3, 0);
-  float& v = waterMat->MatTransform(3, 1);
+  float& u = waterOffset_.x;
+  float& v = waterOffset_.y;
   u += 0.1f * timer_.DeltaTimeSecond();
   v += 0.02f * timer_.DeltaTimeSecond();
   if (u > 1.0f)
     u -= 1.0f;
   if (v > 1.0f)
     v -= 1.0f;
-
-  // Mark dirty because we have changed the material constant
-  waterMat->NumFramesDirty = gNumFrameResources;
 }
 
 void TexCrate::OnUpdate() {
-  // Find next available slot in frame resource array.
-  // If all slots have been filled by CPU and not yet used by GPU, let CPU wait.
-  currentFrameResourceIndex_ = (currentFrameResourceIndex_ + 1) % s_frameResourceCount;
-  currentFrameResource_ = frameResources_[currentFrameResourceIndex_].get();
-
-  // if (UINT64 frameFence = currentFrameResource_->fence;
-  //     frameFence != 0 && fence_->GetCompletedValue() < frameFence) {
-  //   HANDLE event = CreateEventEx(nullptr, nullptr, false, EVENT_ALL_ACCESS);
-  //   ThrowIfFailed(fence_->SetEventOnCompletion(frameFence, event));
-  //   WaitForSingleObject(event, INFINITE);
-  //   CloseHandle(event);
-  // }
+  if (sceneChannel_->IsClosed()) {
+    StopRenderThread();
+    if (renderError_) {
+      std::rethrow_exception(renderError_);
+    }
+    return;
+  }
 
-  FlushCommandQueue();
+  // Waits only while the render thread still reads the snapshot from two frames ago.
+  auto* snapshot = sceneChannel_->BeginFrame();
+  if (!snapshot) {
+    return;
+  }
 
   // Update pass constant buffer
   auto x = radius_ * sinf(phi_) * cosf(theta_);
@@ -219,7 +330,7 @@ void TexCrate::OnUpdate() {
   auto detProj = XMMatrixDeterminant(proj);
   auto invProj = XMMatrixInverse(&detProj, proj);
 
-  PassConstant passConst;
+  PassConstant& passConst = snapshot->pass;
   XMStoreFloat4x4(&passConst.view, view);
   XMStoreFloat4x4(&passConst.invView, invView);
   XMStoreFloat4x4(&passConst.proj, proj);
@@ -238,94 +349,274 @@ void TexCrate::OnUpdate() {
   XMStoreFloat3(&passConst.lights[0].Direction, lightDir);
   passConst.lights[0].Strength = {0.8f, 0.8f, 0.7f};
 
-  currentFrameResource_->passCbuffer->Load(0, passConst);
+  // Update water texture coordinate scaling to achieve texture animation
+  WaterTextureAnimation();
+  snapshot->waterOffset = waterOffset_;
+  snapshot->wireframe = wireframe_;
 
-  // Update object constant buffer if changed
-  for (auto& item : renderItems_) {
-    if (item.dirtyFrameCount > 0) {
-      ObjectConstant objConst;
-      auto model = XMLoadFloat4x4(&item.modelToWorld);
-      XMStoreFloat4x4(&objConst.model, model);
-      auto texTransform = XMLoadFloat4x4(&item.texTransform);
-      XMStoreFloat4x4(&objConst.texTransform, texTransform);
-      currentFrameResource_->objectCbuffer->Load(item.objectCbufferIndex, objConst);
-      --item.dirtyFrameCount;
+  // Update wave vertex buffer; the snapshot keeps its capacity, so this is a plain copy.
+  waves_->Update(timer_.TotalTimeFromStart(), timer_.DeltaTimeSecond());
+  snapshot->waveVertices.assign(waves_->VertexData(), waves_->VertexData() + waves_->VertexCount());
+
+  // Only items that changed cross over.
+  for (UINT i = 0; i < gameItems_.size(); ++i) {
+    auto& item = gameItems_[i];
+    if (item.dirty) {
+      sceneChannel_->Push({i, item.material, item.modelToWorld});
+      item.dirty = false;
     }
   }
 
-  // Update material constant buffer if changed
-  for (auto& mat : materials_) {
-    Material* m = mat.second.get();
-    if (m->NumFramesDirty > 0) {
-      MaterialConstants c;
-      c.DiffuseAlbedo = m->DiffuseAlbedo;
-      c.FresnelR0 = m->FresnelR0;
-      c.Roughness = m->Roughness;
-      c.MatTransform = m->MatTransform;
-
-      currentFrameResource_->materialCbuffer->Load(m->MatCBIndex, c);
-      --m->NumFramesDirty;
-    }
-  }
+  sceneChannel_->Publish();
+}
 
-  // Update water texture coordinate scaling to achieve texture animation
-  WaterTextureAnimation();
+void TexCrate::BeginRenderFrame(const SceneSnapshot& snapshot) {
+  // Move to the next frame resource, waiting only if the GPU still uses it. The other frames in
+  // flight keep running while this one is recorded.
+  currentFrameResourceIndex_ = static_cast<int>(framePacer_->BeginFrame());
+  currentFrameResource_ = frameResources_[currentFrameResourceIndex_].get();
+  ReportFramePacing();
+
+  // The GPU is done with this frame resource; recycle its transient constants and descriptors.
+  auto* uploadAllocator = currentFrameResource_->uploadAllocator.get();
+  uploadAllocator->Reset();
+  UINT64 completedFenceValue = fence_->GetCompletedValue();
+  srvAllocator_->Reclaim(completedFenceValue);
+  staticBufferAllocator_->Reclaim(completedFenceValue);
+  copyUploader_->Reclaim();
+
+  sceneChannel_->Drain([this](const RenderPacket& packet) {
+    RenderItem* item = drawItems_[packet.item];
+    item->modelToWorld = packet.modelToWorld;
+    item->mat = materialTable_.Get(packet.material);
+    item->dirtyFrameCount = 1;
+  });
 
-  // Update wave vertex buffer
-  waves_->Update(timer_.TotalTimeFromStart(), timer_.DeltaTimeSecond());
-  Vertex* vertices = waves_->VertexData();
-  for (int i = 0; i < waves_->VertexCount(); ++i) {
-    currentFrameResource_->waveVbuffer->Load(i, vertices[i]);
+  Material* waterMat = materials_["water"].get();
+  waterMat->MatTransform(3, 0) = snapshot.waterOffset.x;
+  waterMat->MatTransform(3, 1) = snapshot.waterOffset.y;
+
+  currentFrameResource_->passCbAddress = uploadAllocator->PushConstants(snapshot.pass);
+
+  // Object and material constants live in transient memory, so they are written every frame
+  // rather than only while dirty.
+  if (bindless_) {
+    UpdateBindlessBuffers();
+  } else {
+    UpdateConstantBuffers();
   }
+
+  // One sequential write streams the whole array instead of a store per vertex.
+  currentFrameResource_->waveVbuffer->Load(0,
+                                           snapshot.waveVertices.data(),
+                                           static_cast<UINT>(snapshot.waveVertices.size()));
 }
 
-void TexCrate::Draw() {
-  auto curAlloc = currentFrameResource_->alloc;
-  ThrowIfFailed(curAlloc->Reset());
+void TexCrate::UpdateConstantBuffers() {
+  auto* uploadAllocator = currentFrameResource_->uploadAllocator.get();
 
-  auto* pso = wireframe_ ? psoWireframe_.Get() : pso_.Get();
-  ThrowIfFailed(commandList_->Reset(curAlloc.Get(), pso));
+  auto& drawConstants = currentFrameResource_->drawConstants;
+  drawConstants.resize(drawItems_.size());
+  for (const auto* item : drawItems_) {
+    drawConstants[item->objectCbufferIndex] = DrawConstant::FromMatrices(item->modelToWorld,
+                                                                         item->texTransform);
+  }
 
-  SetViewportAndScissorRects();
+  // Root constants are recorded straight into the command list; only a root CBV needs a copy.
+  auto& objectCbAddresses = currentFrameResource_->objectCbAddresses;
+  objectCbAddresses.clear();
+  if (!drawConstantsInRoot_) {
+    for (const auto& c : drawConstants) {
+      objectCbAddresses.push_back(uploadAllocator->PushConstants(c));
+    }
+  }
 
-  Transition(swapChain_->GetCurrentBackBuffer(),
-             D3D12_RESOURCE_STATE_PRESENT,
-             D3D12_RESOURCE_STATE_RENDER_TARGET);
+  auto& materialCbAddresses = currentFrameResource_->materialCbAddresses;
+  materialCbAddresses.resize(materials_.size());
+  for (auto& mat : materials_) {
+    Material* m = mat.second.get();
+    MaterialConstants c;
+    c.DiffuseAlbedo = m->DiffuseAlbedo;
+    c.FresnelR0 = m->FresnelR0;
+    c.Roughness = m->Roughness;
+    c.MatTransform = m->MatTransform;
+    materialCbAddresses[m->MatCBIndex] = uploadAllocator->PushConstants(c);
+  }
+}
 
-  auto rtv = swapChain_->GetCurrentBackBufferView();
-  commandList_->ClearRenderTargetView(rtv, Colors::LightSteelBlue, 0, nullptr);
+void TexCrate::UpdateBindlessBuffers() {
+  auto* uploadAllocator = currentFrameResource_->uploadAllocator.get();
 
-  auto dsv = dsvHeap_->GetDescriptorHandleCpu(0);
-  commandList_->ClearDepthStencilView(dsv,
-                                      D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL,
-                                      1.0f,
-                                      0,
-                                      0,
-                                      nullptr);
+  // One array of objects and one of materials, indexed by each draw's root constants. Changed
+  // items go to the CPU mirror, and this frame's copy takes the mirror's dirty runs.
+  for (auto* item : drawItems_) {
+    if (item->dirtyFrameCount > 0) {
+      ObjectConstant objConst;
+      objConst.model = item->modelToWorld;
+      objConst.texTransform = item->texTransform;
+      objectMirror_->Set(item->objectCbufferIndex, objConst);
+      item->dirtyFrameCount = 0;
+    }
+  }
+
+  auto* objectBuffer = currentFrameResource_->objectBuffer.get();
+  for (const auto& range : objectMirror_->TakeDirtyRanges(currentFrameResourceIndex_)) {
+    const auto* first = reinterpret_cast<const ObjectConstant*>(objectMirror_->GetData(range.first));
+    objectBuffer->Load(static_cast<int>(range.first), first, range.count);
+  }
 
-  commandList_->OMSetRenderTargets(1, &rtv, true, &dsv);
+  auto materials = uploadAllocator->Allocate(sizeof(MaterialData) * materialTable_.GetCount(), 16);
+  MappedWriter materialWriter(materials.cpu, materials.size);
+  materialTable_.Pack(materialWriter);
+  currentFrameResource_->materialBufferAddress = materials.gpu;
+}
 
-  commandList_->SetGraphicsRootSignature(rootSignature_.Get());
+void TexCrate::DrawFrame(const SceneSnapshot& snapshot) {
+  auto* pso = snapshot.wireframe ? psoWireframe_.Get() : pso_.Get();
+  commandListBackend_->SetInitialState(pso);
 
-  // Bind pass constant buffer
-  commandList_->SetGraphicsRootConstantBufferView(
-      2,
-      currentFrameResource_->passCbuffer->GetElementGpuVirtualAddress(0));
+  auto* backBuffer = swapChain_->GetCurrentBackBuffer();
+  auto rtv = swapChain_->GetCurrentBackBufferView();
+  auto dsv = dsvHeap_->GetDescriptorHandleCpu(0);
 
-  DrawAllRenderItems();
+  frameGraph_->Reset();
+  auto target = frameGraph_->Import("BackBuffer",
+                                    backBuffer,
+                                    stateTracker_.GetState(backBuffer),
+                                    D3D12_RESOURCE_STATE_PRESENT);
+  auto depth = frameGraph_->Import("DepthStencil",
+                                   depthStencilBuffer_.Get(),
+                                   stateTracker_.GetState(depthStencilBuffer_.Get()),
+                                   D3D12_RESOURCE_STATE_DEPTH_WRITE);
+
+  // Clear on this thread, then draw on the workers.
+  auto scene = [&](FrameGraph::PassContext& context) {
+    auto& recorder = context.GetRecorder();
+
+    auto clear = recorder.Begin();
+    clear.commandList->ClearRenderTargetView(rtv, Colors::LightSteelBlue, 0, nullptr);
+    clear.commandList->ClearDepthStencilView(dsv,
+                                             D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL,
+                                             1.0f,
+                                             0,
+                                             0,
+                                             nullptr);
+    recorder.End(clear);
+
+    recorder.Record(drawItems_.size(), [&](const ParallelRecorder::List& list, size_t first, size_t count) {
+      auto* cmdList = list.commandList;
+      cmdList->RSSetViewports(1, &viewport_);
+      cmdList->RSSetScissorRects(1, &scissorRect_);
+      cmdList->OMSetRenderTargets(1, &rtv, true, &dsv);
+      cmdList->SetGraphicsRootSignature(rootSignature_.Get());
+      cmdList->SetGraphicsRootConstantBufferView(passRootParam_, currentFrameResource_->passCbAddress);
+
+      if (bindless_) {
+        DrawRenderItemsBindless(cmdList, first, count);
+      } else {
+        DrawRenderItems(cmdList, first, count);
+      }
+    });
+  };
+  frameGraph_->AddPass("Scene", scene)
+      .Write(target, D3D12_RESOURCE_STATE_RENDER_TARGET)
+      .Write(depth, D3D12_RESOURCE_STATE_DEPTH_WRITE);
 
-  Transition(swapChain_->GetCurrentBackBuffer(),
-             D3D12_RESOURCE_STATE_RENDER_TARGET,
-             D3D12_RESOURCE_STATE_PRESENT);
+  // Barriers come from the graph, which recompiles only when the passes or states change.
+  frameGraph_->Compile();
+  frameGraph_->Execute(*recorder_, stateTracker_);
 
-  ThrowIfFailed(commandList_->Close());
-  ExecuteCommandList();
+  // Only the first frame drawing an upload waits for its batch; later ones find it complete.
+  for (const auto* item : drawItems_) {
+    copyUploader_->Require(item->upload);
+  }
+  copyUploader_->Require(packedTexturesUpload_);
+  copyUploader_->InsertWaits(commandQueue_.Get());
 
-  ThrowIfFailed(swapChain_->Present());
-  swapChain_->SwapBuffers();
+  recorder_->Submit();
 
   currentFrameResource_->fence = ++nextFenceValue_;
   ThrowIfFailed(commandQueue_->Signal(fence_.Get(), nextFenceValue_));
+  srvAllocator_->EndFrame(nextFenceValue_);
+  staticBufferAllocator_->EndFrame(nextFenceValue_);
+  commandListBackend_->EndFrame(nextFenceValue_);
+  frameGraph_->EndFrame(nextFenceValue_);
+  framePacer_->EndFrame(nextFenceValue_);
+
+  // Waits for the next frame only once this one is fully accounted for.
+  PresentFrame();
+}
+
+void TexCrate::ReportResourceStats() {
+  if (!s_reportStats) {
+    return;
+  }
+
+  const auto& stats = textureCache_->GetStats();
+  DebugPrint("Texture cache: %llu hits, %llu misses, %llu evictions, %.1f MB resident\n",
+             stats.hits,
+             stats.misses,
+             stats.evictions,
+             stats.residentBytes / (1024.0 * 1024.0));
+
+  const auto& copyStats = copyUploader_->GetStats();
+  DebugPrint("Copy queue: %llu uploads, %.1f KB in %llu batches\n",
+             copyStats.uploads,
+             copyStats.bytes / 1024.0,
+             copyStats.batches);
+
+  const auto& ringStats = copyQueueBackend_->GetUploadRing().GetStats();
+  DebugPrint("Upload ring: %llu allocations, %.1f KB, %llu wraparounds, %llu stalls, %llu overflows\n",
+             ringStats.allocations,
+             ringStats.bytesAllocated / 1024.0,
+             ringStats.wraparounds,
+             ringStats.stalls,
+             ringStats.overflows);
+
+  auto heapStats = staticBufferAllocator_->GetStats();
+  DebugPrint("Static buffers: %zu in %zu blocks, %.1f KB of %.1f KB, %.0f%% occupied, %.0f%% fragmented\n",
+             heapStats.allocationCount,
+             heapStats.blockCount,
+             heapStats.bytesRequested / 1024.0,
+             heapStats.bytesReserved / 1024.0,
+             heapStats.Occupancy() * 100.0,
+             heapStats.Fragmentation() * 100.0);
+
+  DebugPrint("CPU buffer shadows: %.1f KB full, %.1f KB compact, %zu buffers without\n",
+             DefaultBuffer::GetCpuShadowBytes(CpuShadowPolicy::Full) / 1024.0,
+             DefaultBuffer::GetCpuShadowBytes(CpuShadowPolicy::Compact) / 1024.0,
+             DefaultBuffer::GetCpuShadowCount(CpuShadowPolicy::None));
+}
+
+void TexCrate::ReportFramePacing() {
+  const auto& stats = framePacer_->GetStats();
+  if (!s_reportStats || stats.frames < s_pacingReportFrames) {
+    return;
+  }
+
+  auto channelStats = sceneChannel_->GetStats();
+  const auto& presentStats = presentPacing_->GetStats();
+  DebugPrint("Frame pacing (%u in flight): CPU waited %llu/%llu frames, %.2f ms/frame; "
+             "GPU idle %llu frames, <= %.2f ms/frame; %zu command lists; "
+             "game thread waited %llu and render thread %llu times in %llu frames; "
+             "%s presents every %.2f ms, frames cost %.2f ms, started %.2f ms late, %llu missed\n",
+             framePacer_->GetFramesInFlight(),
+             stats.cpuWaitFrames,
+             stats.frames,
+             stats.cpuWaitSeconds * 1000.0 / stats.frames,
+             stats.gpuIdleFrames,
+             stats.gpuIdleSeconds * 1000.0 / stats.frames,
+             commandContextPool_->GetContextCount(D3D12_COMMAND_LIST_TYPE_DIRECT),
+             channelStats.gameWaits,
+             channelStats.renderWaits,
+             channelStats.frames,
+             presentPacing_->GetMode() == FrameLatencyMode::LowLatency ? "Low latency" : "Throughput",
+             presentPacing_->GetPresentInterval() * 1000.0,
+             presentPacing_->GetFrameCost() * 1000.0,
+             presentStats.frames ? presentStats.delaySeconds * 1000.0 / presentStats.frames : 0.0,
+             presentStats.missedPresents);
+  framePacer_->ResetStats();
+  presentPacing_->ResetStats();
 }
 
 void TexCrate::BuildLandGeometry() {
@@ -353,25 +644,16 @@ void TexCrate::BuildLandGeometry() {
     vertices.push_back(Vertex{p, normal(p.x, p.z), v.TexC});
   }
 
-  UINT vbByteSize = vertices.size() * sizeof(Vertex);
-  landVbuffer_ = std::make_unique<VertexBuffer>(sizeof(Vertex), vbByteSize);
-  landVbuffer_->Load(device_.Get(), commandList_.Get(), vertices.data(), vbByteSize);
-
   std::vector<std::uint16_t> indices = gridMesh.GetIndices16();
-
-  UINT ibByteSize = indices.size() * sizeof(std::uint16_t);
-  landIbuffer_ = std::make_unique<IndexBuffer>(DXGI_FORMAT_R16_UINT, ibByteSize);
-  landIbuffer_->Load(device_.Get(), commandList_.Get(), indices.data(), ibByteSize);
+  auto submesh = staticGeometry_->Add(vertices, indices);
 
   RenderItem land;
-  land.indexCount = indices.size();
-  land.indexStart = 0;
-  land.baseVertex = 0;
+  land.indexCount = submesh.indexCount;
+  land.indexStart = submesh.indexStart;
+  land.baseVertex = submesh.baseVertex;
   land.objectCbufferIndex = 0;
   land.modelToWorld = MathHelper::Identity4x4();
   land.mat = materials_["grass"].get();
-  land.vbuffer = landVbuffer_.get();
-  land.ibuffer = landIbuffer_.get();
 
   // Scale grass texture coordinate 5x
   // Grass texture will repeat 5x in [0,1]
@@ -385,14 +667,20 @@ void TexCrate::BuildWavesGeometry() {
 
   UINT ibByteSize = waves_->IndexCount() * sizeof(std::uint16_t);
   wavesIbuffer_ = std::make_unique<IndexBuffer>(DXGI_FORMAT_R16_UINT, ibByteSize);
-  wavesIbuffer_->Load(device_.Get(), commandList_.Get(), waves_->IndexData(), ibByteSize);
+  wavesIbuffer_->Load(copyUploader_->GetCommandList(),
+                      copyQueueBackend_->GetUploadRing(),
+                      *staticBufferAllocator_,
+                      waves_->IndexData(),
+                      ibByteSize);
+  waveRenderItem_.upload = copyUploader_->Commit(ibByteSize);
 
   waveRenderItem_.indexCount = waves_->IndexCount();
   waveRenderItem_.indexStart = 0;
   waveRenderItem_.baseVertex = 0;
-  waveRenderItem_.objectCbufferIndex = 0;
+  waveRenderItem_.objectCbufferIndex = 2;  // after the land (0) and the crate (1)
   waveRenderItem_.modelToWorld = MathHelper::Identity4x4();
   waveRenderItem_.mat = materials_["water"].get();
+  waveRenderItem_.ibuffer = wavesIbuffer_.get();
 }
 
 void TexCrate::BuildCrateGeometry() {
@@ -407,19 +695,13 @@ void TexCrate::BuildCrateGeometry() {
     vertices.push_back(Vertex{pos, normal, texCoord});
   }
 
-  auto vbByteSize = sizeof(Vertex) * vertices.size();
-  crateVbuffer_ = std::make_unique<VertexBuffer>(sizeof(Vertex), vbByteSize);
-  crateVbuffer_->Load(device_.Get(), commandList_.Get(), vertices.data(), vbByteSize);
-
   const std::vector<uint16_t>& indices = crateGeo.GetIndices16();
-  auto ibByteSize = indices.size() * sizeof(uint16_t);
-  crateIbuffer_ = std::make_unique<IndexBuffer>(DXGI_FORMAT_R16_UINT, ibByteSize);
-  crateIbuffer_->Load(device_.Get(), commandList_.Get(), indices.data(), ibByteSize);
+  auto submesh = staticGeometry_->Add(vertices, indices);
 
   RenderItem crate;
-  crate.indexCount = indices.size();
-  crate.indexStart = 0;
-  crate.baseVertex = 0;
+  crate.indexCount = submesh.indexCount;
+  crate.indexStart = submesh.indexStart;
+  crate.baseVertex = submesh.baseVertex;
   crate.objectCbufferIndex = 1;  // live inside object cbuffer with land constant buffer
 
   float scale = 8.0f;
@@ -429,199 +711,331 @@ void TexCrate::BuildCrateGeometry() {
   XMStoreFloat4x4(&crate.modelToWorld, transform);
 
   crate.mat = materials_["crate"].get();
-  crate.vbuffer = crateVbuffer_.get();
-  crate.ibuffer = crateIbuffer_.get();
   renderItems_.push_back(crate);
 }
 
 void TexCrate::LoadTexture() {
-  auto crateTex = std::make_unique<Texture>();
-  crateTex->Name = "WoodCrateTex";
-  crateTex->Filename = L"WoodCrate01.dds";
-  ThrowIfFailed(CreateDDSTextureFromFile12(device_.Get(),
-                                           commandList_.Get(),
-                                           crateTex->Filename.c_str(),
-                                           crateTex->Resource,
-                                           crateTex->UploadHeap));
-
-  crateTex_ = std::move(crateTex);
-
-  grassTex_ = std::make_unique<Texture>();
-  grassTex_->Name = "Grass";
-  grassTex_->Filename = L"grass.dds";
-  ThrowIfFailed(CreateDDSTextureFromFile12(device_.Get(),
-                                           commandList_.Get(),
-                                           grassTex_->Filename.c_str(),
-                                           grassTex_->Resource,
-                                           grassTex_->UploadHeap));
-
-  stoneTex_ = std::make_unique<Texture>();
-  stoneTex_->Name = "Stone";
-  stoneTex_->Filename = L"stone.dds";
-  ThrowIfFailed(CreateDDSTextureFromFile12(device_.Get(),
-                                           commandList_.Get(),
-                                           stoneTex_->Filename.c_str(),
-                                           stoneTex_->Resource,
-                                           stoneTex_->UploadHeap));
-
-  waterTex_ = std::make_unique<Texture>();
-  waterTex_->Name = "Water";
-  waterTex_->Filename = L"water1.dds";
-  ThrowIfFailed(CreateDDSTextureFromFile12(device_.Get(),
-                                           commandList_.Get(),
-                                           waterTex_->Filename.c_str(),
-                                           waterTex_->Resource,
-                                           waterTex_->UploadHeap));
-
-  // Create srv heap
-  {
-    D3D12_DESCRIPTOR_HEAP_DESC desc{};
-    desc.NumDescriptors = 4;
-    desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-    desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-    srvHeap_ = std::make_unique<DescriptorHeap>(device_.Get(), desc);
-  }
-
-  // Crate 3x srv in the heap
-  // srv[0]: crate
-  // srv[1]: grass
-  // srv[2]: stone
-  // srv[3]: water
-  {
-    auto tex = crateTex_->Resource.Get();
+  // Repeat loads of the same content (under any filename) share one resource.
+  if (!textureCache_) {
+    textureCache_ = std::make_unique<TextureCache>(device_.Get(), 64ull << 20);
+    // An evicted texture may still be read by the copy queue (its upload, or packing) and by
+    // frames in flight on the graphics queue; it goes once both are done with it.
+    textureCache_->SetRetireCallback([this](ComPtr<ID3D12Resource> resource) {
+      copyUploader_->Retain(resource);
+      DeferRelease(std::move(resource));
+    });
+  }
 
-    D3D12_SHADER_RESOURCE_VIEW_DESC desc{};
-    desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-    desc.Format = tex->GetDesc().Format;
-    desc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-    desc.Texture2D.MostDetailedMip = 0;
-    desc.Texture2D.MipLevels = tex->GetDesc().MipLevels;
-    desc.Texture2D.ResourceMinLODClamp = 0.0f;
+  // Files shipped without a mip chain (stone.dds) get one built at load time. Each texture is
+  // submitted on its own so that the copy queue uploads it while the next file is parsed.
+  auto load = [this](const wchar_t* filename) {
+    auto texture = textureCache_->Load(copyUploader_->GetCommandList(), filename, DDS_LOADER_MIP_AUTOGEN);
+    if (texture->UploadHeap) {  // not a cache hit
+      copyUploader_->Commit(texture->UploadHeap->GetDesc().Width);
+      copyUploader_->Retain(std::move(texture->UploadHeap));
+      copyUploader_->Flush();
+    }
+    return texture;
+  };
+  crateTex_ = load(L"WoodCrate01.dds");
+  grassTex_ = load(L"grass.dds");
+  stoneTex_ = load(L"stone.dds");
+  waterTex_ = load(L"water1.dds");
+
+  PackTextures();
+}
+
+void TexCrate::PackTextures() {
+  // Merge the material textures into as few Texture2DArrays as possible so that draws sharing a
+  // group keep the same descriptor table. Each material samples its slice (and atlas region)
+  // through MatTransform. Tiling textures are never put in an atlas.
+  struct Entry {
+    Texture* tex;
+    const char* material;
+    bool tiling;
+  };
+  const Entry entries[] = {{crateTex_.get(), "crate", false},
+                           {grassTex_.get(), "grass", true},
+                           {stoneTex_.get(), nullptr, false},
+                           {waterTex_.get(), "water", true}};
+
+  auto isBlockCompressed = [](DXGI_FORMAT f) {
+    return (f >= DXGI_FORMAT_BC1_TYPELESS && f <= DXGI_FORMAT_BC5_SNORM) ||
+           (f >= DXGI_FORMAT_BC6H_TYPELESS && f <= DXGI_FORMAT_BC7_UNORM_SRGB);
+  };
 
-    device_->CreateShaderResourceView(tex, &desc, srvHeap_->GetDescriptorHandleCpu(0));
+  std::vector<TexturePacker::Source> sources;
+  for (const auto& entry : entries) {
+    auto desc = entry.tex->Resource->GetDesc();
+    TexturePacker::Source source;
+    source.name = entry.tex->Name;
+    source.format = desc.Format;
+    source.width = static_cast<uint32_t>(desc.Width);
+    source.height = desc.Height;
+    source.mipCount = desc.MipLevels;
+    source.blockDim = isBlockCompressed(desc.Format) ? 4 : 1;
+    source.tiling = entry.tiling;
+    sources.push_back(source);
   }
-  {
-    auto tex = grassTex_->Resource.Get();
 
-    D3D12_SHADER_RESOURCE_VIEW_DESC desc{};
-    desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-    desc.Format = tex->GetDesc().Format;
-    desc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-    desc.Texture2D.MostDetailedMip = 0;
-    desc.Texture2D.MipLevels = tex->GetDesc().MipLevels;
-    desc.Texture2D.ResourceMinLODClamp = 0.0f;
+  auto plan = TexturePacker().Pack(sources);
 
-    device_->CreateShaderResourceView(tex, &desc, srvHeap_->GetDescriptorHandleCpu(1));
+  // Sources uploaded in the open batch are still in COPY_DEST until it has executed. Once it has,
+  // they are back in COMMON and the copies below promote them to COPY_SOURCE.
+  copyUploader_->Flush();
+  auto* cmdList = copyUploader_->GetCommandList();
+  for (const auto& entry : entries) {
+    copyUploader_->Retain(entry.tex->Resource);
   }
-  {
-    auto tex = stoneTex_->Resource.Get();
 
-    D3D12_SHADER_RESOURCE_VIEW_DESC desc{};
-    desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-    desc.Format = tex->GetDesc().Format;
-    desc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-    desc.Texture2D.MostDetailedMip = 0;
-    desc.Texture2D.MipLevels = tex->GetDesc().MipLevels;
-    desc.Texture2D.ResourceMinLODClamp = 0.0f;
+  packedTextures_.clear();
+  UINT64 packedBytes = 0;
+  for (const auto& group : plan.groups) {
+    auto desc = CD3DX12_RESOURCE_DESC::Tex2D(static_cast<DXGI_FORMAT>(group.format),
+                                             group.width,
+                                             group.height,
+                                             static_cast<UINT16>(group.arraySize),
+                                             static_cast<UINT16>(group.mipCount));
+    auto heapProp = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+    ComPtr<ID3D12Resource> packed;
+    ThrowIfFailed(device_->CreateCommittedResource(&heapProp,
+                                                   D3D12_HEAP_FLAG_NONE,
+                                                   &desc,
+                                                   D3D12_RESOURCE_STATE_COMMON,
+                                                   nullptr,
+                                                   IID_PPV_ARGS(packed.GetAddressOf())));
+    packedBytes += device_->GetResourceAllocationInfo(0, 1, &desc).SizeInBytes;
+
+    for (UINT slice = 0; slice < group.arraySize; ++slice) {
+      for (UINT mip = 0; mip < group.mipCount; ++mip) {
+        UINT dstSub = D3D12CalcSubresource(mip, slice, 0, group.mipCount, group.arraySize);
+        CD3DX12_TEXTURE_COPY_LOCATION dst(packed.Get(), dstSub);
+
+        if (group.kind == TexturePacker::Kind::Array) {
+          CD3DX12_TEXTURE_COPY_LOCATION src(entries[group.sources[slice]].tex->Resource.Get(), mip);
+          cmdList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+          continue;
+        }
+
+        // Atlas: copy every entry, then replicate its edge texels (whole blocks for BC formats)
+        // outwards to fill the guard band.
+        for (size_t index : group.sources) {
+          const auto& source = sources[index];
+          const auto& placement = plan.placements[index];
+          CD3DX12_TEXTURE_COPY_LOCATION src(entries[index].tex->Resource.Get(), mip);
+
+          int w = static_cast<int>(std::max(1u, source.width >> mip));
+          int h = static_cast<int>(std::max(1u, source.height >> mip));
+          int x = static_cast<int>(placement.x >> mip);
+          int y = static_cast<int>(placement.y >> mip);
+          int guard = static_cast<int>(group.guardTexels >> mip);
+          int step = static_cast<int>(source.blockDim);
+
+          // The guard band of an entry at an atlas edge reaches past it, and the edge strips of
+          // a level smaller than a block reach past the source, so both rectangles are signed
+          // and clipped (the destination to the level, rounded up to whole blocks) before use.
+          int levelWidth = static_cast<int>((std::max(1u, group.width >> mip) + step - 1) / step * step);
+          int levelHeight = static_cast<int>((std::max(1u, group.height >> mip) + step - 1) / step * step);
+          auto copy = [&](int dx, int dy, int left, int top, int right, int bottom) {
+            if (left < 0) {
+              dx -= left;
+              left = 0;
+            }
+            if (top < 0) {
+              dy -= top;
+              top = 0;
+            }
+            if (dx < 0) {
+              left -= dx;
+              dx = 0;
+            }
+            if (dy < 0) {
+              top -= dy;
+              dy = 0;
+            }
+            right = std::min({right, w, left + levelWidth - dx});
+            bottom = std::min({bottom, h, top + levelHeight - dy});
+            if (left >= right || top >= bottom) {
+              return;
+            }
+            D3D12_BOX box = {static_cast<UINT>(left),
+                             static_cast<UINT>(top),
+                             0,
+                             static_cast<UINT>(right),
+                             static_cast<UINT>(bottom),
+                             1};
+            cmdList->CopyTextureRegion(&dst, static_cast<UINT>(dx), static_cast<UINT>(dy), 0, &src, &box);
+          };
+
+          copy(x, y, 0, 0, w, h);
+          for (int d = step; d <= guard; d += step) {
+            copy(x - d, y, 0, 0, step, h);
+            copy(x + w + d - step, y, w - step, 0, w, h);
+            copy(x, y - d, 0, 0, w, step);
+            copy(x, y + h + d - step, 0, h - step, w, h);
+            for (int e = step; e <= guard; e += step) {
+              copy(x - d, y - e, 0, 0, step, step);
+              copy(x + w + d - step, y - e, w - step, 0, w, step);
+              copy(x - d, y + h + e - step, 0, h - step, step, h);
+              copy(x + w + d - step, y + h + e - step, w - step, h - step, w, h);
+            }
+          }
+        }
+      }
+    }
+
+    packedTextures_.push_back(packed);
+  }
 
-    device_->CreateShaderResourceView(tex, &desc, srvHeap_->GetDescriptorHandleCpu(2));
+  // Left in COMMON; the first draw sampling them promotes them to PIXEL_SHADER_RESOURCE.
+  packedTexturesUpload_ = copyUploader_->Commit(packedBytes);
+  copyUploader_->Flush();
+
+  // One Texture2DArray srv per group, in a contiguous range of the shader-visible heap
+  if (!srvAllocator_) {
+    srvAllocator_ = std::make_unique<DescriptorAllocator>(device_.Get(),
+                                                          D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
+                                                          s_persistentSrvCount,
+                                                          s_transientSrvCount,
+                                                          true);
+  }
+  if (srvAllocator_->IsValid(packedSrvs_)) {
+    srvAllocator_->Free(packedSrvs_);
   }
-  {
-    auto tex = waterTex_->Resource.Get();
+  packedSrvs_ = srvAllocator_->Allocate(static_cast<UINT>(packedTextures_.size()));
+
+  for (size_t i = 0; i < packedTextures_.size(); ++i) {
+    auto tex = packedTextures_[i].Get();
 
     D3D12_SHADER_RESOURCE_VIEW_DESC desc{};
     desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
     desc.Format = tex->GetDesc().Format;
-    desc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-    desc.Texture2D.MostDetailedMip = 0;
-    desc.Texture2D.MipLevels = tex->GetDesc().MipLevels;
-    desc.Texture2D.ResourceMinLODClamp = 0.0f;
+    desc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2DARRAY;
+    desc.Texture2DArray.MostDetailedMip = 0;
+    desc.Texture2DArray.MipLevels = tex->GetDesc().MipLevels;
+    desc.Texture2DArray.FirstArraySlice = 0;
+    desc.Texture2DArray.ArraySize = tex->GetDesc().DepthOrArraySize;
+    desc.Texture2DArray.ResourceMinLODClamp = 0.0f;
+
+    auto srv = srvAllocator_->GetCpuHandle(packedSrvs_, static_cast<UINT>(i));
+    device_->CreateShaderResourceView(tex, &desc, srv);
+  }
 
-    device_->CreateShaderResourceView(tex, &desc, srvHeap_->GetDescriptorHandleCpu(3));
+  for (size_t i = 0; i < std::size(entries); ++i) {
+    if (!entries[i].material) {
+      continue;
+    }
+    Material* mat = materials_[entries[i].material].get();
+    mat->DiffuseSrvHeapIndex = static_cast<int>(packedSrvs_.index + plan.placements[i].group);
+    TexturePacker::WriteMatTransform(plan.placements[i], mat->MatTransform.m);
   }
 }
 
-void TexCrate::DrawAllRenderItems() {
-  auto* objectCbuffer = currentFrameResource_->objectCbuffer.get();
-  auto* matCbuffer = currentFrameResource_->materialCbuffer.get();
-
-  ID3D12DescriptorHeap* heaps[] = {srvHeap_->Get()};
-  commandList_->SetDescriptorHeaps(1, heaps);
-
-  // Draw land & crate
-  for (const auto& item : renderItems_) {
-    // bind VBV and IBV
-    auto vbv = item.vbuffer->GetView();
-    commandList_->IASetVertexBuffers(0, 1, &vbv);
+void TexCrate::BindGeometry(ID3D12GraphicsCommandList* cmdList,
+                            const RenderItem& item,
+                            BoundGeometry& bound) {
+  if (!bound.valid || item.vbuffer != bound.vbuffer) {
+    // The waves have no VertexBuffer; their vertices are rewritten in each frame's upload buffer.
+    auto vbv = item.vbuffer ? item.vbuffer->GetView()
+                            : ViewAsVertexBuffer(currentFrameResource_->waveVbuffer.get());
+    cmdList->IASetVertexBuffers(0, 1, &vbv);
+  }
 
+  if (!bound.valid || item.ibuffer != bound.ibuffer) {
     auto ibv = item.ibuffer->GetView();
-    commandList_->IASetIndexBuffer(&ibv);
-
-    // bind CBV to object constant buffer
-    auto objCbufferAddress = objectCbuffer->GetElementGpuVirtualAddress(item.objectCbufferIndex);
-    commandList_->SetGraphicsRootConstantBufferView(0, objCbufferAddress);
-    commandList_->IASetPrimitiveTopology(item.primitiveType);
-
-    auto matCbufferAddress = matCbuffer->GetElementGpuVirtualAddress(item.mat->MatCBIndex);
-    commandList_->SetGraphicsRootConstantBufferView(1, matCbufferAddress);
-
-    auto texSrv = srvHeap_->GetDescriptorHandleGpu(item.mat->DiffuseSrvHeapIndex);
-    commandList_->SetGraphicsRootDescriptorTable(3, texSrv);
+    cmdList->IASetIndexBuffer(&ibv);
+  }
 
-    commandList_->DrawIndexedInstanced(item.indexCount, 1, item.indexStart, item.baseVertex, 0);
+  if (!bound.valid || item.primitiveType != bound.topology) {
+    cmdList->IASetPrimitiveTopology(item.primitiveType);
   }
 
-  // Draw waves
-  auto* waveVbuffer = currentFrameResource_->waveVbuffer.get();
-  D3D12_VERTEX_BUFFER_VIEW vbv = ViewAsVertexBuffer(waveVbuffer);
-  commandList_->IASetVertexBuffers(0, 1, &vbv);
+  bound = {true, item.vbuffer, item.ibuffer, item.primitiveType};
+}
 
-  auto ibv = wavesIbuffer_->GetView();
-  commandList_->IASetIndexBuffer(&ibv);
+void TexCrate::DrawRenderItems(ID3D12GraphicsCommandList* cmdList, size_t first, size_t count) {
+  const auto& drawConstants = currentFrameResource_->drawConstants;
+  const auto& objectCbAddresses = currentFrameResource_->objectCbAddresses;
+  const auto& materialCbAddresses = currentFrameResource_->materialCbAddresses;
+
+  ID3D12DescriptorHeap* heaps[] = {srvAllocator_->GetHeap()};
+  cmdList->SetDescriptorHeaps(1, heaps);
+
+  // Materials packed into the same texture group share a descriptor table; only rebind on change.
+  int boundSrv = -1;
+  BoundGeometry bound;
+
+  for (size_t i = first; i < first + count; ++i) {
+    const RenderItem& item = *drawItems_[i];
+    BindGeometry(cmdList, item, bound);
+
+    if (drawConstantsInRoot_) {
+      cmdList->SetGraphicsRoot32BitConstants(drawRootParam_,
+                                             sizeof(DrawConstant) / 4,
+                                             &drawConstants[item.objectCbufferIndex],
+                                             0);
+    } else {
+      cmdList->SetGraphicsRootConstantBufferView(drawRootParam_,
+                                                 objectCbAddresses[item.objectCbufferIndex]);
+    }
 
-  auto address = objectCbuffer->GetElementGpuVirtualAddress(waveRenderItem_.objectCbufferIndex);
-  auto matAddress = matCbuffer->GetElementGpuVirtualAddress(waveRenderItem_.mat->MatCBIndex);
-  commandList_->SetGraphicsRootConstantBufferView(0, address);
-  commandList_->SetGraphicsRootConstantBufferView(1, matAddress);
+    cmdList->SetGraphicsRootConstantBufferView(materialRootParam_,
+                                               materialCbAddresses[item.mat->MatCBIndex]);
 
-  auto waterSrv = srvHeap_->GetDescriptorHandleGpu(waveRenderItem_.mat->DiffuseSrvHeapIndex);
-  commandList_->SetGraphicsRootDescriptorTable(3, waterSrv);
+    if (item.mat->DiffuseSrvHeapIndex != boundSrv) {
+      boundSrv = item.mat->DiffuseSrvHeapIndex;
+      cmdList->SetGraphicsRootDescriptorTable(textureRootParam_, srvAllocator_->GetGpuHandle(boundSrv));
+    }
 
-  commandList_->IASetPrimitiveTopology(waveRenderItem_.primitiveType);
+    cmdList->DrawIndexedInstanced(item.indexCount, 1, item.indexStart, item.baseVertex, 0);
+  }
+}
 
-  commandList_->DrawIndexedInstanced(waveRenderItem_.indexCount,
-                                     1,
-                                     waveRenderItem_.indexStart,
-                                     waveRenderItem_.baseVertex,
-                                     0);
+void TexCrate::DrawRenderItemsBindless(ID3D12GraphicsCommandList* cmdList, size_t first, size_t count) {
+  ID3D12DescriptorHeap* heaps[] = {srvAllocator_->GetHeap()};
+  cmdList->SetDescriptorHeaps(1, heaps);
+
+  // Everything but the indices is bound once per list.
+  auto objectBuffer = currentFrameResource_->objectBuffer->GetElementGpuVirtualAddress(0);
+  cmdList->SetGraphicsRootShaderResourceView(objectBufferRootParam_, objectBuffer);
+  cmdList->SetGraphicsRootShaderResourceView(materialBufferRootParam_,
+                                             currentFrameResource_->materialBufferAddress);
+  cmdList->SetGraphicsRootDescriptorTable(textureRootParam_, srvAllocator_->GetGpuHandle(0u));
+
+  BoundGeometry bound;
+  for (size_t i = first; i < first + count; ++i) {
+    const RenderItem& item = *drawItems_[i];
+    BindGeometry(cmdList, item, bound);
+
+    UINT indices[] = {item.objectCbufferIndex, static_cast<UINT>(item.mat->MatCBIndex)};
+    cmdList->SetGraphicsRoot32BitConstants(drawRootParam_, 2, indices, 0);
+    cmdList->DrawIndexedInstanced(item.indexCount, 1, item.indexStart, item.baseVertex, 0);
+  }
 }
 
 void TexCrate::BuildMaterials() {
   auto grass = std::make_unique<Material>();
   grass->Name = "grass";
-  grass->MatCBIndex = 0;
   grass->DiffuseAlbedo = XMFLOAT4(0.2f, 0.6f, 0.6f, 1.0f);
   grass->FresnelR0 = XMFLOAT3(0.01f, 0.01f, 0.01f);
   grass->Roughness = 0.125f;
-  grass->DiffuseSrvHeapIndex = 1;  // grass
+  materialTable_.Add(grass.get());
   materials_["grass"] = std::move(grass);
 
   auto water = std::make_unique<Material>();
   water->Name = "water";
-  water->MatCBIndex = 1;
   water->DiffuseAlbedo = XMFLOAT4(0.0f, 0.2f, 0.6f, 1.0f);
   water->FresnelR0 = XMFLOAT3(0.1f, 0.1f, 0.1f);
   water->Roughness = 0.0f;
-  water->DiffuseSrvHeapIndex = 3;  // water
+  materialTable_.Add(water.get());
   materials_["water"] = std::move(water);
 
   auto crate = std::make_unique<Material>();
   crate->Name = "crate";
-  crate->MatCBIndex = 2;
   crate->DiffuseAlbedo = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
   crate->FresnelR0 = XMFLOAT3(0.01f, 0.01f, 0.01f);
   crate->Roughness = 0.125f;
-  crate->DiffuseSrvHeapIndex = 0;  // crate
+  materialTable_.Add(crate.get());
   materials_["crate"] = std::move(crate);
 }
 
@@ -1,27 +1,78 @@
 #pragma once
+#include <exception>
+#include <thread>
+
+#include "Common/TextureCache.h"
 #include "FrameResource.h"
+#include "MyApp/CopyUploader.h"
 #include "MyApp/D3DApp.h"
 #include "MyApp/DefaultHeapBuffers.h"
+#include "MyApp/DescriptorAllocator.h"
+#include "MyApp/FrameGraph.h"
+#include "MyApp/GeometryPool.h"
+#include "MyApp/MaterialTable.h"
+#include "MyApp/ParallelRecorder.h"
+#include "MyApp/RenderChannel.h"
+#include "MyApp/RootSignatureBuilder.h"
+#include "MyApp/StructuredBufferMirror.h"
 #include "RenderItem.h"
 #include "WavesGeometry.h"
 
 class TexCrate final : public D3DApp {
 public:
   static constexpr int s_frameResourceCount = 3;
+  static constexpr bool s_reportStats = false;  // resource and pacing stats to the debugger output
+  static constexpr UINT64 s_pacingReportFrames = 600;
+  static constexpr size_t s_minDrawsPerList = 64;
+  static constexpr UINT64 s_uploadPageSize = 64 * 1024;
+  static constexpr UINT64 s_staticBufferBlockSize = 1024 * 1024;
+  static constexpr UINT64 s_copyRingSize = 4 * 1024 * 1024;
+  static constexpr UINT s_persistentSrvCount = 256;
+  static constexpr UINT s_transientSrvCount = 64;
+  static constexpr size_t s_renderPacketCapacity = 1024;
 
   TexCrate(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR pCmdLine, int nCmdShow)
-      : D3DApp(hInstance, hPrevInstance, pCmdLine, nCmdShow) {};
+      : D3DApp(hInstance, hPrevInstance, pCmdLine, nCmdShow) {
+    // An interactive viewer: keep the queue short and start frames late so the camera follows
+    // the mouse closely. -throughput queues frames as deep as DXGI allows, for batch captures.
+    swapChainSettings_.bufferCount = 3;
+    if (!pCmdLine || !wcsstr(pCmdLine, L"-throughput")) {
+      swapChainSettings_.latencyMode = FrameLatencyMode::LowLatency;
+    }
+  }
+
+  // Frame resources may still be in use by the GPU.
+  ~TexCrate() override {
+    StopRenderThread();
+    if (framePacer_) {
+      framePacer_->WaitForIdle();
+    }
+    if (copyUploader_) {
+      copyUploader_->WaitForIdle();
+    }
+  }
 
   void OnKeyDown() override;
 
   void OnMouseMove() override;
 
   void OnInitialize() override;
+
+  void BuildRootSignature();
+
   void WaterTextureAnimation();
 
+  // Game thread: simulates the next frame and publishes it to the render thread.
   void OnUpdate() override;
 
-  void Draw() override;
+  // Both do nothing unless s_reportStats is set.
+  void ReportResourceStats();
+  void ReportFramePacing();
+
+  // Frames are drawn on renderThread_; see RenderLoop().
+  void Draw() override {}
+
+  void OnResize() override;
 
   void BuildLandGeometry();
 
@@ -31,36 +82,118 @@ public:
 
   void LoadTexture();
 
-  void DrawAllRenderItems();
+  void PackTextures();
+
+  void UpdateConstantBuffers();
+
+  void UpdateBindlessBuffers();
+
+  void DrawRenderItems(ID3D12GraphicsCommandList* cmdList, size_t first, size_t count);
+
+  void DrawRenderItemsBindless(ID3D12GraphicsCommandList* cmdList, size_t first, size_t count);
 
   void BuildMaterials();
 
 private:
+  // What the game thread hands the render thread for one frame.
+  struct SceneSnapshot {
+    PassConstant pass;
+    DirectX::XMFLOAT2 waterOffset = {0.0f, 0.0f};  // texture translation of the water material
+    bool wireframe = false;
+    std::vector<Vertex> waveVertices;
+  };
+
+  // A draw item whose transform or material changed.
+  struct RenderPacket {
+    UINT item = 0;      // into drawItems_
+    UINT material = 0;  // MatCBIndex
+    DirectX::XMFLOAT4X4 modelToWorld;
+  };
+
+  using SceneChannel = RenderChannel<SceneSnapshot, RenderPacket>;
+
+  // The game thread's side of a draw item; sent as a packet while dirty.
+  struct GameItem {
+    DirectX::XMFLOAT4X4 modelToWorld;
+    UINT material = 0;
+    bool dirty = true;
+  };
+
+  void StartRenderThread();
+
+  // Lets the render thread finish the frames already published, then joins it.
+  void StopRenderThread();
+
+  void RenderLoop();
+
+  // Render thread: takes over the frame resource and writes the frame's constants.
+  void BeginRenderFrame(const SceneSnapshot& snapshot);
+
+  void DrawFrame(const SceneSnapshot& snapshot);
+
+  std::unique_ptr<SceneChannel> sceneChannel_;
+  std::thread renderThread_;
+  std::exception_ptr renderError_;  // set by the render thread before it closes the channel
+
+  // Owned by the game thread once the render thread runs.
+  std::vector<GameItem> gameItems_;
+  DirectX::XMFLOAT2 waterOffset_ = {0.0f, 0.0f};
+
+  std::unique_ptr<D3D12CopyQueueBackend> copyQueueBackend_;
+  std::unique_ptr<CopyUploader> copyUploader_;
+
+  // Declared before the buffers it backs so that it outlives them.
+  std::unique_ptr<D3D12DefaultHeapBackend> staticBufferBackend_;
+  std::unique_ptr<DefaultHeapAllocator> staticBufferAllocator_;
+
   std::unique_ptr<WavesGeometry> waves_;
   std::unique_ptr<IndexBuffer> wavesIbuffer_;
 
-  std::unique_ptr<VertexBuffer> landVbuffer_;
-  std::unique_ptr<IndexBuffer> landIbuffer_;
-
-  std::array<std::unique_ptr<FrameResource>, s_frameResourceCount> frameResources_;
+  std::unique_ptr<GeometryPool> staticGeometry_;
+
+  std::unique_ptr<D3D12UploadBackend> uploadBackend_;
+  // Frames the CPU may record ahead of the GPU; takes effect in OnInitialize().
+  UINT framesInFlight_ = s_frameResourceCount;
+  std::unique_ptr<FramePacer> framePacer_;
+  std::vector<std::unique_ptr<FrameResource>> frameResources_;
+  std::unique_ptr<D3D12CommandListBackend> commandListBackend_;
+  std::unique_ptr<ParallelRecorder> recorder_;
+  std::unique_ptr<D3D12FrameGraphBackend> frameGraphBackend_;
+  std::unique_ptr<FrameGraph> frameGraph_;  // declared again every frame, compiled on change
   int currentFrameResourceIndex_ = 0;
   FrameResource* currentFrameResource_{};
 
   std::vector<RenderItem> renderItems_;
+  std::unique_ptr<StructuredBufferMirror> objectMirror_;  // ObjectConstant by objectCbufferIndex
   RenderItem waveRenderItem_;
+  std::vector<RenderItem*> drawItems_;  // renderItems_, then the waves
 
-  std::unique_ptr<VertexBuffer> crateVbuffer_;
-  std::unique_ptr<IndexBuffer> crateIbuffer_;
   RenderItem crateRenderItem_;
 
-  std::unique_ptr<Texture> crateTex_ = nullptr;
-  std::unique_ptr<Texture> grassTex_ = nullptr;
-  std::unique_ptr<Texture> stoneTex_ = nullptr;
-  std::unique_ptr<Texture> waterTex_ = nullptr;
-  std::unique_ptr<DescriptorHeap> srvHeap_ = nullptr;
+  std::unique_ptr<TextureCache> textureCache_;
+  TextureCache::Handle crateTex_;
+  TextureCache::Handle grassTex_;
+  TextureCache::Handle stoneTex_;
+  TextureCache::Handle waterTex_;
+  std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> packedTextures_;
+  CopyUploader::Ticket packedTexturesUpload_;
+  std::unique_ptr<DescriptorAllocator> srvAllocator_;
+  DescriptorAllocator::Handle packedSrvs_;
 
   Microsoft::WRL::ComPtr<ID3D12RootSignature> rootSignature_;
 
+  // Root parameter indices assigned by BuildRootSignature().
+  UINT drawRootParam_ = 0;
+  UINT materialRootParam_ = 0;
+  UINT passRootParam_ = 0;
+  UINT textureRootParam_ = 0;
+  UINT objectBufferRootParam_ = 0;
+  UINT materialBufferRootParam_ = 0;
+  bool drawConstantsInRoot_ = false;
+
+  // cbuffer declarations matching the root signature, passed to the shaders as ROOT_CBUFFERS.
+  std::string rootCbufferDeclarations_;
+
   Microsoft::WRL::ComPtr<ID3DBlob> vertexShader_;
   Microsoft::WRL::ComPtr<ID3DBlob> pixelShader_;
 
@@ -69,8 +202,20 @@ private:
   Microsoft::WRL::ComPtr<ID3D12PipelineState> psoWireframe_;
 
   std::unordered_map<std::string, std::unique_ptr<Material>> materials_;
+  MaterialTable materialTable_;
+
+  // Set at init when the device supports resource binding tier 2.
+  bool bindless_ = false;
+
+  // Input-assembler state last set on a command list, to skip redundant binds.
+  struct BoundGeometry {
+    bool valid = false;
+    const VertexBuffer* vbuffer = nullptr;
+    const IndexBuffer* ibuffer = nullptr;
+    D3D12_PRIMITIVE_TOPOLOGY topology = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
+  };
 
-  // std::unique_ptr<DescriptorHeap> samplerHeap_;
+  void BindGeometry(ID3D12GraphicsCommandList* cmdList, const RenderItem& item, BoundGeometry& bound);
 
   static std::array<CD3DX12_STATIC_SAMPLER_DESC, 6> GetStaticSamplers();
 
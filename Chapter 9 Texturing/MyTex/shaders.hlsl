@@ -11,18 +11,54 @@
 
 #include "LightingUtil.hlsl"
 
-cbuffer cbPerObject : register(b0) {
-  float4x4 gWorld;
-  float4x4 gTexTransform;
+#ifndef ROOT_CBUFFERS
+#error ROOT_CBUFFERS must be defined by the application
+#endif
+
+#ifdef BINDLESS
+
+// Per-draw state is a pair of indices; objects and materials are read from structured buffers
+// and textures from one unbounded descriptor range.
+struct ObjectData {
+  float4x4 World;
+  float4x4 TexTransform;
 };
 
-cbuffer cbMaterial : register(b1) {
-  float4 gDiffuseAlbedo;
-  float3 gFresnelR0;
-  float gRoughness;
-  float4x4 gMatTransform;
+struct MaterialData {
+  float4 DiffuseAlbedo;
+  float3 FresnelR0;
+  float Roughness;
+  float4x4 MatTransform;
+  uint DiffuseMapIndex;
+  uint3 Pad;
 };
 
+// cbDraw (gObjectIndex, gMaterialIndex) is declared by ROOT_CBUFFERS.
+ROOT_CBUFFERS
+
+StructuredBuffer<ObjectData> gObjects : register(t0);
+StructuredBuffer<MaterialData> gMaterials : register(t1);
+Texture2DArray gTextures[] : register(t0, space1);
+
+#define gWorld gObjects[gObjectIndex].World
+#define gTexTransform gObjects[gObjectIndex].TexTransform
+#define gDiffuseAlbedo gMaterials[gMaterialIndex].DiffuseAlbedo
+#define gFresnelR0 gMaterials[gMaterialIndex].FresnelR0
+#define gRoughness gMaterials[gMaterialIndex].Roughness
+#define gMatTransform gMaterials[gMaterialIndex].MatTransform
+#define gDiffuseMap gTextures[gMaterials[gMaterialIndex].DiffuseMapIndex]
+
+#else
+
+// cbPerObject (gWorld as float3x4, gTexTransform as float2x4) and cbMaterial are declared by
+// ROOT_CBUFFERS, which the application generates along with the root signature.
+ROOT_CBUFFERS
+
+// Material textures are packed into arrays; gMatTransform maps uv into the slice (z) and region.
+Texture2DArray gDiffuseMap : register(t0);
+
+#endif
+
 cbuffer cbPass : register(b2) {
   float4x4 gView;
   float4x4 gInvView;
@@ -41,7 +77,6 @@ cbuffer cbPass : register(b2) {
   Light gLights[MaxLights];
 };
 
-Texture2D gDiffuseMap : register(t0);
 
 SamplerState gPointWrap : register(s0);
 SamplerState gPointClamp : register(s1);
@@ -60,21 +95,22 @@ struct VertexOut {
   float4 PosH : SV_POSITION;
   float3 PosW : POSITION;
   float3 NormalW : NORMAL;
-  float2 TexCoord : TEXCOORD;
+  float3 TexCoord : TEXCOORD;
 };
 
 VertexOut VS(VertexIn vin) {
   VertexOut vout;
 
-  float4 posW = mul(gWorld, float4(vin.PosL, 1.0f));
+  // .xyz/.xy and the 3x3 cast let the same code take full or trimmed matrices.
+  float4 posW = float4(mul(gWorld, float4(vin.PosL, 1.0f)).xyz, 1.0f);
   vout.PosW = posW.xyz;
 
-  vout.NormalW = mul(gWorld, vin.NormalL);
+  vout.NormalW = mul((float3x3)gWorld, vin.NormalL);
 
   vout.PosH = mul(mul(gProj, gView), posW);
 
-  float4 tex = mul(gTexTransform, float4(vin.TexCoord, 0.0f, 1.0f));
-  vout.TexCoord = mul(gMatTransform, tex).xy; 
+  float4 tex = float4(mul(gTexTransform, float4(vin.TexCoord, 0.0f, 1.0f)).xy, 0.0f, 1.0f);
+  vout.TexCoord = mul(gMatTransform, tex).xyz;
   
   return vout;
 }
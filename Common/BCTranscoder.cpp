@@ -0,0 +1,970 @@
+#include "BCTranscoder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "ParallelFor.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#define BC_USE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+constexpr size_t s_blockPixels = 16;
+
+// BC7 4-bit index interpolation weights (out of 64).
+constexpr int s_bc7Weights4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+int Clamp255(float v) {
+    return static_cast<int>(std::min(255.0f, std::max(0.0f, v + 0.5f)));
+}
+
+// Per-channel min/max over the 16 RGBA pixels of a block.
+void BlockMinMax(const uint8_t rgba[64], uint8_t mn[4], uint8_t mx[4]) {
+#if BC_USE_SSE2
+    __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgba));
+    __m128i r1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgba + 16));
+    __m128i r2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgba + 32));
+    __m128i r3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgba + 48));
+
+    __m128i lo = _mm_min_epu8(_mm_min_epu8(r0, r1), _mm_min_epu8(r2, r3));
+    __m128i hi = _mm_max_epu8(_mm_max_epu8(r0, r1), _mm_max_epu8(r2, r3));
+    lo = _mm_min_epu8(lo, _mm_srli_si128(lo, 8));
+    lo = _mm_min_epu8(lo, _mm_srli_si128(lo, 4));
+    hi = _mm_max_epu8(hi, _mm_srli_si128(hi, 8));
+    hi = _mm_max_epu8(hi, _mm_srli_si128(hi, 4));
+
+    int l = _mm_cvtsi128_si32(lo);
+    int h = _mm_cvtsi128_si32(hi);
+    std::memcpy(mn, &l, 4);
+    std::memcpy(mx, &h, 4);
+#else
+    for (int c = 0; c < 4; ++c) {
+        mn[c] = 255;
+        mx[c] = 0;
+    }
+    for (size_t i = 0; i < s_blockPixels; ++i) {
+        for (int c = 0; c < 4; ++c) {
+            mn[c] = std::min(mn[c], rgba[i * 4 + c]);
+            mx[c] = std::max(mx[c], rgba[i * 4 + c]);
+        }
+    }
+#endif
+}
+
+// Projects every pixel onto axis relative to origin and returns the smallest and largest
+// projection. Channels beyond channelCount must be zero in axis.
+void ProjectExtents(const uint8_t rgba[64],
+                    const float origin[4],
+                    const float axis[4],
+                    float& tMin,
+                    float& tMax) {
+    tMin = std::numeric_limits<float>::max();
+    tMax = -std::numeric_limits<float>::max();
+
+#if BC_USE_SSE2
+    const __m128 o = _mm_loadu_ps(origin);
+    const __m128 a = _mm_loadu_ps(axis);
+    const __m128i zero = _mm_setzero_si128();
+
+    for (size_t row = 0; row < 4; ++row) {
+        __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgba + row * 16));
+        __m128i lo16 = _mm_unpacklo_epi8(px, zero);
+        __m128i hi16 = _mm_unpackhi_epi8(px, zero);
+        __m128i p[4] = {_mm_unpacklo_epi16(lo16, zero),
+                        _mm_unpackhi_epi16(lo16, zero),
+                        _mm_unpacklo_epi16(hi16, zero),
+                        _mm_unpackhi_epi16(hi16, zero)};
+
+        for (auto& pi : p) {
+            __m128 d = _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(pi), o), a);
+            d = _mm_add_ps(d, _mm_movehl_ps(d, d));
+            d = _mm_add_ss(d, _mm_shuffle_ps(d, d, 1));
+            float t = _mm_cvtss_f32(d);
+            tMin = std::min(tMin, t);
+            tMax = std::max(tMax, t);
+        }
+    }
+#else
+    for (size_t i = 0; i < s_blockPixels; ++i) {
+        float t = 0.0f;
+        for (int c = 0; c < 4; ++c) {
+            t += (rgba[i * 4 + c] - origin[c]) * axis[c];
+        }
+        tMin = std::min(tMin, t);
+        tMax = std::max(tMax, t);
+    }
+#endif
+}
+
+// Principal axis of the block colors over the first channelCount channels.
+// Returns false when the block is (nearly) a single color.
+bool PrincipalAxis(const uint8_t rgba[64], int channelCount, float mean[4], float axis[4]) {
+    for (int c = 0; c < 4; ++c) {
+        mean[c] = 0.0f;
+        axis[c] = 0.0f;
+    }
+
+    for (size_t i = 0; i < s_blockPixels; ++i) {
+        for (int c = 0; c < channelCount; ++c) {
+            mean[c] += rgba[i * 4 + c];
+        }
+    }
+    for (int c = 0; c < channelCount; ++c) {
+        mean[c] /= s_blockPixels;
+    }
+
+    float cov[4][4] = {};
+    for (size_t i = 0; i < s_blockPixels; ++i) {
+        float d[4] = {};
+        for (int c = 0; c < channelCount; ++c) {
+            d[c] = rgba[i * 4 + c] - mean[c];
+        }
+        for (int r = 0; r < channelCount; ++r) {
+            for (int c = r; c < channelCount; ++c) {
+                cov[r][c] += d[r] * d[c];
+            }
+        }
+    }
+    for (int r = 0; r < channelCount; ++r) {
+        for (int c = 0; c < r; ++c) {
+            cov[r][c] = cov[c][r];
+        }
+    }
+
+    // Power iteration, seeded with the diagonal that has the largest spread. Channels that vary
+    // against the widest one get a negative sign, or a seed like (1, 0, 1) for a red/blue block
+    // would be orthogonal to its axis and the iteration would collapse.
+    int widest = 0;
+    for (int c = 1; c < channelCount; ++c) {
+        if (cov[c][c] > cov[widest][widest]) {
+            widest = c;
+        }
+    }
+    float v[4] = {};
+    for (int c = 0; c < channelCount; ++c) {
+        v[c] = cov[c][c] + 1e-3f;
+        if (cov[widest][c] < 0.0f) {
+            v[c] = -v[c];
+        }
+    }
+
+    float length = 0.0f;
+    for (int iteration = 0; iteration < 8; ++iteration) {
+        float w[4] = {};
+        for (int r = 0; r < channelCount; ++r) {
+            for (int c = 0; c < channelCount; ++c) {
+                w[r] += cov[r][c] * v[c];
+            }
+        }
+
+        length = 0.0f;
+        for (int c = 0; c < channelCount; ++c) {
+            length += w[c] * w[c];
+        }
+        length = std::sqrt(length);
+        if (length < 1e-6f) {
+            return false;
+        }
+        for (int c = 0; c < channelCount; ++c) {
+            v[c] = w[c] / length;
+        }
+    }
+
+    for (int c = 0; c < channelCount; ++c) {
+        axis[c] = v[c];
+    }
+    return true;
+}
+
+// Endpoints along the principal axis, inset by 1/16 of the range to reduce quantization error.
+void AxisEndpoints(const uint8_t rgba[64], int channelCount, float e0[4], float e1[4]) {
+    float mean[4];
+    float axis[4];
+    if (!PrincipalAxis(rgba, channelCount, mean, axis)) {
+        for (int c = 0; c < 4; ++c) {
+            e0[c] = e1[c] = mean[c];
+        }
+        return;
+    }
+
+    float tMin = 0.0f;
+    float tMax = 0.0f;
+    ProjectExtents(rgba, mean, axis, tMin, tMax);
+
+    float inset = (tMax - tMin) / 16.0f;
+    tMin += inset;
+    tMax -= inset;
+
+    for (int c = 0; c < 4; ++c) {
+        e0[c] = std::min(255.0f, std::max(0.0f, mean[c] + axis[c] * tMax));
+        e1[c] = std::min(255.0f, std::max(0.0f, mean[c] + axis[c] * tMin));
+    }
+}
+
+// Least-squares endpoints for fixed per-pixel weights (weight applies to e0).
+bool RefineEndpoints(const uint8_t rgba[64],
+                     const float weights[16],
+                     const bool used[16],
+                     int channelCount,
+                     float e0[4],
+                     float e1[4]) {
+    float aa = 0.0f;
+    float ab = 0.0f;
+    float bb = 0.0f;
+    float ax[4] = {};
+    float bx[4] = {};
+
+    for (size_t i = 0; i < s_blockPixels; ++i) {
+        if (!used[i]) {
+            continue;
+        }
+        float a = weights[i];
+        float b = 1.0f - a;
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for (int c = 0; c < channelCount; ++c) {
+            ax[c] += a * rgba[i * 4 + c];
+            bx[c] += b * rgba[i * 4 + c];
+        }
+    }
+
+    float det = aa * bb - ab * ab;
+    if (std::fabs(det) < 1e-6f) {
+        return false;
+    }
+
+    float inv = 1.0f / det;
+    for (int c = 0; c < channelCount; ++c) {
+        e0[c] = std::min(255.0f, std::max(0.0f, (ax[c] * bb - bx[c] * ab) * inv));
+        e1[c] = std::min(255.0f, std::max(0.0f, (bx[c] * aa - ax[c] * ab) * inv));
+    }
+    return true;
+}
+
+int ColorDistance(const uint8_t* px, const int* palette, int channelCount) {
+    int d = 0;
+    for (int c = 0; c < channelCount; ++c) {
+        int diff = px[c] - palette[c];
+        d += diff * diff;
+    }
+    return d;
+}
+
+//--------------------------------------------------------------------------------------
+// BC1 color block
+//--------------------------------------------------------------------------------------
+uint16_t To565(const float c[4]) {
+    int r = (Clamp255(c[0]) * 31 + 127) / 255;
+    int g = (Clamp255(c[1]) * 63 + 127) / 255;
+    int b = (Clamp255(c[2]) * 31 + 127) / 255;
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+void From565(uint16_t v, int out[4]) {
+    int r = (v >> 11) & 31;
+    int g = (v >> 5) & 63;
+    int b = v & 31;
+    out[0] = (r << 3) | (r >> 2);
+    out[1] = (g << 2) | (g >> 4);
+    out[2] = (b << 3) | (b >> 2);
+    out[3] = 255;
+}
+
+void ColorPalette(uint16_t c0, uint16_t c1, bool fourColor, int palette[4][4]) {
+    From565(c0, palette[0]);
+    From565(c1, palette[1]);
+    for (int c = 0; c < 3; ++c) {
+        if (fourColor) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        } else {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+    }
+    palette[2][3] = 255;
+    palette[3][3] = fourColor ? 255 : 0;
+}
+
+// Picks indices for a color block and returns the total squared error.
+int ColorIndices(const uint8_t rgba[64],
+                 uint16_t c0,
+                 uint16_t c1,
+                 bool fourColor,
+                 const bool transparent[16],
+                 uint8_t indices[16]) {
+    int palette[4][4];
+    ColorPalette(c0, c1, fourColor, palette);
+
+    int total = 0;
+    int choices = fourColor ? 4 : 3;
+    for (size_t i = 0; i < s_blockPixels; ++i) {
+        if (transparent[i]) {
+            indices[i] = 3;
+            continue;
+        }
+
+        int best = 0;
+        int bestDist = std::numeric_limits<int>::max();
+        for (int p = 0; p < choices; ++p) {
+            int d = ColorDistance(rgba + i * 4, palette[p], 3);
+            if (d < bestDist) {
+                bestDist = d;
+                best = p;
+            }
+        }
+        indices[i] = static_cast<uint8_t>(best);
+        total += bestDist;
+    }
+    return total;
+}
+
+// Encodes the color part of BC1/BC3. forceFourColor is set for BC3, where the color block is
+// always decoded in four-color mode.
+void EncodeColorBlock(const uint8_t rgba[64], bool forceFourColor, uint8_t out[8]) {
+    bool transparent[16] = {};
+    bool anyTransparent = false;
+    if (!forceFourColor) {
+        for (size_t i = 0; i < s_blockPixels; ++i) {
+            transparent[i] = rgba[i * 4 + 3] < 128;
+            anyTransparent |= transparent[i];
+        }
+    }
+
+    uint8_t mn[4];
+    uint8_t mx[4];
+    BlockMinMax(rgba, mn, mx);
+
+    float e0[4];
+    float e1[4];
+    if (mn[0] == mx[0] && mn[1] == mx[1] && mn[2] == mx[2]) {
+        for (int c = 0; c < 4; ++c) {
+            e0[c] = e1[c] = mn[c];
+        }
+    } else {
+        AxisEndpoints(rgba, 3, e0, e1);
+    }
+
+    bool fourColor = !anyTransparent;
+    auto order = [fourColor](uint16_t& a, uint16_t& b) {
+        // Four-color mode needs c0 > c1, three-color mode needs c0 <= c1.
+        if ((fourColor && a < b) || (!fourColor && a > b)) {
+            std::swap(a, b);
+        }
+    };
+
+    uint16_t c0 = To565(e0);
+    uint16_t c1 = To565(e1);
+    order(c0, c1);
+
+    uint8_t indices[16];
+    // Index with the palette the decoder will pick: three colors whenever c0 <= c1, which is
+    // always the case for a block with transparent texels.
+    int error = ColorIndices(rgba, c0, c1, forceFourColor || c0 > c1, transparent, indices);
+
+    // One least-squares refinement pass using the chosen indices. Transparent texels take no
+    // part; their index does not depend on the endpoints.
+    if (c0 != c1) {
+        static constexpr float s_fourColorWeights[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+        static constexpr float s_threeColorWeights[4] = {1.0f, 0.0f, 0.5f, 0.0f};
+        const float* weightTable = fourColor ? s_fourColorWeights : s_threeColorWeights;
+        float weights[16];
+        bool used[16];
+        for (size_t i = 0; i < s_blockPixels; ++i) {
+            weights[i] = weightTable[indices[i]];
+            used[i] = !transparent[i];
+        }
+
+        float r0[4] = {};
+        float r1[4] = {};
+        if (RefineEndpoints(rgba, weights, used, 3, r0, r1)) {
+            uint16_t n0 = To565(r0);
+            uint16_t n1 = To565(r1);
+            order(n0, n1);
+            if (n0 != n1) {
+                uint8_t refined[16];
+                int refinedError =
+                    ColorIndices(rgba, n0, n1, forceFourColor || n0 > n1, transparent, refined);
+                if (refinedError < error) {
+                    c0 = n0;
+                    c1 = n1;
+                    std::memcpy(indices, refined, sizeof(indices));
+                }
+            }
+        }
+    }
+
+    if (c0 == c1 && fourColor) {
+        std::fill(std::begin(indices), std::end(indices), uint8_t{0});
+    }
+
+    uint32_t bits = 0;
+    for (size_t i = 0; i < s_blockPixels; ++i) {
+        bits |= static_cast<uint32_t>(indices[i]) << (2 * i);
+    }
+
+    out[0] = static_cast<uint8_t>(c0 & 0xff);
+    out[1] = static_cast<uint8_t>(c0 >> 8);
+    out[2] = static_cast<uint8_t>(c1 & 0xff);
+    out[3] = static_cast<uint8_t>(c1 >> 8);
+    std::memcpy(out + 4, &bits, 4);
+}
+
+void DecodeColorBlock(const uint8_t in[8], bool forceFourColor, uint8_t rgba[64]) {
+    uint16_t c0 = static_cast<uint16_t>(in[0] | (in[1] << 8));
+    uint16_t c1 = static_cast<uint16_t>(in[2] | (in[3] << 8));
+    uint32_t bits;
+    std::memcpy(&bits, in + 4, 4);
+
+    int palette[4][4];
+    ColorPalette(c0, c1, forceFourColor || c0 > c1, palette);
+
+    for (size_t i = 0; i < s_blockPixels; ++i) {
+        const int* p = palette[(bits >> (2 * i)) & 3];
+        for (int c = 0; c < 4; ++c) {
+            rgba[i * 4 + c] = static_cast<uint8_t>(p[c]);
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------
+// BC3 alpha block
+//--------------------------------------------------------------------------------------
+void AlphaPalette(int a0, int a1, int palette[8]) {
+    palette[0] = a0;
+    palette[1] = a1;
+    if (a0 > a1) {
+        for (int i = 1; i < 7; ++i) {
+            palette[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+        }
+    } else {
+        for (int i = 1; i < 5; ++i) {
+            palette[i + 1] = ((5 - i) * a0 + i * a1) / 5;
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+void EncodeAlphaBlock(const uint8_t rgba[64], uint8_t out[8]) {
+    uint8_t mn[4];
+    uint8_t mx[4];
+    BlockMinMax(rgba, mn, mx);
+
+    int a0 = mx[3];
+    int a1 = mn[3];
+
+    uint64_t bits = 0;
+    if (a0 != a1) {
+        int palette[8];
+        AlphaPalette(a0, a1, palette);
+
+        for (size_t i = 0; i < s_blockPixels; ++i) {
+            int a = rgba[i * 4 + 3];
+            int best = 0;
+            int bestDist = std::numeric_limits<int>::max();
+            for (int p = 0; p < 8; ++p) {
+                int d = std::abs(a - palette[p]);
+                if (d < bestDist) {
+                    bestDist = d;
+                    best = p;
+                }
+            }
+            bits |= static_cast<uint64_t>(best) << (3 * i);
+        }
+    }
+
+    out[0] = static_cast<uint8_t>(a0);
+    out[1] = static_cast<uint8_t>(a1);
+    for (int i = 0; i < 6; ++i) {
+        out[2 + i] = static_cast<uint8_t>(bits >> (8 * i));
+    }
+}
+
+void DecodeAlphaBlock(const uint8_t in[8], uint8_t rgba[64]) {
+    int palette[8];
+    AlphaPalette(in[0], in[1], palette);
+
+    uint64_t bits = 0;
+    for (int i = 0; i < 6; ++i) {
+        bits |= static_cast<uint64_t>(in[2 + i]) << (8 * i);
+    }
+
+    for (size_t i = 0; i < s_blockPixels; ++i) {
+        rgba[i * 4 + 3] = static_cast<uint8_t>(palette[(bits >> (3 * i)) & 7]);
+    }
+}
+
+//--------------------------------------------------------------------------------------
+// BC7 mode 6
+//--------------------------------------------------------------------------------------
+struct BC7Endpoint {
+    int value[4];  // 8-bit reconstructed value, (q << 1) | p
+    int q[4];      // 7-bit quantized value
+    int p;
+};
+
+BC7Endpoint QuantizeBC7(const float e[4]) {
+    BC7Endpoint best{};
+    int bestError = std::numeric_limits<int>::max();
+
+    for (int p = 0; p < 2; ++p) {
+        BC7Endpoint candidate{};
+        candidate.p = p;
+        int error = 0;
+        for (int c = 0; c < 4; ++c) {
+            int q = static_cast<int>(std::floor((e[c] - p) / 2.0f + 0.5f));
+            q = std::min(127, std::max(0, q));
+            candidate.q[c] = q;
+            candidate.value[c] = (q << 1) | p;
+            int diff = candidate.value[c] - Clamp255(e[c]);
+            error += diff * diff;
+        }
+        if (error < bestError) {
+            bestError = error;
+            best = candidate;
+        }
+    }
+    return best;
+}
+
+int BC7Indices(const uint8_t rgba[64],
+               const BC7Endpoint& e0,
+               const BC7Endpoint& e1,
+               uint8_t indices[16]) {
+    int palette[16][4];
+    for (int i = 0; i < 16; ++i) {
+        int w = s_bc7Weights4[i];
+        for (int c = 0; c < 4; ++c) {
+            palette[i][c] = ((64 - w) * e0.value[c] + w * e1.value[c] + 32) >> 6;
+        }
+    }
+
+    int total = 0;
+    for (size_t i = 0; i < s_blockPixels; ++i) {
+        int best = 0;
+        int bestDist = std::numeric_limits<int>::max();
+        for (int p = 0; p < 16; ++p) {
+            int d = ColorDistance(rgba + i * 4, palette[p], 4);
+            if (d < bestDist) {
+                bestDist = d;
+                best = p;
+            }
+        }
+        indices[i] = static_cast<uint8_t>(best);
+        total += bestDist;
+    }
+    return total;
+}
+
+class BitWriter {
+  public:
+    explicit BitWriter(uint8_t* out) : out_(out) { std::memset(out_, 0, 16); }
+
+    void Write(uint32_t value, int bitCount) {
+        for (int i = 0; i < bitCount; ++i, ++pos_) {
+            if (value & (1u << i)) {
+                out_[pos_ >> 3] |= static_cast<uint8_t>(1u << (pos_ & 7));
+            }
+        }
+    }
+
+  private:
+    uint8_t* out_;
+    int pos_ = 0;
+};
+
+class BitReader {
+  public:
+    explicit BitReader(const uint8_t* in) : in_(in) {}
+
+    uint32_t Read(int bitCount) {
+        uint32_t value = 0;
+        for (int i = 0; i < bitCount; ++i, ++pos_) {
+            value |= static_cast<uint32_t>((in_[pos_ >> 3] >> (pos_ & 7)) & 1) << i;
+        }
+        return value;
+    }
+
+  private:
+    const uint8_t* in_;
+    int pos_ = 0;
+};
+
+//--------------------------------------------------------------------------------------
+// Surfaces
+//--------------------------------------------------------------------------------------
+
+// Gathers a 4x4 block as RGBA, replicating the edge texels for partial blocks.
+void LoadBlock(const uint8_t* src,
+               size_t width,
+               size_t height,
+               size_t rowPitch,
+               size_t bx,
+               size_t by,
+               bool swapRedBlue,
+               uint8_t block[64]) {
+    for (size_t y = 0; y < 4; ++y) {
+        size_t sy = std::min(by * 4 + y, height - 1);
+        const uint8_t* row = src + sy * rowPitch;
+        for (size_t x = 0; x < 4; ++x) {
+            size_t sx = std::min(bx * 4 + x, width - 1);
+            const uint8_t* px = row + sx * 4;
+            uint8_t* dst = block + (y * 4 + x) * 4;
+            dst[0] = px[swapRedBlue ? 2 : 0];
+            dst[1] = px[1];
+            dst[2] = px[swapRedBlue ? 0 : 2];
+            dst[3] = px[3];
+        }
+    }
+}
+
+void EncodeBlock(BCTranscoder::Format format, const uint8_t block[64], uint8_t* out) {
+    switch (format) {
+        case BCTranscoder::Format::BC1:
+            BCTranscoder::EncodeBlockBC1(block, out);
+            break;
+        case BCTranscoder::Format::BC3:
+            BCTranscoder::EncodeBlockBC3(block, out);
+            break;
+        case BCTranscoder::Format::BC7:
+            BCTranscoder::EncodeBlockBC7(block, out);
+            break;
+    }
+}
+
+// One unit of parallel work: a row of blocks in one surface of the chain.
+struct Tile {
+    const uint8_t* source;
+    uint8_t* encoded;
+    size_t width;
+    size_t height;
+    size_t blockRow;
+};
+
+double SquaredError(const uint8_t* source,
+                    const uint8_t* decoded,
+                    size_t width,
+                    size_t height,
+                    size_t rowPitch,
+                    bool swapRedBlue,
+                    int channelCount) {
+    double sum = 0.0;
+    for (size_t y = 0; y < height; ++y) {
+        const uint8_t* a = source + y * rowPitch;
+        const uint8_t* b = decoded + y * width * 4;
+        for (size_t x = 0; x < width; ++x) {
+            for (int c = 0; c < channelCount; ++c) {
+                int sc = (swapRedBlue && c != 1 && c != 3) ? 2 - c : c;
+                double d = static_cast<double>(a[x * 4 + sc]) - b[x * 4 + c];
+                sum += d * d;
+            }
+        }
+    }
+    return sum;
+}
+
+double PsnrFromMse(double mse) {
+    if (mse <= 0.0) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+
+}  // namespace
+
+void BCTranscoder::EncodeBlockBC1(const uint8_t rgba[64], uint8_t out[8]) {
+    EncodeColorBlock(rgba, false, out);
+}
+
+void BCTranscoder::EncodeBlockBC3(const uint8_t rgba[64], uint8_t out[16]) {
+    EncodeAlphaBlock(rgba, out);
+    EncodeColorBlock(rgba, true, out + 8);
+}
+
+void BCTranscoder::EncodeBlockBC7(const uint8_t rgba[64], uint8_t out[16]) {
+    float e0[4];
+    float e1[4];
+    AxisEndpoints(rgba, 4, e0, e1);
+
+    BC7Endpoint q0 = QuantizeBC7(e0);
+    BC7Endpoint q1 = QuantizeBC7(e1);
+
+    uint8_t indices[16];
+    int error = BC7Indices(rgba, q0, q1, indices);
+
+    float weights[16];
+    bool used[16];
+    for (size_t i = 0; i < s_blockPixels; ++i) {
+        weights[i] = 1.0f - s_bc7Weights4[indices[i]] / 64.0f;
+        used[i] = true;
+    }
+
+    float r0[4];
+    float r1[4];
+    if (RefineEndpoints(rgba, weights, used, 4, r0, r1)) {
+        BC7Endpoint n0 = QuantizeBC7(r0);
+        BC7Endpoint n1 = QuantizeBC7(r1);
+        uint8_t refined[16];
+        int refinedError = BC7Indices(rgba, n0, n1, refined);
+        if (refinedError < error) {
+            q0 = n0;
+            q1 = n1;
+            std::memcpy(indices, refined, sizeof(indices));
+        }
+    }
+
+    // The anchor (pixel 0) index is stored with its top bit implied zero.
+    if (indices[0] & 8) {
+        std::swap(q0, q1);
+        for (auto& index : indices) {
+            index = static_cast<uint8_t>(15 - index);
+        }
+    }
+
+    BitWriter writer(out);
+    writer.Write(1u << 6, 7);
+    for (int c = 0; c < 4; ++c) {
+        writer.Write(q0.q[c], 7);
+        writer.Write(q1.q[c], 7);
+    }
+    writer.Write(q0.p, 1);
+    writer.Write(q1.p, 1);
+    writer.Write(indices[0], 3);
+    for (size_t i = 1; i < s_blockPixels; ++i) {
+        writer.Write(indices[i], 4);
+    }
+}
+
+void BCTranscoder::DecodeBlockBC1(const uint8_t in[8], uint8_t rgba[64]) {
+    DecodeColorBlock(in, false, rgba);
+}
+
+void BCTranscoder::DecodeBlockBC3(const uint8_t in[16], uint8_t rgba[64]) {
+    DecodeColorBlock(in + 8, true, rgba);
+    DecodeAlphaBlock(in, rgba);
+}
+
+bool BCTranscoder::DecodeBlockBC7(const uint8_t in[16], uint8_t rgba[64]) {
+    if ((in[0] & 0x7f) != 0x40) {
+        return false;
+    }
+
+    BitReader reader(in);
+    reader.Read(7);
+
+    int q[2][4];
+    for (int c = 0; c < 4; ++c) {
+        q[0][c] = static_cast<int>(reader.Read(7));
+        q[1][c] = static_cast<int>(reader.Read(7));
+    }
+    int p0 = static_cast<int>(reader.Read(1));
+    int p1 = static_cast<int>(reader.Read(1));
+
+    int e0[4];
+    int e1[4];
+    for (int c = 0; c < 4; ++c) {
+        e0[c] = (q[0][c] << 1) | p0;
+        e1[c] = (q[1][c] << 1) | p1;
+    }
+
+    for (size_t i = 0; i < s_blockPixels; ++i) {
+        int w = s_bc7Weights4[reader.Read(i == 0 ? 3 : 4)];
+        for (int c = 0; c < 4; ++c) {
+            rgba[i * 4 + c] = static_cast<uint8_t>(((64 - w) * e0[c] + w * e1[c] + 32) >> 6);
+        }
+    }
+    return true;
+}
+
+size_t BCTranscoder::EncodedChainBytes(Format format,
+                                       size_t width,
+                                       size_t height,
+                                       size_t mipCount,
+                                       size_t arraySize) {
+    size_t bytes = 0;
+    size_t w = width;
+    size_t h = height;
+    for (size_t mip = 0; mip < mipCount; ++mip) {
+        bytes += EncodedSurfaceBytes(format, w, h);
+        w = std::max<size_t>(1, w >> 1);
+        h = std::max<size_t>(1, h >> 1);
+    }
+    return bytes * arraySize;
+}
+
+void BCTranscoder::EncodeSurface(Format format,
+                                 const uint8_t* rgba,
+                                 size_t width,
+                                 size_t height,
+                                 size_t rowPitch,
+                                 bool swapRedBlue,
+                                 uint8_t* blocks) const {
+    size_t blocksWide = (width + 3) / 4;
+    size_t blocksHigh = (height + 3) / 4;
+    size_t blockBytes = BlockBytes(format);
+    size_t encodedRowBytes = EncodedRowBytes(format, width);
+
+    ParallelFor(
+        blocksHigh,
+        [&](size_t by) {
+            uint8_t block[64];
+            uint8_t* dst = blocks + by * encodedRowBytes;
+            for (size_t bx = 0; bx < blocksWide; ++bx) {
+                LoadBlock(rgba, width, height, rowPitch, bx, by, swapRedBlue, block);
+                EncodeBlock(format, block, dst + bx * blockBytes);
+            }
+        },
+        workerCount_);
+}
+
+bool BCTranscoder::DecodeSurface(Format format,
+                                 const uint8_t* blocks,
+                                 size_t width,
+                                 size_t height,
+                                 uint8_t* rgba,
+                                 size_t rowPitch) const {
+    size_t blocksWide = (width + 3) / 4;
+    size_t blocksHigh = (height + 3) / 4;
+    size_t blockBytes = BlockBytes(format);
+
+    for (size_t by = 0; by < blocksHigh; ++by) {
+        for (size_t bx = 0; bx < blocksWide; ++bx) {
+            const uint8_t* src = blocks + (by * blocksWide + bx) * blockBytes;
+            uint8_t block[64];
+            switch (format) {
+                case Format::BC1:
+                    DecodeBlockBC1(src, block);
+                    break;
+                case Format::BC3:
+                    DecodeBlockBC3(src, block);
+                    break;
+                case Format::BC7:
+                    if (!DecodeBlockBC7(src, block)) {
+                        return false;
+                    }
+                    break;
+            }
+
+            for (size_t y = 0; y < 4 && by * 4 + y < height; ++y) {
+                size_t copyPixels = std::min<size_t>(4, width - bx * 4);
+                std::memcpy(rgba + (by * 4 + y) * rowPitch + bx * 16, block + y * 16, copyPixels * 4);
+            }
+        }
+    }
+    return true;
+}
+
+bool BCTranscoder::EncodeChain(Format format,
+                               const uint8_t* source,
+                               size_t sourceBytes,
+                               size_t width,
+                               size_t height,
+                               size_t mipCount,
+                               size_t arraySize,
+                               bool swapRedBlue,
+                               uint8_t* encoded,
+                               size_t encodedBytes,
+                               Stats* stats) const {
+    if (!source || !encoded || width == 0 || height == 0) {
+        return false;
+    }
+    if (encodedBytes < EncodedChainBytes(format, width, height, mipCount, arraySize)) {
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    // Walk the chain once to lay out every surface, then encode all block rows as one batch of
+    // tiles so small mips do not serialize on their own thread spawns.
+    std::vector<Tile> tiles;
+    const uint8_t* src = source;
+    const uint8_t* srcEnd = source + sourceBytes;
+    uint8_t* dst = encoded;
+    for (size_t slice = 0; slice < arraySize; ++slice) {
+        size_t w = width;
+        size_t h = height;
+        for (size_t mip = 0; mip < mipCount; ++mip) {
+            size_t surfaceBytes = w * h * 4;
+            if (src + surfaceBytes > srcEnd) {
+                return false;
+            }
+
+            for (size_t by = 0; by < (h + 3) / 4; ++by) {
+                tiles.push_back({src, dst, w, h, by});
+            }
+
+            src += surfaceBytes;
+            dst += EncodedSurfaceBytes(format, w, h);
+            w = std::max<size_t>(1, w >> 1);
+            h = std::max<size_t>(1, h >> 1);
+        }
+    }
+
+    size_t blockBytes = BlockBytes(format);
+    ParallelFor(
+        tiles.size(),
+        [&](size_t t) {
+            const Tile& tile = tiles[t];
+            uint8_t block[64];
+            uint8_t* row = tile.encoded + tile.blockRow * EncodedRowBytes(format, tile.width);
+            for (size_t bx = 0; bx < (tile.width + 3) / 4; ++bx) {
+                LoadBlock(tile.source, tile.width, tile.height, tile.width * 4, bx, tile.blockRow, swapRedBlue, block);
+                EncodeBlock(format, block, row + bx * blockBytes);
+            }
+        },
+        workerCount_);
+
+    if (stats) {
+        int channelCount = format == Format::BC1 ? 3 : 4;
+        double errorSum = 0.0;
+        double sampleCount = 0.0;
+        std::vector<uint8_t> decoded;
+
+        src = source;
+        dst = encoded;
+        for (size_t slice = 0; slice < arraySize; ++slice) {
+            size_t w = width;
+            size_t h = height;
+            for (size_t mip = 0; mip < mipCount; ++mip) {
+                decoded.resize(w * h * 4);
+                if (!DecodeSurface(format, dst, w, h, decoded.data(), w * 4)) {
+                    return false;
+                }
+                errorSum += SquaredError(src, decoded.data(), w, h, w * 4, swapRedBlue, channelCount);
+                sampleCount += static_cast<double>(w * h * channelCount);
+
+                src += w * h * 4;
+                dst += EncodedSurfaceBytes(format, w, h);
+                w = std::max<size_t>(1, w >> 1);
+                h = std::max<size_t>(1, h >> 1);
+            }
+        }
+
+        stats->psnr = PsnrFromMse(errorSum / sampleCount);
+        stats->sourceBytes = static_cast<size_t>(src - source);
+        stats->encodedBytes = static_cast<size_t>(dst - encoded);
+        stats->seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    return true;
+}
+
+double BCTranscoder::Psnr(const uint8_t* a,
+                          const uint8_t* b,
+                          size_t width,
+                          size_t height,
+                          size_t rowPitch,
+                          bool swapRedBlue) {
+    double sum = SquaredError(a, b, width, height, rowPitch, swapRedBlue, 4);
+    return PsnrFromMse(sum / static_cast<double>(width * height * 4));
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// CPU block-compression encoder/decoder used by the DDS loader's import step.
+//
+// Surfaces are RGBA8 (or BGRA8 with swapRedBlue) and are processed in 4x4 blocks. Block rows are
+// spread across worker threads, and the endpoint search for each block runs on SSE2 where
+// available. Chains are read and written in the order FillInitData12 walks them: for every array
+// slice, every mip level, tightly packed.
+//
+// Only BC7 mode 6 (single subset RGBA, 4-bit indices) is produced, and decoding BC7 supports that
+// mode only; that is enough to verify our own output.
+class BCTranscoder {
+  public:
+    enum class Format { BC1, BC3, BC7 };
+
+    struct Stats {
+        double psnr = 0.0;  // dB over all channels; +inf for a lossless result
+        size_t sourceBytes = 0;
+        size_t encodedBytes = 0;
+        double seconds = 0.0;
+    };
+
+    explicit BCTranscoder(unsigned int workerCount = 0) : workerCount_(workerCount) {}
+
+    static size_t BlockBytes(Format format) { return format == Format::BC1 ? 8 : 16; }
+
+    static size_t EncodedRowBytes(Format format, size_t width) {
+        return ((width + 3) / 4) * BlockBytes(format);
+    }
+
+    static size_t EncodedSurfaceBytes(Format format, size_t width, size_t height) {
+        return EncodedRowBytes(format, width) * ((height + 3) / 4);
+    }
+
+    // Total bytes of a chain in FillInitData12 order.
+    static size_t EncodedChainBytes(Format format,
+                                    size_t width,
+                                    size_t height,
+                                    size_t mipCount,
+                                    size_t arraySize);
+
+    void EncodeSurface(Format format,
+                       const uint8_t* rgba,
+                       size_t width,
+                       size_t height,
+                       size_t rowPitch,
+                       bool swapRedBlue,
+                       uint8_t* blocks) const;
+
+    // Returns false for BC7 blocks in a mode other than 6.
+    bool DecodeSurface(Format format,
+                       const uint8_t* blocks,
+                       size_t width,
+                       size_t height,
+                       uint8_t* rgba,
+                       size_t rowPitch) const;
+
+    // Encodes a tightly packed 32bpp chain. When stats is given the result is decoded again and
+    // compared against the source to compute the PSNR.
+    bool EncodeChain(Format format,
+                     const uint8_t* source,
+                     size_t sourceBytes,
+                     size_t width,
+                     size_t height,
+                     size_t mipCount,
+                     size_t arraySize,
+                     bool swapRedBlue,
+                     uint8_t* encoded,
+                     size_t encodedBytes,
+                     Stats* stats = nullptr) const;
+
+    // PSNR of a decoded, tightly packed RGBA surface b against source a (rowPitch applies to a).
+    static double Psnr(const uint8_t* a,
+                       const uint8_t* b,
+                       size_t width,
+                       size_t height,
+                       size_t rowPitch,
+                       bool swapRedBlue = false);
+
+    static void EncodeBlockBC1(const uint8_t rgba[64], uint8_t out[8]);
+    static void EncodeBlockBC3(const uint8_t rgba[64], uint8_t out[16]);
+    static void EncodeBlockBC7(const uint8_t rgba[64], uint8_t out[16]);
+
+    static void DecodeBlockBC1(const uint8_t in[8], uint8_t rgba[64]);
+    static void DecodeBlockBC3(const uint8_t in[16], uint8_t rgba[64]);
+    static bool DecodeBlockBC7(const uint8_t in[16], uint8_t rgba[64]);
+
+  private:
+    unsigned int workerCount_ = 0;
+};
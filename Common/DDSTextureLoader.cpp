@@ -20,10 +20,13 @@
 
 #include <assert.h>
 #include <algorithm>
+#include <array>
 #include <memory>
 #include <wrl.h>
 
 #include "DDSTextureLoader.h" 
+#include "BCTranscoder.h"
+#include "MipGenerator.h"
 
 using namespace Microsoft::WRL;
 
@@ -270,9 +273,10 @@ static HRESULT LoadTextureDataFromFile( _In_z_ const wchar_t* fileName,
 
 
 //--------------------------------------------------------------------------------------
-// Return the BPP for a particular format
+// Return the BPP for a particular format. Reference switch: the loader reads the
+// values through s_formatTable (see LookupFormat).
 //--------------------------------------------------------------------------------------
-static size_t BitsPerPixel( _In_ DXGI_FORMAT fmt )
+static constexpr size_t ComputeBitsPerPixel( _In_ DXGI_FORMAT fmt )
 {
     switch( fmt )
     {
@@ -420,23 +424,54 @@ static size_t BitsPerPixel( _In_ DXGI_FORMAT fmt )
 
 
 //--------------------------------------------------------------------------------------
-// Get surface information for a particular format
+// sRGB counterpart of a format, or the format itself. Reference switch for s_formatTable.
 //--------------------------------------------------------------------------------------
-static void GetSurfaceInfo( _In_ size_t width,
-                            _In_ size_t height,
-                            _In_ DXGI_FORMAT fmt,
-                            _Out_opt_ size_t* outNumBytes,
-                            _Out_opt_ size_t* outRowBytes,
-                            _Out_opt_ size_t* outNumRows )
+static constexpr DXGI_FORMAT ComputeSRGB( _In_ DXGI_FORMAT format )
 {
-    size_t numBytes = 0;
-    size_t rowBytes = 0;
-    size_t numRows = 0;
+    switch( format )
+    {
+    case DXGI_FORMAT_R8G8B8A8_UNORM:
+        return DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
 
-    bool bc = false;
-    bool packed = false;
-    bool planar = false;
-    size_t bpe = 0;
+    case DXGI_FORMAT_BC1_UNORM:
+        return DXGI_FORMAT_BC1_UNORM_SRGB;
+
+    case DXGI_FORMAT_BC2_UNORM:
+        return DXGI_FORMAT_BC2_UNORM_SRGB;
+
+    case DXGI_FORMAT_BC3_UNORM:
+        return DXGI_FORMAT_BC3_UNORM_SRGB;
+
+    case DXGI_FORMAT_B8G8R8A8_UNORM:
+        return DXGI_FORMAT_B8G8R8A8_UNORM_SRGB;
+
+    case DXGI_FORMAT_B8G8R8X8_UNORM:
+        return DXGI_FORMAT_B8G8R8X8_UNORM_SRGB;
+
+    case DXGI_FORMAT_BC7_UNORM:
+        return DXGI_FORMAT_BC7_UNORM_SRGB;
+
+    default:
+        return format;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+// Surface layout of a particular format. bpe is the size in bytes of a BC block, of a
+// packed pixel pair or of a planar luma pair; it is left untouched for linear formats.
+//--------------------------------------------------------------------------------------
+enum FORMAT_LAYOUT : uint8_t
+{
+    FORMAT_LAYOUT_LINEAR,
+    FORMAT_LAYOUT_BC,
+    FORMAT_LAYOUT_PACKED,
+    FORMAT_LAYOUT_PLANAR,
+    FORMAT_LAYOUT_NV11,
+};
+
+static constexpr FORMAT_LAYOUT ComputeFormatLayout( _In_ DXGI_FORMAT fmt, _Out_ size_t& bpe )
+{
     switch (fmt)
     {
     case DXGI_FORMAT_BC1_TYPELESS:
@@ -445,9 +480,8 @@ static void GetSurfaceInfo( _In_ size_t width,
     case DXGI_FORMAT_BC4_TYPELESS:
     case DXGI_FORMAT_BC4_UNORM:
     case DXGI_FORMAT_BC4_SNORM:
-        bc=true;
         bpe = 8;
-        break;
+        return FORMAT_LAYOUT_BC;
 
     case DXGI_FORMAT_BC2_TYPELESS:
     case DXGI_FORMAT_BC2_UNORM:
@@ -464,35 +498,63 @@ static void GetSurfaceInfo( _In_ size_t width,
     case DXGI_FORMAT_BC7_TYPELESS:
     case DXGI_FORMAT_BC7_UNORM:
     case DXGI_FORMAT_BC7_UNORM_SRGB:
-        bc = true;
         bpe = 16;
-        break;
+        return FORMAT_LAYOUT_BC;
 
     case DXGI_FORMAT_R8G8_B8G8_UNORM:
     case DXGI_FORMAT_G8R8_G8B8_UNORM:
     case DXGI_FORMAT_YUY2:
-        packed = true;
         bpe = 4;
-        break;
+        return FORMAT_LAYOUT_PACKED;
 
     case DXGI_FORMAT_Y210:
     case DXGI_FORMAT_Y216:
-        packed = true;
         bpe = 8;
-        break;
+        return FORMAT_LAYOUT_PACKED;
 
     case DXGI_FORMAT_NV12:
     case DXGI_FORMAT_420_OPAQUE:
-        planar = true;
         bpe = 2;
-        break;
+        return FORMAT_LAYOUT_PLANAR;
 
     case DXGI_FORMAT_P010:
     case DXGI_FORMAT_P016:
-        planar = true;
         bpe = 4;
-        break;
+        return FORMAT_LAYOUT_PLANAR;
+
+    case DXGI_FORMAT_NV11:
+        return FORMAT_LAYOUT_NV11;
+
+    default:
+        return FORMAT_LAYOUT_LINEAR;
     }
+}
+
+
+//--------------------------------------------------------------------------------------
+// Get surface information for a particular format. Reference arithmetic: the loader uses
+// the table-driven GetSurfaceInfo below, which static_assert checks against this.
+//--------------------------------------------------------------------------------------
+struct SURFACE_INFO
+{
+    size_t numBytes;
+    size_t rowBytes;
+    size_t numRows;
+};
+
+static constexpr SURFACE_INFO ComputeSurfaceInfo( _In_ size_t width,
+                                                  _In_ size_t height,
+                                                  _In_ DXGI_FORMAT fmt )
+{
+    size_t numBytes = 0;
+    size_t rowBytes = 0;
+    size_t numRows = 0;
+
+    size_t bpe = 0;
+    FORMAT_LAYOUT layout = ComputeFormatLayout( fmt, bpe );
+    bool bc = layout == FORMAT_LAYOUT_BC;
+    bool packed = layout == FORMAT_LAYOUT_PACKED;
+    bool planar = layout == FORMAT_LAYOUT_PLANAR;
 
     if (bc)
     {
@@ -530,23 +592,186 @@ static void GetSurfaceInfo( _In_ size_t width,
     }
     else
     {
-        size_t bpp = BitsPerPixel( fmt );
+        size_t bpp = ComputeBitsPerPixel( fmt );
         rowBytes = ( width * bpp + 7 ) / 8; // round up to nearest byte
         numRows = height;
         numBytes = rowBytes * height;
     }
 
+    return { numBytes, rowBytes, numRows };
+}
+
+
+//--------------------------------------------------------------------------------------
+// Format descriptor table, generated at compile time from the switches above. Header
+// parsing and FillInitData look formats up here instead of walking the switches for every
+// subresource. Formats past B4G4R4A4_UNORM are not used by the loader and read as unknown.
+//--------------------------------------------------------------------------------------
+struct FORMAT_DESC
+{
+    uint8_t bitsPerPixel;
+    uint8_t bitsPerBlock;   // bits per blockWidth x blockHeight element
+    uint8_t blockWidth;
+    uint8_t blockHeight;
+    FORMAT_LAYOUT layout;
+    DXGI_FORMAT srgbFormat;
+};
+
+static constexpr FORMAT_DESC ComputeFormatDesc( _In_ DXGI_FORMAT fmt )
+{
+    size_t bpe = 0;
+    FORMAT_LAYOUT layout = ComputeFormatLayout( fmt, bpe );
+    size_t bpp = ComputeBitsPerPixel( fmt );
+
+    FORMAT_DESC desc = { static_cast<uint8_t>( bpp ), static_cast<uint8_t>( bpp ), 1, 1, layout, ComputeSRGB( fmt ) };
+    switch ( layout )
+    {
+    case FORMAT_LAYOUT_BC:
+        desc.bitsPerBlock = static_cast<uint8_t>( bpe * 8 );
+        desc.blockWidth = 4;
+        desc.blockHeight = 4;
+        break;
+
+    case FORMAT_LAYOUT_PACKED:
+    case FORMAT_LAYOUT_PLANAR:
+        desc.bitsPerBlock = static_cast<uint8_t>( bpe * 8 );
+        desc.blockWidth = 2;
+        break;
+
+    case FORMAT_LAYOUT_NV11:
+        desc.bitsPerBlock = 32;
+        desc.blockWidth = 4;
+        break;
+
+    default:
+        break;
+    }
+    return desc;
+}
+
+static constexpr size_t s_formatTableSize = DXGI_FORMAT_B4G4R4A4_UNORM + 1;
+
+static constexpr std::array<FORMAT_DESC, s_formatTableSize> BuildFormatTable()
+{
+    std::array<FORMAT_DESC, s_formatTableSize> table = {};
+    for ( size_t i = 0; i < s_formatTableSize; ++i )
+    {
+        table[i] = ComputeFormatDesc( static_cast<DXGI_FORMAT>( i ) );
+    }
+    return table;
+}
+
+static constexpr std::array<FORMAT_DESC, s_formatTableSize> s_formatTable = BuildFormatTable();
+
+static constexpr FORMAT_DESC LookupFormat( _In_ DXGI_FORMAT fmt )
+{
+    return ( static_cast<size_t>( fmt ) < s_formatTableSize )
+        ? s_formatTable[fmt]
+        : FORMAT_DESC{ 0, 0, 1, 1, FORMAT_LAYOUT_LINEAR, fmt };
+}
+
+static constexpr size_t BitsPerPixel( _In_ DXGI_FORMAT fmt )
+{
+    return LookupFormat( fmt ).bitsPerPixel;
+}
+
+static constexpr DXGI_FORMAT MakeSRGB( _In_ DXGI_FORMAT format )
+{
+    return LookupFormat( format ).srgbFormat;
+}
+
+// MakeSRGB() returns formats without an sRGB variant unchanged, so it cannot tell them apart
+// from formats that are already sRGB.
+static constexpr bool IsSRGB( _In_ DXGI_FORMAT format )
+{
+    switch( format )
+    {
+    case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+    case DXGI_FORMAT_BC1_UNORM_SRGB:
+    case DXGI_FORMAT_BC2_UNORM_SRGB:
+    case DXGI_FORMAT_BC3_UNORM_SRGB:
+    case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+    case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+    case DXGI_FORMAT_BC7_UNORM_SRGB:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+static constexpr SURFACE_INFO LookupSurfaceInfo( _In_ size_t width,
+                                                 _In_ size_t height,
+                                                 _In_ const FORMAT_DESC& desc )
+{
+    size_t rowBytes = ( ( width + desc.blockWidth - 1 ) / desc.blockWidth * desc.bitsPerBlock + 7 ) / 8;
+    size_t numRows = ( height + desc.blockHeight - 1 ) / desc.blockHeight;
+    size_t numBytes = rowBytes * numRows;
+
+    if ( desc.layout == FORMAT_LAYOUT_PLANAR )
+    {
+        numBytes = ( rowBytes * height ) + ( ( rowBytes * height + 1 ) >> 1 );
+        numRows = height + ( ( height + 1 ) >> 1 );
+    }
+    else if ( desc.layout == FORMAT_LAYOUT_NV11 )
+    {
+        numRows = height * 2; // Direct3D makes this simplifying assumption, although it is larger than the 4:1:1 data
+        numBytes = rowBytes * numRows;
+    }
+
+    return { numBytes, rowBytes, numRows };
+}
+
+// Compile-time check of the table against the reference switches, including formats just
+// past the end of the table. A handful of sizes per format covers empty, sub-block, exact-block,
+// odd and large surfaces while staying well inside the compiler's constexpr step limit.
+static constexpr bool FormatTableMatchesSwitches()
+{
+    constexpr size_t sizes[][2] = { { 0, 0 }, { 1, 1 }, { 3, 5 }, { 4, 4 }, { 13, 1023 } };
+    for ( size_t i = 0; i < s_formatTableSize + 4; ++i )
+    {
+        auto fmt = static_cast<DXGI_FORMAT>( i );
+        FORMAT_DESC desc = LookupFormat( fmt );
+        if ( desc.bitsPerPixel != ComputeBitsPerPixel( fmt ) || desc.srgbFormat != ComputeSRGB( fmt ) )
+            return false;
+
+        for ( const auto& size : sizes )
+        {
+            SURFACE_INFO a = LookupSurfaceInfo( size[0], size[1], desc );
+            SURFACE_INFO b = ComputeSurfaceInfo( size[0], size[1], fmt );
+            if ( a.numBytes != b.numBytes || a.rowBytes != b.rowBytes || a.numRows != b.numRows )
+                return false;
+        }
+    }
+    return true;
+}
+
+static_assert( FormatTableMatchesSwitches(), "s_formatTable disagrees with the reference format switches" );
+
+
+//--------------------------------------------------------------------------------------
+// Get surface information for a particular format
+//--------------------------------------------------------------------------------------
+static void GetSurfaceInfo( _In_ size_t width,
+                            _In_ size_t height,
+                            _In_ DXGI_FORMAT fmt,
+                            _Out_opt_ size_t* outNumBytes,
+                            _Out_opt_ size_t* outRowBytes,
+                            _Out_opt_ size_t* outNumRows )
+{
+    SURFACE_INFO info = LookupSurfaceInfo( width, height, LookupFormat( fmt ) );
+
     if (outNumBytes)
     {
-        *outNumBytes = numBytes;
+        *outNumBytes = info.numBytes;
     }
     if (outRowBytes)
     {
-        *outRowBytes = rowBytes;
+        *outRowBytes = info.rowBytes;
     }
     if (outNumRows)
     {
-        *outNumRows = numRows;
+        *outNumRows = info.numRows;
     }
 }
 
@@ -765,38 +990,6 @@ static DXGI_FORMAT GetDXGIFormat( const DDS_PIXELFORMAT& ddpf )
 }
 
 
-//--------------------------------------------------------------------------------------
-static DXGI_FORMAT MakeSRGB( _In_ DXGI_FORMAT format )
-{
-    switch( format )
-    {
-    case DXGI_FORMAT_R8G8B8A8_UNORM:
-        return DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
-
-    case DXGI_FORMAT_BC1_UNORM:
-        return DXGI_FORMAT_BC1_UNORM_SRGB;
-
-    case DXGI_FORMAT_BC2_UNORM:
-        return DXGI_FORMAT_BC2_UNORM_SRGB;
-
-    case DXGI_FORMAT_BC3_UNORM:
-        return DXGI_FORMAT_BC3_UNORM_SRGB;
-
-    case DXGI_FORMAT_B8G8R8A8_UNORM:
-        return DXGI_FORMAT_B8G8R8A8_UNORM_SRGB;
-
-    case DXGI_FORMAT_B8G8R8X8_UNORM:
-        return DXGI_FORMAT_B8G8R8X8_UNORM_SRGB;
-
-    case DXGI_FORMAT_BC7_UNORM:
-        return DXGI_FORMAT_BC7_UNORM_SRGB;
-
-    default:
-        return format;
-    }
-}
-
-
 //--------------------------------------------------------------------------------------
 static HRESULT FillInitData( _In_ size_t width,
                              _In_ size_t height,
@@ -1302,14 +1495,21 @@ static HRESULT CreateD3DResources12(
 			}
 			else
 			{
-				cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(texture.Get(),
-					D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST));
+				// A copy queue can't transition to shader states. The copy promotes the texture from
+				// COMMON and it decays back once the list has executed; the first read on the graphics
+				// queue promotes it to PIXEL_SHADER_RESOURCE.
+				const bool copyQueue = cmdList->GetType() == D3D12_COMMAND_LIST_TYPE_COPY;
+
+				if (!copyQueue)
+					cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(texture.Get(),
+						D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST));
 
 				// Use Heap-allocating UpdateSubresources implementation for variable number of subresources (which is the case for textures).
 				UpdateSubresources(cmdList, texture.Get(), textureUploadHeap.Get(), 0, 0, num2DSubresources, initData);
 
-				cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(texture.Get(),
-					D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
+				if (!copyQueue)
+					cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(texture.Get(),
+						D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
 			}
 		}
 	} break;
@@ -1669,6 +1869,256 @@ static HRESULT CreateTextureFromDDS( _In_ ID3D11Device* d3dDevice,
     return hr;
 }
 
+//--------------------------------------------------------------------------------------
+// Optional import step: build a full mip chain for 2D textures stored with a single level.
+// Returns S_FALSE and leaves mipCount/bitData untouched when the texture is not a candidate.
+//--------------------------------------------------------------------------------------
+static HRESULT GenerateMipChain(
+	_In_ uint32_t resDim,
+	_In_ size_t width,
+	_In_ size_t height,
+	_In_ size_t depth,
+	_In_ size_t arraySize,
+	_In_ unsigned int loadFlags,
+	_In_ DXGI_FORMAT format,
+	_Inout_ size_t& mipCount,
+	_Inout_ const uint8_t*& bitData,
+	_Inout_ size_t& bitSize,
+	std::unique_ptr<uint8_t[]>& generated)
+{
+	if (mipCount > 1 || resDim != D3D12_RESOURCE_DIMENSION_TEXTURE2D || depth > 1)
+		return S_FALSE;
+
+	size_t fullMipCount = MipGenerator::FullMipCount(width, height);
+	if (fullMipCount <= 1)
+		return S_FALSE;
+
+	bool bc = false;
+	BCTranscoder::Format bcFormat = BCTranscoder::Format::BC1;
+	switch (format)
+	{
+	case DXGI_FORMAT_R8G8B8A8_UNORM:
+	case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+	case DXGI_FORMAT_B8G8R8A8_UNORM:
+	case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+	case DXGI_FORMAT_B8G8R8X8_UNORM:
+	case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+		break;
+
+	case DXGI_FORMAT_BC1_UNORM:
+	case DXGI_FORMAT_BC1_UNORM_SRGB:
+		bc = true;
+		bcFormat = BCTranscoder::Format::BC1;
+		break;
+
+	case DXGI_FORMAT_BC3_UNORM:
+	case DXGI_FORMAT_BC3_UNORM_SRGB:
+		bc = true;
+		bcFormat = BCTranscoder::Format::BC3;
+		break;
+
+	case DXGI_FORMAT_BC7_UNORM:
+	case DXGI_FORMAT_BC7_UNORM_SRGB:
+		bc = true;
+		bcFormat = BCTranscoder::Format::BC7;
+		break;
+
+	default:
+		return S_FALSE;
+	}
+
+	// Filter in linear space when the format is stored as sRGB.
+	MipGenerator::Settings settings;
+	settings.filter = (loadFlags & DDS_LOADER_MIP_KAISER) ? MipGenerator::Filter::Kaiser : MipGenerator::Filter::Box;
+	settings.srgb = IsSRGB(format);
+
+	size_t texels = width * height;
+	size_t sliceBytes = bc ? BCTranscoder::EncodedSurfaceBytes(bcFormat, width, height) : texels * 4;
+	if (bitSize < sliceBytes * arraySize)
+		return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+
+	const uint8_t* top = bitData;
+	std::unique_ptr<uint8_t[]> decoded;
+	if (bc)
+	{
+		decoded.reset(new (std::nothrow) uint8_t[texels * 4 * arraySize]);
+		if (!decoded)
+			return E_OUTOFMEMORY;
+
+		BCTranscoder transcoder;
+		for (size_t slice = 0; slice < arraySize; ++slice)
+		{
+			if (!transcoder.DecodeSurface(bcFormat, bitData + slice * sliceBytes, width, height,
+				decoded.get() + slice * texels * 4, width * 4))
+			{
+				// BC7 modes other than 6 cannot be decoded; upload the single level as-is.
+				return S_FALSE;
+			}
+		}
+		top = decoded.get();
+	}
+
+	size_t chainBytes = MipGenerator::ChainBytes(width, height, fullMipCount, arraySize);
+	std::unique_ptr<uint8_t[]> chain(new (std::nothrow) uint8_t[chainBytes]);
+	if (!chain)
+		return E_OUTOFMEMORY;
+
+	MipGenerator::Stats stats;
+	if (!MipGenerator(settings).GenerateChain(top, texels * 4 * arraySize, width, height, arraySize,
+		fullMipCount, chain.get(), chainBytes, &stats))
+	{
+		return E_FAIL;
+	}
+
+	if (bc)
+	{
+		// Re-encode levels 1..n; level 0 keeps the original blocks rather than a lossy round trip.
+		size_t encodedBytes = BCTranscoder::EncodedChainBytes(bcFormat, width, height, fullMipCount, arraySize);
+		std::unique_ptr<uint8_t[]> encoded(new (std::nothrow) uint8_t[encodedBytes]);
+		if (!encoded)
+			return E_OUTOFMEMORY;
+
+		BCTranscoder transcoder;
+		const uint8_t* src = chain.get();
+		uint8_t* dst = encoded.get();
+		for (size_t slice = 0; slice < arraySize; ++slice)
+		{
+			memcpy(dst, bitData + slice * sliceBytes, sliceBytes);
+			src += texels * 4;
+			dst += sliceBytes;
+
+			size_t w = width;
+			size_t h = height;
+			for (size_t mip = 1; mip < fullMipCount; ++mip)
+			{
+				w = std::max<size_t>(1, w >> 1);
+				h = std::max<size_t>(1, h >> 1);
+				transcoder.EncodeSurface(bcFormat, src, w, h, w * 4, false, dst);
+				src += w * h * 4;
+				dst += BCTranscoder::EncodedSurfaceBytes(bcFormat, w, h);
+			}
+		}
+
+		generated = std::move(encoded);
+		bitSize = encodedBytes;
+	}
+	else
+	{
+		generated = std::move(chain);
+		bitSize = chainBytes;
+	}
+
+	char report[128];
+	sprintf_s(report, "Generated %zu mips for %zux%zu x%zu in %.2f ms (%.1f MP/s)\n",
+		fullMipCount, width, height, arraySize, stats.seconds * 1000.0, stats.megapixelsPerSecond);
+	OutputDebugStringA(report);
+
+	mipCount = fullMipCount;
+	bitData = generated.get();
+	return S_OK;
+}
+
+//--------------------------------------------------------------------------------------
+// Optional import step: block-compress 32bpp RGBA/BGRA 2D data before it is laid out by
+// FillInitData12. Returns S_FALSE and leaves format/bitData untouched when the texture is not
+// a candidate (other formats, volumes, or a top level that is not a multiple of 4).
+//--------------------------------------------------------------------------------------
+static HRESULT TranscodeToBC(
+	_In_ uint32_t resDim,
+	_In_ size_t width,
+	_In_ size_t height,
+	_In_ size_t depth,
+	_In_ size_t mipCount,
+	_In_ size_t arraySize,
+	_In_ unsigned int loadFlags,
+	_Inout_ DXGI_FORMAT& format,
+	_Inout_ const uint8_t*& bitData,
+	_Inout_ size_t& bitSize,
+	std::unique_ptr<uint8_t[]>& transcoded,
+	_Out_opt_ float* psnr)
+{
+	if (psnr)
+		*psnr = 0.0f;
+
+	bool swapRedBlue = false;
+	bool ignoreAlpha = false;
+	switch (format)
+	{
+	case DXGI_FORMAT_R8G8B8A8_UNORM:
+	case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+		break;
+
+	case DXGI_FORMAT_B8G8R8A8_UNORM:
+	case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+		swapRedBlue = true;
+		break;
+
+	case DXGI_FORMAT_B8G8R8X8_UNORM:
+	case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+		swapRedBlue = true;
+		ignoreAlpha = true;
+		break;
+
+	default:
+		return S_FALSE;
+	}
+
+	if (resDim != D3D12_RESOURCE_DIMENSION_TEXTURE2D || depth > 1 || (width % 4) || (height % 4))
+		return S_FALSE;
+
+	BCTranscoder::Format target = BCTranscoder::Format::BC1;
+	DXGI_FORMAT targetFormat = DXGI_FORMAT_BC1_UNORM;
+	if (loadFlags & DDS_LOADER_TRANSCODE_BC7)
+	{
+		target = BCTranscoder::Format::BC7;
+		targetFormat = DXGI_FORMAT_BC7_UNORM;
+	}
+	else if (loadFlags & DDS_LOADER_TRANSCODE_BC3)
+	{
+		target = BCTranscoder::Format::BC3;
+		targetFormat = DXGI_FORMAT_BC3_UNORM;
+	}
+
+	bool srgb = IsSRGB(format);
+	if (srgb)
+		targetFormat = MakeSRGB(targetFormat);
+
+	// X8 formats carry garbage in the alpha byte; force it opaque so BC1 does not punch holes.
+	std::unique_ptr<uint8_t[]> opaque;
+	const uint8_t* source = bitData;
+	if (ignoreAlpha)
+	{
+		opaque.reset(new (std::nothrow) uint8_t[bitSize]);
+		if (!opaque)
+			return E_OUTOFMEMORY;
+		memcpy(opaque.get(), bitData, bitSize);
+		for (size_t i = 3; i < bitSize; i += 4)
+			opaque[i] = 0xff;
+		source = opaque.get();
+	}
+
+	size_t encodedBytes = BCTranscoder::EncodedChainBytes(target, width, height, mipCount, arraySize);
+	transcoded.reset(new (std::nothrow) uint8_t[encodedBytes]);
+	if (!transcoded)
+		return E_OUTOFMEMORY;
+
+	BCTranscoder::Stats stats;
+	if (!BCTranscoder{}.EncodeChain(target, source, bitSize, width, height, mipCount, arraySize,
+		swapRedBlue, transcoded.get(), encodedBytes, psnr ? &stats : nullptr))
+	{
+		transcoded.reset();
+		return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+	}
+
+	if (psnr)
+		*psnr = static_cast<float>(stats.psnr);
+
+	format = targetFormat;
+	bitData = transcoded.get();
+	bitSize = encodedBytes;
+	return S_OK;
+}
+
 static HRESULT CreateTextureFromDDS12(
 	_In_ ID3D12Device* device,
 	_In_opt_ ID3D12GraphicsCommandList* cmdList,
@@ -1677,8 +2127,10 @@ static HRESULT CreateTextureFromDDS12(
 	_In_ size_t bitSize,
 	_In_ size_t maxsize,
 	_In_ bool forceSRGB,
+	_In_ unsigned int loadFlags,
 	ComPtr<ID3D12Resource>& texture,
-	ComPtr<ID3D12Resource>& textureUploadHeap)
+	ComPtr<ID3D12Resource>& textureUploadHeap,
+	_Out_opt_ float* transcodePsnr)
 {
 	HRESULT hr = S_OK;
 
@@ -1835,6 +2287,28 @@ static HRESULT CreateTextureFromDDS12(
 		return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
 	}
 
+	std::unique_ptr<uint8_t[]> generated;
+	if (loadFlags & DDS_LOADER_MIP_AUTOGEN)
+	{
+		hr = GenerateMipChain(resDim, width, height, depth, arraySize, loadFlags,
+			format, mipCount, bitData, bitSize, generated);
+		if (FAILED(hr))
+			return hr;
+	}
+
+	std::unique_ptr<uint8_t[]> transcoded;
+	if (loadFlags & (DDS_LOADER_TRANSCODE_BC1 | DDS_LOADER_TRANSCODE_BC3 | DDS_LOADER_TRANSCODE_BC7))
+	{
+		hr = TranscodeToBC(resDim, width, height, depth, mipCount, arraySize, loadFlags,
+			format, bitData, bitSize, transcoded, transcodePsnr);
+		if (FAILED(hr))
+			return hr;
+	}
+	else if (transcodePsnr)
+	{
+		*transcodePsnr = 0.0f;
+	}
+
 	// Create the texture
 	std::unique_ptr<D3D12_SUBRESOURCE_DATA[]> initData(
 		new (std::nothrow) D3D12_SUBRESOURCE_DATA[mipCount * arraySize]
@@ -1928,6 +2402,24 @@ HRESULT DirectX::CreateDDSTextureFromMemory12(
 	_In_ size_t maxsize,
 	_Out_opt_ DDS_ALPHA_MODE* alphaMode
 	)
+{
+	return CreateDDSTextureFromMemory12Ex(device, cmdList, ddsData, ddsDataSize, maxsize,
+		DDS_LOADER_DEFAULT, texture, textureUploadHeap, alphaMode, nullptr);
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::CreateDDSTextureFromMemory12Ex(
+	ID3D12Device* device,
+	_In_ ID3D12GraphicsCommandList* cmdList,
+	_In_reads_bytes_(ddsDataSize) const uint8_t* ddsData,
+	_In_ size_t ddsDataSize,
+	_In_ size_t maxsize,
+	_In_ unsigned int loadFlags,
+	ComPtr<ID3D12Resource>& texture,
+	ComPtr<ID3D12Resource>& textureUploadHeap,
+	_Out_opt_ DDS_ALPHA_MODE* alphaMode,
+	_Out_opt_ float* transcodePsnr
+	)
 {
 	if (alphaMode)
 		(*alphaMode) = DDS_ALPHA_MODE_UNKNOWN;
@@ -1978,8 +2470,10 @@ HRESULT DirectX::CreateDDSTextureFromMemory12(
 		ddsDataSize - offset,
 		maxsize,
 		false,
+		loadFlags,
 		texture,
-		textureUploadHeap
+		textureUploadHeap,
+		transcodePsnr
 		);
 
 	if (SUCCEEDED(hr))
@@ -2141,6 +2635,20 @@ HRESULT DirectX::CreateDDSTextureFromFile12(_In_ ID3D12Device* device,
 	_Out_ ComPtr<ID3D12Resource>& textureUploadHeap,
 	_In_ size_t maxsize,
 	_Out_opt_ DDS_ALPHA_MODE* alphaMode)
+{
+	return CreateDDSTextureFromFile12Ex(device, cmdList, szFileName, maxsize, DDS_LOADER_DEFAULT,
+		texture, textureUploadHeap, alphaMode, nullptr);
+}
+
+HRESULT DirectX::CreateDDSTextureFromFile12Ex(_In_ ID3D12Device* device,
+	_In_ ID3D12GraphicsCommandList* cmdList,
+	_In_z_ const wchar_t* szFileName,
+	_In_ size_t maxsize,
+	_In_ unsigned int loadFlags,
+	_Out_ ComPtr<ID3D12Resource>& texture,
+	_Out_ ComPtr<ID3D12Resource>& textureUploadHeap,
+	_Out_opt_ DDS_ALPHA_MODE* alphaMode,
+	_Out_opt_ float* transcodePsnr)
 {
 	if (texture)
 	{
@@ -2171,11 +2679,21 @@ HRESULT DirectX::CreateDDSTextureFromFile12(_In_ ID3D12Device* device,
 		return hr;
 	}
 
+	float psnr = 0.0f;
 	hr = CreateTextureFromDDS12(device, cmdList, header,
-		bitData, bitSize, maxsize, false, texture, textureUploadHeap);
+		bitData, bitSize, maxsize, false, loadFlags, texture, textureUploadHeap, &psnr);
 
 	if (SUCCEEDED(hr))
 	{
+		if (psnr > 0.0f)
+		{
+			wchar_t report[MAX_PATH + 64];
+			_snwprintf_s(report, _TRUNCATE, L"%s: block-compressed on load, PSNR %.2f dB\n", szFileName, psnr);
+			OutputDebugStringW(report);
+		}
+		if (transcodePsnr)
+			*transcodePsnr = psnr;
+
 /*
 #if !defined(NO_D3D11_DEBUG_NAME) && ( defined(_DEBUG) || defined(PROFILE) )
 		if (texture != 0 || textureView != 0)
@@ -55,6 +55,23 @@ namespace DirectX
         DDS_ALPHA_MODE_CUSTOM        = 4,
     };
 
+    // Import options for the D3D12 Ex loaders. The transcode flags block-compress 32bpp RGBA/BGRA
+    // 2D textures on load (see BCTranscoder.h); other formats are uploaded unchanged. When more
+    // than one target is given the highest quality one wins (BC7, then BC3, then BC1).
+    //
+    // MIP_AUTOGEN builds a full chain on the CPU for 2D textures stored with a single level
+    // (see MipGenerator.h), before any transcode. 32bpp and BC1/BC3/BC7 (mode 6) data is
+    // supported; BC data is decoded, filtered and re-encoded, keeping the original top level.
+    enum DDS_LOADER_FLAGS
+    {
+        DDS_LOADER_DEFAULT          = 0,
+        DDS_LOADER_TRANSCODE_BC1    = 0x1,
+        DDS_LOADER_TRANSCODE_BC3    = 0x2,
+        DDS_LOADER_TRANSCODE_BC7    = 0x4,
+        DDS_LOADER_MIP_AUTOGEN      = 0x8,
+        DDS_LOADER_MIP_KAISER       = 0x10, // Kaiser filter for MIP_AUTOGEN instead of box
+    };
+
     // Standard version
     HRESULT CreateDDSTextureFromMemory( _In_ ID3D11Device* d3dDevice,
                                         _In_reads_bytes_(ddsDataSize) const uint8_t* ddsData,
@@ -92,6 +109,31 @@ namespace DirectX
 		                               _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr
 		                               );
 
+	// Extended D3D12 version with import options (DDS_LOADER_FLAGS). transcodePsnr receives the
+	// PSNR in dB of the block-compressed result, or 0 when nothing was transcoded.
+	HRESULT CreateDDSTextureFromMemory12Ex(_In_ ID3D12Device* device,
+		                                   _In_ ID3D12GraphicsCommandList* cmdList,
+		                                   _In_reads_bytes_(ddsDataSize) const uint8_t* ddsData,
+		                                   _In_ size_t ddsDataSize,
+		                                   _In_ size_t maxsize,
+		                                   _In_ unsigned int loadFlags,
+		                                   _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& texture,
+		                                   _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& textureUploadHeap,
+		                                   _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr,
+		                                   _Out_opt_ float* transcodePsnr = nullptr
+		                                   );
+
+	HRESULT CreateDDSTextureFromFile12Ex(_In_ ID3D12Device* device,
+		                                 _In_ ID3D12GraphicsCommandList* cmdList,
+		                                 _In_z_ const wchar_t* szFileName,
+		                                 _In_ size_t maxsize,
+		                                 _In_ unsigned int loadFlags,
+		                                 _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& texture,
+		                                 _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& textureUploadHeap,
+		                                 _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr,
+		                                 _Out_opt_ float* transcodePsnr = nullptr
+		                                 );
+
     // Standard version with optional auto-gen mipmap support
     HRESULT CreateDDSTextureFromMemory( _In_ ID3D11Device* d3dDevice,
                                         _In_opt_ ID3D11DeviceContext* d3dContext,
@@ -0,0 +1,386 @@
+#include "MipGenerator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "ParallelFor.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#define MIP_USE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+constexpr float s_pi = 3.14159265358979f;
+constexpr float s_kaiserRadius = 3.0f;
+constexpr float s_kaiserAlpha = 4.0f;
+
+// Output rows per band; bands overlap by the kernel radius in source rows.
+constexpr size_t s_bandRows = 32;
+
+float SrgbToLinear(float c) {
+    return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
+
+float LinearToSrgb(float c) {
+    return c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+}
+
+struct DecodeTable {
+    float unorm[256];
+    float srgb[256];
+
+    DecodeTable() {
+        for (int i = 0; i < 256; ++i) {
+            unorm[i] = i / 255.0f;
+            srgb[i] = SrgbToLinear(unorm[i]);
+        }
+    }
+};
+
+const DecodeTable& Table() {
+    static const DecodeTable s_table;
+    return s_table;
+}
+
+float BesselI0(float x) {
+    float sum = 1.0f;
+    float term = 1.0f;
+    float halfX = 0.5f * x;
+    for (int k = 1; k < 32; ++k) {
+        term *= (halfX / k) * (halfX / k);
+        sum += term;
+        if (term < sum * 1e-8f) {
+            break;
+        }
+    }
+    return sum;
+}
+
+float KaiserSinc(float t) {
+    float at = std::fabs(t);
+    if (at >= s_kaiserRadius) {
+        return 0.0f;
+    }
+
+    float sinc = at < 1e-6f ? 1.0f : std::sin(s_pi * at) / (s_pi * at);
+    float r = at / s_kaiserRadius;
+    return sinc * BesselI0(s_kaiserAlpha * std::sqrt(1.0f - r * r)) / BesselI0(s_kaiserAlpha);
+}
+
+// Source taps for every output texel along one axis.
+struct Contributors {
+    std::vector<size_t> offset;  // outputCount + 1 entries into index/weight
+    std::vector<int> index;
+    std::vector<float> weight;
+};
+
+int Address(long long i, size_t size, bool wrap) {
+    long long n = static_cast<long long>(size);
+    if (wrap) {
+        return static_cast<int>(((i % n) + n) % n);
+    }
+    return static_cast<int>(std::min(n - 1, std::max(0LL, i)));
+}
+
+Contributors BuildContributors(size_t sourceSize,
+                               size_t outputSize,
+                               MipGenerator::Filter filter,
+                               bool wrap) {
+    Contributors c;
+    c.offset.reserve(outputSize + 1);
+    float scale = static_cast<float>(sourceSize) / static_cast<float>(outputSize);
+
+    for (size_t x = 0; x < outputSize; ++x) {
+        c.offset.push_back(c.index.size());
+        size_t begin = c.index.size();
+
+        if (filter == MipGenerator::Filter::Box || scale <= 1.0f) {
+            // Area coverage of [x, x + 1) in source texels.
+            float lo = x * scale;
+            float hi = (x + 1) * scale;
+            for (long long i = static_cast<long long>(std::floor(lo)); i < hi; ++i) {
+                float w = std::min<float>(hi, i + 1.0f) - std::max<float>(lo, static_cast<float>(i));
+                if (w > 0.0f) {
+                    c.index.push_back(Address(i, sourceSize, wrap));
+                    c.weight.push_back(w);
+                }
+            }
+        } else {
+            float center = (x + 0.5f) * scale - 0.5f;
+            float support = s_kaiserRadius * scale;
+            long long first = static_cast<long long>(std::ceil(center - support));
+            long long last = static_cast<long long>(std::floor(center + support));
+            for (long long i = first; i <= last; ++i) {
+                float w = KaiserSinc((i - center) / scale);
+                if (w != 0.0f) {
+                    c.index.push_back(Address(i, sourceSize, wrap));
+                    c.weight.push_back(w);
+                }
+            }
+        }
+
+        float sum = 0.0f;
+        for (size_t i = begin; i < c.weight.size(); ++i) {
+            sum += c.weight[i];
+        }
+        for (size_t i = begin; i < c.weight.size(); ++i) {
+            c.weight[i] /= sum;
+        }
+    }
+    c.offset.push_back(c.index.size());
+    return c;
+}
+
+void DecodeRow(const uint8_t* src, size_t width, bool srgb, float* out) {
+    const DecodeTable& table = Table();
+    const float* rgb = srgb ? table.srgb : table.unorm;
+    for (size_t x = 0; x < width; ++x) {
+        out[x * 4 + 0] = rgb[src[x * 4 + 0]];
+        out[x * 4 + 1] = rgb[src[x * 4 + 1]];
+        out[x * 4 + 2] = rgb[src[x * 4 + 2]];
+        out[x * 4 + 3] = table.unorm[src[x * 4 + 3]];
+    }
+}
+
+// out[x] = sum over taps of weight * row[index], four channels at a time.
+void FilterRow(const float* row, const Contributors& h, size_t outputWidth, float* out) {
+    for (size_t x = 0; x < outputWidth; ++x) {
+#if MIP_USE_SSE2
+        __m128 acc = _mm_setzero_ps();
+        for (size_t t = h.offset[x]; t < h.offset[x + 1]; ++t) {
+            __m128 px = _mm_loadu_ps(row + h.index[t] * 4);
+            acc = _mm_add_ps(acc, _mm_mul_ps(px, _mm_set1_ps(h.weight[t])));
+        }
+        _mm_storeu_ps(out + x * 4, acc);
+#else
+        float acc[4] = {};
+        for (size_t t = h.offset[x]; t < h.offset[x + 1]; ++t) {
+            const float* px = row + h.index[t] * 4;
+            for (int c = 0; c < 4; ++c) {
+                acc[c] += px[c] * h.weight[t];
+            }
+        }
+        std::memcpy(out + x * 4, acc, sizeof(acc));
+#endif
+    }
+}
+
+// acc += weight * row over count floats.
+void AccumulateRow(const float* row, float weight, size_t count, float* acc) {
+    size_t i = 0;
+#if MIP_USE_SSE2
+    __m128 w = _mm_set1_ps(weight);
+    for (; i + 4 <= count; i += 4) {
+        __m128 a = _mm_loadu_ps(acc + i);
+        _mm_storeu_ps(acc + i, _mm_add_ps(a, _mm_mul_ps(_mm_loadu_ps(row + i), w)));
+    }
+#endif
+    for (; i < count; ++i) {
+        acc[i] += row[i] * weight;
+    }
+}
+
+void EncodeRow(const float* in, size_t width, bool srgb, uint8_t* dst) {
+    auto toByte = [](float v) {
+        return static_cast<uint8_t>(std::min(255.0f, std::max(0.0f, v * 255.0f + 0.5f)));
+    };
+
+    for (size_t x = 0; x < width; ++x) {
+        for (int c = 0; c < 3; ++c) {
+            float v = std::min(1.0f, std::max(0.0f, in[x * 4 + c]));
+            dst[x * 4 + c] = toByte(srgb ? LinearToSrgb(v) : v);
+        }
+        dst[x * 4 + 3] = toByte(in[x * 4 + 3]);
+    }
+}
+
+struct Level {
+    const uint8_t* source;  // the previous level of the slice
+    size_t sourceWidth;
+    uint8_t* destination;
+    size_t width;
+    size_t height;
+    const Contributors* horizontal;
+    const Contributors* vertical;
+};
+
+struct Band {
+    const Level* level;
+    size_t firstRow;
+    size_t rowCount;
+};
+
+// Per-worker buffers, grown to the largest band seen and reused for every band after it.
+struct Scratch {
+    std::vector<int> rows;        // source rows the band reads, sorted
+    std::vector<float> decoded;   // one source row
+    std::vector<float> filtered;  // each of rows, filtered horizontally
+    std::vector<float> acc;       // one output row
+};
+
+void FilterBand(const Band& band, bool srgb, Scratch& scratch) {
+    const Level& level = *band.level;
+    const Contributors& v = *level.vertical;
+    const size_t lastRow = band.firstRow + band.rowCount;
+
+    // Horizontally filter each source row the band touches, once.
+    auto& rows = scratch.rows;
+    rows.clear();
+    for (size_t y = band.firstRow; y < lastRow; ++y) {
+        rows.insert(rows.end(), v.index.begin() + v.offset[y], v.index.begin() + v.offset[y + 1]);
+    }
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+    const size_t rowFloats = level.width * 4;
+    scratch.decoded.resize(level.sourceWidth * 4);
+    scratch.filtered.resize(rows.size() * rowFloats);
+    scratch.acc.resize(rowFloats);
+    for (size_t r = 0; r < rows.size(); ++r) {
+        DecodeRow(level.source + rows[r] * level.sourceWidth * 4, level.sourceWidth, srgb, scratch.decoded.data());
+        FilterRow(scratch.decoded.data(), *level.horizontal, level.width, scratch.filtered.data() + r * rowFloats);
+    }
+
+    for (size_t y = band.firstRow; y < lastRow; ++y) {
+        std::fill(scratch.acc.begin(), scratch.acc.end(), 0.0f);
+        for (size_t t = v.offset[y]; t < v.offset[y + 1]; ++t) {
+            size_t r = std::lower_bound(rows.begin(), rows.end(), v.index[t]) - rows.begin();
+            AccumulateRow(scratch.filtered.data() + r * rowFloats, v.weight[t], rowFloats, scratch.acc.data());
+        }
+        EncodeRow(scratch.acc.data(), level.width, srgb, level.destination + y * level.width * 4);
+    }
+}
+
+}  // namespace
+
+size_t MipGenerator::FullMipCount(size_t width, size_t height) {
+    size_t count = 1;
+    while (width > 1 || height > 1) {
+        width = std::max<size_t>(1, width >> 1);
+        height = std::max<size_t>(1, height >> 1);
+        ++count;
+    }
+    return count;
+}
+
+size_t MipGenerator::ChainBytes(size_t width, size_t height, size_t mipCount, size_t arraySize) {
+    size_t bytes = 0;
+    for (size_t mip = 0; mip < mipCount; ++mip) {
+        bytes += width * height * 4;
+        width = std::max<size_t>(1, width >> 1);
+        height = std::max<size_t>(1, height >> 1);
+    }
+    return bytes * arraySize;
+}
+
+bool MipGenerator::GenerateChain(const uint8_t* topLevels,
+                                 size_t topLevelBytes,
+                                 size_t width,
+                                 size_t height,
+                                 size_t arraySize,
+                                 size_t mipCount,
+                                 uint8_t* chain,
+                                 size_t chainBytes,
+                                 Stats* stats) const {
+    if (!topLevels || !chain || width == 0 || height == 0 || arraySize == 0 || mipCount == 0) {
+        return false;
+    }
+    if (mipCount > FullMipCount(width, height) || topLevelBytes < width * height * 4 * arraySize ||
+        chainBytes < ChainBytes(width, height, mipCount, arraySize)) {
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    // Taps depend only on the level sizes, so they are shared by every slice. Each level is
+    // filtered from the one before it.
+    std::vector<Contributors> horizontal(mipCount);
+    std::vector<Contributors> vertical(mipCount);
+    {
+        size_t w = width;
+        size_t h = height;
+        for (size_t mip = 1; mip < mipCount; ++mip) {
+            size_t sourceWidth = w;
+            size_t sourceHeight = h;
+            w = std::max<size_t>(1, w >> 1);
+            h = std::max<size_t>(1, h >> 1);
+            horizontal[mip] = BuildContributors(sourceWidth, w, settings_.filter, settings_.wrap);
+            vertical[mip] = BuildContributors(sourceHeight, h, settings_.filter, settings_.wrap);
+        }
+    }
+
+    // levels[slice * mipCount + mip]; level 0 is copied from the source.
+    std::vector<Level> levels(arraySize * mipCount);
+    uint8_t* dst = chain;
+    for (size_t slice = 0; slice < arraySize; ++slice) {
+        size_t w = width;
+        size_t h = height;
+        for (size_t mip = 0; mip < mipCount; ++mip) {
+            Level& level = levels[slice * mipCount + mip];
+            level.destination = dst;
+            level.width = w;
+            level.height = h;
+            if (mip > 0) {
+                const Level& previous = levels[slice * mipCount + mip - 1];
+                level.source = previous.destination;
+                level.sourceWidth = previous.width;
+                level.horizontal = &horizontal[mip];
+                level.vertical = &vertical[mip];
+            }
+            dst += w * h * 4;
+            w = std::max<size_t>(1, w >> 1);
+            h = std::max<size_t>(1, h >> 1);
+        }
+        std::memcpy(levels[slice * mipCount].destination, topLevels + slice * width * height * 4, width * height * 4);
+    }
+
+    unsigned int workerCount = settings_.workerCount;
+    if (workerCount == 0) {
+        workerCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    std::vector<Scratch> scratch(workerCount);
+
+    // Levels run one after another; the bands of a level, across all slices, run in parallel.
+    std::vector<Band> bands;
+    for (size_t mip = 1; mip < mipCount; ++mip) {
+        bands.clear();
+        for (size_t slice = 0; slice < arraySize; ++slice) {
+            const Level& level = levels[slice * mipCount + mip];
+            for (size_t row = 0; row < level.height; row += s_bandRows) {
+                bands.push_back({&level, row, std::min(s_bandRows, level.height - row)});
+            }
+        }
+
+        // One work item per worker, so each owns its scratch; bands are handed out between them.
+        std::atomic<size_t> next{0};
+        size_t workers = std::min<size_t>(workerCount, bands.size());
+        ParallelFor(
+            workers,
+            [&](size_t worker) {
+                for (size_t b = next.fetch_add(1); b < bands.size(); b = next.fetch_add(1)) {
+                    FilterBand(bands[b], settings_.srgb, scratch[worker]);
+                }
+            },
+            static_cast<unsigned int>(workers));
+    }
+
+    if (stats) {
+        stats->width = width;
+        stats->height = height;
+        stats->mipCount = mipCount;
+        stats->arraySize = arraySize;
+        stats->seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double megapixels = static_cast<double>(width * height * arraySize) / 1e6;
+        stats->megapixelsPerSecond = stats->seconds > 0.0 ? megapixels / stats->seconds : 0.0;
+    }
+
+    return true;
+}
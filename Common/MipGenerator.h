@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// CPU mip-chain generator for 32bpp textures, shared by the DDS loader and offline tools.
+//
+// Each level is filtered from the one before it with a separable 2:1 kernel, so a level reads
+// four times fewer texels than the last and the whole chain costs about 4/3 of one pass over the
+// top level. Levels are built in order; within a level, bands of rows from every array slice are
+// built in parallel. Rows are filtered four channels at a time on SSE2 where available. With
+// srgb set, RGB is filtered in linear space and re-encoded; alpha is always filtered linearly.
+class MipGenerator {
+  public:
+    enum class Filter {
+        Box,     // exact area average of each texel's footprint in the level above
+        Kaiser,  // Kaiser-windowed sinc (radius 3, alpha 4); sharper, may ring on hard edges
+    };
+
+    struct Settings {
+        Filter filter = Filter::Box;
+        bool srgb = false;
+        bool wrap = true;  // wrap (tiling textures) or clamp at the edges
+        unsigned int workerCount = 0;
+    };
+
+    struct Stats {
+        size_t width = 0;
+        size_t height = 0;
+        size_t mipCount = 0;
+        size_t arraySize = 0;
+        double seconds = 0.0;
+        double megapixelsPerSecond = 0.0;  // top-level texels processed per second
+    };
+
+    MipGenerator() = default;
+    explicit MipGenerator(const Settings& settings) : settings_(settings) {}
+
+    static size_t FullMipCount(size_t width, size_t height);
+
+    // Bytes of a 32bpp chain in FillInitData12 order (slice-major, mip-minor).
+    static size_t ChainBytes(size_t width, size_t height, size_t mipCount, size_t arraySize);
+
+    // topLevels holds arraySize tightly packed width x height 32bpp images. The chain is written
+    // with level 0 copied from the source and levels 1..mipCount-1 generated.
+    bool GenerateChain(const uint8_t* topLevels,
+                       size_t topLevelBytes,
+                       size_t width,
+                       size_t height,
+                       size_t arraySize,
+                       size_t mipCount,
+                       uint8_t* chain,
+                       size_t chainBytes,
+                       Stats* stats = nullptr) const;
+
+  private:
+    Settings settings_;
+};
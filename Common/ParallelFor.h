@@ -0,0 +1,41 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Runs fn(i) for every i in [0, count) on up to workerCount threads (0 = hardware concurrency).
+// Work items are handed out through an atomic counter so uneven items balance themselves.
+// The calling thread takes part in the work, so a count of 1 never spawns a thread.
+template <typename Fn>
+void ParallelFor(size_t count, Fn&& fn, unsigned int workerCount = 0) {
+    if (count == 0) {
+        return;
+    }
+
+    if (workerCount == 0) {
+        workerCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workerCount = static_cast<unsigned int>(std::min<size_t>(workerCount, count));
+
+    std::atomic<size_t> next{0};
+    auto work = [&]() {
+        for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+            fn(i);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(workerCount - 1);
+    for (unsigned int t = 1; t < workerCount; ++t) {
+        threads.emplace_back(work);
+    }
+
+    work();
+
+    for (auto& t : threads) {
+        t.join();
+    }
+}
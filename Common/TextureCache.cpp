@@ -0,0 +1,247 @@
+#include "TextureCache.h"
+
+#include <cstring>
+
+using Microsoft::WRL::ComPtr;
+
+namespace {
+
+constexpr uint64_t s_prime1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t s_prime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t s_prime3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t s_prime4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t s_prime5 = 0x27D4EB2F165667C5ULL;
+
+uint64_t Rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+uint64_t Read64(const uint8_t* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+uint32_t Read32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+uint64_t Round(uint64_t acc, uint64_t input) {
+    acc += input * s_prime2;
+    acc = Rotl(acc, 31);
+    return acc * s_prime1;
+}
+
+uint64_t MergeRound(uint64_t acc, uint64_t value) {
+    acc ^= Round(0, value);
+    return acc * s_prime1 + s_prime4;
+}
+
+// Read-only view of a whole file.
+class MappedFile {
+  public:
+    explicit MappedFile(const std::wstring& filename) {
+        file_ = CreateFileW(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE) {
+            return;
+        }
+
+        LARGE_INTEGER size{};
+        if (!GetFileSizeEx(file_, &size) || size.HighPart != 0 || size.LowPart == 0) {
+            return;
+        }
+
+        mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping_) {
+            return;
+        }
+
+        data_ = static_cast<const uint8_t*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+        if (data_) {
+            size_ = size.LowPart;
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+        if (data_) {
+            UnmapViewOfFile(data_);
+        }
+        if (mapping_) {
+            CloseHandle(mapping_);
+        }
+        if (file_ != INVALID_HANDLE_VALUE) {
+            CloseHandle(file_);
+        }
+    }
+
+    const uint8_t* Data() const { return data_; }
+    size_t Size() const { return size_; }
+
+  private:
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+}  // namespace
+
+TextureCache::TextureCache(ID3D12Device* device, uint64_t budgetBytes)
+    : device_(device), budgetBytes_(budgetBytes) {}
+
+TextureCache::Handle TextureCache::Load(ID3D12GraphicsCommandList* cmdList,
+                                        const std::wstring& filename,
+                                        unsigned int loadFlags) {
+    MappedFile file(filename);
+    if (!file.Data()) {
+        DWORD error = GetLastError();
+        ThrowIfFailed(HRESULT_FROM_WIN32(error != ERROR_SUCCESS ? error : ERROR_HANDLE_EOF));
+    }
+
+    auto texture = LoadFromMemory(cmdList, file.Data(), file.Size(), loadFlags);
+    if (texture->Filename.empty()) {
+        texture->Filename = filename;
+    }
+    return texture;
+}
+
+TextureCache::Handle TextureCache::LoadFromMemory(ID3D12GraphicsCommandList* cmdList,
+                                                  const uint8_t* ddsData,
+                                                  size_t ddsDataSize,
+                                                  unsigned int loadFlags) {
+    Key key = {Hash(ddsData, ddsDataSize), ddsDataSize, loadFlags};
+    if (auto texture = Lookup(key)) {
+        ++stats_.hits;
+        return texture;
+    }
+    ++stats_.misses;
+
+    auto texture = std::make_shared<Texture>();
+    char name[17];
+    sprintf_s(name, "%016llx", static_cast<unsigned long long>(key.hash));
+    texture->Name = name;
+    ThrowIfFailed(DirectX::CreateDDSTextureFromMemory12Ex(device_.Get(),
+                                                          cmdList,
+                                                          ddsData,
+                                                          ddsDataSize,
+                                                          0,
+                                                          loadFlags,
+                                                          texture->Resource,
+                                                          texture->UploadHeap));
+
+    auto desc = texture->Resource->GetDesc();
+    uint64_t bytes = device_->GetResourceAllocationInfo(0, 1, &desc).SizeInBytes;
+
+    lru_.push_front({key, texture, bytes});
+    entries_[key] = lru_.begin();
+    stats_.residentBytes += bytes;
+    stats_.residentCount = lru_.size();
+
+    Trim(budgetBytes_);
+    return texture;
+}
+
+TextureCache::WeakHandle TextureCache::Find(uint64_t hash, unsigned int loadFlags) const {
+    for (const auto& entry : lru_) {
+        if (entry.key.hash == hash && entry.key.loadFlags == loadFlags) {
+            return entry.texture;
+        }
+    }
+    return {};
+}
+
+TextureCache::Handle TextureCache::Lookup(const Key& key) {
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        return nullptr;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return it->second->texture;
+}
+
+void TextureCache::ReleaseUploadHeaps() {
+    for (auto& entry : lru_) {
+        entry.texture->UploadHeap = nullptr;
+    }
+}
+
+void TextureCache::Trim(uint64_t targetBytes) {
+    for (auto it = lru_.end(); it != lru_.begin() && stats_.residentBytes > targetBytes;) {
+        --it;
+        // The cache holds one reference; anything more means a client still uses the texture.
+        if (it->texture.use_count() > 1) {
+            continue;
+        }
+        if (retire_) {
+            retire_(std::move(it->texture->Resource));
+            if (it->texture->UploadHeap) {
+                retire_(std::move(it->texture->UploadHeap));
+            }
+        }
+        stats_.residentBytes -= it->bytes;
+        ++stats_.evictions;
+        entries_.erase(it->key);
+        it = lru_.erase(it);
+    }
+    stats_.residentCount = lru_.size();
+}
+
+void TextureCache::SetBudget(uint64_t budgetBytes) {
+    budgetBytes_ = budgetBytes;
+    Trim(budgetBytes_);
+}
+
+uint64_t TextureCache::Hash(const void* data, size_t size, uint64_t seed) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    const uint8_t* end = p + size;
+    uint64_t h;
+
+    if (size >= 32) {
+        uint64_t v1 = seed + s_prime1 + s_prime2;
+        uint64_t v2 = seed + s_prime2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - s_prime1;
+        for (const uint8_t* limit = end - 32; p <= limit; p += 32) {
+            v1 = Round(v1, Read64(p));
+            v2 = Round(v2, Read64(p + 8));
+            v3 = Round(v3, Read64(p + 16));
+            v4 = Round(v4, Read64(p + 24));
+        }
+        h = Rotl(v1, 1) + Rotl(v2, 7) + Rotl(v3, 12) + Rotl(v4, 18);
+        h = MergeRound(h, v1);
+        h = MergeRound(h, v2);
+        h = MergeRound(h, v3);
+        h = MergeRound(h, v4);
+    } else {
+        h = seed + s_prime5;
+    }
+
+    h += static_cast<uint64_t>(size);
+
+    for (; p + 8 <= end; p += 8) {
+        h ^= Round(0, Read64(p));
+        h = Rotl(h, 27) * s_prime1 + s_prime4;
+    }
+    if (p + 4 <= end) {
+        h ^= static_cast<uint64_t>(Read32(p)) * s_prime1;
+        h = Rotl(h, 23) * s_prime2 + s_prime3;
+        p += 4;
+    }
+    for (; p < end; ++p) {
+        h ^= (*p) * s_prime5;
+        h = Rotl(h, 11) * s_prime1;
+    }
+
+    h ^= h >> 33;
+    h *= s_prime2;
+    h ^= h >> 29;
+    h *= s_prime3;
+    h ^= h >> 32;
+    return h;
+}
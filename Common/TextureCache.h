@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "d3dUtil.h"
+
+// Content-addressed registry of DDS textures.
+//
+// Textures are keyed by an xxHash64 of the file bytes (read through a file mapping) together
+// with the loader flags, so the same image is uploaded once however many materials or
+// filenames refer to it. Clients hold shared_ptr handles; weak handles observe a texture
+// without keeping it resident. Textures nobody references stay cached in LRU order and are
+// evicted once the resident total exceeds the byte budget. Referenced textures are never
+// evicted, so the budget can be exceeded while they are in use.
+//
+// An unreferenced texture may still be read by submitted work: its upload, a copy out of it, or
+// draws of earlier frames. Evicted resources go to the retire callback, which should keep them
+// until that work has finished. Without one they are released on eviction, and the GPU must be
+// done with every evictable texture before a Trim(), SetBudget() or Load() that may evict.
+class TextureCache {
+  public:
+    using Handle = std::shared_ptr<Texture>;
+    using WeakHandle = std::weak_ptr<Texture>;
+
+    // Called with the resource, and the upload heap if not yet released, of each evicted texture.
+    using RetireCallback = std::function<void(Microsoft::WRL::ComPtr<ID3D12Resource> resource)>;
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        uint64_t residentBytes = 0;
+        size_t residentCount = 0;
+    };
+
+    TextureCache(ID3D12Device* device, uint64_t budgetBytes);
+
+    TextureCache(const TextureCache&) = delete;
+    TextureCache& operator=(const TextureCache&) = delete;
+
+    // Returns the resident texture with the same content and flags, or records its upload on
+    // cmdList. On a copy list the texture is left in COMMON instead of PIXEL_SHADER_RESOURCE.
+    // Throws DxException when the file cannot be read or the DDS is invalid.
+    Handle Load(ID3D12GraphicsCommandList* cmdList,
+                const std::wstring& filename,
+                unsigned int loadFlags = DirectX::DDS_LOADER_DEFAULT);
+
+    Handle LoadFromMemory(ID3D12GraphicsCommandList* cmdList,
+                          const uint8_t* ddsData,
+                          size_t ddsDataSize,
+                          unsigned int loadFlags = DirectX::DDS_LOADER_DEFAULT);
+
+    // Lookup without loading; empty when the content is not resident.
+    WeakHandle Find(uint64_t hash, unsigned int loadFlags = DirectX::DDS_LOADER_DEFAULT) const;
+
+    // Drops the upload heaps of every cached texture. Call once the command lists that recorded
+    // the uploads have finished executing.
+    void ReleaseUploadHeaps();
+
+    // Evicts unreferenced textures, least recently used first, until residentBytes <= targetBytes.
+    void Trim(uint64_t targetBytes);
+
+    void SetBudget(uint64_t budgetBytes);
+    uint64_t GetBudget() const { return budgetBytes_; }
+
+    void SetRetireCallback(RetireCallback retire) { retire_ = std::move(retire); }
+
+    const Stats& GetStats() const { return stats_; }
+
+    // xxHash64 of the given bytes.
+    static uint64_t Hash(const void* data, size_t size, uint64_t seed = 0);
+
+  private:
+    struct Key {
+        uint64_t hash;
+        uint64_t size;
+        unsigned int loadFlags;
+
+        bool operator==(const Key& other) const {
+            return hash == other.hash && size == other.size && loadFlags == other.loadFlags;
+        }
+    };
+
+    struct KeyHasher {
+        size_t operator()(const Key& key) const {
+            return static_cast<size_t>(key.hash ^ (static_cast<uint64_t>(key.loadFlags) << 32));
+        }
+    };
+
+    struct Entry {
+        Key key;
+        Handle texture;
+        uint64_t bytes;
+    };
+
+    Handle Lookup(const Key& key);
+
+    Microsoft::WRL::ComPtr<ID3D12Device> device_;
+    uint64_t budgetBytes_;
+    RetireCallback retire_;
+
+    std::list<Entry> lru_;  // most recently used first
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHasher> entries_;
+
+    Stats stats_;
+};
@@ -0,0 +1,242 @@
+#include "TexturePacker.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+uint32_t RoundUp(uint32_t value, uint32_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+uint32_t NextPowerOfTwo(uint32_t value) {
+    uint32_t p = 1;
+    while (p < value) {
+        p <<= 1;
+    }
+    return p;
+}
+
+bool SameArrayKey(const TexturePacker::Source& a, const TexturePacker::Source& b) {
+    return a.format == b.format && a.width == b.width && a.height == b.height &&
+           a.mipCount == b.mipCount && a.blockDim == b.blockDim;
+}
+
+}  // namespace
+
+TexturePacker::Plan TexturePacker::Pack(const std::vector<Source>& sources) const {
+    Plan plan;
+    plan.placements.resize(sources.size());
+
+    // Bucket by everything a Texture2DArray slice has to share, in first-seen order.
+    std::vector<std::vector<size_t>> buckets;
+    for (size_t i = 0; i < sources.size(); ++i) {
+        auto it = std::find_if(buckets.begin(), buckets.end(), [&](const std::vector<size_t>& bucket) {
+            return SameArrayKey(sources[bucket.front()], sources[i]);
+        });
+        if (it != buckets.end()) {
+            it->push_back(i);
+        } else {
+            buckets.push_back({i});
+        }
+    }
+
+    // Leftover non-tiling singletons are atlas candidates, grouped by format.
+    std::vector<std::vector<size_t>> atlasCandidates;
+    for (const auto& bucket : buckets) {
+        const Source& first = sources[bucket.front()];
+        if (bucket.size() >= 2 || first.tiling) {
+            AddArrayGroup(sources, bucket, plan);
+            continue;
+        }
+
+        auto it = std::find_if(atlasCandidates.begin(), atlasCandidates.end(), [&](const std::vector<size_t>& c) {
+            const Source& s = sources[c.front()];
+            return s.format == first.format && s.blockDim == first.blockDim;
+        });
+        if (it != atlasCandidates.end()) {
+            it->push_back(bucket.front());
+        } else {
+            atlasCandidates.push_back({bucket.front()});
+        }
+    }
+
+    for (auto& candidates : atlasCandidates) {
+        PackAtlases(sources, candidates, plan);
+    }
+
+    return plan;
+}
+
+void TexturePacker::AddArrayGroup(const std::vector<Source>& sources,
+                                  const std::vector<size_t>& members,
+                                  Plan& plan) const {
+    size_t maxSlices = std::max<uint32_t>(1, settings_.maxArraySlices);
+    for (size_t begin = 0; begin < members.size(); begin += maxSlices) {
+        size_t end = std::min(members.size(), begin + maxSlices);
+        const Source& first = sources[members[begin]];
+
+        Group group;
+        group.kind = Kind::Array;
+        group.format = first.format;
+        group.width = first.width;
+        group.height = first.height;
+        group.mipCount = first.mipCount;
+        group.arraySize = static_cast<uint32_t>(end - begin);
+        group.sources.assign(members.begin() + begin, members.begin() + end);
+
+        for (size_t i = begin; i < end; ++i) {
+            Placement& p = plan.placements[members[i]];
+            p = Placement{};
+            p.group = plan.groups.size();
+            p.slice = static_cast<uint32_t>(i - begin);
+        }
+        plan.groups.push_back(std::move(group));
+    }
+}
+
+void TexturePacker::PackAtlases(const std::vector<Source>& sources,
+                                std::vector<size_t> candidates,
+                                Plan& plan) const {
+    if (candidates.size() == 1) {
+        AddArrayGroup(sources, candidates, plan);
+        return;
+    }
+
+    // Entry offsets and sizes must stay whole blocks at every kept mip, and the guard band must
+    // not vanish at the smallest one. Dropping the tail of the chain keeps the alignment (and so
+    // the guard band) small; the lowest mips of an atlas would bleed between entries anyway.
+    const uint32_t blockDim = sources[candidates.front()].blockDim;
+    const uint32_t guard = RoundUp(std::max(settings_.guardTexels, blockDim), blockDim);
+    uint32_t mipCount = sources[candidates.front()].mipCount;
+    for (size_t i : candidates) {
+        mipCount = std::max(1u, std::min(mipCount, sources[i].mipCount));
+    }
+    auto fits = [&](uint32_t mips) {
+        uint32_t alignment = blockDim << (mips - 1);
+        if (alignment > guard) {
+            return false;
+        }
+        for (size_t i : candidates) {
+            if (sources[i].width % alignment != 0 || sources[i].height % alignment != 0) {
+                return false;
+            }
+        }
+        return true;
+    };
+    while (mipCount > 1 && !fits(mipCount)) {
+        --mipCount;
+    }
+    const uint32_t alignment = blockDim << (mipCount - 1);
+    const uint32_t guardTexels = RoundUp(guard, alignment);
+
+    auto paddedWidth = [&](size_t i) { return RoundUp(sources[i].width, alignment) + 2 * guardTexels; };
+    auto paddedHeight = [&](size_t i) { return RoundUp(sources[i].height, alignment) + 2 * guardTexels; };
+
+    // Entries too large for any atlas keep a resource of their own.
+    std::vector<size_t> remaining;
+    for (size_t i : candidates) {
+        if (paddedWidth(i) > settings_.maxAtlasSize || paddedHeight(i) > settings_.maxAtlasSize) {
+            AddArrayGroup(sources, {i}, plan);
+        } else {
+            remaining.push_back(i);
+        }
+    }
+
+    // Shelf packing, tallest first. Whatever does not fit starts the next atlas.
+    std::stable_sort(remaining.begin(), remaining.end(), [&](size_t a, size_t b) {
+        return paddedHeight(a) > paddedHeight(b);
+    });
+
+    while (!remaining.empty()) {
+        if (remaining.size() == 1) {
+            AddArrayGroup(sources, remaining, plan);
+            return;
+        }
+
+        double area = 0.0;
+        uint32_t widest = 0;
+        for (size_t i : remaining) {
+            area += static_cast<double>(paddedWidth(i)) * paddedHeight(i);
+            widest = std::max(widest, paddedWidth(i));
+        }
+        uint32_t atlasWidth = NextPowerOfTwo(static_cast<uint32_t>(std::ceil(std::sqrt(area))));
+        atlasWidth = std::min(settings_.maxAtlasSize, std::max(atlasWidth, widest));
+
+        struct Slot {
+            size_t source;
+            uint32_t x;
+            uint32_t y;
+        };
+        std::vector<Slot> slots;
+        std::vector<size_t> deferred;
+        uint32_t x = 0;
+        uint32_t y = 0;
+        uint32_t shelfHeight = 0;
+        uint32_t usedWidth = 0;
+        for (size_t i : remaining) {
+            if (x + paddedWidth(i) > atlasWidth) {
+                x = 0;
+                y += shelfHeight;
+                shelfHeight = 0;
+            }
+            if (y + paddedHeight(i) > settings_.maxAtlasSize) {
+                deferred.push_back(i);
+                continue;
+            }
+            slots.push_back({i, x, y});
+            x += paddedWidth(i);
+            usedWidth = std::max(usedWidth, x);
+            shelfHeight = std::max(shelfHeight, paddedHeight(i));
+        }
+
+        if (slots.size() == 1) {
+            AddArrayGroup(sources, {slots.front().source}, plan);
+        } else {
+            Group group;
+            group.kind = Kind::Atlas;
+            group.format = sources[slots.front().source].format;
+            group.width = usedWidth;
+            group.height = y + shelfHeight;
+            group.mipCount = mipCount;
+            group.arraySize = 1;
+            group.guardTexels = guardTexels;
+
+            for (const Slot& slot : slots) {
+                const Source& s = sources[slot.source];
+                Placement& p = plan.placements[slot.source];
+                p.group = plan.groups.size();
+                p.slice = 0;
+                p.x = slot.x + guardTexels;
+                p.y = slot.y + guardTexels;
+                p.scaleU = static_cast<float>(s.width) / group.width;
+                p.scaleV = static_cast<float>(s.height) / group.height;
+                p.offsetU = static_cast<float>(p.x) / group.width;
+                p.offsetV = static_cast<float>(p.y) / group.height;
+                group.sources.push_back(slot.source);
+            }
+            plan.groups.push_back(std::move(group));
+        }
+
+        remaining = std::move(deferred);
+    }
+}
+
+void TexturePacker::Remap(const Placement& placement, float u, float v, float& outU, float& outV, float& outSlice) {
+    outU = u * placement.scaleU + placement.offsetU;
+    outV = v * placement.scaleV + placement.offsetV;
+    outSlice = static_cast<float>(placement.slice);
+}
+
+void TexturePacker::WriteMatTransform(const Placement& placement, float m[4][4]) {
+    for (int r = 0; r < 4; ++r) {
+        for (int c = 0; c < 4; ++c) {
+            m[r][c] = r == c ? 1.0f : 0.0f;
+        }
+    }
+    m[0][0] = placement.scaleU;
+    m[1][1] = placement.scaleV;
+    m[3][0] = placement.offsetU;
+    m[3][1] = placement.offsetV;
+    m[3][2] = static_cast<float>(placement.slice);
+}
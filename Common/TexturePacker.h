@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Plans how a set of material textures is merged into fewer GPU resources.
+//
+// Textures that share format, size and mip count become slices of one Texture2DArray. Remaining
+// non-tiling textures of the same format are packed into a 2D atlas (one array slice) with guard
+// bands of replicated edge texels around every entry. Tiling textures never go into an atlas,
+// since wrap addressing would sample their neighbours; they keep a slice of their own.
+//
+// Planning is pure CPU work on texture descriptions; the caller copies the texel data. For every
+// source the plan gives the group, slice and the UV scale/offset that maps [0,1] into its region.
+class TexturePacker {
+  public:
+    struct Source {
+        std::string name;
+        uint32_t format = 0;  // DXGI_FORMAT; only compared for equality
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t mipCount = 1;
+        uint32_t blockDim = 1;  // 4 for block-compressed formats
+        bool tiling = false;    // sampled with wrap addressing outside [0,1]
+    };
+
+    struct Settings {
+        uint32_t guardTexels = 16;  // minimum guard band at mip 0, per side
+        uint32_t maxAtlasSize = 4096;
+        uint32_t maxArraySlices = 2048;
+    };
+
+    enum class Kind { Array, Atlas };
+
+    struct Group {
+        Kind kind = Kind::Array;
+        uint32_t format = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t mipCount = 1;
+        uint32_t arraySize = 1;
+        uint32_t guardTexels = 0;  // atlas only; a multiple of the alignment of the last mip
+        std::vector<size_t> sources;
+    };
+
+    struct Placement {
+        size_t group = 0;
+        uint32_t slice = 0;
+        uint32_t x = 0;  // top-left texel of the entry at mip 0 (atlas only)
+        uint32_t y = 0;
+        float scaleU = 1.0f;
+        float scaleV = 1.0f;
+        float offsetU = 0.0f;
+        float offsetV = 0.0f;
+    };
+
+    struct Plan {
+        std::vector<Group> groups;
+        std::vector<Placement> placements;  // one per source, in source order
+    };
+
+    TexturePacker() = default;
+    explicit TexturePacker(const Settings& settings) : settings_(settings) {}
+
+    Plan Pack(const std::vector<Source>& sources) const;
+
+    // Maps a source UV into the packed resource: (u', v') in the group and the array slice.
+    static void Remap(const Placement& placement, float u, float v, float& outU, float& outV, float& outSlice);
+
+    // Writes the placement into a MaterialConstants::MatTransform (row vectors, as the shaders
+    // use it): scale on the diagonal, UV offset in m[3][0..1] and the array slice in m[3][2].
+    static void WriteMatTransform(const Placement& placement, float m[4][4]);
+
+  private:
+    void PackAtlases(const std::vector<Source>& sources, std::vector<size_t> candidates, Plan& plan) const;
+    void AddArrayGroup(const std::vector<Source>& sources, const std::vector<size_t>& members, Plan& plan) const;
+
+    Settings settings_;
+};
@@ -66,8 +66,17 @@ bool MyApp::InitializeWindow(const std::wstring& initWindowName) {
     return isRunning;
 }
 
+void MyApp::InitializeHeadless(UINT width, UINT height) {
+    clientWidth = width;
+    clientHeight = height;
+    hwnd = nullptr;
+    isRunning = true;
+}
+
 void MyApp::ShowWindow() {
-    ::ShowWindow(hwnd, nCmdShow);
+    if (hwnd) {
+        ::ShowWindow(hwnd, nCmdShow);
+    }
 }
 
 bool MyApp::PollEvents() {
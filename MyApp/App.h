@@ -2,6 +2,7 @@
 
 #include <windows.h>
 
+#include <atomic>
 #include <xstring>
 
 class MyApp {
@@ -16,6 +17,9 @@ class MyApp {
 
     bool InitializeWindow(const std::wstring &windowName);
 
+    // Runs without a window: nothing to show, no messages, and the loop runs until Quit().
+    void InitializeHeadless(UINT width, UINT height);
+
     void ShowWindow();
 
     bool PollEvents();
@@ -47,12 +51,17 @@ class MyApp {
 
     virtual void OnResize() {}
 
+    // Makes PollEvents() return false, ending the frame loop.
+    void Quit() { isRunning = false; }
+
     [[nodiscard]] static bool IsKeyDown(char key) { return GetKeyState(key) & 0x8000; }
 
     auto GetWindow() const { return hwnd; }
 
     auto GetWindowName() const { return windowName; }
 
+    const wchar_t* GetCmdLine() const { return pCmdLine; }
+
     POINT GetMousePos() const { return mousePos_; }
 
     bool IsLMouseDown() const { return lMouseDown_; }
@@ -61,7 +70,7 @@ class MyApp {
 
   private:
     // ReSharper disable once IdentifierTypo
-    HWND hwnd;
+    HWND hwnd = nullptr;
     std::wstring windowName;
 
     UINT clientWidth = 800;
@@ -72,7 +81,7 @@ class MyApp {
     PWSTR pCmdLine;
     int nCmdShow;
 
-    bool isRunning;
+    std::atomic<bool> isRunning = false;
 
     bool lMouseDown_;
     bool rMouseDown_;
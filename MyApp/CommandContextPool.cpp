@@ -0,0 +1,93 @@
+#include "CommandContextPool.h"
+
+void D3D12CommandContextBackend::Create(CommandContext& context, ID3D12PipelineState* initialState) {
+    ThrowIfFailed(device_->CreateCommandAllocator(context.type,
+                                                  IID_PPV_ARGS(context.allocator.GetAddressOf())));
+    ThrowIfFailed(device_->CreateCommandList(0,
+                                             context.type,
+                                             context.allocator.Get(),
+                                             initialState,
+                                             IID_PPV_ARGS(context.commandList.GetAddressOf())));
+}
+
+void D3D12CommandContextBackend::Reset(CommandContext& context, ID3D12PipelineState* initialState) {
+    ThrowIfFailed(context.allocator->Reset());
+    ThrowIfFailed(context.commandList->Reset(context.allocator.Get(), initialState));
+}
+
+CommandContextPool::CommandContextPool(CommandContextBackend* backend, FenceBackend* fence)
+    : backend_(backend),
+      defaultFence_(fence) {}
+
+void CommandContextPool::SetFence(D3D12_COMMAND_LIST_TYPE type, FenceBackend* fence) {
+    std::lock_guard lock(mutex_);
+    TypePool& pool = GetTypePool(type);
+    assert(pool.contexts.empty() && "Set the fence before acquiring contexts of this type.");
+    pool.fence = fence;
+}
+
+CommandContext* CommandContextPool::Acquire(D3D12_COMMAND_LIST_TYPE type,
+                                            ID3D12PipelineState* initialState) {
+    CommandContext* context = nullptr;
+    bool created = false;
+    {
+        std::lock_guard lock(mutex_);
+        TypePool& pool = GetTypePool(type);
+        ++stats_.acquired;
+
+        if (!pool.released.empty()) {
+            UINT64 oldest = pool.released.front()->fenceValue;
+            if (oldest > pool.lastCompleted) {
+                pool.lastCompleted = pool.fence->GetCompletedValue();
+            }
+            if (oldest <= pool.lastCompleted) {
+                context = pool.released.front();
+                pool.released.pop_front();
+            }
+        }
+
+        if (context == nullptr) {
+            context = &pool.contexts.emplace_back();
+            context->type = type;
+            created = true;
+            ++stats_.created;
+        }
+    }
+
+    // The context belongs to this thread until Release().
+    if (created) {
+        backend_->Create(*context, initialState);
+    } else {
+        backend_->Reset(*context, initialState);
+    }
+    return context;
+}
+
+void CommandContextPool::Release(CommandContext* context, UINT64 fenceValue) {
+    std::lock_guard lock(mutex_);
+    TypePool& pool = GetTypePool(context->type);
+    assert((pool.released.empty() || pool.released.back()->fenceValue <= fenceValue) &&
+           "Contexts must be released in fence order.");
+
+    context->fenceValue = fenceValue;
+    pool.released.push_back(context);
+}
+
+size_t CommandContextPool::GetContextCount(D3D12_COMMAND_LIST_TYPE type) const {
+    std::lock_guard lock(mutex_);
+    auto it = pools_.find(type);
+    return it == pools_.end() ? 0 : it->second.contexts.size();
+}
+
+CommandContextPool::Stats CommandContextPool::GetStats() const {
+    std::lock_guard lock(mutex_);
+    return stats_;
+}
+
+CommandContextPool::TypePool& CommandContextPool::GetTypePool(D3D12_COMMAND_LIST_TYPE type) {
+    auto [it, inserted] = pools_.try_emplace(type);
+    if (inserted) {
+        it->second.fence = defaultFence_;
+    }
+    return it->second;
+}
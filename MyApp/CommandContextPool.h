@@ -0,0 +1,93 @@
+#pragma once
+
+#include <deque>
+#include <map>
+#include <mutex>
+
+#include "Common/d3dUtil.h"
+#include "FramePacer.h"
+
+// A command allocator and the list recording into it. Owned by CommandContextPool.
+struct CommandContext {
+    Microsoft::WRL::ComPtr<ID3D12CommandAllocator> allocator;
+    Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> commandList;
+    D3D12_COMMAND_LIST_TYPE type = D3D12_COMMAND_LIST_TYPE_DIRECT;
+    UINT64 fenceValue = 0;  // reusable once the queue's fence reaches this
+};
+
+// Creates and resets the objects behind a CommandContext. A fake can leave them null so the
+// recycling logic runs without a device.
+class CommandContextBackend {
+  public:
+    virtual ~CommandContextBackend() = default;
+
+    // Fills in a new context with its list open.
+    virtual void Create(CommandContext& context, ID3D12PipelineState* initialState) = 0;
+
+    // Resets the allocator and reopens the list. The GPU must be done with both.
+    virtual void Reset(CommandContext& context, ID3D12PipelineState* initialState) = 0;
+};
+
+class D3D12CommandContextBackend final : public CommandContextBackend {
+  public:
+    explicit D3D12CommandContextBackend(ID3D12Device* device) : device_(device) {}
+
+    void Create(CommandContext& context, ID3D12PipelineState* initialState) override;
+
+    void Reset(CommandContext& context, ID3D12PipelineState* initialState) override;
+
+  private:
+    Microsoft::WRL::ComPtr<ID3D12Device> device_;
+};
+
+// Allocator/list pairs per queue type, recycled by fence value.
+//
+// Acquire() hands out a context with its list open; Release() returns it tagged with the fence
+// value the queue will signal after executing it. Released contexts queue up per type in release
+// order, so only the oldest has to be checked against the fence. A new context is created only
+// when that one is still in flight, which bounds the pool by the contexts a frame uses times the
+// frames in flight. Each allocator is reset on reuse and keeps the memory it grew to.
+//
+// Acquire() and Release() are safe to call from several threads.
+class CommandContextPool {
+  public:
+    struct Stats {
+        UINT64 acquired = 0;
+        UINT64 created = 0;
+    };
+
+    // fence is used for every queue type unless overridden with SetFence().
+    CommandContextPool(CommandContextBackend* backend, FenceBackend* fence);
+
+    // For queue types signalling a fence of their own.
+    void SetFence(D3D12_COMMAND_LIST_TYPE type, FenceBackend* fence);
+
+    [[nodiscard]]
+    CommandContext* Acquire(D3D12_COMMAND_LIST_TYPE type, ID3D12PipelineState* initialState = nullptr);
+
+    // Call once the list is closed and executed, with the fence value its queue signals after it.
+    void Release(CommandContext* context, UINT64 fenceValue);
+
+    [[nodiscard]]
+    size_t GetContextCount(D3D12_COMMAND_LIST_TYPE type) const;
+
+    [[nodiscard]]
+    Stats GetStats() const;
+
+  private:
+    struct TypePool {
+        FenceBackend* fence = nullptr;
+        UINT64 lastCompleted = 0;  // cached so a ready context costs no fence query
+        std::deque<CommandContext> contexts;  // references stay valid while the pool grows
+        std::deque<CommandContext*> released;  // oldest first
+    };
+
+    TypePool& GetTypePool(D3D12_COMMAND_LIST_TYPE type);
+
+    CommandContextBackend* backend_ = nullptr;
+    FenceBackend* defaultFence_ = nullptr;
+
+    mutable std::mutex mutex_;
+    std::map<D3D12_COMMAND_LIST_TYPE, TypePool> pools_;
+    Stats stats_;
+};
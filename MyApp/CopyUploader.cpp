@@ -0,0 +1,136 @@
+#include "CopyUploader.h"
+
+D3D12CopyQueueBackend::D3D12CopyQueueBackend(ID3D12Device* device,
+                                             CommandContextPool* pool,
+                                             UINT64 ringSize)
+    : pool_(pool) {
+    D3D12_COMMAND_QUEUE_DESC queueDesc{};
+    queueDesc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+    queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+    ThrowIfFailed(device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(queue_.GetAddressOf())));
+
+    ThrowIfFailed(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(fence_.GetAddressOf())));
+    fenceBackend_ = std::make_unique<D3D12FenceBackend>(fence_.Get());
+    pool_->SetFence(D3D12_COMMAND_LIST_TYPE_COPY, fenceBackend_.get());
+
+    uploadRing_ = std::make_unique<UploadRing>(device, fence_.Get(), ringSize);
+}
+
+ID3D12GraphicsCommandList* D3D12CopyQueueBackend::Open() {
+    assert(context_ == nullptr);
+    context_ = pool_->Acquire(D3D12_COMMAND_LIST_TYPE_COPY);
+    return context_->commandList.Get();
+}
+
+void D3D12CopyQueueBackend::Submit(UINT64 fenceValue) {
+    assert(context_ != nullptr);
+    ThrowIfFailed(context_->commandList->Close());
+
+    ID3D12CommandList* lists[] = {context_->commandList.Get()};
+    queue_->ExecuteCommandLists(_countof(lists), lists);
+    ThrowIfFailed(queue_->Signal(fence_.Get(), fenceValue));
+
+    uploadRing_->Submit(fenceValue);
+    pool_->Release(context_, fenceValue);
+    context_ = nullptr;
+}
+
+void D3D12CopyQueueBackend::InsertWait(ID3D12CommandQueue* queue, UINT64 fenceValue) {
+    ThrowIfFailed(queue->Wait(fence_.Get(), fenceValue));
+}
+
+CopyUploader::CopyUploader(CopyQueueBackend* backend, UINT64 batchBytes)
+    : backend_(backend),
+      batchBytes_(batchBytes),
+      retained_(backend) {}
+
+CopyUploader::~CopyUploader() {
+    WaitForIdle();
+}
+
+ID3D12GraphicsCommandList* CopyUploader::GetCommandList() {
+    if (!open_) {
+        commandList_ = backend_->Open();
+        open_ = true;
+        openBytes_ = 0;
+        openFenceValue_ = lastSubmitted_ + 1;
+    }
+    return commandList_;
+}
+
+CopyUploader::Ticket CopyUploader::Commit(UINT64 byteSize) {
+    assert(open_ && "Record the upload on GetCommandList() first.");
+
+    ++stats_.uploads;
+    stats_.bytes += byteSize;
+    openBytes_ += byteSize;
+
+    Ticket ticket = {openFenceValue_};
+    if (openBytes_ >= batchBytes_) {
+        Flush();
+    }
+    return ticket;
+}
+
+void CopyUploader::Retain(Microsoft::WRL::ComPtr<ID3D12Resource> resource) {
+    // Without an open batch the GPU can only still be reading it from the last submitted one.
+    if (open_) {
+        retained_.Release(std::move(resource), openFenceValue_);
+    } else if (lastSubmitted_ > 0) {
+        retained_.Release(std::move(resource), lastSubmitted_);
+    }
+}
+
+void CopyUploader::Flush() {
+    if (!open_) {
+        return;
+    }
+
+    backend_->Submit(openFenceValue_);
+    lastSubmitted_ = openFenceValue_;
+    ++stats_.batches;
+
+    commandList_ = nullptr;
+    open_ = false;
+}
+
+void CopyUploader::Require(Ticket ticket) {
+    required_ = std::max(required_, ticket.fenceValue);
+}
+
+void CopyUploader::InsertWaits(ID3D12CommandQueue* queue) {
+    if (required_ <= waited_) {
+        return;
+    }
+
+    // A wait on a value the copy queue has not been asked to signal would never return.
+    if (required_ > lastSubmitted_) {
+        Flush();
+    }
+
+    if (IsComplete({required_})) {
+        ++stats_.skippedWaits;
+    } else {
+        backend_->InsertWait(queue, required_);
+        ++stats_.gpuWaits;
+    }
+    waited_ = required_;
+}
+
+bool CopyUploader::IsComplete(Ticket ticket) {
+    if (ticket.fenceValue > lastCompleted_) {
+        lastCompleted_ = backend_->GetCompletedValue();
+    }
+    return ticket.fenceValue <= lastCompleted_;
+}
+
+void CopyUploader::Reclaim() {
+    retained_.Collect();
+}
+
+void CopyUploader::WaitForIdle() {
+    if (lastSubmitted_ > 0) {
+        backend_->Wait(lastSubmitted_);
+    }
+    Reclaim();
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <memory>
+
+#include "Common/d3dUtil.h"
+#include "CommandContextPool.h"
+#include "DeferredReleaseQueue.h"
+#include "FramePacer.h"
+#include "UploadRing.h"
+
+// Copy queue behind CopyUploader, including the fence it signals. A simulated queue can hand out
+// null lists and complete batches on demand.
+class CopyQueueBackend : public FenceBackend {
+  public:
+    // Opens a list to record the next batch into.
+    virtual ID3D12GraphicsCommandList* Open() = 0;
+
+    // Closes and executes the open list, then signals fenceValue.
+    virtual void Submit(UINT64 fenceValue) = 0;
+
+    // Makes queue wait on the GPU until the copy fence reaches fenceValue.
+    virtual void InsertWait(ID3D12CommandQueue* queue, UINT64 fenceValue) = 0;
+};
+
+// A COPY queue with its own fence and staging ring. Lists come from the context pool.
+//
+// Resources recorded on it must start in COMMON and take no barriers: copies promote them to
+// COPY_DEST or COPY_SOURCE and they decay back to COMMON when the batch finishes. From there
+// buffers and textures are promoted to their read states on first use by the graphics queue.
+class D3D12CopyQueueBackend final : public CopyQueueBackend {
+  public:
+    D3D12CopyQueueBackend(ID3D12Device* device, CommandContextPool* pool, UINT64 ringSize);
+
+    ID3D12GraphicsCommandList* Open() override;
+
+    void Submit(UINT64 fenceValue) override;
+
+    void InsertWait(ID3D12CommandQueue* queue, UINT64 fenceValue) override;
+
+    UINT64 GetCompletedValue() override { return fence_->GetCompletedValue(); }
+
+    void Wait(UINT64 value) override { fenceBackend_->Wait(value); }
+
+    // Staging memory for copies recorded on this queue, recycled by its fence.
+    [[nodiscard]]
+    UploadRing& GetUploadRing() { return *uploadRing_; }
+
+  private:
+    CommandContextPool* pool_ = nullptr;
+    Microsoft::WRL::ComPtr<ID3D12CommandQueue> queue_;
+    Microsoft::WRL::ComPtr<ID3D12Fence> fence_;
+    std::unique_ptr<D3D12FenceBackend> fenceBackend_;
+    std::unique_ptr<UploadRing> uploadRing_;
+
+    CommandContext* context_ = nullptr;  // open batch
+};
+
+// Batches uploads on a copy queue so they overlap with rendering and with loading the next
+// asset, and makes the graphics queue wait only for batches it actually reads from.
+//
+// Uploads are recorded on GetCommandList() and then committed, which returns a ticket for the
+// batch they landed in. A batch is submitted once it holds batchBytes, on Flush(), or when a
+// consumer needs it. Before executing a frame, the consumer Require()s the tickets of what it
+// draws and calls InsertWaits(): the graphics queue then waits on the GPU for the newest
+// required batch, and only if the copy queue has not already finished it. Fence values only
+// grow, so a resource costs a wait the first time it is used at most.
+//
+// Staging memory and other resources Retain()ed with a batch are released once it completes.
+// All calls come from one thread, and there is one consuming queue.
+class CopyUploader {
+  public:
+    // Batch an upload landed in; the default ticket needs no wait.
+    struct Ticket {
+        UINT64 fenceValue = 0;
+    };
+
+    struct Stats {
+        UINT64 uploads = 0;
+        UINT64 bytes = 0;
+        UINT64 batches = 0;
+        UINT64 gpuWaits = 0;
+        UINT64 skippedWaits = 0;  // batch had already completed
+    };
+
+    static constexpr UINT64 s_defaultBatchBytes = 32ull << 20;
+
+    explicit CopyUploader(CopyQueueBackend* backend, UINT64 batchBytes = s_defaultBatchBytes);
+
+    CopyUploader(const CopyUploader& other) = delete;
+    CopyUploader& operator=(const CopyUploader& other) = delete;
+
+    // Waits for every submitted batch.
+    ~CopyUploader();
+
+    // The open batch's list, opened on first use. Fetch it again for every upload; Commit() may
+    // have submitted the previous one.
+    [[nodiscard]]
+    ID3D12GraphicsCommandList* GetCommandList();
+
+    // Call after recording an upload of byteSize on GetCommandList().
+    Ticket Commit(UINT64 byteSize);
+
+    // Keeps resource alive until the open batch has executed.
+    void Retain(Microsoft::WRL::ComPtr<ID3D12Resource> resource);
+
+    // Submits the open batch, if any.
+    void Flush();
+
+    // The next submission on the consuming queue reads what ticket's batch uploaded.
+    void Require(Ticket ticket);
+
+    // Call before executing the consumer's lists on queue. Submits the open batch if it is
+    // required.
+    void InsertWaits(ID3D12CommandQueue* queue);
+
+    [[nodiscard]]
+    bool IsComplete(Ticket ticket);
+
+    // Releases what completed batches retained.
+    void Reclaim();
+
+    void WaitForIdle();
+
+    [[nodiscard]]
+    const Stats& GetStats() const { return stats_; }
+
+  private:
+    CopyQueueBackend* backend_ = nullptr;
+    UINT64 batchBytes_ = 0;
+
+    ID3D12GraphicsCommandList* commandList_ = nullptr;
+    bool open_ = false;
+    UINT64 openBytes_ = 0;
+    UINT64 openFenceValue_ = 0;
+    DeferredReleaseQueue retained_;  // on the copy fence
+
+    UINT64 lastSubmitted_ = 0;
+    UINT64 lastCompleted_ = 0;
+    UINT64 required_ = 0;
+    UINT64 waited_ = 0;
+
+    Stats stats_;
+};
@@ -26,32 +26,38 @@ void D3DApp::OnResize() {
 
     assert(device_);
     assert(swapChain_);
-    assert(commandAllocator_);
 
-    // Flush before changing any resources.
-    FlushCommandQueue();
-
-    ThrowIfFailed(commandList_->Reset(commandAllocator_.Get(), nullptr));
+    // DXGI resizes the back buffers only once no GPU work refers to them, so this waits for the
+    // frames in flight. The depth buffer and anything else replaced goes to deferredReleases_.
+    fenceBackend_->Wait(nextFenceValue_);
 
+    for (int i = 0; i < swapChain_->BufferCount(); ++i) {
+        stateTracker_.Unregister(swapChain_->GetBuffer(i));
+    }
     swapChain_->ResetAllBuffers();
 
     ThrowIfFailed(swapChain_->Resize(GetClientWidth(), GetClientHeight()));
 
     swapChain_->CreateRtvs(device_.Get());
+    for (int i = 0; i < swapChain_->BufferCount(); ++i) {
+        stateTracker_.Register(swapChain_->GetBuffer(i), D3D12_RESOURCE_STATE_PRESENT);
+    }
 
     CreateDepthStencilBuffer();
 
     CreateDepthStencilView();
 
-    ExecuteCommandList();
-
-    FlushCommandQueue();
-
     UpdateViewport();
 }
 
 void D3DApp::Initialize(const wchar_t* windowName) {
-    if (!InitializeWindow(windowName)) {
+    headless_.ParseCommandLine(GetCmdLine());
+    if (headless_.enabled) {
+        InitializeHeadless(headless_.width, headless_.height);
+        // Nothing is on screen to be late for; batch runs want frames as fast as they come.
+        swapChainSettings_.latencyMode = FrameLatencyMode::Throughput;
+        timingLog_ = std::make_unique<FrameTimingLog>(headless_.outputDir / L"timings.csv");
+    } else if (!InitializeWindow(windowName)) {
         throw std::runtime_error("Failed to initialize window");
     }
 
@@ -96,6 +102,9 @@ bool D3DApp::InitializeD3D() {
                                        D3D12_FENCE_FLAG_NONE,
                                        IID_PPV_ARGS(fence_.ReleaseAndGetAddressOf())));
 
+    fenceBackend_ = std::make_unique<D3D12FenceBackend>(fence_.Get());
+    deferredReleases_ = std::make_unique<DeferredReleaseQueue>(fenceBackend_.get());
+
     // 4x MSAA quality support
     D3D12_FEATURE_DATA_MULTISAMPLE_QUALITY_LEVELS qualityLevels{};
     qualityLevels.Format = backBufferFormat_;
@@ -136,9 +145,8 @@ void D3DApp::DefaultDraw() {
     ThrowIfFailed(commandAllocator_->Reset());
     ThrowIfFailed(commandList_->Reset(commandAllocator_.Get(), nullptr));
 
-    Transition(swapChain_->GetCurrentBackBuffer(),
-               D3D12_RESOURCE_STATE_PRESENT,
-               D3D12_RESOURCE_STATE_RENDER_TARGET);
+    Transition(swapChain_->GetCurrentBackBuffer(), D3D12_RESOURCE_STATE_RENDER_TARGET);
+    FlushBarriers();
 
     SetViewportAndScissorRects();
 
@@ -157,18 +165,60 @@ void D3DApp::DefaultDraw() {
     auto dsv = dsvHeap_->GetDescriptorHandleCpu(0);
     commandList_->OMSetRenderTargets(1, &rtv, true, &dsv);
 
-    Transition(swapChain_->GetCurrentBackBuffer(),
-               D3D12_RESOURCE_STATE_RENDER_TARGET,
-               D3D12_RESOURCE_STATE_PRESENT);
+    Transition(swapChain_->GetCurrentBackBuffer(), D3D12_RESOURCE_STATE_PRESENT);
+    FlushBarriers();
 
     ThrowIfFailed(commandList_->Close());
 
     ExecuteCommandList();
 
+    PresentFrame();
+
+    FlushCommandQueue();
+}
+
+void D3DApp::PresentFrame() {
+    if (timingLog_ && headless_.frameCount > 0 &&
+        timingLog_->GetFrameCount() >= headless_.frameCount) {
+        // Quit() has been called; frames still in the loop are neither captured nor logged.
+        deferredReleases_->Collect();
+        return;
+    }
+
     ThrowIfFailed(swapChain_->Present());
     swapChain_->SwapBuffers();
+    presentPacing_->OnPresent();
+    deferredReleases_->Collect();
+
+    if (timingLog_) {
+        timingLog_->Record(frameStartSeconds_, Timer::GetCurrentSeconds());
+        if (timingLog_->GetFrameCount() == headless_.frameCount) {
+            Quit();
+        }
+    }
 
-    FlushCommandQueue();
+    swapChain_->WaitForNextFrame();
+    presentPacing_->OnFrameReady();
+
+    double delay = presentPacing_->GetStartDelay();
+    if (delay > 0.0) {
+        double until = Timer::GetCurrentSeconds() + delay;
+
+        // Sleep() can overshoot by a whole scheduler tick, longer than most delays. The timer
+        // takes the bulk of it and yielding the last fraction of a millisecond absorbs its jitter.
+        if (pacingTimer_ && delay > 0.001) {
+            LARGE_INTEGER dueTime;
+            dueTime.QuadPart = -static_cast<LONGLONG>((delay - 0.0005) * 1e7);  // relative, 100 ns units
+            if (SetWaitableTimerEx(pacingTimer_.get(), &dueTime, 0, nullptr, nullptr, nullptr, 0)) {
+                WaitForSingleObject(pacingTimer_.get(), INFINITE);
+            }
+        }
+        while (Timer::GetCurrentSeconds() < until) {
+            SwitchToThread();
+        }
+    }
+    presentPacing_->OnFrameStart();
+    frameStartSeconds_ = Timer::GetCurrentSeconds();
 }
 
 void D3DApp::CreateCommandObjects() {
@@ -188,9 +238,43 @@ void D3DApp::CreateCommandObjects() {
                                              nullptr,
                                              IID_PPV_ARGS(commandList_.GetAddressOf())));
     ThrowIfFailed(commandList_->Close());
+
+    commandContextBackend_ = std::make_unique<D3D12CommandContextBackend>(device_.Get());
+    commandContextPool_ = std::make_unique<CommandContextPool>(commandContextBackend_.get(),
+                                                               fenceBackend_.get());
 }
 
 void D3DApp::CreateSwapChain() {
+    if (headless_.enabled) {
+        OffscreenTarget::Settings settings;
+        settings.bufferCount = swapChainSettings_.bufferCount;
+        settings.captureInterval = headless_.captureInterval;
+        settings.outputDir = headless_.outputDir;
+        swapChain_ = std::make_unique<OffscreenTarget>(device_.Get(),
+                                                       commandQueue_.Get(),
+                                                       backBufferFormat_,
+                                                       GetClientWidth(),
+                                                       GetClientHeight(),
+                                                       settings);
+    } else {
+        CreateWindowSwapChain();
+    }
+
+    presentPacing_ = std::make_unique<PresentPacingPolicy>(swapChainSettings_.latencyMode);
+    pacingTimer_.reset(CreateWaitableTimerExW(nullptr,
+                                              nullptr,
+                                              CREATE_WAITABLE_TIMER_HIGH_RESOLUTION,
+                                              TIMER_ALL_ACCESS));
+
+    // A waitable swap chain starts signalled once per queued frame it allows; the first frame
+    // waits like every later one.
+    swapChain_->WaitForNextFrame();
+    presentPacing_->OnFrameReady();
+    presentPacing_->OnFrameStart();
+    frameStartSeconds_ = Timer::GetCurrentSeconds();
+}
+
+void D3DApp::CreateWindowSwapChain() {
     DXGI_SWAP_CHAIN_DESC desc{};
     desc.BufferDesc.Width = GetClientWidth();
     desc.BufferDesc.Height = GetClientHeight();
@@ -204,17 +288,18 @@ void D3DApp::CreateSwapChain() {
     desc.SampleDesc.Quality = msaa4XEnabled_ ? (msaa4XQuality_ - 1) : 0;
 
     desc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
-    desc.BufferCount = swapChain_->BufferCount();
+    desc.BufferCount = swapChainSettings_.bufferCount;
 
     desc.OutputWindow = GetWindow();
     desc.Windowed = true;
     desc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
     desc.Flags = DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH;
 
-    swapChain_ = std::make_unique<SwapChain<2>>(device_.Get(),
-                                                dxgiFactory_.Get(),
-                                                commandQueue_.Get(),
-                                                desc);
+    swapChain_ = std::make_unique<SwapChain>(device_.Get(),
+                                             dxgiFactory_.Get(),
+                                             commandQueue_.Get(),
+                                             desc,
+                                             swapChainSettings_);
 }
 
 void D3DApp::CreateDsvHeaps() {
@@ -229,17 +314,34 @@ void D3DApp::CreateDsvHeaps() {
 
 void D3DApp::FlushCommandQueue() {
     ThrowIfFailed(commandQueue_->Signal(fence_.Get(), ++nextFenceValue_));
+    if (uploadRing_) {
+        uploadRing_->Submit(nextFenceValue_);
+    }
+
+    fenceBackend_->Wait(nextFenceValue_);
 
-    if (fence_->GetCompletedValue() < nextFenceValue_) {
-        auto eventHandle = CreateEventEx(nullptr, nullptr, false, EVENT_ALL_ACCESS);
-        ThrowIfFailed(fence_->SetEventOnCompletion(nextFenceValue_, eventHandle));
-        WaitForSingleObject(eventHandle, INFINITE);
-        CloseHandle(eventHandle);
+    if (uploadRing_) {
+        uploadRing_->Reclaim();
     }
+    deferredReleases_->Collect();
+}
+
+UploadRing& D3DApp::GetUploadRing() {
+    if (!uploadRing_) {
+        uploadRing_ = std::make_unique<UploadRing>(device_.Get(), fence_.Get(), uploadRingSize_);
+    }
+    return *uploadRing_;
+}
+
+void D3DApp::DeferRelease(ComPtr<IUnknown> object) {
+    deferredReleases_->Release(std::move(object), GetNextFenceValue());
 }
 
 void D3DApp::CreateDepthStencilBuffer() {
-    depthStencilBuffer_.Reset();
+    if (depthStencilBuffer_) {
+        stateTracker_.Unregister(depthStencilBuffer_.Get());
+        DeferRelease(std::move(depthStencilBuffer_));
+    }
 
     D3D12_RESOURCE_DESC desc{};
     desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
@@ -262,13 +364,15 @@ void D3DApp::CreateDepthStencilBuffer() {
 
     auto heapProp = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
 
+    // Created in the state it is used in, so that a resize records no barrier.
     ThrowIfFailed(device_->CreateCommittedResource(
         &heapProp,
         D3D12_HEAP_FLAG_NONE,
         &desc,
-        D3D12_RESOURCE_STATE_COMMON,
+        D3D12_RESOURCE_STATE_DEPTH_WRITE,
         &optClear,
         IID_PPV_ARGS(depthStencilBuffer_.ReleaseAndGetAddressOf())));
+    stateTracker_.Register(depthStencilBuffer_.Get(), D3D12_RESOURCE_STATE_DEPTH_WRITE);
 }
 
 void D3DApp::CreateDepthStencilView() {
@@ -281,19 +385,14 @@ void D3DApp::CreateDepthStencilView() {
     device_->CreateDepthStencilView(depthStencilBuffer_.Get(),
                                     &desc,
                                     dsvHeap_->GetDescriptorHandleCpu(0));
+}
 
-    Transition(depthStencilBuffer_.Get(),
-               D3D12_RESOURCE_STATE_COMMON,
-               D3D12_RESOURCE_STATE_DEPTH_WRITE);
-
-    ThrowIfFailed(commandList_->Close());
+void D3DApp::Transition(ID3D12Resource* resource, D3D12_RESOURCE_STATES to) {
+    stateTracker_.Transition(resource, to);
 }
 
-void D3DApp::Transition(ID3D12Resource* resource,
-                        D3D12_RESOURCE_STATES from,
-                        D3D12_RESOURCE_STATES to) {
-    auto transition = CD3DX12_RESOURCE_BARRIER::Transition(resource, from, to);
-    commandList_->ResourceBarrier(1, &transition);
+void D3DApp::FlushBarriers() {
+    stateTracker_.Flush(commandList_.Get());
 }
 
 void D3DApp::CalculateFrameStats() {
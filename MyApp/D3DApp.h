@@ -7,8 +7,17 @@
 
 #include "Common/d3dUtil.h"
 
+#include "CommandContextPool.h"
+#include "DeferredReleaseQueue.h"
 #include "DescriptorHeap.h"
+#include "FramePacer.h"
+#include "Headless.h"
+#include "OffscreenTarget.h"
+#include "PresentPacingPolicy.h"
+#include "PresentTarget.h"
+#include "ResourceStateTracker.h"
 #include "SwapChain.h"
+#include "UploadRing.h"
 
 // Link necessary d3d12 libraries.
 #pragma comment(lib, "d3dcompiler.lib")
@@ -44,17 +53,42 @@ class D3DApp : public MyApp {
 
     void CreateCommandObjects();
 
+    // The window's swap chain, or offscreen targets when headless.
     void CreateSwapChain();
 
+    void CreateWindowSwapChain();
+
     void CreateDsvHeaps();
 
     void FlushCommandQueue();
 
+    // The value the next Signal on fence_ will use. Work submitted before it completes by then.
+    [[nodiscard]]
+    UINT64 GetNextFenceValue() const { return nextFenceValue_ + 1; }
+
+    // Releases object once the GPU has finished everything submitted before the next Signal on
+    // fence_, without waiting for it here.
+    void DeferRelease(Microsoft::WRL::ComPtr<IUnknown> object);
+
+    // Staging memory for uploads recorded on commandList_, created on first use. Anything
+    // allocated from it must be followed by a Signal on fence_ and Submit() with the same value;
+    // FlushCommandQueue() does both.
+    UploadRing& GetUploadRing();
+
     void CreateDepthStencilBuffer();
 
     void CreateDepthStencilView();
 
-    void Transition(ID3D12Resource* resource, D3D12_RESOURCE_STATES from, D3D12_RESOURCE_STATES to);
+    // Queues a transition of a tracked resource on commandList_; see stateTracker_.
+    void Transition(ID3D12Resource* resource, D3D12_RESOURCE_STATES to);
+
+    // Records the queued transitions on commandList_. Call before the draws and copies using them.
+    void FlushBarriers();
+
+    // Presents the current back buffer, then returns once the next frame should start: after
+    // the swap chain can take it and, in low-latency mode, as late as presentPacing_ allows.
+    // Headless, it logs the frame's timing instead and quits after headless_.frameCount frames.
+    void PresentFrame();
 
     Microsoft::WRL::ComPtr<IDXGIFactory4> dxgiFactory_;
     Microsoft::WRL::ComPtr<ID3D12Device> device_;
@@ -63,17 +97,44 @@ class D3DApp : public MyApp {
     Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> commandList_;
     Microsoft::WRL::ComPtr<ID3D12CommandAllocator> commandAllocator_;
 
+    // Per-frame command lists. commandList_ above stays for initialization and resizing.
+    std::unique_ptr<D3D12CommandContextBackend> commandContextBackend_;
+    std::unique_ptr<CommandContextPool> commandContextPool_;
+
     DXGI_FORMAT backBufferFormat_ = DXGI_FORMAT_R8G8B8A8_UNORM;
-    std::unique_ptr<SwapChain<2>> swapChain_;
+    // Buffer count and latency mode; takes effect in InitializeD3D().
+    SwapChain::Settings swapChainSettings_;
+    // The window's swap chain, or offscreen buffers when headless.
+    std::unique_ptr<PresentTarget> swapChain_;
+    std::unique_ptr<PresentPacingPolicy> presentPacing_;
+    // High-resolution timer for the start delays; null where unsupported, which falls back to yielding.
+    std::unique_ptr<void, decltype(&CloseHandle)> pacingTimer_{nullptr, &CloseHandle};
 
     Microsoft::WRL::ComPtr<ID3D12Resource> depthStencilBuffer_;
     DXGI_FORMAT depthStencilFormat_ = DXGI_FORMAT_D24_UNORM_S8_UINT;
     std::unique_ptr<DescriptorHeap> dsvHeap_;
 
+    // States of the back buffers, the depth buffer and any resource an app registers, as of the
+    // last list recorded for commandQueue_.
+    ResourceStateTracker stateTracker_;
+
     bool isPaused_ = false;
 
+    // Parsed from the command line in Initialize(), which creates a window only if not enabled.
+    HeadlessSettings headless_;
+    std::unique_ptr<FrameTimingLog> timingLog_;  // headless only
+    double frameStartSeconds_ = 0.0;
+
     UINT64 nextFenceValue_ = 0;
     Microsoft::WRL::ComPtr<ID3D12Fence> fence_;
+    std::unique_ptr<D3D12FenceBackend> fenceBackend_;  // cached event for CPU waits on fence_
+
+    // Collected each frame and on every flush.
+    std::unique_ptr<DeferredReleaseQueue> deferredReleases_;
+
+    // Null until GetUploadRing(); apps that upload through their own queue never pay for it.
+    UINT64 uploadRingSize_ = 4 * 1024 * 1024;
+    std::unique_ptr<UploadRing> uploadRing_;
 
     UINT msaa4XQuality_ = {};
     bool msaa4XEnabled_ = false;
@@ -0,0 +1,217 @@
+#include "DefaultHeapAllocator.h"
+
+using Microsoft::WRL::ComPtr;
+
+namespace {
+
+UINT64 NextPowerOfTwo(UINT64 value) {
+    UINT64 p = 1;
+    while (p < value) {
+        p <<= 1;
+    }
+    return p;
+}
+
+}  // namespace
+
+BuddyAllocator::BuddyAllocator(UINT64 size, UINT64 minBlockSize)
+    : size_(size),
+      minBlockSize_(minBlockSize) {
+    assert(size_ >= minBlockSize_);
+    assert((size_ & (size_ - 1)) == 0 && (minBlockSize_ & (minBlockSize_ - 1)) == 0);
+
+    freeLists_.resize(Order(size_) + 1);
+    freeLists_.back().insert(0);
+}
+
+UINT64 BuddyAllocator::Allocate(UINT64 size, UINT64 alignment) {
+    // A range is aligned to its own size, so a larger alignment just asks for a larger range.
+    UINT order = Order(std::max(size, alignment));
+    if (order >= freeLists_.size()) {
+        return s_invalidOffset;
+    }
+
+    UINT found = order;
+    while (found < freeLists_.size() && freeLists_[found].empty()) {
+        ++found;
+    }
+    if (found == freeLists_.size()) {
+        return s_invalidOffset;
+    }
+
+    // Lowest offset first keeps the allocations packed towards the start of the block.
+    UINT64 offset = *freeLists_[found].begin();
+    freeLists_[found].erase(freeLists_[found].begin());
+
+    // Split down to the requested order, freeing the upper halves.
+    while (found > order) {
+        --found;
+        freeLists_[found].insert(offset + (minBlockSize_ << found));
+    }
+
+    allocated_[offset] = order;
+    bytesAllocated_ += minBlockSize_ << order;
+    return offset;
+}
+
+void BuddyAllocator::Free(UINT64 offset) {
+    auto it = allocated_.find(offset);
+    assert(it != allocated_.end() && "Offset was not allocated.");
+    UINT order = it->second;
+    allocated_.erase(it);
+    bytesAllocated_ -= minBlockSize_ << order;
+
+    while (order + 1 < freeLists_.size()) {
+        UINT64 buddy = offset ^ (minBlockSize_ << order);
+        auto& freeList = freeLists_[order];
+        auto buddyIt = freeList.find(buddy);
+        if (buddyIt == freeList.end()) {
+            break;
+        }
+        freeList.erase(buddyIt);
+        offset = std::min(offset, buddy);
+        ++order;
+    }
+    freeLists_[order].insert(offset);
+}
+
+UINT64 BuddyAllocator::RoundedSize(UINT64 size) const {
+    return minBlockSize_ << Order(size);
+}
+
+UINT64 BuddyAllocator::GetLargestFreeRange() const {
+    for (size_t order = freeLists_.size(); order-- > 0;) {
+        if (!freeLists_[order].empty()) {
+            return minBlockSize_ << order;
+        }
+    }
+    return 0;
+}
+
+UINT BuddyAllocator::Order(UINT64 size) const {
+    UINT order = 0;
+    while ((minBlockSize_ << order) < size) {
+        ++order;
+    }
+    return order;
+}
+
+DefaultHeapBackend::Block D3D12DefaultHeapBackend::CreateBlock(UINT64 size) {
+    Entry entry;
+
+    D3D12_HEAP_DESC heapDesc{};
+    heapDesc.SizeInBytes = size;
+    heapDesc.Properties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+    heapDesc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+    heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
+    ThrowIfFailed(device_->CreateHeap(&heapDesc, IID_PPV_ARGS(&entry.heap)));
+
+    auto desc = CD3DX12_RESOURCE_DESC::Buffer(size);
+    ThrowIfFailed(device_->CreatePlacedResource(entry.heap.Get(),
+                                                0,
+                                                &desc,
+                                                D3D12_RESOURCE_STATE_COMMON,
+                                                nullptr,
+                                                IID_PPV_ARGS(&entry.buffer)));
+
+    Block block;
+    block.resource = entry.buffer.Get();
+    block.gpu = entry.buffer->GetGPUVirtualAddress();
+    block.size = size;
+
+    entries_.push_back(std::move(entry));
+    return block;
+}
+
+void D3D12DefaultHeapBackend::ReleaseBlock(const Block& block) {
+    auto it = std::find_if(entries_.begin(), entries_.end(), [&](const Entry& entry) {
+        return entry.buffer.Get() == block.resource;
+    });
+    if (it != entries_.end()) {
+        entries_.erase(it);
+    }
+}
+
+DefaultHeapAllocator::DefaultHeapAllocator(DefaultHeapBackend* backend, UINT64 blockSize)
+    : backend_(backend),
+      blockSize_(blockSize) {
+    assert((blockSize_ & (blockSize_ - 1)) == 0);
+    assert(blockSize_ % D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT == 0);
+}
+
+DefaultHeapAllocator::~DefaultHeapAllocator() {
+    for (const auto& block : blocks_) {
+        backend_->ReleaseBlock(block.memory);
+    }
+}
+
+DefaultHeapAllocator::Allocation DefaultHeapAllocator::Allocate(UINT64 size, UINT64 alignment) {
+    UINT64 offset = BuddyAllocator::s_invalidOffset;
+    size_t index = 0;
+    for (; index < blocks_.size(); ++index) {
+        offset = blocks_[index].ranges.Allocate(size, alignment);
+        if (offset != BuddyAllocator::s_invalidOffset) {
+            break;
+        }
+    }
+
+    if (offset == BuddyAllocator::s_invalidOffset) {
+        UINT64 blockSize = std::max(blockSize_, NextPowerOfTwo(std::max(size, alignment)));
+        blocks_.push_back({backend_->CreateBlock(blockSize), BuddyAllocator(blockSize, s_minBlockSize)});
+        index = blocks_.size() - 1;
+        offset = blocks_[index].ranges.Allocate(size, alignment);
+    }
+
+    const auto& memory = blocks_[index].memory;
+    Allocation allocation;
+    allocation.resource = memory.resource;
+    allocation.offset = offset;
+    allocation.gpu = memory.gpu + offset;
+    allocation.size = size;
+    allocation.block = index;
+
+    bytesRequested_ += size;
+    return allocation;
+}
+
+void DefaultHeapAllocator::Free(const Allocation& allocation) {
+    assert(allocation.block < blocks_.size());
+    openFrees_.push_back(allocation);
+}
+
+void DefaultHeapAllocator::EndFrame(UINT64 fenceValue) {
+    assert((pendingFrees_.empty() || fenceValue >= pendingFrees_.back().fenceValue) &&
+           "Fence values must not decrease.");
+    for (const auto& allocation : openFrees_) {
+        pendingFrees_.push_back({fenceValue, allocation});
+    }
+    openFrees_.clear();
+}
+
+void DefaultHeapAllocator::Reclaim(UINT64 completedFenceValue) {
+    while (!pendingFrees_.empty() && pendingFrees_.front().fenceValue <= completedFenceValue) {
+        Release(pendingFrees_.front().allocation);
+        pendingFrees_.pop_front();
+    }
+}
+
+void DefaultHeapAllocator::Release(const Allocation& allocation) {
+    blocks_[allocation.block].ranges.Free(allocation.offset);
+    bytesRequested_ -= allocation.size;
+}
+
+DefaultHeapAllocator::Stats DefaultHeapAllocator::GetStats() const {
+    Stats stats;
+    stats.blockCount = blocks_.size();
+    stats.bytesRequested = bytesRequested_;
+    stats.pendingFreeCount = openFrees_.size() + pendingFrees_.size();
+    for (const auto& block : blocks_) {
+        stats.allocationCount += block.ranges.GetAllocationCount();
+        stats.bytesReserved += block.ranges.GetSize();
+        stats.bytesAllocated += block.ranges.GetBytesAllocated();
+        UINT64 largest = block.ranges.GetLargestFreeRange();
+        stats.largestFreeRange = std::max(stats.largestFreeRange, largest);
+        stats.blockFreeRanges += largest;
+    }
+    return stats;
+}
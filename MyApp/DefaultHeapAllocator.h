@@ -0,0 +1,186 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "Common/d3dUtil.h"
+
+// Binary buddy allocator over the offsets [0, size). Pure bookkeeping; it never touches memory.
+//
+// Every range is a power-of-two multiple of minBlockSize and is aligned to its own size, so any
+// alignment up to the rounded request size comes for free. Freed ranges merge with their buddy
+// as soon as both halves are free.
+class BuddyAllocator {
+  public:
+    static constexpr UINT64 s_invalidOffset = ~0ull;
+
+    // size and minBlockSize must be powers of two, size >= minBlockSize.
+    BuddyAllocator(UINT64 size, UINT64 minBlockSize);
+
+    // Returns s_invalidOffset when no free range is large enough.
+    [[nodiscard]]
+    UINT64 Allocate(UINT64 size, UINT64 alignment = 1);
+
+    void Free(UINT64 offset);
+
+    // Bytes a request of the given size would actually occupy.
+    [[nodiscard]]
+    UINT64 RoundedSize(UINT64 size) const;
+
+    [[nodiscard]]
+    UINT64 GetSize() const { return size_; }
+
+    [[nodiscard]]
+    UINT64 GetBytesAllocated() const { return bytesAllocated_; }
+
+    [[nodiscard]]
+    UINT64 GetLargestFreeRange() const;
+
+    [[nodiscard]]
+    size_t GetAllocationCount() const { return allocated_.size(); }
+
+  private:
+    [[nodiscard]]
+    UINT Order(UINT64 size) const;
+
+    UINT64 size_ = 0;
+    UINT64 minBlockSize_ = 0;
+
+    std::vector<std::set<UINT64>> freeLists_;  // free range offsets, by order
+    std::unordered_map<UINT64, UINT> allocated_;  // offset -> order
+    UINT64 bytesAllocated_ = 0;
+};
+
+// Source of default-heap memory for buffers, handed out in large blocks. The D3D12 backend creates
+// an ID3D12Heap and one placed buffer spanning it; tests can substitute fake blocks.
+class DefaultHeapBackend {
+  public:
+    struct Block {
+        ID3D12Resource* resource = nullptr;
+        D3D12_GPU_VIRTUAL_ADDRESS gpu = 0;
+        UINT64 size = 0;
+    };
+
+    virtual ~DefaultHeapBackend() = default;
+
+    virtual Block CreateBlock(UINT64 size) = 0;
+    virtual void ReleaseBlock(const Block& block) = 0;
+};
+
+class D3D12DefaultHeapBackend final : public DefaultHeapBackend {
+  public:
+    explicit D3D12DefaultHeapBackend(ID3D12Device* device) : device_(device) {}
+
+    Block CreateBlock(UINT64 size) override;
+    void ReleaseBlock(const Block& block) override;
+
+  private:
+    struct Entry {
+        Microsoft::WRL::ComPtr<ID3D12Heap> heap;
+        Microsoft::WRL::ComPtr<ID3D12Resource> buffer;
+    };
+
+    Microsoft::WRL::ComPtr<ID3D12Device> device_;
+    std::vector<Entry> entries_;
+};
+
+// Suballocates static buffers (vertex, index, ...) from shared default-heap blocks.
+//
+// A placed or committed buffer is aligned to 64 KB, so a mesh of a few KB used to waste most of
+// a page. Here each block is one buffer covering a whole heap and allocations are ranges of it,
+// managed by a BuddyAllocator. Requests larger than the block size get a block of their own.
+// Blocks are kept until the allocator is destroyed.
+//
+// Free() does not hand a range out again straight away, since draws already submitted may still
+// read it. Ranges freed since the last EndFrame() are stamped with that frame's fence value and
+// come back once Reclaim() sees the fence complete.
+//
+// The shared buffers stay in D3D12_RESOURCE_STATE_COMMON: copies into them and reads from them
+// rely on implicit promotion, so an upload must be executed before a later command list draws
+// from the range.
+class DefaultHeapAllocator {
+  public:
+    struct Allocation {
+        ID3D12Resource* resource = nullptr;
+        UINT64 offset = 0;
+        D3D12_GPU_VIRTUAL_ADDRESS gpu = 0;
+        UINT64 size = 0;
+        size_t block = 0;
+
+        explicit operator bool() const { return resource != nullptr || gpu != 0; }
+    };
+
+    struct Stats {
+        size_t blockCount = 0;
+        size_t allocationCount = 0;
+        UINT64 bytesReserved = 0;   // total block size
+        UINT64 bytesRequested = 0;  // sum of requested sizes
+        UINT64 bytesAllocated = 0;  // after buddy rounding
+        UINT64 largestFreeRange = 0;
+        UINT64 blockFreeRanges = 0;  // sum of each block's largest free range
+        size_t pendingFreeCount = 0;  // freed, waiting for the GPU
+
+        // Share of the reserved bytes in use.
+        [[nodiscard]]
+        double Occupancy() const {
+            return bytesReserved ? static_cast<double>(bytesAllocated) / bytesReserved : 0.0;
+        }
+
+        // 0 when the free space of each block is one range; approaches 1 as it splinters. An
+        // allocation never spans blocks, so free space spread over several is not counted.
+        [[nodiscard]]
+        double Fragmentation() const {
+            UINT64 free = bytesReserved - bytesAllocated;
+            return free ? 1.0 - static_cast<double>(blockFreeRanges) / free : 0.0;
+        }
+    };
+
+    static constexpr UINT64 s_minBlockSize = 256;
+
+    // blockSize must be a power of two and a multiple of 64 KB.
+    DefaultHeapAllocator(DefaultHeapBackend* backend, UINT64 blockSize);
+
+    DefaultHeapAllocator(const DefaultHeapAllocator& other) = delete;
+    DefaultHeapAllocator& operator=(const DefaultHeapAllocator& other) = delete;
+
+    ~DefaultHeapAllocator();
+
+    [[nodiscard]]
+    Allocation Allocate(UINT64 size, UINT64 alignment = s_minBlockSize);
+
+    // The range is reused once the fence value of the current frame has completed.
+    void Free(const Allocation& allocation);
+
+    // Call right after the queue has been asked to signal fenceValue for this frame.
+    void EndFrame(UINT64 fenceValue);
+
+    void Reclaim(UINT64 completedFenceValue);
+
+    [[nodiscard]]
+    Stats GetStats() const;
+
+  private:
+    struct Block {
+        DefaultHeapBackend::Block memory;
+        BuddyAllocator ranges;
+    };
+
+    struct PendingFree {
+        UINT64 fenceValue = 0;
+        Allocation allocation;
+    };
+
+    void Release(const Allocation& allocation);
+
+    DefaultHeapBackend* backend_ = nullptr;
+    UINT64 blockSize_ = 0;
+
+    std::vector<Block> blocks_;
+    UINT64 bytesRequested_ = 0;
+
+    std::vector<Allocation> openFrees_;  // freed since the last EndFrame()
+    std::deque<PendingFree> pendingFrees_;  // oldest first
+};
@@ -1,5 +1,8 @@
 #include "DefaultHeapBuffers.h"
 
+std::array<DefaultBuffer::ShadowAccount, static_cast<size_t>(CpuShadowPolicy::Count)>
+    DefaultBuffer::s_shadowAccounts;
+
 DefaultBuffer::DefaultBuffer(ID3D12Device* device,
                              ID3D12GraphicsCommandList* commandList,
                              const void* initData,
@@ -7,28 +10,179 @@ DefaultBuffer::DefaultBuffer(ID3D12Device* device,
     Load(device, commandList, initData, byteSize);
 }
 
+DefaultBuffer::~DefaultBuffer() {
+    ReleaseCpuShadow();
+    ReleaseGpuBuffer();
+}
+
 void DefaultBuffer::Load(ID3D12Device* device,
                          ID3D12GraphicsCommandList* commandList,
                          const void* data,
-                         unsigned int byteSize) {
-    ThrowIfFailed(D3DCreateBlob(byteSize, bufferCpu_.ReleaseAndGetAddressOf()));
-    CopyMemory(bufferCpu_->GetBufferPointer(), data, byteSize);
+                         unsigned int byteSize,
+                         const CpuShadow& shadow) {
+    StoreCpuShadow(data, byteSize, shadow);
+    ReleaseGpuBuffer();
     bufferGpu_ = d3dUtil::CreateDefaultBuffer(device, commandList, data, byteSize, uploadBuffer_);
 }
 
+void DefaultBuffer::Load(ID3D12Device* device,
+                         ID3D12GraphicsCommandList* commandList,
+                         UploadRing& uploadRing,
+                         const void* data,
+                         unsigned int byteSize,
+                         const CpuShadow& shadow) {
+    StoreCpuShadow(data, byteSize, shadow);
+    ReleaseGpuBuffer();
+    uploadBuffer_ = nullptr;
+
+    auto heapProp = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+    auto desc = CD3DX12_RESOURCE_DESC::Buffer(byteSize);
+    ThrowIfFailed(device->CreateCommittedResource(&heapProp,
+                                                  D3D12_HEAP_FLAG_NONE,
+                                                  &desc,
+                                                  D3D12_RESOURCE_STATE_COMMON,
+                                                  nullptr,
+                                                  IID_PPV_ARGS(bufferGpu_.ReleaseAndGetAddressOf())));
+
+    auto staging = uploadRing.Allocate(byteSize);
+    MappedWriter(staging.cpu, byteSize).Write(data, byteSize);
+
+    auto transition = CD3DX12_RESOURCE_BARRIER::Transition(bufferGpu_.Get(),
+                                                           D3D12_RESOURCE_STATE_COMMON,
+                                                           D3D12_RESOURCE_STATE_COPY_DEST);
+    commandList->ResourceBarrier(1, &transition);
+
+    commandList->CopyBufferRegion(bufferGpu_.Get(), 0, staging.resource, staging.offset, byteSize);
+
+    transition = CD3DX12_RESOURCE_BARRIER::Transition(bufferGpu_.Get(),
+                                                      D3D12_RESOURCE_STATE_COPY_DEST,
+                                                      D3D12_RESOURCE_STATE_GENERIC_READ);
+    commandList->ResourceBarrier(1, &transition);
+}
+
+void DefaultBuffer::Load(ID3D12GraphicsCommandList* commandList,
+                         UploadRing& uploadRing,
+                         DefaultHeapAllocator& heapAllocator,
+                         const void* data,
+                         unsigned int byteSize,
+                         const CpuShadow& shadow) {
+    StoreCpuShadow(data, byteSize, shadow);
+    ReleaseGpuBuffer();
+    uploadBuffer_ = nullptr;
+
+    allocation_ = heapAllocator.Allocate(byteSize);
+    heapAllocator_ = &heapAllocator;
+
+    auto staging = uploadRing.Allocate(byteSize);
+    MappedWriter(staging.cpu, byteSize).Write(data, byteSize);
+
+    // The shared block stays in COMMON; the copy promotes it to COPY_DEST and it decays back
+    // once the command list has executed, so no barriers that would affect other ranges.
+    commandList->CopyBufferRegion(allocation_.resource,
+                                  allocation_.offset,
+                                  staging.resource,
+                                  staging.offset,
+                                  byteSize);
+}
+
 D3D12_GPU_VIRTUAL_ADDRESS DefaultBuffer::GetGpuVirtualAddress() const {
+    if (allocation_) {
+        return allocation_.gpu;
+    }
     return bufferGpu_->GetGPUVirtualAddress();
 }
 
-void DefaultBuffer::ResetUploader() {
-    uploadBuffer_ = nullptr;
+void DefaultBuffer::ResetUploader(DeferredReleaseQueue& releases, UINT64 fenceValue) {
+    releases.Release(std::move(uploadBuffer_), fenceValue);
+}
+
+UINT64 DefaultBuffer::GetCpuShadowBytes(CpuShadowPolicy policy) {
+    return s_shadowAccounts[static_cast<size_t>(policy)].bytes;
+}
+
+size_t DefaultBuffer::GetCpuShadowCount(CpuShadowPolicy policy) {
+    return s_shadowAccounts[static_cast<size_t>(policy)].count;
+}
+
+void DefaultBuffer::StoreCpuShadow(const void* data, unsigned int byteSize, const CpuShadow& shadow) {
+    ReleaseCpuShadow();
+    shadowPolicy_ = shadow.policy;
+
+    switch (shadow.policy) {
+        case CpuShadowPolicy::Full:
+            ThrowIfFailed(D3DCreateBlob(byteSize, bufferCpu_.ReleaseAndGetAddressOf()));
+            CopyMemory(bufferCpu_->GetBufferPointer(), data, byteSize);
+            break;
+        case CpuShadowPolicy::Compact: {
+            assert(shadow.stride > 0 && shadow.elementOffset + shadow.elementSize <= shadow.stride);
+            const auto* src = static_cast<const BYTE*>(data);
+            UINT count = byteSize / shadow.stride;
+            ThrowIfFailed(D3DCreateBlob(count * shadow.elementSize, bufferCpu_.ReleaseAndGetAddressOf()));
+            auto* dst = static_cast<BYTE*>(bufferCpu_->GetBufferPointer());
+            for (UINT i = 0; i < count; ++i) {
+                CopyMemory(dst + i * shadow.elementSize,
+                           src + i * shadow.stride + shadow.elementOffset,
+                           shadow.elementSize);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+
+    auto& account = s_shadowAccounts[static_cast<size_t>(shadowPolicy_)];
+    account.bytes += GetCpuShadowSize();
+    ++account.count;
+    shadowAccounted_ = true;
+}
+
+void DefaultBuffer::ReleaseCpuShadow() {
+    if (!shadowAccounted_) {
+        return;
+    }
+
+    auto& account = s_shadowAccounts[static_cast<size_t>(shadowPolicy_)];
+    account.bytes -= GetCpuShadowSize();
+    --account.count;
+
+    bufferCpu_ = nullptr;
+    shadowPolicy_ = CpuShadowPolicy::None;
+    shadowAccounted_ = false;
+}
+
+void DefaultBuffer::ReleaseGpuBuffer() {
+    bufferGpu_ = nullptr;
+    if (heapAllocator_) {
+        heapAllocator_->Free(allocation_);
+        heapAllocator_ = nullptr;
+        allocation_ = {};
+    }
+}
+
+void VertexBuffer::Load(ID3D12Device* device,
+                        ID3D12GraphicsCommandList* commandList,
+                        const void* data,
+                        unsigned int byteSize,
+                        const CpuShadow& shadow) {
+    vbuffer_.Load(device, commandList, data, byteSize, shadow);
 }
 
 void VertexBuffer::Load(ID3D12Device* device,
                         ID3D12GraphicsCommandList* commandList,
+                        UploadRing& uploadRing,
                         const void* data,
-                        unsigned int byteSize) {
-    vbuffer_.Load(device, commandList, data, byteSize);
+                        unsigned int byteSize,
+                        const CpuShadow& shadow) {
+    vbuffer_.Load(device, commandList, uploadRing, data, byteSize, shadow);
+}
+
+void VertexBuffer::Load(ID3D12GraphicsCommandList* commandList,
+                        UploadRing& uploadRing,
+                        DefaultHeapAllocator& heapAllocator,
+                        const void* data,
+                        unsigned int byteSize,
+                        const CpuShadow& shadow) {
+    vbuffer_.Load(commandList, uploadRing, heapAllocator, data, byteSize, shadow);
 }
 
 D3D12_VERTEX_BUFFER_VIEW VertexBuffer::GetView() const {
@@ -42,8 +196,27 @@ D3D12_VERTEX_BUFFER_VIEW VertexBuffer::GetView() const {
 void IndexBuffer::Load(ID3D12Device* device,
                        ID3D12GraphicsCommandList* commandList,
                        const void* data,
-                       unsigned int byteSize) {
-    ibuffer_.Load(device, commandList, data, byteSize);
+                       unsigned int byteSize,
+                       const CpuShadow& shadow) {
+    ibuffer_.Load(device, commandList, data, byteSize, shadow);
+}
+
+void IndexBuffer::Load(ID3D12Device* device,
+                       ID3D12GraphicsCommandList* commandList,
+                       UploadRing& uploadRing,
+                       const void* data,
+                       unsigned int byteSize,
+                       const CpuShadow& shadow) {
+    ibuffer_.Load(device, commandList, uploadRing, data, byteSize, shadow);
+}
+
+void IndexBuffer::Load(ID3D12GraphicsCommandList* commandList,
+                       UploadRing& uploadRing,
+                       DefaultHeapAllocator& heapAllocator,
+                       const void* data,
+                       unsigned int byteSize,
+                       const CpuShadow& shadow) {
+    ibuffer_.Load(commandList, uploadRing, heapAllocator, data, byteSize, shadow);
 }
 
 D3D12_INDEX_BUFFER_VIEW IndexBuffer::GetView() const {
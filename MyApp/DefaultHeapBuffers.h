@@ -1,6 +1,30 @@
 #pragma once
 
+#include <array>
+
 #include "D3DApp.h"
+#include "DefaultHeapAllocator.h"
+#include "DeferredReleaseQueue.h"
+#include "MappedWriter.h"
+
+enum class CpuShadowPolicy { None, Full, Compact, Count };
+
+// Which bytes of a buffer stay readable on the CPU after Load. Nothing is kept by default.
+struct CpuShadow {
+    CpuShadowPolicy policy = CpuShadowPolicy::None;
+
+    // Compact only: keep elementSize bytes at elementOffset of every stride bytes, e.g. just the
+    // vertex positions for picking or collision.
+    UINT stride = 0;
+    UINT elementOffset = 0;
+    UINT elementSize = 0;
+
+    static CpuShadow Full() { return {CpuShadowPolicy::Full}; }
+
+    static CpuShadow Compact(UINT stride, UINT elementOffset, UINT elementSize) {
+        return {CpuShadowPolicy::Compact, stride, elementOffset, elementSize};
+    }
+};
 
 class DefaultBuffer {
   public:
@@ -10,20 +34,79 @@ class DefaultBuffer {
                   const void* initData,
                   unsigned int byteSize);
 
+    DefaultBuffer(const DefaultBuffer& other) = delete;
+    DefaultBuffer& operator=(const DefaultBuffer& other) = delete;
+
+    ~DefaultBuffer();
+
     void Load(ID3D12Device* device,
               ID3D12GraphicsCommandList* commandList,
               const void* data,
-              unsigned int byteSize);
+              unsigned int byteSize,
+              const CpuShadow& shadow = {});
+
+    // Stages the data in the shared upload ring, which reclaims the space once the copy has
+    // executed. There is no uploader to reset afterwards.
+    void Load(ID3D12Device* device,
+              ID3D12GraphicsCommandList* commandList,
+              UploadRing& uploadRing,
+              const void* data,
+              unsigned int byteSize,
+              const CpuShadow& shadow = {});
+
+    // Places the buffer in a range of a shared default-heap block instead of a resource of its
+    // own. The range is freed on destruction or the next Load, and heapAllocator hands it out
+    // again only once the frame that freed it has completed on the GPU.
+    void Load(ID3D12GraphicsCommandList* commandList,
+              UploadRing& uploadRing,
+              DefaultHeapAllocator& heapAllocator,
+              const void* data,
+              unsigned int byteSize,
+              const CpuShadow& shadow = {});
 
     [[nodiscard]]
     D3D12_GPU_VIRTUAL_ADDRESS GetGpuVirtualAddress() const;
 
-    void ResetUploader();
+    // Null under CpuShadowPolicy::None.
+    [[nodiscard]]
+    const void* GetCpuShadow() const { return bufferCpu_ ? bufferCpu_->GetBufferPointer() : nullptr; }
+
+    [[nodiscard]]
+    size_t GetCpuShadowSize() const { return bufferCpu_ ? bufferCpu_->GetBufferSize() : 0; }
+
+    [[nodiscard]]
+    CpuShadowPolicy GetCpuShadowPolicy() const { return shadowPolicy_; }
+
+    // System memory held by the CPU shadows of all live buffers with the given policy.
+    [[nodiscard]]
+    static UINT64 GetCpuShadowBytes(CpuShadowPolicy policy);
+
+    [[nodiscard]]
+    static size_t GetCpuShadowCount(CpuShadowPolicy policy);
+
+    // Hands the staging buffer of the device-only Load() to releases, to be dropped once the
+    // upload has executed by fenceValue.
+    void ResetUploader(DeferredReleaseQueue& releases, UINT64 fenceValue);
 
   private:
+    void StoreCpuShadow(const void* data, unsigned int byteSize, const CpuShadow& shadow);
+    void ReleaseCpuShadow();
+    void ReleaseGpuBuffer();
+
+    struct ShadowAccount {
+        UINT64 bytes = 0;
+        size_t count = 0;
+    };
+    static std::array<ShadowAccount, static_cast<size_t>(CpuShadowPolicy::Count)> s_shadowAccounts;
+
     Microsoft::WRL::ComPtr<ID3DBlob> bufferCpu_;
+    CpuShadowPolicy shadowPolicy_ = CpuShadowPolicy::None;
+    bool shadowAccounted_ = false;  // counted in s_shadowAccounts
     Microsoft::WRL::ComPtr<ID3D12Resource> bufferGpu_;
     Microsoft::WRL::ComPtr<ID3D12Resource> uploadBuffer_;
+
+    DefaultHeapAllocator* heapAllocator_ = nullptr;
+    DefaultHeapAllocator::Allocation allocation_;
 };
 
 class VertexBuffer {
@@ -33,11 +116,36 @@ class VertexBuffer {
     void Load(ID3D12Device* device,
               ID3D12GraphicsCommandList* commandList,
               const void* data,
-              unsigned int byteSize);
+              unsigned int byteSize,
+              const CpuShadow& shadow = {});
+
+    void Load(ID3D12Device* device,
+              ID3D12GraphicsCommandList* commandList,
+              UploadRing& uploadRing,
+              const void* data,
+              unsigned int byteSize,
+              const CpuShadow& shadow = {});
+
+    void Load(ID3D12GraphicsCommandList* commandList,
+              UploadRing& uploadRing,
+              DefaultHeapAllocator& heapAllocator,
+              const void* data,
+              unsigned int byteSize,
+              const CpuShadow& shadow = {});
 
     [[nodiscard]]
     D3D12_VERTEX_BUFFER_VIEW GetView() const;
 
+    void ResetUploader(DeferredReleaseQueue& releases, UINT64 fenceValue) {
+        vbuffer_.ResetUploader(releases, fenceValue);
+    }
+
+    [[nodiscard]]
+    const void* GetCpuShadow() const { return vbuffer_.GetCpuShadow(); }
+
+    [[nodiscard]]
+    size_t GetCpuShadowSize() const { return vbuffer_.GetCpuShadowSize(); }
+
   private:
     DefaultBuffer vbuffer_;
 
@@ -54,11 +162,36 @@ class IndexBuffer {
     void Load(ID3D12Device* device,
               ID3D12GraphicsCommandList* commandList,
               const void* data,
-              unsigned int byteSize);
+              unsigned int byteSize,
+              const CpuShadow& shadow = {});
+
+    void Load(ID3D12Device* device,
+              ID3D12GraphicsCommandList* commandList,
+              UploadRing& uploadRing,
+              const void* data,
+              unsigned int byteSize,
+              const CpuShadow& shadow = {});
+
+    void Load(ID3D12GraphicsCommandList* commandList,
+              UploadRing& uploadRing,
+              DefaultHeapAllocator& heapAllocator,
+              const void* data,
+              unsigned int byteSize,
+              const CpuShadow& shadow = {});
 
     [[nodiscard]]
     D3D12_INDEX_BUFFER_VIEW GetView() const;
 
+    void ResetUploader(DeferredReleaseQueue& releases, UINT64 fenceValue) {
+        ibuffer_.ResetUploader(releases, fenceValue);
+    }
+
+    [[nodiscard]]
+    const void* GetCpuShadow() const { return ibuffer_.GetCpuShadow(); }
+
+    [[nodiscard]]
+    size_t GetCpuShadowSize() const { return ibuffer_.GetCpuShadowSize(); }
+
   private:
     DefaultBuffer ibuffer_;
 
@@ -0,0 +1,42 @@
+#include "DeferredReleaseQueue.h"
+
+void DeferredReleaseQueue::Release(Microsoft::WRL::ComPtr<IUnknown> object, UINT64 fenceValue) {
+    if (!object) {
+        return;
+    }
+    assert((pending_.empty() || fenceValue >= pending_.back().fenceValue) &&
+           "Fence values must not decrease.");
+
+    ++stats_.deferred;
+
+    // Known to be complete already; nothing to wait for.
+    if (fenceValue <= lastCompleted_) {
+        ++stats_.released;
+        return;
+    }
+    pending_.push_back({fenceValue, std::move(object)});
+}
+
+void DeferredReleaseQueue::Collect() {
+    if (pending_.empty()) {
+        return;
+    }
+
+    if (pending_.front().fenceValue > lastCompleted_) {
+        lastCompleted_ = fence_->GetCompletedValue();
+    }
+    while (!pending_.empty() && pending_.front().fenceValue <= lastCompleted_) {
+        pending_.pop_front();
+        ++stats_.released;
+    }
+}
+
+void DeferredReleaseQueue::Flush() {
+    if (pending_.empty()) {
+        return;
+    }
+
+    fence_->Wait(pending_.back().fenceValue);
+    Collect();
+    assert(pending_.empty());
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <deque>
+
+#include "Common/d3dUtil.h"
+#include "FramePacer.h"
+
+// Holds COM objects the GPU may still use and drops them once a fence says it is done, so that
+// freeing a resource never needs the queue drained.
+//
+// Each object is enqueued with the fence value signalled after the last work that may use it.
+// Collect() releases every object whose value the fence has reached, for one GetCompletedValue()
+// call at most. Values must not decrease from one Release() to the next, so the oldest entry is
+// always the next to go.
+//
+// The destructor releases whatever is left without waiting; the owner must have waited for the
+// GPU by then, as for any resource it holds directly.
+class DeferredReleaseQueue {
+  public:
+    struct Stats {
+        UINT64 deferred = 0;
+        UINT64 released = 0;
+    };
+
+    explicit DeferredReleaseQueue(FenceBackend* fence) : fence_(fence) {}
+
+    DeferredReleaseQueue(const DeferredReleaseQueue& other) = delete;
+    DeferredReleaseQueue& operator=(const DeferredReleaseQueue& other) = delete;
+
+    // Takes over object's reference until the fence reaches fenceValue. Null objects are ignored.
+    void Release(Microsoft::WRL::ComPtr<IUnknown> object, UINT64 fenceValue);
+
+    // Releases every object whose fence value has completed.
+    void Collect();
+
+    // Blocks until the fence reaches the newest value enqueued, then releases everything.
+    void Flush();
+
+    [[nodiscard]]
+    size_t GetPendingCount() const { return pending_.size(); }
+
+    [[nodiscard]]
+    const Stats& GetStats() const { return stats_; }
+
+  private:
+    struct Entry {
+        UINT64 fenceValue = 0;
+        Microsoft::WRL::ComPtr<IUnknown> object;
+    };
+
+    FenceBackend* fence_ = nullptr;
+    std::deque<Entry> pending_;  // oldest first
+    UINT64 lastCompleted_ = 0;
+
+    Stats stats_;
+};
@@ -0,0 +1,165 @@
+#include "DescriptorAllocator.h"
+
+namespace {
+
+D3D12_DESCRIPTOR_HEAP_DESC MakeHeapDesc(D3D12_DESCRIPTOR_HEAP_TYPE type, UINT count, bool shaderVisible) {
+    D3D12_DESCRIPTOR_HEAP_DESC desc{};
+    desc.Type = type;
+    desc.NumDescriptors = count;
+    desc.Flags = shaderVisible ? D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE : D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+    desc.NodeMask = 0;
+    return desc;
+}
+
+}  // namespace
+
+DescriptorIndexAllocator::DescriptorIndexAllocator(UINT persistentCount, UINT transientCount)
+    : persistentCount_(persistentCount),
+      transientCount_(transientCount),
+      generations_(persistentCount, 0) {
+    if (persistentCount_ > 0) {
+        freeRanges_[0] = persistentCount_;
+    }
+}
+
+DescriptorIndexAllocator::Handle DescriptorIndexAllocator::Allocate(UINT count) {
+    assert(count > 0);
+    for (auto it = freeRanges_.begin(); it != freeRanges_.end(); ++it) {
+        if (it->second < count) {
+            continue;
+        }
+
+        Handle handle;
+        handle.index = it->first;
+        handle.count = count;
+        handle.generation = generations_[handle.index];
+
+        UINT remaining = it->second - count;
+        freeRanges_.erase(it);
+        if (remaining > 0) {
+            freeRanges_[handle.index + count] = remaining;
+        }
+        persistentUsed_ += count;
+        return handle;
+    }
+    return {};
+}
+
+void DescriptorIndexAllocator::Free(const Handle& handle) {
+    assert(IsValid(handle) && "Stale or foreign descriptor handle.");
+
+    ++generations_[handle.index];
+    persistentUsed_ -= handle.count;
+
+    UINT index = handle.index;
+    UINT count = handle.count;
+
+    // Merge with the free ranges on either side.
+    auto next = freeRanges_.lower_bound(index);
+    if (next != freeRanges_.begin()) {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == index) {
+            index = prev->first;
+            count += prev->second;
+            freeRanges_.erase(prev);
+        }
+    }
+    if (next != freeRanges_.end() && next->first == handle.index + handle.count) {
+        count += next->second;
+        freeRanges_.erase(next);
+    }
+    freeRanges_[index] = count;
+}
+
+bool DescriptorIndexAllocator::IsValid(const Handle& handle) const {
+    return !handle.IsNull() && handle.count > 0 && handle.index + handle.count <= persistentCount_ &&
+           generations_[handle.index] == handle.generation;
+}
+
+UINT DescriptorIndexAllocator::AllocateTransient(UINT count) {
+    assert(count > 0);
+    if (count > transientCount_) {
+        return s_invalidIndex;
+    }
+
+    // A range never straddles the end of the ring; skip the tail and start over at 0.
+    bool wrap = transientHead_ + count > transientCount_;
+    UINT padding = wrap ? transientCount_ - transientHead_ : 0;
+    if (transientUsed_ + padding + count > transientCount_) {
+        return s_invalidIndex;
+    }
+
+    UINT offset = wrap ? 0 : transientHead_;
+    transientHead_ = offset + count;
+    transientUsed_ += padding + count;
+    openFrame_.end = transientHead_;
+    openFrame_.count += padding + count;
+    return persistentCount_ + offset;
+}
+
+void DescriptorIndexAllocator::EndFrame(UINT64 fenceValue) {
+    if (openFrame_.count == 0) {
+        return;
+    }
+
+    openFrame_.fenceValue = fenceValue;
+    frames_.push_back(openFrame_);
+    openFrame_ = Frame{};
+}
+
+void DescriptorIndexAllocator::Reclaim(UINT64 completedFenceValue) {
+    while (!frames_.empty() && frames_.front().fenceValue <= completedFenceValue) {
+        transientUsed_ -= frames_.front().count;
+        frames_.pop_front();
+    }
+
+    if (transientUsed_ == 0) {
+        transientHead_ = 0;
+    }
+}
+
+DescriptorIndexAllocator::Stats DescriptorIndexAllocator::GetStats() const {
+    Stats stats;
+    stats.persistentUsed = persistentUsed_;
+    stats.persistentFree = persistentCount_ - persistentUsed_;
+    stats.freeRangeCount = freeRanges_.size();
+    for (const auto& [index, count] : freeRanges_) {
+        stats.largestFreeRange = std::max(stats.largestFreeRange, count);
+    }
+    stats.transientInFlight = transientUsed_;
+    return stats;
+}
+
+DescriptorAllocator::DescriptorAllocator(ID3D12Device* device,
+                                         D3D12_DESCRIPTOR_HEAP_TYPE type,
+                                         UINT persistentCount,
+                                         UINT transientCount,
+                                         bool shaderVisible)
+    : heap_(device, MakeHeapDesc(type, persistentCount + transientCount, shaderVisible)),
+      indices_(persistentCount, transientCount) {}
+
+DescriptorAllocator::Handle DescriptorAllocator::Allocate(UINT count) {
+    Handle handle = indices_.Allocate(count);
+    if (handle.IsNull()) {
+        ThrowIfFailed(E_OUTOFMEMORY);
+    }
+    return handle;
+}
+
+UINT DescriptorAllocator::AllocateTransient(UINT count) {
+    UINT index = indices_.AllocateTransient(count);
+    if (index == DescriptorIndexAllocator::s_invalidIndex) {
+        ThrowIfFailed(E_OUTOFMEMORY);
+    }
+    return index;
+}
+
+CD3DX12_CPU_DESCRIPTOR_HANDLE DescriptorAllocator::GetCpuHandle(const Handle& handle, UINT offset) {
+    assert(IsValid(handle) && offset < handle.count);
+    return heap_.GetDescriptorHandleCpu(static_cast<int>(handle.index + offset));
+}
+
+CD3DX12_GPU_DESCRIPTOR_HANDLE DescriptorAllocator::GetGpuHandle(const Handle& handle, UINT offset) {
+    assert(IsValid(handle) && offset < handle.count);
+    return heap_.GetDescriptorHandleGpu(static_cast<int>(handle.index + offset));
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <deque>
+#include <map>
+#include <vector>
+
+#include "DescriptorHeap.h"
+
+// Index bookkeeping for one descriptor heap. Pure CPU; it never touches a device.
+//
+// The heap is split in two. The persistent region [0, persistentCount) hands out contiguous
+// ranges first-fit from a free list; freed ranges merge with free neighbours and are reused.
+// Handles carry the generation of their first slot, which Free() bumps, so a handle that
+// outlived its range is detected instead of aliasing whatever is allocated there next.
+//
+// The transient region that follows is a ring for descriptors written every frame. Ranges taken
+// since the last EndFrame() are stamped with that frame's fence value and come back once
+// Reclaim() sees the fence complete.
+class DescriptorIndexAllocator {
+  public:
+    static constexpr UINT s_invalidIndex = ~0u;
+
+    struct Handle {
+        UINT index = s_invalidIndex;
+        UINT count = 0;
+        UINT generation = 0;
+
+        [[nodiscard]]
+        bool IsNull() const { return index == s_invalidIndex; }
+    };
+
+    struct Stats {
+        UINT persistentUsed = 0;
+        UINT persistentFree = 0;
+        UINT largestFreeRange = 0;
+        size_t freeRangeCount = 0;
+        UINT transientInFlight = 0;
+    };
+
+    DescriptorIndexAllocator(UINT persistentCount, UINT transientCount);
+
+    // Returns a null handle when no free range is large enough.
+    [[nodiscard]]
+    Handle Allocate(UINT count = 1);
+
+    // The GPU must be done with the descriptors.
+    void Free(const Handle& handle);
+
+    [[nodiscard]]
+    bool IsValid(const Handle& handle) const;
+
+    // Returns s_invalidIndex when the transient ring is full.
+    [[nodiscard]]
+    UINT AllocateTransient(UINT count = 1);
+
+    // Call right after the queue has been asked to signal fenceValue for this frame.
+    void EndFrame(UINT64 fenceValue);
+
+    void Reclaim(UINT64 completedFenceValue);
+
+    [[nodiscard]]
+    UINT GetPersistentCount() const { return persistentCount_; }
+
+    [[nodiscard]]
+    UINT GetTransientCount() const { return transientCount_; }
+
+    [[nodiscard]]
+    Stats GetStats() const;
+
+  private:
+    struct Frame {
+        UINT64 fenceValue = 0;
+        UINT end = 0;    // transientHead_ after the frame's last allocation
+        UINT count = 0;  // slots, wrap padding included
+    };
+
+    UINT persistentCount_ = 0;
+    UINT transientCount_ = 0;
+
+    std::map<UINT, UINT> freeRanges_;  // first index -> count
+    std::vector<UINT> generations_;    // by first index of a range
+    UINT persistentUsed_ = 0;
+
+    UINT transientHead_ = 0;
+    UINT transientUsed_ = 0;
+    Frame openFrame_;
+    std::deque<Frame> frames_;  // oldest first
+};
+
+// Descriptor heap with allocation. Persistent ranges replace hand-picked indices, so textures can
+// be streamed in and out without rebuilding the heap; the transient region serves per-frame
+// dynamic descriptors. Throws DxException(E_OUTOFMEMORY) when a region is exhausted.
+class DescriptorAllocator {
+  public:
+    using Handle = DescriptorIndexAllocator::Handle;
+
+    DescriptorAllocator(ID3D12Device* device,
+                        D3D12_DESCRIPTOR_HEAP_TYPE type,
+                        UINT persistentCount,
+                        UINT transientCount,
+                        bool shaderVisible);
+
+    [[nodiscard]]
+    Handle Allocate(UINT count = 1);
+
+    void Free(const Handle& handle) { indices_.Free(handle); }
+
+    [[nodiscard]]
+    bool IsValid(const Handle& handle) const { return indices_.IsValid(handle); }
+
+    // Heap index of a transient range, valid until its frame's fence completes.
+    [[nodiscard]]
+    UINT AllocateTransient(UINT count = 1);
+
+    void EndFrame(UINT64 fenceValue) { indices_.EndFrame(fenceValue); }
+
+    void Reclaim(UINT64 completedFenceValue) { indices_.Reclaim(completedFenceValue); }
+
+    [[nodiscard]]
+    ID3D12DescriptorHeap* GetHeap() const { return heap_.Get(); }
+
+    [[nodiscard]]
+    CD3DX12_CPU_DESCRIPTOR_HANDLE GetCpuHandle(const Handle& handle, UINT offset = 0);
+
+    [[nodiscard]]
+    CD3DX12_GPU_DESCRIPTOR_HANDLE GetGpuHandle(const Handle& handle, UINT offset = 0);
+
+    [[nodiscard]]
+    CD3DX12_CPU_DESCRIPTOR_HANDLE GetCpuHandle(UINT index) { return heap_.GetDescriptorHandleCpu(index); }
+
+    [[nodiscard]]
+    CD3DX12_GPU_DESCRIPTOR_HANDLE GetGpuHandle(UINT index) { return heap_.GetDescriptorHandleGpu(index); }
+
+    [[nodiscard]]
+    DescriptorIndexAllocator::Stats GetStats() const { return indices_.GetStats(); }
+
+  private:
+    DescriptorHeap heap_;
+    DescriptorIndexAllocator indices_;
+};
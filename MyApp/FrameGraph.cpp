@@ -0,0 +1,530 @@
+#include "FrameGraph.h"
+
+#include <algorithm>
+
+namespace {
+
+// FNV-1a over the fields that shape the compiled graph.
+class TopologyHash {
+  public:
+    template <typename T>
+    void Add(const T& value) {
+        const auto* bytes = reinterpret_cast<const unsigned char*>(&value);
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            hash_ = (hash_ ^ bytes[i]) * 0x100000001b3ull;
+        }
+    }
+
+    void Add(const std::string& value) {
+        for (char c : value) {
+            Add(c);
+        }
+        Add(value.size());
+    }
+
+    [[nodiscard]]
+    UINT64 Get() const { return hash_; }
+
+  private:
+    UINT64 hash_ = 0xcbf29ce484222325ull;
+};
+
+UINT64 AlignUp(UINT64 value, UINT64 alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+bool Overlaps(const FrameGraph::Placement& a, const FrameGraph::Placement& b) {
+    return a.offset < b.offset + b.size && b.offset < a.offset + a.size;
+}
+
+bool LifetimesOverlap(const FrameGraph::Placement& a, const FrameGraph::Placement& b) {
+    return a.firstPass <= b.lastPass && b.firstPass <= a.lastPass;
+}
+
+}  // namespace
+
+D3D12FrameGraphBackend::D3D12FrameGraphBackend(ID3D12Device* device, FenceBackend* fence)
+    : device_(device),
+      fence_(fence) {
+    rtvSize_ = device_->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
+    dsvSize_ = device_->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_DSV);
+}
+
+D3D12_RESOURCE_ALLOCATION_INFO D3D12FrameGraphBackend::GetAllocationInfo(const D3D12_RESOURCE_DESC& desc) {
+    return device_->GetResourceAllocationInfo(0, 1, &desc);
+}
+
+void D3D12FrameGraphBackend::BeginTransients(UINT64 heapSize, UINT64 heapAlignment, UINT count) {
+    // The frames still in flight may be using the current transients.
+    if (current_.heap) {
+        current_.fenceValue = lastFenceValue_;
+        retired_.push_back(std::move(current_));
+    }
+    current_ = {};
+    views_.assign(count, {});
+    Reclaim();
+
+    if (heapSize == 0) {
+        return;
+    }
+
+    CD3DX12_HEAP_DESC heapDesc(heapSize,
+                               D3D12_HEAP_TYPE_DEFAULT,
+                               heapAlignment,
+                               D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES);
+    ThrowIfFailed(device_->CreateHeap(&heapDesc, IID_PPV_ARGS(current_.heap.GetAddressOf())));
+    current_.resources.resize(count);
+
+    D3D12_DESCRIPTOR_HEAP_DESC viewHeapDesc{};
+    viewHeapDesc.NumDescriptors = count;
+    viewHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+    viewHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
+    ThrowIfFailed(device_->CreateDescriptorHeap(&viewHeapDesc, IID_PPV_ARGS(current_.rtvHeap.GetAddressOf())));
+    viewHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_DSV;
+    ThrowIfFailed(device_->CreateDescriptorHeap(&viewHeapDesc, IID_PPV_ARGS(current_.dsvHeap.GetAddressOf())));
+}
+
+ID3D12Resource* D3D12FrameGraphBackend::CreateTransient(UINT index,
+                                                        UINT64 offset,
+                                                        const D3D12_RESOURCE_DESC& desc,
+                                                        const D3D12_CLEAR_VALUE* clearValue,
+                                                        D3D12_RESOURCE_STATES state) {
+    auto& resource = current_.resources[index];
+    ThrowIfFailed(device_->CreatePlacedResource(current_.heap.Get(),
+                                                offset,
+                                                &desc,
+                                                state,
+                                                clearValue,
+                                                IID_PPV_ARGS(resource.GetAddressOf())));
+
+    if (desc.Flags & D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL) {
+        views_[index] = CD3DX12_CPU_DESCRIPTOR_HANDLE(current_.dsvHeap->GetCPUDescriptorHandleForHeapStart(),
+                                                      static_cast<INT>(index),
+                                                      dsvSize_);
+        device_->CreateDepthStencilView(resource.Get(), nullptr, views_[index]);
+    } else {
+        views_[index] = CD3DX12_CPU_DESCRIPTOR_HANDLE(current_.rtvHeap->GetCPUDescriptorHandleForHeapStart(),
+                                                      static_cast<INT>(index),
+                                                      rtvSize_);
+        device_->CreateRenderTargetView(resource.Get(), nullptr, views_[index]);
+    }
+    return resource.Get();
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE D3D12FrameGraphBackend::GetView(UINT index) {
+    assert(index < views_.size() && views_[index].ptr != 0 && "Not a created transient.");
+    return views_[index];
+}
+
+void D3D12FrameGraphBackend::EndFrame(UINT64 fenceValue) {
+    lastFenceValue_ = fenceValue;
+    Reclaim();
+}
+
+void D3D12FrameGraphBackend::Reclaim() {
+    if (retired_.empty()) {
+        return;
+    }
+
+    UINT64 completed = fence_->GetCompletedValue();
+    while (!retired_.empty() && retired_.front().fenceValue <= completed) {
+        retired_.pop_front();
+    }
+}
+
+ID3D12Resource* FrameGraph::PassContext::GetResource(Handle handle) const {
+    assert(handle.index < graph_.resources_.size());
+    return graph_.resources_[handle.index].resource;
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE FrameGraph::PassContext::GetView(Handle handle) const {
+    assert(handle.index < graph_.resources_.size() && !graph_.resources_[handle.index].imported);
+    return graph_.backend_->GetView(handle.index);
+}
+
+FrameGraph::PassBuilder& FrameGraph::PassBuilder::Read(Handle resource, D3D12_RESOURCE_STATES state) {
+    graph_.AddAccess(pass_, resource, state, false);
+    return *this;
+}
+
+FrameGraph::PassBuilder& FrameGraph::PassBuilder::Write(Handle resource, D3D12_RESOURCE_STATES state) {
+    graph_.AddAccess(pass_, resource, state, true);
+    return *this;
+}
+
+FrameGraph::PassBuilder& FrameGraph::PassBuilder::SetSideEffect() {
+    graph_.passes_[pass_].sideEffect = true;
+    return *this;
+}
+
+FrameGraph::FrameGraph(FrameGraphBackend* backend) : backend_(backend) {}
+
+void FrameGraph::Reset() {
+    resources_.clear();
+    passes_.clear();
+}
+
+FrameGraph::Handle FrameGraph::Import(std::string name,
+                                      ID3D12Resource* resource,
+                                      D3D12_RESOURCE_STATES initialState,
+                                      D3D12_RESOURCE_STATES finalState) {
+    assert(resource != nullptr);
+
+    Resource imported;
+    imported.name = std::move(name);
+    imported.imported = true;
+    imported.resource = resource;
+    imported.initialState = initialState;
+    imported.finalState = finalState;
+    resources_.push_back(std::move(imported));
+    return {static_cast<UINT>(resources_.size() - 1)};
+}
+
+FrameGraph::Handle FrameGraph::Create(std::string name,
+                                      const D3D12_RESOURCE_DESC& desc,
+                                      const D3D12_CLEAR_VALUE* clearValue) {
+    constexpr auto targetFlags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL;
+    if (desc.Dimension != D3D12_RESOURCE_DIMENSION_TEXTURE2D || (desc.Flags & targetFlags) == 0) {
+        ThrowIfFailed(E_INVALIDARG);
+    }
+
+    Resource transient;
+    transient.name = std::move(name);
+    transient.desc = desc;
+    if (clearValue) {
+        transient.hasClearValue = true;
+        transient.clearValue = *clearValue;
+    }
+    resources_.push_back(std::move(transient));
+    return {static_cast<UINT>(resources_.size() - 1)};
+}
+
+FrameGraph::PassBuilder FrameGraph::AddPass(std::string name, ExecuteFn execute) {
+    Pass pass;
+    pass.name = std::move(name);
+    pass.execute = std::move(execute);
+    passes_.push_back(std::move(pass));
+    return {*this, static_cast<UINT>(passes_.size() - 1)};
+}
+
+void FrameGraph::AddAccess(UINT pass, Handle resource, D3D12_RESOURCE_STATES state, bool write) {
+    assert(resource.index < resources_.size() && "Handle from another frame.");
+
+    auto& accesses = passes_[pass].accesses;
+    auto same = [resource](const Access& access) { return access.resource == resource.index; };
+    auto it = std::find_if(accesses.begin(), accesses.end(), same);
+    if (it == accesses.end()) {
+        accesses.push_back({resource.index, state, false, false});
+        it = std::prev(accesses.end());
+    } else if (it->state != state) {
+        // One pass cannot need a resource in two states at once.
+        ThrowIfFailed(E_INVALIDARG);
+    }
+
+    (write ? it->write : it->read) = true;
+}
+
+bool FrameGraph::Compile() {
+    UINT64 hash = HashTopology();
+    if (hasCompiled_ && hash == compiledHash_) {
+        ++stats_.reuses;
+        return false;
+    }
+
+    std::vector<bool> kept;
+    Cull(kept);
+
+    compiled_ = {};
+    compiled_.placements.resize(resources_.size());
+
+    std::vector<D3D12_RESOURCE_STATES> states(resources_.size(), D3D12_RESOURCE_STATE_COMMON);
+    std::vector<bool> live(resources_.size(), false);
+    for (size_t i = 0; i < resources_.size(); ++i) {
+        if (resources_[i].imported) {
+            states[i] = resources_[i].initialState;
+            live[i] = true;
+        }
+    }
+
+    constexpr auto targetStates = D3D12_RESOURCE_STATE_RENDER_TARGET | D3D12_RESOURCE_STATE_DEPTH_WRITE;
+    for (UINT p = 0; p < passes_.size(); ++p) {
+        if (!kept[p]) {
+            ++compiled_.culledPasses;
+            continue;
+        }
+
+        CompiledPass compiledPass;
+        compiledPass.pass = p;
+        auto index = static_cast<UINT>(compiled_.passes.size());
+
+        for (const auto& access : passes_[p].accesses) {
+            UINT r = access.resource;
+            auto& placement = compiled_.placements[r];
+
+            if (!live[r]) {
+                // A transient starts out undefined and is discarded in the state it is first
+                // written in, so that has to be a render target or depth write.
+                if (access.read || (access.state & ~targetStates) != 0) {
+                    ThrowIfFailed(E_INVALIDARG);
+                }
+                live[r] = true;
+                states[r] = access.state;
+                placement.firstPass = index;
+                placement.state = access.state;
+                compiledPass.activated.push_back(r);
+            } else if (states[r] != access.state) {
+                compiledPass.transitions.push_back({r, states[r], access.state});
+                states[r] = access.state;
+            }
+
+            if (!resources_[r].imported) {
+                placement.lastPass = index;
+            }
+        }
+        compiled_.passes.push_back(std::move(compiledPass));
+    }
+
+    for (UINT r = 0; r < resources_.size(); ++r) {
+        if (resources_[r].imported && states[r] != resources_[r].finalState) {
+            compiled_.finalTransitions.push_back({r, states[r], resources_[r].finalState});
+        }
+    }
+
+    Place();
+
+    compiledHash_ = hash;
+    hasCompiled_ = true;
+    realized_ = false;
+    ++stats_.compiles;
+    return true;
+}
+
+void FrameGraph::Execute(ParallelRecorder& recorder, ResourceStateTracker& tracker) {
+    assert(hasCompiled_ && compiledHash_ == HashTopology() && "Compile() the declared graph first.");
+    Realize(tracker);
+
+    for (UINT r = 0; r < resources_.size(); ++r) {
+        if (!resources_[r].imported) {
+            resources_[r].resource = transients_[r];
+        }
+    }
+
+    // Imported resources follow the tracker rather than the compiled states, which only differ
+    // if a caller declared the wrong initial state.
+    auto recordBarriers = [&](const std::vector<UINT>& aliased, const std::vector<UINT>& activated) {
+        std::vector<D3D12_RESOURCE_BARRIER> barriers;
+        for (UINT r : aliased) {
+            barriers.push_back(CD3DX12_RESOURCE_BARRIER::Aliasing(nullptr, resources_[r].resource));
+        }
+        auto transitions = tracker.TakeBarriers();
+        barriers.insert(barriers.end(), transitions.begin(), transitions.end());
+
+        if (barriers.empty() && activated.empty()) {
+            return;
+        }
+
+        auto list = recorder.Begin();
+        if (!barriers.empty()) {
+            list.commandList->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+        }
+        for (UINT r : activated) {
+            list.commandList->DiscardResource(resources_[r].resource, nullptr);
+        }
+        recorder.End(list);
+    };
+
+    PassContext context(*this, recorder);
+    for (const auto& compiledPass : compiled_.passes) {
+        const auto& pass = passes_[compiledPass.pass];
+        for (const auto& access : pass.accesses) {
+            tracker.Transition(resources_[access.resource].resource, access.state);
+        }
+        recordBarriers(compiledPass.aliased, compiledPass.activated);
+
+        if (pass.execute) {
+            pass.execute(context);
+        }
+    }
+
+    for (const auto& resource : resources_) {
+        if (resource.imported) {
+            tracker.Transition(resource.resource, resource.finalState);
+        }
+    }
+    recordBarriers({}, {});
+}
+
+void FrameGraph::EndFrame(UINT64 fenceValue) {
+    backend_->EndFrame(fenceValue);
+}
+
+UINT64 FrameGraph::HashTopology() const {
+    TopologyHash hash;
+
+    hash.Add(resources_.size());
+    for (const auto& resource : resources_) {
+        hash.Add(resource.imported);
+        if (resource.imported) {
+            hash.Add(resource.initialState);
+            hash.Add(resource.finalState);
+            continue;
+        }
+
+        // Field by field; the structs have padding.
+        const auto& desc = resource.desc;
+        hash.Add(desc.Width);
+        hash.Add(desc.Height);
+        hash.Add(desc.DepthOrArraySize);
+        hash.Add(desc.MipLevels);
+        hash.Add(desc.Format);
+        hash.Add(desc.SampleDesc.Count);
+        hash.Add(desc.SampleDesc.Quality);
+        hash.Add(desc.Layout);
+        hash.Add(desc.Flags);
+        hash.Add(resource.hasClearValue);
+        if (resource.hasClearValue) {
+            hash.Add(resource.clearValue.Format);
+            if (desc.Flags & D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL) {
+                hash.Add(resource.clearValue.DepthStencil.Depth);
+                hash.Add(resource.clearValue.DepthStencil.Stencil);
+            } else {
+                hash.Add(resource.clearValue.Color);
+            }
+        }
+    }
+
+    hash.Add(passes_.size());
+    for (const auto& pass : passes_) {
+        hash.Add(pass.name);
+        hash.Add(pass.sideEffect);
+        hash.Add(pass.accesses.size());
+        for (const auto& access : pass.accesses) {
+            hash.Add(access.resource);
+            hash.Add(access.state);
+            hash.Add(access.read);
+            hash.Add(access.write);
+        }
+    }
+    return hash.Get();
+}
+
+void FrameGraph::Cull(std::vector<bool>& kept) const {
+    kept.assign(passes_.size(), false);
+
+    // Walking backwards, a resource is needed if a kept pass after this point reads it.
+    // Imported resources are needed at the end of the frame.
+    std::vector<bool> needed(resources_.size(), false);
+    for (size_t r = 0; r < resources_.size(); ++r) {
+        needed[r] = resources_[r].imported;
+    }
+
+    for (size_t p = passes_.size(); p-- > 0;) {
+        const auto& pass = passes_[p];
+        bool keep = pass.sideEffect;
+        for (const auto& access : pass.accesses) {
+            keep |= access.write && needed[access.resource];
+        }
+        if (!keep) {
+            continue;
+        }
+
+        kept[p] = true;
+        for (const auto& access : pass.accesses) {
+            if (access.read) {
+                needed[access.resource] = true;
+            }
+        }
+    }
+}
+
+void FrameGraph::Place() {
+    auto& placements = compiled_.placements;
+
+    std::vector<UINT> order;
+    std::vector<UINT64> alignments(resources_.size(), 0);
+    for (UINT r = 0; r < resources_.size(); ++r) {
+        if (resources_[r].imported || placements[r].firstPass == UINT_MAX) {
+            continue;
+        }
+
+        auto info = backend_->GetAllocationInfo(resources_[r].desc);
+        placements[r].size = info.SizeInBytes;
+        alignments[r] = std::max<UINT64>(info.Alignment, 1);
+        compiled_.heapAlignment = std::max(compiled_.heapAlignment, alignments[r]);
+        order.push_back(r);
+    }
+
+    // Largest first, so small transients fill the gaps left between large ones.
+    std::stable_sort(order.begin(), order.end(), [&](UINT a, UINT b) {
+        return placements[a].size > placements[b].size;
+    });
+
+    std::vector<UINT> placed;
+    for (UINT r : order) {
+        auto& placement = placements[r];
+
+        // Memory in use by transients alive at the same time, by offset.
+        std::vector<const Placement*> taken;
+        for (UINT other : placed) {
+            if (LifetimesOverlap(placement, placements[other])) {
+                taken.push_back(&placements[other]);
+            }
+        }
+        std::sort(taken.begin(), taken.end(), [](const Placement* a, const Placement* b) {
+            return a->offset < b->offset;
+        });
+
+        UINT64 offset = 0;
+        for (const auto* range : taken) {
+            if (AlignUp(offset, alignments[r]) + placement.size <= range->offset) {
+                break;
+            }
+            offset = std::max(offset, range->offset + range->size);
+        }
+        placement.offset = AlignUp(offset, alignments[r]);
+
+        compiled_.heapSize = std::max(compiled_.heapSize, placement.offset + placement.size);
+        placed.push_back(r);
+    }
+
+    // Any transient sharing memory needs an aliasing barrier when it becomes active, including
+    // the first one each frame, which follows the last one of the frame before.
+    for (UINT r : order) {
+        bool shared = std::any_of(order.begin(), order.end(), [&](UINT other) {
+            return other != r && Overlaps(placements[r], placements[other]);
+        });
+        if (shared) {
+            compiled_.passes[placements[r].firstPass].aliased.push_back(r);
+        }
+    }
+}
+
+void FrameGraph::Realize(ResourceStateTracker& tracker) {
+    if (realized_) {
+        return;
+    }
+
+    for (auto* transient : transients_) {
+        if (transient) {
+            tracker.Unregister(transient);
+        }
+    }
+    transients_.assign(resources_.size(), nullptr);
+
+    backend_->BeginTransients(compiled_.heapSize, compiled_.heapAlignment, static_cast<UINT>(resources_.size()));
+    for (UINT r = 0; r < resources_.size(); ++r) {
+        const auto& placement = compiled_.placements[r];
+        if (resources_[r].imported || placement.size == 0) {
+            continue;
+        }
+
+        const auto& resource = resources_[r];
+        transients_[r] = backend_->CreateTransient(r,
+                                                   placement.offset,
+                                                   resource.desc,
+                                                   resource.hasClearValue ? &resource.clearValue : nullptr,
+                                                   placement.state);
+        tracker.Register(transients_[r], placement.state);
+    }
+    realized_ = true;
+}
@@ -0,0 +1,268 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Common/d3dUtil.h"
+#include "FramePacer.h"
+#include "ParallelRecorder.h"
+#include "ResourceStateTracker.h"
+
+// Device work behind FrameGraph. Compile() only asks for allocation sizes, so a fake returning
+// made-up sizes is enough to run it headless; the rest is used by Execute().
+class FrameGraphBackend {
+  public:
+    virtual ~FrameGraphBackend() = default;
+
+    [[nodiscard]]
+    virtual D3D12_RESOURCE_ALLOCATION_INFO GetAllocationInfo(const D3D12_RESOURCE_DESC& desc) = 0;
+
+    // Drops the current transients and makes room for count of them in heapSize bytes.
+    virtual void BeginTransients(UINT64 heapSize, UINT64 heapAlignment, UINT count) = 0;
+
+    // Places transient index at offset in the heap, with a view for its render target or
+    // depth-stencil flag.
+    virtual ID3D12Resource* CreateTransient(UINT index,
+                                            UINT64 offset,
+                                            const D3D12_RESOURCE_DESC& desc,
+                                            const D3D12_CLEAR_VALUE* clearValue,
+                                            D3D12_RESOURCE_STATES state) = 0;
+
+    [[nodiscard]]
+    virtual D3D12_CPU_DESCRIPTOR_HANDLE GetView(UINT index) = 0;
+
+    // Call right after the queue has been asked to signal fenceValue.
+    virtual void EndFrame(UINT64 fenceValue) = 0;
+};
+
+// One heap shared by all transients, and the RTVs and DSVs into them. Transients dropped by
+// BeginTransients() are released once the frames that used them have completed.
+class D3D12FrameGraphBackend final : public FrameGraphBackend {
+  public:
+    D3D12FrameGraphBackend(ID3D12Device* device, FenceBackend* fence);
+
+    D3D12_RESOURCE_ALLOCATION_INFO GetAllocationInfo(const D3D12_RESOURCE_DESC& desc) override;
+
+    void BeginTransients(UINT64 heapSize, UINT64 heapAlignment, UINT count) override;
+
+    ID3D12Resource* CreateTransient(UINT index,
+                                    UINT64 offset,
+                                    const D3D12_RESOURCE_DESC& desc,
+                                    const D3D12_CLEAR_VALUE* clearValue,
+                                    D3D12_RESOURCE_STATES state) override;
+
+    D3D12_CPU_DESCRIPTOR_HANDLE GetView(UINT index) override;
+
+    void EndFrame(UINT64 fenceValue) override;
+
+  private:
+    struct Transients {
+        UINT64 fenceValue = 0;  // last frame using them
+        Microsoft::WRL::ComPtr<ID3D12Heap> heap;
+        std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> resources;
+        Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> rtvHeap;
+        Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> dsvHeap;
+    };
+
+    void Reclaim();
+
+    Microsoft::WRL::ComPtr<ID3D12Device> device_;
+    FenceBackend* fence_ = nullptr;
+    UINT rtvSize_ = 0;
+    UINT dsvSize_ = 0;
+
+    Transients current_;
+    std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> views_;
+    std::deque<Transients> retired_;
+    UINT64 lastFenceValue_ = 0;
+};
+
+// Schedules a frame as passes that declare the resources they read and write.
+//
+// The graph is declared again every frame: Reset(), Import() the resources that outlive it such
+// as the back buffer, Create() transient textures, and AddPass() in submission order. Compile()
+// hashes what was declared and does the work only when that differs from the last compile:
+//
+// - Passes are culled unless they have side effects, write an imported resource, or write
+//   something a kept pass reads later.
+// - Each transient lives from the first to the last kept pass using it. Transients whose
+//   lifetimes do not overlap share memory in one heap, placed largest first at the lowest
+//   offset free for their whole lifetime.
+// - The state each pass needs every resource in is worked out, giving the barriers before it,
+//   and imported resources are returned to their final state after the last pass.
+//
+// Execute() creates the transients when the compiled layout changed, then per pass records the
+// aliasing and state barriers on a list of its own and runs the pass, which records through the
+// recorder so it can split its work across workers. State barriers go through the tracker,
+// which has to know the imported resources. Transients are only render targets and depth
+// buffers; their contents are undefined at their first pass, which must clear them.
+class FrameGraph {
+  public:
+    struct Handle {
+        UINT index = UINT_MAX;
+    };
+
+    struct Transition {
+        UINT resource = 0;
+        D3D12_RESOURCE_STATES before = D3D12_RESOURCE_STATE_COMMON;
+        D3D12_RESOURCE_STATES after = D3D12_RESOURCE_STATE_COMMON;
+    };
+
+    struct CompiledPass {
+        UINT pass = 0;
+        std::vector<UINT> activated;  // transients first used here
+        std::vector<UINT> aliased;    // of those, sharing memory with other transients
+        std::vector<Transition> transitions;
+    };
+
+    // Per resource; left empty for imported and culled ones.
+    struct Placement {
+        UINT64 offset = 0;
+        UINT64 size = 0;
+        UINT firstPass = UINT_MAX;  // index into CompiledGraph::passes
+        UINT lastPass = 0;
+        D3D12_RESOURCE_STATES state = D3D12_RESOURCE_STATE_COMMON;  // at firstPass
+    };
+
+    struct CompiledGraph {
+        std::vector<CompiledPass> passes;  // kept passes, in order
+        std::vector<Transition> finalTransitions;
+        std::vector<Placement> placements;
+        UINT64 heapSize = 0;
+        UINT64 heapAlignment = 0;
+        UINT culledPasses = 0;
+    };
+
+    struct Stats {
+        UINT64 compiles = 0;
+        UINT64 reuses = 0;  // topology unchanged
+    };
+
+    class PassContext {
+      public:
+        PassContext(const FrameGraph& graph, ParallelRecorder& recorder)
+            : graph_(graph),
+              recorder_(recorder) {}
+
+        [[nodiscard]]
+        ParallelRecorder& GetRecorder() const { return recorder_; }
+
+        [[nodiscard]]
+        ID3D12Resource* GetResource(Handle handle) const;
+
+        // RTV or DSV of a transient.
+        [[nodiscard]]
+        D3D12_CPU_DESCRIPTOR_HANDLE GetView(Handle handle) const;
+
+      private:
+        const FrameGraph& graph_;
+        ParallelRecorder& recorder_;
+    };
+
+    using ExecuteFn = std::function<void(PassContext& context)>;
+
+    // Declares what a pass uses. A resource used twice by one pass must be in one state.
+    class PassBuilder {
+      public:
+        PassBuilder(FrameGraph& graph, UINT pass) : graph_(graph), pass_(pass) {}
+
+        PassBuilder& Read(Handle resource, D3D12_RESOURCE_STATES state = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+
+        // state is one the pass writes in, e.g. RENDER_TARGET or DEPTH_WRITE.
+        PassBuilder& Write(Handle resource, D3D12_RESOURCE_STATES state);
+
+        // Keeps the pass even when nothing uses what it writes.
+        PassBuilder& SetSideEffect();
+
+      private:
+        FrameGraph& graph_;
+        UINT pass_ = 0;
+    };
+
+    explicit FrameGraph(FrameGraphBackend* backend);
+
+    // Starts declaring the next frame. The compiled graph and transients are kept.
+    void Reset();
+
+    // A resource owned elsewhere, currently in initialState, to be left in finalState.
+    Handle Import(std::string name,
+                  ID3D12Resource* resource,
+                  D3D12_RESOURCE_STATES initialState,
+                  D3D12_RESOURCE_STATES finalState);
+
+    // A texture that only lives within the frame. desc must allow render target or depth-stencil.
+    Handle Create(std::string name, const D3D12_RESOURCE_DESC& desc, const D3D12_CLEAR_VALUE* clearValue = nullptr);
+
+    PassBuilder AddPass(std::string name, ExecuteFn execute);
+
+    // Returns whether anything was recompiled.
+    bool Compile();
+
+    void Execute(ParallelRecorder& recorder, ResourceStateTracker& tracker);
+
+    // Call right after the queue has been asked to signal fenceValue.
+    void EndFrame(UINT64 fenceValue);
+
+    [[nodiscard]]
+    const CompiledGraph& GetCompiled() const { return compiled_; }
+
+    [[nodiscard]]
+    const std::string& GetPassName(UINT pass) const { return passes_[pass].name; }
+
+    [[nodiscard]]
+    const Stats& GetStats() const { return stats_; }
+
+  private:
+    struct Resource {
+        std::string name;
+        bool imported = false;
+        ID3D12Resource* resource = nullptr;  // imported, or transient once created
+        D3D12_RESOURCE_STATES initialState = D3D12_RESOURCE_STATE_COMMON;
+        D3D12_RESOURCE_STATES finalState = D3D12_RESOURCE_STATE_COMMON;
+        D3D12_RESOURCE_DESC desc{};
+        bool hasClearValue = false;
+        D3D12_CLEAR_VALUE clearValue{};
+    };
+
+    struct Access {
+        UINT resource = 0;
+        D3D12_RESOURCE_STATES state = D3D12_RESOURCE_STATE_COMMON;
+        bool read = false;
+        bool write = false;
+    };
+
+    struct Pass {
+        std::string name;
+        std::vector<Access> accesses;
+        bool sideEffect = false;
+        ExecuteFn execute;
+    };
+
+    void AddAccess(UINT pass, Handle resource, D3D12_RESOURCE_STATES state, bool write);
+
+    [[nodiscard]]
+    UINT64 HashTopology() const;
+
+    void Cull(std::vector<bool>& kept) const;
+
+    void Place();
+
+    void Realize(ResourceStateTracker& tracker);
+
+    FrameGraphBackend* backend_ = nullptr;
+
+    std::vector<Resource> resources_;
+    std::vector<Pass> passes_;
+
+    CompiledGraph compiled_;
+    UINT64 compiledHash_ = 0;
+    bool hasCompiled_ = false;
+
+    // Transients created for the compiled graph, by resource index.
+    std::vector<ID3D12Resource*> transients_;
+    bool realized_ = false;
+
+    Stats stats_;
+};
@@ -0,0 +1,75 @@
+#include "FramePacer.h"
+
+#include <chrono>
+
+D3D12FenceBackend::D3D12FenceBackend(ID3D12Fence* fence) : fence_(fence) {
+    event_ = CreateEventEx(nullptr, nullptr, false, EVENT_ALL_ACCESS);
+    if (!event_) {
+        ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
+    }
+}
+
+D3D12FenceBackend::~D3D12FenceBackend() {
+    CloseHandle(event_);
+}
+
+void D3D12FenceBackend::Wait(UINT64 value) {
+    if (fence_->GetCompletedValue() < value) {
+        ThrowIfFailed(fence_->SetEventOnCompletion(value, event_));
+        WaitForSingleObject(event_, INFINITE);
+    }
+}
+
+FramePacer::FramePacer(FenceBackend* fence, UINT framesInFlight, Clock clock)
+    : fence_(fence),
+      clock_(std::move(clock)),
+      slotFences_(framesInFlight, 0),
+      frameIndex_(framesInFlight - 1) {
+    assert(framesInFlight > 0);
+    if (!clock_) {
+        clock_ = [] {
+            using namespace std::chrono;
+            return duration<double>(steady_clock::now().time_since_epoch()).count();
+        };
+    }
+    lastSeenBusy_ = clock_();
+}
+
+UINT FramePacer::BeginFrame() {
+    frameIndex_ = (frameIndex_ + 1) % GetFramesInFlight();
+
+    // Only the frame that last used this slot has to be finished; newer ones keep running.
+    UINT64 slotFence = slotFences_[frameIndex_];
+    if (fence_->GetCompletedValue() < slotFence) {
+        double start = clock_();
+        lastSeenBusy_ = start;
+        fence_->Wait(slotFence);
+        ++stats_.cpuWaitFrames;
+        stats_.cpuWaitSeconds += clock_() - start;
+    }
+
+    if (fence_->GetCompletedValue() < lastSubmitted_) {
+        lastSeenBusy_ = clock_();
+    }
+    return frameIndex_;
+}
+
+void FramePacer::EndFrame(UINT64 fenceValue) {
+    assert(fenceValue > lastSubmitted_);
+
+    // Had the GPU finished everything before this frame arrived, it sat idle waiting for us.
+    double now = clock_();
+    if (lastSubmitted_ != 0 && fence_->GetCompletedValue() >= lastSubmitted_) {
+        ++stats_.gpuIdleFrames;
+        stats_.gpuIdleSeconds += now - lastSeenBusy_;
+    }
+    lastSeenBusy_ = now;
+
+    slotFences_[frameIndex_] = fenceValue;
+    lastSubmitted_ = fenceValue;
+    ++stats_.frames;
+}
+
+void FramePacer::WaitForIdle() {
+    fence_->Wait(lastSubmitted_);
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "Common/d3dUtil.h"
+
+// Fence the CPU can poll and block on. The D3D12 backend wraps an ID3D12Fence; a simulated
+// fence driven by a fake queue can stand in to run the pacing logic headless.
+class FenceBackend {
+  public:
+    virtual ~FenceBackend() = default;
+
+    virtual UINT64 GetCompletedValue() = 0;
+
+    // Blocks until the fence has reached value.
+    virtual void Wait(UINT64 value) = 0;
+};
+
+// Waits with one event created up front instead of an event per wait.
+class D3D12FenceBackend final : public FenceBackend {
+  public:
+    explicit D3D12FenceBackend(ID3D12Fence* fence);
+
+    D3D12FenceBackend(const D3D12FenceBackend& other) = delete;
+    D3D12FenceBackend& operator=(const D3D12FenceBackend& other) = delete;
+
+    ~D3D12FenceBackend() override;
+
+    UINT64 GetCompletedValue() override { return fence_->GetCompletedValue(); }
+
+    void Wait(UINT64 value) override;
+
+  private:
+    Microsoft::WRL::ComPtr<ID3D12Fence> fence_;
+    HANDLE event_ = nullptr;
+};
+
+// Keeps up to framesInFlight frames queued on the GPU while the CPU records the next one.
+//
+// Each frame slot remembers the fence value signalled after its last submission. BeginFrame()
+// moves to the next slot and blocks only if the GPU has not yet passed that slot's fence, i.e.
+// only if the CPU is a full ring ahead. EndFrame() records the slot's fence value.
+//
+// Stats separate the two ways a frame can stall. CPU wait is measured time spent blocked in
+// BeginFrame(). GPU idle is counted when a frame is submitted after the GPU has already drained
+// the previous one; its time is an upper bound, from the last moment the GPU was seen busy.
+class FramePacer {
+  public:
+    struct Stats {
+        UINT64 frames = 0;
+        UINT64 cpuWaitFrames = 0;
+        double cpuWaitSeconds = 0.0;
+        UINT64 gpuIdleFrames = 0;
+        double gpuIdleSeconds = 0.0;
+    };
+
+    // Returns seconds from an arbitrary origin; defaults to a steady clock.
+    using Clock = std::function<double()>;
+
+    FramePacer(FenceBackend* fence, UINT framesInFlight, Clock clock = {});
+
+    // Blocks until the next slot is free and returns its index.
+    UINT BeginFrame();
+
+    // Call right after the queue has been asked to signal fenceValue for this frame.
+    void EndFrame(UINT64 fenceValue);
+
+    // Blocks until every submitted frame has completed.
+    void WaitForIdle();
+
+    [[nodiscard]]
+    UINT GetFrameIndex() const { return frameIndex_; }
+
+    [[nodiscard]]
+    UINT GetFramesInFlight() const { return static_cast<UINT>(slotFences_.size()); }
+
+    [[nodiscard]]
+    const Stats& GetStats() const { return stats_; }
+
+    void ResetStats() { stats_ = {}; }
+
+  private:
+    FenceBackend* fence_ = nullptr;
+    Clock clock_;
+
+    std::vector<UINT64> slotFences_;  // 0 until the slot has been submitted once
+    UINT frameIndex_ = 0;
+    UINT64 lastSubmitted_ = 0;
+    double lastSeenBusy_ = 0.0;
+
+    Stats stats_;
+};
@@ -0,0 +1,61 @@
+#include "GeometryPool.h"
+
+GeometryPool::GeometryPool(UINT vertexStride, DXGI_FORMAT indexFormat)
+    : vertexStride_(vertexStride),
+      indexFormat_(indexFormat) {
+    assert(indexFormat_ == DXGI_FORMAT_R16_UINT || indexFormat_ == DXGI_FORMAT_R32_UINT);
+    indexSize_ = indexFormat_ == DXGI_FORMAT_R16_UINT ? 2 : 4;
+}
+
+GeometryPool::Submesh GeometryPool::Add(const void* vertices,
+                                        UINT vertexCount,
+                                        const void* indices,
+                                        UINT indexCount) {
+    assert(!IsUploaded() && "Meshes must be added before Upload().");
+
+    Submesh submesh;
+    submesh.indexCount = indexCount;
+    submesh.indexStart = indexCount_;
+    submesh.baseVertex = vertexCount_;
+    submesh.vertexCount = vertexCount;
+
+    const auto* vertexBytes = static_cast<const BYTE*>(vertices);
+    vertexData_.insert(vertexData_.end(), vertexBytes, vertexBytes + vertexCount * vertexStride_);
+    const auto* indexBytes = static_cast<const BYTE*>(indices);
+    indexData_.insert(indexData_.end(), indexBytes, indexBytes + indexCount * indexSize_);
+
+    vertexCount_ += vertexCount;
+    indexCount_ += indexCount;
+    submeshes_.push_back(submesh);
+    return submesh;
+}
+
+void GeometryPool::Upload(ID3D12GraphicsCommandList* commandList,
+                          UploadRing& uploadRing,
+                          DefaultHeapAllocator& heapAllocator,
+                          const CpuShadow& vertexShadow,
+                          const CpuShadow& indexShadow) {
+    assert(!IsUploaded());
+
+    auto vbByteSize = static_cast<UINT>(vertexData_.size());
+    vbuffer_ = std::make_unique<VertexBuffer>(vertexStride_, vbByteSize);
+    vbuffer_->Load(commandList,
+                   uploadRing,
+                   heapAllocator,
+                   vertexData_.data(),
+                   vbByteSize,
+                   vertexShadow);
+
+    auto ibByteSize = static_cast<UINT>(indexData_.size());
+    ibuffer_ = std::make_unique<IndexBuffer>(indexFormat_, ibByteSize);
+    ibuffer_->Load(commandList,
+                   uploadRing,
+                   heapAllocator,
+                   indexData_.data(),
+                   ibByteSize,
+                   indexShadow);
+
+    // The upload ring holds its own copy until the command list executes.
+    vertexData_ = {};
+    indexData_ = {};
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "DefaultHeapBuffers.h"
+
+// Packs static meshes of one vertex format into a shared vertex buffer and index buffer.
+//
+// Add() appends a mesh to CPU-side staging arrays and returns where it landed; indices keep
+// their mesh-local values and the mesh's first vertex becomes its baseVertex. Nothing touches
+// the device until Upload(), which creates both megabuffers in one go, so all items drawn from
+// the pool share a single IA binding. Meshes must all be added before Upload().
+class GeometryPool {
+  public:
+    struct Submesh {
+        UINT indexCount = 0;
+        UINT indexStart = 0;
+        UINT baseVertex = 0;
+        UINT vertexCount = 0;
+    };
+
+    // indexFormat is DXGI_FORMAT_R16_UINT or DXGI_FORMAT_R32_UINT.
+    GeometryPool(UINT vertexStride, DXGI_FORMAT indexFormat);
+
+    GeometryPool(const GeometryPool& other) = delete;
+    GeometryPool& operator=(const GeometryPool& other) = delete;
+
+    Submesh Add(const void* vertices, UINT vertexCount, const void* indices, UINT indexCount);
+
+    template <typename V, typename I>
+    Submesh Add(const std::vector<V>& vertices, const std::vector<I>& indices) {
+        assert(sizeof(V) == vertexStride_ && sizeof(I) == indexSize_);
+        return Add(vertices.data(),
+                   static_cast<UINT>(vertices.size()),
+                   indices.data(),
+                   static_cast<UINT>(indices.size()));
+    }
+
+    // Creates the megabuffers and releases the staging arrays. The shadows choose what the
+    // buffers keep in system memory.
+    void Upload(ID3D12GraphicsCommandList* commandList,
+                UploadRing& uploadRing,
+                DefaultHeapAllocator& heapAllocator,
+                const CpuShadow& vertexShadow = {},
+                const CpuShadow& indexShadow = {});
+
+    [[nodiscard]]
+    bool IsUploaded() const { return vbuffer_ != nullptr; }
+
+    // Null until Upload().
+    [[nodiscard]]
+    VertexBuffer* GetVertexBuffer() const { return vbuffer_.get(); }
+
+    [[nodiscard]]
+    IndexBuffer* GetIndexBuffer() const { return ibuffer_.get(); }
+
+    [[nodiscard]]
+    const std::vector<Submesh>& GetSubmeshes() const { return submeshes_; }
+
+    [[nodiscard]]
+    UINT GetVertexCount() const { return vertexCount_; }
+
+    [[nodiscard]]
+    UINT GetIndexCount() const { return indexCount_; }
+
+  private:
+    UINT vertexStride_ = 0;
+    DXGI_FORMAT indexFormat_ = DXGI_FORMAT_R16_UINT;
+    UINT indexSize_ = 0;
+
+    std::vector<BYTE> vertexData_;
+    std::vector<BYTE> indexData_;
+    UINT vertexCount_ = 0;
+    UINT indexCount_ = 0;
+    std::vector<Submesh> submeshes_;
+
+    std::unique_ptr<VertexBuffer> vbuffer_;
+    std::unique_ptr<IndexBuffer> ibuffer_;
+};
@@ -0,0 +1,79 @@
+#include "Headless.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+void HeadlessSettings::ParseCommandLine(const wchar_t* commandLine) {
+    if (!commandLine) {
+        return;
+    }
+
+    std::wistringstream args(commandLine);
+    std::wstring arg;
+    auto readUnsigned = [&args](auto& field) {
+        std::wstring value;
+        if (!(args >> value)) {
+            return;
+        }
+        wchar_t* end = nullptr;
+        auto parsed = wcstoull(value.c_str(), &end, 10);
+        if (end != value.c_str() && *end == L'\0') {
+            field = static_cast<std::remove_reference_t<decltype(field)>>(parsed);
+        }
+    };
+
+    while (args >> arg) {
+        if (arg == L"-headless") {
+            enabled = true;
+        } else if (arg == L"-frames") {
+            readUnsigned(frameCount);
+        } else if (arg == L"-capture") {
+            readUnsigned(captureInterval);
+        } else if (arg == L"-out") {
+            std::wstring value;
+            if (args >> value) {
+                outputDir = value;
+            }
+        } else if (arg == L"-size") {
+            std::wstring value;
+            UINT w = 0;
+            UINT h = 0;
+            if (args >> value && swscanf_s(value.c_str(), L"%ux%u", &w, &h) == 2 && w > 0 && h > 0) {
+                width = w;
+                height = h;
+            }
+        }
+    }
+}
+
+FrameTimingLog::FrameTimingLog(const std::filesystem::path& path) {
+    if (path.has_parent_path()) {
+        std::filesystem::create_directories(path.parent_path());
+    }
+    file_.open(path);
+    if (!file_) {
+        throw std::runtime_error("Failed to open " + path.string());
+    }
+    file_ << "frame,start_ms,cpu_ms,interval_ms\n";
+}
+
+void FrameTimingLog::Record(double frameStart, double present) {
+    if (frames_ == 0) {
+        firstStart_ = frameStart;
+        lastPresent_ = frameStart;
+    }
+
+    char row[96];
+    int size = sprintf_s(row,
+                         "%llu,%.3f,%.3f,%.3f\n",
+                         frames_,
+                         (frameStart - firstStart_) * 1000.0,
+                         (present - frameStart) * 1000.0,
+                         (present - lastPresent_) * 1000.0);
+    file_.write(row, size);
+
+    lastPresent_ = present;
+    ++frames_;
+}
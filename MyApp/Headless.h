@@ -0,0 +1,45 @@
+#pragma once
+
+#include <filesystem>
+#include <fstream>
+
+#include "Common/d3dUtil.h"
+
+// Running without a window, for producing frames in batch. Apps may set these before
+// Initialize(); the command line overrides them:
+//
+//   -headless            render offscreen instead of into a window
+//   -frames N            quit after N frames (0 runs until the process is stopped)
+//   -size WxH            render target size
+//   -out DIR             where frames and timings.csv go
+//   -capture N           write every Nth frame (0 writes none, for timing runs)
+struct HeadlessSettings {
+    bool enabled = false;
+    UINT width = 1280;
+    UINT height = 720;
+    UINT64 frameCount = 600;
+    UINT captureInterval = 1;
+    std::filesystem::path outputDir = L"frames";
+
+    // Options that are missing or malformed leave their field as it was.
+    void ParseCommandLine(const wchar_t* commandLine);
+};
+
+// One CSV row per frame: its index, when it started, its CPU time from start to present, and
+// the time since the previous present.
+class FrameTimingLog {
+  public:
+    explicit FrameTimingLog(const std::filesystem::path& path);
+
+    // Times in seconds, e.g. from Timer::GetCurrentSeconds().
+    void Record(double frameStart, double present);
+
+    [[nodiscard]]
+    UINT64 GetFrameCount() const { return frames_; }
+
+  private:
+    std::ofstream file_;
+    UINT64 frames_ = 0;
+    double firstStart_ = 0.0;
+    double lastPresent_ = 0.0;
+};
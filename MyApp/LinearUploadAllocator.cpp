@@ -0,0 +1,91 @@
+#include "LinearUploadAllocator.h"
+
+using Microsoft::WRL::ComPtr;
+
+UploadMemoryBackend::Page D3D12UploadBackend::CreatePage(UINT64 size) {
+    ComPtr<ID3D12Resource> buffer;
+    auto heapProp = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+    auto desc = CD3DX12_RESOURCE_DESC::Buffer(size);
+    ThrowIfFailed(device_->CreateCommittedResource(&heapProp,
+                                                   D3D12_HEAP_FLAG_NONE,
+                                                   &desc,
+                                                   D3D12_RESOURCE_STATE_GENERIC_READ,
+                                                   nullptr,
+                                                   IID_PPV_ARGS(&buffer)));
+
+    // Upload heaps may stay mapped for their whole lifetime.
+    Page page;
+    CD3DX12_RANGE noReads(0, 0);  // write-only; see MappedWriter
+    ThrowIfFailed(buffer->Map(0, &noReads, reinterpret_cast<void**>(&page.cpu)));
+    page.gpu = buffer->GetGPUVirtualAddress();
+    page.size = size;
+
+    resources_.emplace_back(page, buffer);
+    return page;
+}
+
+void D3D12UploadBackend::ReleasePage(const Page& page) {
+    auto it = std::find_if(resources_.begin(), resources_.end(), [&](const auto& entry) {
+        return entry.first.cpu == page.cpu;
+    });
+    if (it != resources_.end()) {
+        it->second->Unmap(0, nullptr);
+        resources_.erase(it);
+    }
+}
+
+LinearUploadAllocator::LinearUploadAllocator(UploadMemoryBackend* backend, UINT64 pageSize)
+    : backend_(backend),
+      pageSize_(pageSize) {
+    AddPage(pageSize_);
+}
+
+LinearUploadAllocator::~LinearUploadAllocator() {
+    for (const auto& page : pages_) {
+        backend_->ReleasePage(page);
+    }
+}
+
+LinearUploadAllocator::Allocation LinearUploadAllocator::Allocate(UINT64 size, UINT64 alignment) {
+    auto alignUp = [alignment](UINT64 address) { return (address + alignment - 1) & ~(alignment - 1); };
+
+    // Align the GPU address, which is what the pipeline checks; the CPU pointer follows.
+    auto* page = &pages_.back();
+    UINT64 offset = alignUp(page->gpu + offset_) - page->gpu;
+    if (offset + size > page->size) {
+        bytesUsed_ += page->size - offset_;
+        AddPage(size + alignment);
+        page = &pages_.back();
+        offset = alignUp(page->gpu) - page->gpu;
+    }
+
+    Allocation allocation;
+    allocation.cpu = page->cpu + offset;
+    allocation.gpu = page->gpu + offset;
+    allocation.size = size;
+
+    bytesUsed_ += offset + size - offset_;
+    offset_ = offset + size;
+    return allocation;
+}
+
+void LinearUploadAllocator::Reset() {
+    // Fold an overflowed frame into a single page sized for it.
+    if (pages_.size() > 1) {
+        UINT64 needed = bytesUsed_;
+        for (const auto& page : pages_) {
+            backend_->ReleasePage(page);
+        }
+        pages_.clear();
+        pageSize_ = std::max(pageSize_, needed);
+        AddPage(pageSize_);
+    }
+
+    offset_ = 0;
+    bytesUsed_ = 0;
+}
+
+void LinearUploadAllocator::AddPage(UINT64 minSize) {
+    pages_.push_back(backend_->CreatePage(std::max(pageSize_, minSize)));
+    offset_ = 0;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Common/d3dUtil.h"
+#include "MappedWriter.h"
+
+// Source of CPU-writable memory the GPU can read, handed out in pages. The D3D12 backend uses
+// persistently mapped upload-heap buffers; tests can substitute plain host memory.
+class UploadMemoryBackend {
+  public:
+    struct Page {
+        BYTE* cpu = nullptr;
+        D3D12_GPU_VIRTUAL_ADDRESS gpu = 0;
+        UINT64 size = 0;
+    };
+
+    virtual ~UploadMemoryBackend() = default;
+
+    virtual Page CreatePage(UINT64 size) = 0;
+    virtual void ReleasePage(const Page& page) = 0;
+};
+
+class D3D12UploadBackend final : public UploadMemoryBackend {
+  public:
+    explicit D3D12UploadBackend(ID3D12Device* device) : device_(device) {}
+
+    Page CreatePage(UINT64 size) override;
+    void ReleasePage(const Page& page) override;
+
+  private:
+    Microsoft::WRL::ComPtr<ID3D12Device> device_;
+    std::vector<std::pair<Page, Microsoft::WRL::ComPtr<ID3D12Resource>>> resources_;
+};
+
+// Per-frame bump allocator for transient GPU-visible data such as constant buffers.
+//
+// Allocations are carved sequentially out of pages obtained from the backend. A new page is
+// started when the current one is full, so the number of allocations per frame is not fixed up
+// front. Reset() recycles everything at once and must only be called after the GPU has finished
+// with the frame that used the allocations (the frame resource's fence has completed). If a
+// frame needed more than one page, Reset() replaces them with a single page big enough for that
+// frame, so steady-state frames stay in one page.
+class LinearUploadAllocator {
+  public:
+    struct Allocation {
+        BYTE* cpu = nullptr;
+        D3D12_GPU_VIRTUAL_ADDRESS gpu = 0;
+        UINT64 size = 0;
+    };
+
+    LinearUploadAllocator(UploadMemoryBackend* backend, UINT64 pageSize);
+
+    LinearUploadAllocator(const LinearUploadAllocator& other) = delete;
+    LinearUploadAllocator& operator=(const LinearUploadAllocator& other) = delete;
+
+    ~LinearUploadAllocator();
+
+    // alignment must be a power of two.
+    [[nodiscard]]
+    Allocation Allocate(UINT64 size, UINT64 alignment = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+
+    // Copies data into a constant-buffer-aligned allocation and returns its GPU address.
+    template <typename T>
+    D3D12_GPU_VIRTUAL_ADDRESS PushConstants(const T& data) {
+        auto allocation = Allocate(d3dUtil::CalcConstantBufferByteSize(sizeof(T)));
+        MappedWriter(allocation.cpu, sizeof(T)).Write(data);
+        return allocation.gpu;
+    }
+
+    void Reset();
+
+    [[nodiscard]]
+    UINT64 GetBytesUsed() const { return bytesUsed_; }
+
+    [[nodiscard]]
+    size_t GetPageCount() const { return pages_.size(); }
+
+  private:
+    void AddPage(UINT64 minSize);
+
+    UploadMemoryBackend* backend_ = nullptr;
+    UINT64 pageSize_ = 0;
+
+    std::vector<UploadMemoryBackend::Page> pages_;
+    UINT64 offset_ = 0;     // into pages_.back()
+    UINT64 bytesUsed_ = 0;  // including alignment padding, across all pages
+};
@@ -0,0 +1,120 @@
+#include "MappedWriter.h"
+
+#include <emmintrin.h>
+
+namespace {
+
+// Non-temporal copy; dst and src need no alignment.
+void StreamCopy(BYTE* dst, const BYTE* src, size_t size) {
+    size_t head = (16 - reinterpret_cast<uintptr_t>(dst) % 16) % 16;
+    head = std::min(head, size);
+    memcpy(dst, src, head);
+    dst += head;
+    src += head;
+    size -= head;
+
+    for (; size >= 16; size -= 16, dst += 16, src += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst), v);
+    }
+    memcpy(dst, src, size);
+}
+
+}  // namespace
+
+MappedWriter::MappedWriter(void* mapped, size_t size)
+    : mapped_(static_cast<BYTE*>(mapped)),
+      size_(size) {}
+
+void MappedWriter::Write(const void* data, size_t size) {
+    assert(!closed_ && "Write after Close().");
+    assert(size <= GetRemaining() && "Write past the end of the mapping.");
+
+    const auto* src = static_cast<const BYTE*>(data);
+    BYTE* dst = mapped_ + offset_;
+    offset_ += size;
+
+    if (size >= s_streamingThreshold) {
+        FlushLine();
+        StreamCopy(dst, src, size);
+        return;
+    }
+
+    while (size > 0) {
+        // Whole lines go out straight from the source instead of through line_.
+        if (reinterpret_cast<uintptr_t>(dst) % s_lineSize == 0 && size >= s_lineSize) {
+            FlushLine();
+            size_t lines = size & ~(s_lineSize - 1);
+            StreamCopy(dst, src, lines);
+            dst += lines;
+            src += lines;
+            size -= lines;
+            continue;
+        }
+
+        auto* line = reinterpret_cast<BYTE*>(reinterpret_cast<uintptr_t>(dst) & ~(s_lineSize - 1));
+        if (line != lineAddress_) {
+            FlushLine();
+            lineAddress_ = line;
+            lineBegin_ = lineEnd_ = static_cast<size_t>(dst - line);
+        }
+
+        size_t count = std::min(size, s_lineSize - lineEnd_);
+        memcpy(line_ + lineEnd_, src, count);
+        lineEnd_ += count;
+        dst += count;
+        src += count;
+        size -= count;
+
+        if (lineEnd_ == s_lineSize) {
+            FlushLine();
+        }
+    }
+}
+
+void MappedWriter::Skip(size_t size) {
+    assert(!closed_ && "Skip after Close().");
+    assert(size <= GetRemaining() && "Skip past the end of the mapping.");
+
+    FlushLine();
+#if MAPPED_WRITER_DEBUG
+    memset(mapped_ + offset_, 0xCD, size);
+#endif
+    offset_ += size;
+}
+
+void MappedWriter::Align(size_t alignment) {
+    assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+    auto address = reinterpret_cast<uintptr_t>(mapped_ + offset_);
+    size_t padding = (alignment - address % alignment) % alignment;
+    if (padding > 0) {
+        Skip(std::min(padding, GetRemaining()));
+    }
+}
+
+void MappedWriter::Close() {
+    if (closed_) {
+        return;
+    }
+
+    FlushLine();
+    _mm_sfence();
+    closed_ = true;
+}
+
+void MappedWriter::FlushLine() {
+    if (lineAddress_ == nullptr) {
+        return;
+    }
+
+    if (lineBegin_ == 0 && lineEnd_ == s_lineSize) {
+        for (size_t i = 0; i < s_lineSize; i += 16) {
+            __m128i v = _mm_load_si128(reinterpret_cast<const __m128i*>(line_ + i));
+            _mm_stream_si128(reinterpret_cast<__m128i*>(lineAddress_ + i), v);
+        }
+    } else {
+        memcpy(lineAddress_ + lineBegin_, line_ + lineBegin_, lineEnd_ - lineBegin_);
+    }
+    lineAddress_ = nullptr;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <type_traits>
+
+#include "Common/d3dUtil.h"
+
+#if !defined(MAPPED_WRITER_DEBUG) && (defined(DEBUG) || defined(_DEBUG))
+#define MAPPED_WRITER_DEBUG 1
+#endif
+
+// Forward-only writer for persistently mapped upload-heap memory.
+//
+// Upload heaps are write-combined: stores are gathered into 64-byte line buffers and sent over
+// the bus in bursts, and nothing is cached for reading. Writing each line once, in order, is as
+// fast as it gets. Scattered or partial-line writes waste bus transactions, and reads, including
+// the hidden ones in `*p += x` or a struct built field by field in place, are uncached and
+// orders of magnitude slower.
+//
+// The writer only appends, and it never hands out a pointer into the mapping, so code that
+// writes through it cannot read the memory back. Small writes are gathered in a 64-byte line and
+// emitted as whole lines, and whole lines within a write skip the gathering; writes of
+// s_streamingThreshold bytes or more go straight out with non-temporal SSE2 stores. Close(), or the destructor, flushes the last partial line and fences
+// the streaming stores.
+//
+// MAPPED_WRITER_DEBUG (on in debug builds) also asserts on writes after Close() and fills bytes
+// passed over by Skip() and Align() with 0xCD, so data the shader reads but nobody wrote stands
+// out instead of looking like stale values from an earlier frame.
+class MappedWriter {
+  public:
+    static constexpr size_t s_lineSize = 64;
+    static constexpr size_t s_streamingThreshold = 1024;
+
+    MappedWriter(void* mapped, size_t size);
+
+    MappedWriter(const MappedWriter& other) = delete;
+    MappedWriter& operator=(const MappedWriter& other) = delete;
+
+    ~MappedWriter() { Close(); }
+
+    void Write(const void* data, size_t size);
+
+    template <typename T>
+    void Write(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "Only plain data can be written to GPU memory.");
+        // Through void, or the array overload below would take sizeof(T) as an element count.
+        Write(static_cast<const void*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    void Write(const T* values, size_t count) {
+        static_assert(std::is_trivially_copyable_v<T>, "Only plain data can be written to GPU memory.");
+        Write(static_cast<const void*>(values), count * sizeof(T));
+    }
+
+    // Moves forward without writing.
+    void Skip(size_t size);
+
+    // Moves forward to the next multiple of alignment from the start of the mapping.
+    void Align(size_t alignment);
+
+    void Close();
+
+    [[nodiscard]]
+    size_t GetOffset() const { return offset_; }
+
+    [[nodiscard]]
+    size_t GetRemaining() const { return size_ - offset_; }
+
+  private:
+    void FlushLine();
+
+    BYTE* mapped_ = nullptr;
+    size_t size_ = 0;
+    size_t offset_ = 0;
+
+    // Line being gathered: its address in the mapping and the written span [lineBegin_, lineEnd_).
+    alignas(16) BYTE line_[s_lineSize];
+    BYTE* lineAddress_ = nullptr;
+    size_t lineBegin_ = 0;
+    size_t lineEnd_ = 0;
+
+    bool closed_ = false;
+};
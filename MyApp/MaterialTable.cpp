@@ -0,0 +1,41 @@
+#include "MaterialTable.h"
+
+UINT MaterialTable::Add(Material* mat) {
+    UINT slot;
+    if (!freeSlots_.empty()) {
+        slot = freeSlots_.back();
+        freeSlots_.pop_back();
+        slots_[slot] = mat;
+    } else {
+        slot = static_cast<UINT>(slots_.size());
+        slots_.push_back(mat);
+    }
+
+    mat->MatCBIndex = static_cast<int>(slot);
+    return slot;
+}
+
+void MaterialTable::Remove(Material* mat) {
+    assert(mat->MatCBIndex >= 0 && static_cast<size_t>(mat->MatCBIndex) < slots_.size());
+    assert(slots_[mat->MatCBIndex] == mat);
+
+    slots_[mat->MatCBIndex] = nullptr;
+    freeSlots_.push_back(static_cast<UINT>(mat->MatCBIndex));
+    mat->MatCBIndex = -1;
+}
+
+void MaterialTable::Pack(MappedWriter& writer) const {
+    for (const Material* mat : slots_) {
+        writer.Write(mat ? ToData(*mat) : MaterialData{});
+    }
+}
+
+MaterialData MaterialTable::ToData(const Material& mat) {
+    MaterialData data;
+    data.DiffuseAlbedo = mat.DiffuseAlbedo;
+    data.FresnelR0 = mat.FresnelR0;
+    data.Roughness = mat.Roughness;
+    data.MatTransform = mat.MatTransform;
+    data.DiffuseMapIndex = static_cast<UINT>(std::max(mat.DiffuseSrvHeapIndex, 0));
+    return data;
+}
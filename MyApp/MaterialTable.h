@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+
+#include "Common/d3dUtil.h"
+#include "MappedWriter.h"
+
+// One material in the bindless material buffer. Mirrors MaterialData in the shaders; structured
+// buffers are tightly packed, so the padding only rounds the stride up to 16 bytes.
+struct MaterialData {
+    DirectX::XMFLOAT4 DiffuseAlbedo = {1.0f, 1.0f, 1.0f, 1.0f};
+    DirectX::XMFLOAT3 FresnelR0 = {0.01f, 0.01f, 0.01f};
+    float Roughness = 0.25f;
+    DirectX::XMFLOAT4X4 MatTransform = MathHelper::Identity4x4();
+    UINT DiffuseMapIndex = 0;  // into the bindless texture range
+    UINT Pad[3] = {};
+};
+static_assert(sizeof(MaterialData) == 112, "MaterialData must match the shader layout");
+
+// Assigns materials their slot in the bindless material buffer and packs them into it.
+//
+// The slot is written to Material::MatCBIndex, so the same index works for the per-draw constant
+// buffer path. Slots of removed materials are reused. DiffuseSrvHeapIndex is taken as an index
+// into the bindless texture range, which starts at the first descriptor of the heap.
+class MaterialTable {
+  public:
+    UINT Add(Material* mat);
+
+    void Remove(Material* mat);
+
+    // The material in slot, or null for a hole.
+    [[nodiscard]]
+    Material* Get(UINT slot) const { return slot < slots_.size() ? slots_[slot] : nullptr; }
+
+    // Slots including holes left by Remove(); the size Pack() writes.
+    [[nodiscard]]
+    UINT GetCount() const { return static_cast<UINT>(slots_.size()); }
+
+    // Writes GetCount() entries in slot order; holes get default data.
+    void Pack(MappedWriter& writer) const;
+
+    [[nodiscard]]
+    static MaterialData ToData(const Material& mat);
+
+  private:
+    std::vector<Material*> slots_;
+    std::vector<UINT> freeSlots_;
+};
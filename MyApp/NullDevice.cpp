@@ -0,0 +1,202 @@
+#include "NullDevice.h"
+
+#include <algorithm>
+
+namespace {
+
+// Hands out addresses 64 KB apart, well away from 0.
+D3D12_GPU_VIRTUAL_ADDRESS NextGpuAddress() {
+    static std::atomic<D3D12_GPU_VIRTUAL_ADDRESS> next{0x10000000};
+    return next.fetch_add(D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+}
+
+template <typename T>
+Microsoft::WRL::ComPtr<T> MakeNull(T* object) {
+    Microsoft::WRL::ComPtr<T> ptr;
+    ptr.Attach(object);
+    return ptr;
+}
+
+}  // namespace
+
+NullResource::NullResource(const D3D12_RESOURCE_DESC& desc)
+    : desc_(desc),
+      gpuAddress_(NextGpuAddress()) {}
+
+HRESULT NullResource::Map(UINT, const D3D12_RANGE*, void** data) {
+    if (data) {
+        *data = nullptr;
+    }
+    return E_NOTIMPL;
+}
+
+RecordingCommandList::Counts& RecordingCommandList::Counts::operator+=(const Counts& other) {
+    draws += other.draws;
+    dispatches += other.dispatches;
+    copies += other.copies;
+    barriers += other.barriers;
+    clears += other.clears;
+    stateChanges += other.stateChanges;
+    return *this;
+}
+
+HRESULT RecordingCommandList::Close() {
+    if (!open_) {
+        return E_FAIL;
+    }
+    open_ = false;
+    return S_OK;
+}
+
+HRESULT RecordingCommandList::Reset(ID3D12CommandAllocator*, ID3D12PipelineState*) {
+    if (open_) {
+        return E_FAIL;
+    }
+    open_ = true;
+    counts_ = {};
+    return S_OK;
+}
+
+void NullFenceBackend::Signal(UINT64 value) {
+    std::lock_guard lock(mutex_);
+    assert((inFlight_.empty() ? completed_ : inFlight_.back()) < value);
+    inFlight_.push_back(value);
+    while (inFlight_.size() > latency_) {
+        completed_ = inFlight_.front();
+        inFlight_.pop_front();
+    }
+}
+
+UINT64 NullFenceBackend::GetCompletedValue() {
+    std::lock_guard lock(mutex_);
+    return completed_;
+}
+
+void NullFenceBackend::Wait(UINT64 value) {
+    std::lock_guard lock(mutex_);
+    ++waits_;
+    while (!inFlight_.empty() && inFlight_.front() <= value) {
+        completed_ = inFlight_.front();
+        inFlight_.pop_front();
+    }
+    completed_ = std::max(completed_, value);
+}
+
+void NullCommandContextBackend::Create(CommandContext& context, ID3D12PipelineState* initialState) {
+    context.allocator.Reset();
+    context.commandList = MakeNull(new RecordingCommandList());
+}
+
+void NullCommandContextBackend::Reset(CommandContext& context, ID3D12PipelineState* initialState) {
+    ThrowIfFailed(context.commandList->Reset(nullptr, initialState));
+}
+
+CommandListBackend::List NullCommandListBackend::Open() {
+    std::lock_guard lock(mutex_);
+    if (openCount_ == lists_.size()) {
+        lists_.push_back(MakeNull(new RecordingCommandList()));
+        ++stats_.lists;
+    } else {
+        ThrowIfFailed(lists_[openCount_]->Reset(nullptr, nullptr));
+    }
+    UINT slot = openCount_++;
+    return {slot, lists_[slot].Get()};
+}
+
+void NullCommandListBackend::Close(UINT slot) {
+    ThrowIfFailed(lists_[slot]->Close());
+}
+
+void NullCommandListBackend::Submit(const std::vector<UINT>& slots) {
+    std::lock_guard lock(mutex_);
+    for (UINT slot : slots) {
+        assert(!lists_[slot]->IsOpen() && "Close lists before submitting them.");
+        stats_.counts += lists_[slot]->GetCounts();
+    }
+    ++stats_.submissions;
+}
+
+void NullCommandListBackend::EndFrame(UINT64 fenceValue) {
+    std::lock_guard lock(mutex_);
+    openCount_ = 0;
+}
+
+NullCopyQueueBackend::NullCopyQueueBackend(UINT latency)
+    : fence_(latency),
+      list_(MakeNull(new RecordingCommandList())) {
+    ThrowIfFailed(list_->Close());
+}
+
+ID3D12GraphicsCommandList* NullCopyQueueBackend::Open() {
+    if (!list_->IsOpen()) {
+        ThrowIfFailed(list_->Reset(nullptr, nullptr));
+    }
+    return list_.Get();
+}
+
+void NullCopyQueueBackend::Submit(UINT64 fenceValue) {
+    if (list_->IsOpen()) {
+        ThrowIfFailed(list_->Close());
+        counts_ += list_->GetCounts();
+    }
+    fence_.Signal(fenceValue);
+}
+
+D3D12_RESOURCE_ALLOCATION_INFO NullFrameGraphBackend::GetAllocationInfo(const D3D12_RESOURCE_DESC& desc) {
+    constexpr UINT64 alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+    UINT64 size = desc.Width;
+    if (desc.Dimension != D3D12_RESOURCE_DIMENSION_BUFFER) {
+        size *= static_cast<UINT64>(desc.Height) * desc.DepthOrArraySize * 8;
+    }
+    return {(size + alignment - 1) / alignment * alignment, alignment};
+}
+
+void NullFrameGraphBackend::BeginTransients(UINT64 heapSize, UINT64 heapAlignment, UINT count) {
+    heapSize_ = heapSize;
+    transients_.clear();
+    transients_.resize(count);
+}
+
+ID3D12Resource* NullFrameGraphBackend::CreateTransient(UINT index,
+                                                       UINT64 offset,
+                                                       const D3D12_RESOURCE_DESC& desc,
+                                                       const D3D12_CLEAR_VALUE* clearValue,
+                                                       D3D12_RESOURCE_STATES state) {
+    assert(offset + GetAllocationInfo(desc).SizeInBytes <= heapSize_);
+    transients_[index] = MakeNull(new NullResource(desc));
+    return transients_[index].Get();
+}
+
+NullPresentTarget::NullPresentTarget(DXGI_FORMAT format, int width, int height, int bufferCount)
+    : format_(format),
+      width_(width),
+      height_(height),
+      buffers_(bufferCount) {
+    assert(bufferCount >= 1);
+    CreateBuffers();
+}
+
+void NullPresentTarget::ResetAllBuffers() {
+    for (auto& buffer : buffers_) {
+        buffer.Reset();
+    }
+}
+
+HRESULT NullPresentTarget::Resize(int clientWidth, int clientHeight) {
+    width_ = clientWidth;
+    height_ = clientHeight;
+    return S_OK;
+}
+
+void NullPresentTarget::CreateRtvs(ID3D12Device* device) {
+    CreateBuffers();
+}
+
+void NullPresentTarget::CreateBuffers() {
+    auto desc = CD3DX12_RESOURCE_DESC::Tex2D(format_, width_, height_, 1, 1);
+    desc.Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
+    for (auto& buffer : buffers_) {
+        buffer = MakeNull(new NullResource(desc));
+    }
+    current_ = 0;
+}
@@ -0,0 +1,493 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "Common/d3dUtil.h"
+#include "CommandContextPool.h"
+#include "CopyUploader.h"
+#include "FrameGraph.h"
+#include "FramePacer.h"
+#include "ParallelRecorder.h"
+#include "PresentTarget.h"
+
+// Stand-ins for the GPU behind the frame loop's backends, so that updating, recording,
+// submitting and pacing run without a device: CPU-side throughput benchmarks, or the loop logic
+// on a machine with no D3D12 driver. Nothing is drawn. Command lists only count what they are
+// asked to record, resources are placeholders that hold no memory, and fences complete a fixed
+// number of signals late, like a GPU that many frames behind.
+//
+// None of these needs a device, only the D3D12 headers. TestNullFrameLoop() in the test project
+// runs the frame loop on them and reports its throughput.
+
+// IUnknown, ID3D12Object and ID3D12DeviceChild for the placeholders. Reference counted like any
+// COM object: create with new and hand to a ComPtr with Attach().
+template <typename Interface>
+class NullDeviceChild : public Interface {
+  public:
+    virtual ~NullDeviceChild() = default;
+
+    HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** object) override {
+        if (!object) {
+            return E_POINTER;
+        }
+        if (riid == __uuidof(Interface) || riid == __uuidof(ID3D12DeviceChild) ||
+            riid == __uuidof(ID3D12Object) || riid == __uuidof(IUnknown)) {
+            *object = static_cast<Interface*>(this);
+            AddRef();
+            return S_OK;
+        }
+        *object = nullptr;
+        return E_NOINTERFACE;
+    }
+
+    ULONG STDMETHODCALLTYPE AddRef() override { return ++refCount_; }
+
+    ULONG STDMETHODCALLTYPE Release() override {
+        ULONG count = --refCount_;
+        if (count == 0) {
+            delete this;
+        }
+        return count;
+    }
+
+    HRESULT STDMETHODCALLTYPE GetPrivateData(REFGUID, UINT*, void*) override { return E_NOTIMPL; }
+
+    HRESULT STDMETHODCALLTYPE SetPrivateData(REFGUID, UINT, const void*) override { return E_NOTIMPL; }
+
+    HRESULT STDMETHODCALLTYPE SetPrivateDataInterface(REFGUID, const IUnknown*) override { return E_NOTIMPL; }
+
+    HRESULT STDMETHODCALLTYPE SetName(LPCWSTR) override { return S_OK; }
+
+    HRESULT STDMETHODCALLTYPE GetDevice(REFIID, void** device) override {
+        if (device) {
+            *device = nullptr;
+        }
+        return E_NOTIMPL;
+    }
+
+  private:
+    std::atomic<ULONG> refCount_{1};
+};
+
+// A resource with a description and nothing behind it. Map() fails; the GPU address is made up
+// but distinct per resource.
+class NullResource final : public NullDeviceChild<ID3D12Resource> {
+  public:
+    explicit NullResource(const D3D12_RESOURCE_DESC& desc);
+
+    HRESULT STDMETHODCALLTYPE Map(UINT, const D3D12_RANGE*, void** data) override;
+
+    void STDMETHODCALLTYPE Unmap(UINT, const D3D12_RANGE*) override {}
+
+    D3D12_RESOURCE_DESC STDMETHODCALLTYPE GetDesc() override { return desc_; }
+
+    D3D12_GPU_VIRTUAL_ADDRESS STDMETHODCALLTYPE GetGPUVirtualAddress() override { return gpuAddress_; }
+
+    HRESULT STDMETHODCALLTYPE WriteToSubresource(UINT, const D3D12_BOX*, const void*, UINT, UINT) override {
+        return E_NOTIMPL;
+    }
+
+    HRESULT STDMETHODCALLTYPE ReadFromSubresource(void*, UINT, UINT, UINT, const D3D12_BOX*) override {
+        return E_NOTIMPL;
+    }
+
+    HRESULT STDMETHODCALLTYPE GetHeapProperties(D3D12_HEAP_PROPERTIES*, D3D12_HEAP_FLAGS*) override {
+        return E_NOTIMPL;
+    }
+
+  private:
+    D3D12_RESOURCE_DESC desc_{};
+    D3D12_GPU_VIRTUAL_ADDRESS gpuAddress_ = 0;
+};
+
+// A direct list that only counts the calls made on it. Like a real list, one thread records into
+// it at a time.
+class RecordingCommandList final : public NullDeviceChild<ID3D12GraphicsCommandList> {
+  public:
+    struct Counts {
+        UINT64 draws = 0;
+        UINT64 dispatches = 0;
+        UINT64 copies = 0;
+        UINT64 barriers = 0;  // individual barriers, not ResourceBarrier() calls
+        UINT64 clears = 0;
+        UINT64 stateChanges = 0;  // pipeline, root signature, root argument and IA/RS/OM bindings
+
+        Counts& operator+=(const Counts& other);
+    };
+
+    [[nodiscard]]
+    const Counts& GetCounts() const { return counts_; }
+
+    [[nodiscard]]
+    bool IsOpen() const { return open_; }
+
+    D3D12_COMMAND_LIST_TYPE STDMETHODCALLTYPE GetType() override { return D3D12_COMMAND_LIST_TYPE_DIRECT; }
+
+    HRESULT STDMETHODCALLTYPE Close() override;
+
+    // Clears the counts.
+    HRESULT STDMETHODCALLTYPE Reset(ID3D12CommandAllocator*, ID3D12PipelineState*) override;
+
+    void STDMETHODCALLTYPE ClearState(ID3D12PipelineState*) override { ++counts_.stateChanges; }
+
+    void STDMETHODCALLTYPE DrawInstanced(UINT, UINT, UINT, UINT) override { ++counts_.draws; }
+
+    void STDMETHODCALLTYPE DrawIndexedInstanced(UINT, UINT, UINT, INT, UINT) override { ++counts_.draws; }
+
+    void STDMETHODCALLTYPE Dispatch(UINT, UINT, UINT) override { ++counts_.dispatches; }
+
+    void STDMETHODCALLTYPE CopyBufferRegion(ID3D12Resource*, UINT64, ID3D12Resource*, UINT64, UINT64) override {
+        ++counts_.copies;
+    }
+
+    void STDMETHODCALLTYPE CopyTextureRegion(const D3D12_TEXTURE_COPY_LOCATION*,
+                                             UINT,
+                                             UINT,
+                                             UINT,
+                                             const D3D12_TEXTURE_COPY_LOCATION*,
+                                             const D3D12_BOX*) override {
+        ++counts_.copies;
+    }
+
+    void STDMETHODCALLTYPE CopyResource(ID3D12Resource*, ID3D12Resource*) override { ++counts_.copies; }
+
+    void STDMETHODCALLTYPE CopyTiles(ID3D12Resource*,
+                                     const D3D12_TILED_RESOURCE_COORDINATE*,
+                                     const D3D12_TILE_REGION_SIZE*,
+                                     ID3D12Resource*,
+                                     UINT64,
+                                     D3D12_TILE_COPY_FLAGS) override {
+        ++counts_.copies;
+    }
+
+    void STDMETHODCALLTYPE ResolveSubresource(ID3D12Resource*,
+                                              UINT,
+                                              ID3D12Resource*,
+                                              UINT,
+                                              DXGI_FORMAT) override {
+        ++counts_.copies;
+    }
+
+    void STDMETHODCALLTYPE IASetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY) override { ++counts_.stateChanges; }
+
+    void STDMETHODCALLTYPE RSSetViewports(UINT, const D3D12_VIEWPORT*) override { ++counts_.stateChanges; }
+
+    void STDMETHODCALLTYPE RSSetScissorRects(UINT, const D3D12_RECT*) override { ++counts_.stateChanges; }
+
+    void STDMETHODCALLTYPE OMSetBlendFactor(const FLOAT[4]) override { ++counts_.stateChanges; }
+
+    void STDMETHODCALLTYPE OMSetStencilRef(UINT) override { ++counts_.stateChanges; }
+
+    void STDMETHODCALLTYPE SetPipelineState(ID3D12PipelineState*) override { ++counts_.stateChanges; }
+
+    void STDMETHODCALLTYPE ResourceBarrier(UINT count, const D3D12_RESOURCE_BARRIER*) override {
+        counts_.barriers += count;
+    }
+
+    void STDMETHODCALLTYPE ExecuteBundle(ID3D12GraphicsCommandList*) override { ++counts_.draws; }
+
+    void STDMETHODCALLTYPE SetDescriptorHeaps(UINT, ID3D12DescriptorHeap* const*) override {
+        ++counts_.stateChanges;
+    }
+
+    void STDMETHODCALLTYPE SetComputeRootSignature(ID3D12RootSignature*) override { ++counts_.stateChanges; }
+
+    void STDMETHODCALLTYPE SetGraphicsRootSignature(ID3D12RootSignature*) override { ++counts_.stateChanges; }
+
+    void STDMETHODCALLTYPE SetComputeRootDescriptorTable(UINT, D3D12_GPU_DESCRIPTOR_HANDLE) override {
+        ++counts_.stateChanges;
+    }
+
+    void STDMETHODCALLTYPE SetGraphicsRootDescriptorTable(UINT, D3D12_GPU_DESCRIPTOR_HANDLE) override {
+        ++counts_.stateChanges;
+    }
+
+    void STDMETHODCALLTYPE SetComputeRoot32BitConstant(UINT, UINT, UINT) override { ++counts_.stateChanges; }
+
+    void STDMETHODCALLTYPE SetGraphicsRoot32BitConstant(UINT, UINT, UINT) override { ++counts_.stateChanges; }
+
+    void STDMETHODCALLTYPE SetComputeRoot32BitConstants(UINT, UINT, const void*, UINT) override {
+        ++counts_.stateChanges;
+    }
+
+    void STDMETHODCALLTYPE SetGraphicsRoot32BitConstants(UINT, UINT, const void*, UINT) override {
+        ++counts_.stateChanges;
+    }
+
+    void STDMETHODCALLTYPE SetComputeRootConstantBufferView(UINT, D3D12_GPU_VIRTUAL_ADDRESS) override {
+        ++counts_.stateChanges;
+    }
+
+    void STDMETHODCALLTYPE SetGraphicsRootConstantBufferView(UINT, D3D12_GPU_VIRTUAL_ADDRESS) override {
+        ++counts_.stateChanges;
+    }
+
+    void STDMETHODCALLTYPE SetComputeRootShaderResourceView(UINT, D3D12_GPU_VIRTUAL_ADDRESS) override {
+        ++counts_.stateChanges;
+    }
+
+    void STDMETHODCALLTYPE SetGraphicsRootShaderResourceView(UINT, D3D12_GPU_VIRTUAL_ADDRESS) override {
+        ++counts_.stateChanges;
+    }
+
+    void STDMETHODCALLTYPE SetComputeRootUnorderedAccessView(UINT, D3D12_GPU_VIRTUAL_ADDRESS) override {
+        ++counts_.stateChanges;
+    }
+
+    void STDMETHODCALLTYPE SetGraphicsRootUnorderedAccessView(UINT, D3D12_GPU_VIRTUAL_ADDRESS) override {
+        ++counts_.stateChanges;
+    }
+
+    void STDMETHODCALLTYPE IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW*) override { ++counts_.stateChanges; }
+
+    void STDMETHODCALLTYPE IASetVertexBuffers(UINT, UINT, const D3D12_VERTEX_BUFFER_VIEW*) override {
+        ++counts_.stateChanges;
+    }
+
+    void STDMETHODCALLTYPE SOSetTargets(UINT, UINT, const D3D12_STREAM_OUTPUT_BUFFER_VIEW*) override {
+        ++counts_.stateChanges;
+    }
+
+    void STDMETHODCALLTYPE OMSetRenderTargets(UINT,
+                                              const D3D12_CPU_DESCRIPTOR_HANDLE*,
+                                              BOOL,
+                                              const D3D12_CPU_DESCRIPTOR_HANDLE*) override {
+        ++counts_.stateChanges;
+    }
+
+    void STDMETHODCALLTYPE ClearDepthStencilView(D3D12_CPU_DESCRIPTOR_HANDLE,
+                                                 D3D12_CLEAR_FLAGS,
+                                                 FLOAT,
+                                                 UINT8,
+                                                 UINT,
+                                                 const D3D12_RECT*) override {
+        ++counts_.clears;
+    }
+
+    void STDMETHODCALLTYPE ClearRenderTargetView(D3D12_CPU_DESCRIPTOR_HANDLE,
+                                                 const FLOAT[4],
+                                                 UINT,
+                                                 const D3D12_RECT*) override {
+        ++counts_.clears;
+    }
+
+    void STDMETHODCALLTYPE ClearUnorderedAccessViewUint(D3D12_GPU_DESCRIPTOR_HANDLE,
+                                                        D3D12_CPU_DESCRIPTOR_HANDLE,
+                                                        ID3D12Resource*,
+                                                        const UINT[4],
+                                                        UINT,
+                                                        const D3D12_RECT*) override {
+        ++counts_.clears;
+    }
+
+    void STDMETHODCALLTYPE ClearUnorderedAccessViewFloat(D3D12_GPU_DESCRIPTOR_HANDLE,
+                                                         D3D12_CPU_DESCRIPTOR_HANDLE,
+                                                         ID3D12Resource*,
+                                                         const FLOAT[4],
+                                                         UINT,
+                                                         const D3D12_RECT*) override {
+        ++counts_.clears;
+    }
+
+    void STDMETHODCALLTYPE DiscardResource(ID3D12Resource*, const D3D12_DISCARD_REGION*) override {
+        ++counts_.clears;
+    }
+
+    void STDMETHODCALLTYPE BeginQuery(ID3D12QueryHeap*, D3D12_QUERY_TYPE, UINT) override {}
+
+    void STDMETHODCALLTYPE EndQuery(ID3D12QueryHeap*, D3D12_QUERY_TYPE, UINT) override {}
+
+    void STDMETHODCALLTYPE ResolveQueryData(ID3D12QueryHeap*,
+                                            D3D12_QUERY_TYPE,
+                                            UINT,
+                                            UINT,
+                                            ID3D12Resource*,
+                                            UINT64) override {
+        ++counts_.copies;
+    }
+
+    void STDMETHODCALLTYPE SetPredication(ID3D12Resource*, UINT64, D3D12_PREDICATION_OP) override {
+        ++counts_.stateChanges;
+    }
+
+    void STDMETHODCALLTYPE SetMarker(UINT, const void*, UINT) override {}
+
+    void STDMETHODCALLTYPE BeginEvent(UINT, const void*, UINT) override {}
+
+    void STDMETHODCALLTYPE EndEvent() override {}
+
+    void STDMETHODCALLTYPE ExecuteIndirect(ID3D12CommandSignature*,
+                                           UINT,
+                                           ID3D12Resource*,
+                                           UINT64,
+                                           ID3D12Resource*,
+                                           UINT64) override {
+        ++counts_.draws;
+    }
+
+  private:
+    Counts counts_;
+    bool open_ = true;
+};
+
+// Signalled values complete once latency further values have been signalled after them, so with
+// one signal per frame the "GPU" runs latency frames behind. Wait() completes the value at once,
+// as if the CPU had blocked until the GPU caught up. Safe to use from several threads.
+class NullFenceBackend final : public FenceBackend {
+  public:
+    explicit NullFenceBackend(UINT latency = 0) : latency_(latency) {}
+
+    // Values must increase.
+    void Signal(UINT64 value);
+
+    UINT64 GetCompletedValue() override;
+
+    void Wait(UINT64 value) override;
+
+    [[nodiscard]]
+    UINT64 GetWaitCount() const { return waits_; }
+
+  private:
+    std::mutex mutex_;
+    UINT latency_ = 0;
+    std::deque<UINT64> inFlight_;  // signalled, not yet completed; oldest first
+    UINT64 completed_ = 0;
+    std::atomic<UINT64> waits_{0};
+};
+
+// Fills contexts with recording lists and no allocators, for running CommandContextPool.
+class NullCommandContextBackend final : public CommandContextBackend {
+  public:
+    void Create(CommandContext& context, ID3D12PipelineState* initialState) override;
+
+    void Reset(CommandContext& context, ID3D12PipelineState* initialState) override;
+};
+
+// Recording lists for ParallelRecorder. Submit() adds up what the submitted lists recorded.
+class NullCommandListBackend final : public CommandListBackend {
+  public:
+    struct Stats {
+        UINT64 lists = 0;
+        UINT64 submissions = 0;
+        RecordingCommandList::Counts counts;
+    };
+
+    List Open() override;
+
+    void Close(UINT slot) override;
+
+    void Submit(const std::vector<UINT>& slots) override;
+
+    void EndFrame(UINT64 fenceValue) override;
+
+    [[nodiscard]]
+    const Stats& GetStats() const { return stats_; }
+
+  private:
+    std::mutex mutex_;
+    std::vector<Microsoft::WRL::ComPtr<RecordingCommandList>> lists_;  // reused every frame
+    UINT openCount_ = 0;  // lists_ handed out this frame
+
+    Stats stats_;
+};
+
+// A copy queue whose batches complete latency batches late.
+class NullCopyQueueBackend final : public CopyQueueBackend {
+  public:
+    explicit NullCopyQueueBackend(UINT latency = 0);
+
+    ID3D12GraphicsCommandList* Open() override;
+
+    void Submit(UINT64 fenceValue) override;
+
+    void InsertWait(ID3D12CommandQueue* queue, UINT64 fenceValue) override {}
+
+    UINT64 GetCompletedValue() override { return fence_.GetCompletedValue(); }
+
+    void Wait(UINT64 value) override { fence_.Wait(value); }
+
+    [[nodiscard]]
+    const RecordingCommandList::Counts& GetCounts() const { return counts_; }
+
+  private:
+    NullFenceBackend fence_;
+    Microsoft::WRL::ComPtr<RecordingCommandList> list_;
+    RecordingCommandList::Counts counts_;
+};
+
+// Placeholder transients for FrameGraph. Allocation sizes assume 8 bytes per texel of the top mip,
+// rounded to 64 KB like a real heap, so placement and aliasing behave about as they would on a
+// device.
+class NullFrameGraphBackend final : public FrameGraphBackend {
+  public:
+    D3D12_RESOURCE_ALLOCATION_INFO GetAllocationInfo(const D3D12_RESOURCE_DESC& desc) override;
+
+    void BeginTransients(UINT64 heapSize, UINT64 heapAlignment, UINT count) override;
+
+    ID3D12Resource* CreateTransient(UINT index,
+                                    UINT64 offset,
+                                    const D3D12_RESOURCE_DESC& desc,
+                                    const D3D12_CLEAR_VALUE* clearValue,
+                                    D3D12_RESOURCE_STATES state) override;
+
+    D3D12_CPU_DESCRIPTOR_HANDLE GetView(UINT index) override { return {index + 1}; }
+
+    void EndFrame(UINT64 fenceValue) override {}
+
+    [[nodiscard]]
+    UINT64 GetHeapSize() const { return heapSize_; }
+
+  private:
+    UINT64 heapSize_ = 0;
+    std::vector<Microsoft::WRL::ComPtr<NullResource>> transients_;
+};
+
+// Placeholder back buffers that are never shown. Views are made-up handles; nothing may write
+// through them.
+class NullPresentTarget final : public PresentTarget {
+  public:
+    NullPresentTarget(DXGI_FORMAT format, int width, int height, int bufferCount = 2);
+
+    int BufferCount() const override { return static_cast<int>(buffers_.size()); }
+
+    DXGI_FORMAT GetFormat() const override { return format_; }
+
+    ID3D12Resource* GetCurrentBackBuffer() const override { return buffers_[current_].Get(); }
+
+    ID3D12Resource* GetBuffer(int i) const override { return buffers_[i].Get(); }
+
+    D3D12_CPU_DESCRIPTOR_HANDLE GetCurrentBackBufferView() const override {
+        return {static_cast<SIZE_T>(current_) + 1};
+    }
+
+    void ResetAllBuffers() override;
+
+    HRESULT Resize(int clientWidth, int clientHeight) override;
+
+    void CreateRtvs(ID3D12Device* device) override;
+
+    HRESULT Present() override {
+        ++presents_;
+        return S_OK;
+    }
+
+    void SwapBuffers() override { current_ = (current_ + 1) % BufferCount(); }
+
+    void WaitForNextFrame() override {}
+
+    [[nodiscard]]
+    UINT64 GetPresentCount() const { return presents_; }
+
+  private:
+    void CreateBuffers();
+
+    DXGI_FORMAT format_;
+    int width_ = 0;
+    int height_ = 0;
+    std::vector<Microsoft::WRL::ComPtr<NullResource>> buffers_;
+    int current_ = 0;
+    UINT64 presents_ = 0;
+};
@@ -0,0 +1,183 @@
+#include "OffscreenTarget.h"
+
+#include <cstdio>
+#include <fstream>
+
+OffscreenTarget::OffscreenTarget(ID3D12Device* device,
+                                 ID3D12CommandQueue* commandQueue,
+                                 DXGI_FORMAT format,
+                                 int width,
+                                 int height,
+                                 const Settings& settings)
+    : device_(device),
+      commandQueue_(commandQueue),
+      settings_(settings),
+      format_(format),
+      width_(width),
+      height_(height),
+      buffers_(settings.bufferCount) {
+    assert(settings_.bufferCount >= 1);
+
+    if (settings_.captureInterval > 0) {
+        bool rgba = format_ == DXGI_FORMAT_R8G8B8A8_UNORM || format_ == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+        bool bgra = format_ == DXGI_FORMAT_B8G8R8A8_UNORM || format_ == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB;
+        if (!rgba && !bgra) {
+            ThrowIfFailed(E_INVALIDARG);
+        }
+        std::filesystem::create_directories(settings_.outputDir);
+    }
+
+    ThrowIfFailed(device_->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(fence_.GetAddressOf())));
+    fenceBackend_ = std::make_unique<D3D12FenceBackend>(fence_.Get());
+
+    for (auto& buffer : buffers_) {
+        ThrowIfFailed(device_->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT,
+                                                      IID_PPV_ARGS(buffer.allocator.GetAddressOf())));
+    }
+    ThrowIfFailed(device_->CreateCommandList(0,
+                                             D3D12_COMMAND_LIST_TYPE_DIRECT,
+                                             buffers_[0].allocator.Get(),
+                                             nullptr,
+                                             IID_PPV_ARGS(commandList_.GetAddressOf())));
+    ThrowIfFailed(commandList_->Close());
+
+    D3D12_DESCRIPTOR_HEAP_DESC rtvHeapDesc{};
+    rtvHeapDesc.NumDescriptors = settings_.bufferCount;
+    rtvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
+    rtvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+    rtvHeapDesc.NodeMask = 0;
+    rtvHeap_ = std::make_unique<DescriptorHeap>(device_.Get(), rtvHeapDesc);
+
+    CreateBuffers();
+}
+
+OffscreenTarget::~OffscreenTarget() {
+    ResetAllBuffers();
+}
+
+void OffscreenTarget::ResetAllBuffers() {
+    for (auto& buffer : buffers_) {
+        if (buffer.captureFence) {
+            WriteCapture(buffer);
+        }
+        buffer.texture.Reset();
+        buffer.readback.Reset();
+    }
+}
+
+HRESULT OffscreenTarget::Resize(int clientWidth, int clientHeight) {
+    width_ = clientWidth;
+    height_ = clientHeight;
+    return S_OK;
+}
+
+void OffscreenTarget::CreateRtvs(ID3D12Device* device) {
+    assert(device == device_.Get());
+    (void)device;
+    CreateBuffers();
+}
+
+void OffscreenTarget::CreateBuffers() {
+    auto desc = CD3DX12_RESOURCE_DESC::Tex2D(format_, width_, height_, 1, 1);
+    desc.Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
+
+    UINT64 readbackSize = 0;
+    device_->GetCopyableFootprints(&desc, 0, 1, 0, &footprint_, nullptr, nullptr, &readbackSize);
+
+    auto defaultHeap = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+    auto readbackHeap = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_READBACK);
+    auto readbackDesc = CD3DX12_RESOURCE_DESC::Buffer(readbackSize);
+
+    for (int i = 0; i < settings_.bufferCount; ++i) {
+        auto& buffer = buffers_[i];
+
+        // COMMON is PRESENT, the state swap chain buffers start in.
+        ThrowIfFailed(
+            device_->CreateCommittedResource(&defaultHeap,
+                                             D3D12_HEAP_FLAG_NONE,
+                                             &desc,
+                                             D3D12_RESOURCE_STATE_COMMON,
+                                             nullptr,
+                                             IID_PPV_ARGS(buffer.texture.ReleaseAndGetAddressOf())));
+        device_->CreateRenderTargetView(buffer.texture.Get(),
+                                        nullptr,
+                                        rtvHeap_->GetDescriptorHandleCpu(i));
+
+        if (settings_.captureInterval > 0) {
+            ThrowIfFailed(
+                device_->CreateCommittedResource(&readbackHeap,
+                                                 D3D12_HEAP_FLAG_NONE,
+                                                 &readbackDesc,
+                                                 D3D12_RESOURCE_STATE_COPY_DEST,
+                                                 nullptr,
+                                                 IID_PPV_ARGS(buffer.readback.ReleaseAndGetAddressOf())));
+        }
+    }
+    current_ = 0;
+}
+
+HRESULT OffscreenTarget::Present() {
+    ++frame_;
+    if (settings_.captureInterval == 0 || frame_ % settings_.captureInterval != 0) {
+        return S_OK;
+    }
+
+    auto& buffer = buffers_[current_];
+    if (buffer.captureFence) {
+        WriteCapture(buffer);
+    }
+
+    // The buffer was left in PRESENT (COMMON); the copy promotes it to COPY_SOURCE and it decays
+    // back once executed, so no barriers.
+    ThrowIfFailed(buffer.allocator->Reset());
+    ThrowIfFailed(commandList_->Reset(buffer.allocator.Get(), nullptr));
+    CD3DX12_TEXTURE_COPY_LOCATION dst(buffer.readback.Get(), footprint_);
+    CD3DX12_TEXTURE_COPY_LOCATION src(buffer.texture.Get(), 0);
+    commandList_->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+    ThrowIfFailed(commandList_->Close());
+
+    ID3D12CommandList* lists[] = {commandList_.Get()};
+    commandQueue_->ExecuteCommandLists(_countof(lists), lists);
+    ThrowIfFailed(commandQueue_->Signal(fence_.Get(), ++fenceValue_));
+
+    buffer.captureFence = fenceValue_;
+    buffer.captureFrame = frame_;
+    return S_OK;
+}
+
+void OffscreenTarget::WriteCapture(Buffer& buffer) {
+    fenceBackend_->Wait(buffer.captureFence);
+    buffer.captureFence = 0;
+
+    char name[32];
+    sprintf_s(name, "frame_%05llu.ppm", buffer.captureFrame);
+    std::ofstream file(settings_.outputDir / name, std::ios::binary);
+    if (!file) {
+        ThrowIfFailed(HRESULT_FROM_WIN32(ERROR_CANNOT_MAKE));
+    }
+
+    const auto& footprint = footprint_.Footprint;
+    char header[32];
+    int headerSize = sprintf_s(header, "P6\n%u %u\n255\n", footprint.Width, footprint.Height);
+    file.write(header, headerSize);
+
+    bool bgra = format_ == DXGI_FORMAT_B8G8R8A8_UNORM || format_ == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB;
+
+    D3D12_RANGE readRange = {0, static_cast<SIZE_T>(footprint.RowPitch) * footprint.Height};
+    BYTE* mapped = nullptr;
+    ThrowIfFailed(buffer.readback->Map(0, &readRange, reinterpret_cast<void**>(&mapped)));
+
+    std::vector<char> row(footprint.Width * 3);
+    for (UINT y = 0; y < footprint.Height; ++y) {
+        const BYTE* src = mapped + footprint_.Offset + static_cast<SIZE_T>(y) * footprint.RowPitch;
+        for (UINT x = 0; x < footprint.Width; ++x) {
+            row[x * 3 + 0] = static_cast<char>(src[x * 4 + (bgra ? 2 : 0)]);
+            row[x * 3 + 1] = static_cast<char>(src[x * 4 + 1]);
+            row[x * 3 + 2] = static_cast<char>(src[x * 4 + (bgra ? 0 : 2)]);
+        }
+        file.write(row.data(), static_cast<std::streamsize>(row.size()));
+    }
+
+    D3D12_RANGE writeRange = {0, 0};
+    buffer.readback->Unmap(0, &writeRange);
+}
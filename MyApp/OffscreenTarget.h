@@ -0,0 +1,97 @@
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+#include "Common/d3dUtil.h"
+
+#include "DescriptorHeap.h"
+#include "FramePacer.h"
+#include "PresentTarget.h"
+
+// Render targets for running without a window. Nothing is shown; instead every captureInterval-th
+// Present() copies the back buffer into a readback buffer, and the file is written by the next
+// capture of the same buffer or when the target is released. The copies go on the frame's queue
+// and signal a fence of their own, so the CPU waits for one only once it is a full ring of
+// buffers ahead of it.
+//
+// Frames are written as binary PPM, frame_00001.ppm onwards, counting every Present(). Only
+// 8-bit RGBA and BGRA formats can be captured.
+class OffscreenTarget final : public PresentTarget {
+  public:
+    struct Settings {
+        int bufferCount = 2;
+        UINT captureInterval = 1;  // 0 writes no frames
+        std::filesystem::path outputDir = L"frames";
+    };
+
+    OffscreenTarget(ID3D12Device* device,
+                    ID3D12CommandQueue* commandQueue,
+                    DXGI_FORMAT format,
+                    int width,
+                    int height,
+                    const Settings& settings);
+
+    OffscreenTarget(const OffscreenTarget& other) = delete;
+    OffscreenTarget& operator=(const OffscreenTarget& other) = delete;
+
+    // Writes the captures still pending.
+    ~OffscreenTarget() override;
+
+    int BufferCount() const override { return settings_.bufferCount; }
+
+    DXGI_FORMAT GetFormat() const override { return format_; }
+
+    ID3D12Resource* GetCurrentBackBuffer() const override { return buffers_[current_].texture.Get(); }
+
+    ID3D12Resource* GetBuffer(int i) const override { return buffers_[i].texture.Get(); }
+
+    D3D12_CPU_DESCRIPTOR_HANDLE GetCurrentBackBufferView() const override {
+        return rtvHeap_->GetDescriptorHandleCpu(current_);
+    }
+
+    void ResetAllBuffers() override;
+
+    HRESULT Resize(int clientWidth, int clientHeight) override;
+
+    void CreateRtvs(ID3D12Device* device) override;
+
+    HRESULT Present() override;
+
+    void SwapBuffers() override { current_ = (current_ + 1) % settings_.bufferCount; }
+
+    void WaitForNextFrame() override {}
+
+  private:
+    struct Buffer {
+        Microsoft::WRL::ComPtr<ID3D12Resource> texture;
+        Microsoft::WRL::ComPtr<ID3D12Resource> readback;
+        Microsoft::WRL::ComPtr<ID3D12CommandAllocator> allocator;
+        UINT64 captureFence = 0;  // 0 when no capture is pending
+        UINT64 captureFrame = 0;
+    };
+
+    void CreateBuffers();
+
+    // Waits for the buffer's pending capture and writes it out.
+    void WriteCapture(Buffer& buffer);
+
+    Microsoft::WRL::ComPtr<ID3D12Device> device_;
+    Microsoft::WRL::ComPtr<ID3D12CommandQueue> commandQueue_;
+    Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> commandList_;
+    Microsoft::WRL::ComPtr<ID3D12Fence> fence_;
+    std::unique_ptr<D3D12FenceBackend> fenceBackend_;
+    UINT64 fenceValue_ = 0;
+
+    Settings settings_;
+    DXGI_FORMAT format_ = DXGI_FORMAT_R8G8B8A8_UNORM;
+    int width_ = 0;
+    int height_ = 0;
+
+    std::vector<Buffer> buffers_;
+    std::unique_ptr<DescriptorHeap> rtvHeap_;
+    D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint_{};
+
+    int current_ = 0;
+    UINT64 frame_ = 0;
+};
@@ -0,0 +1,99 @@
+#include "ParallelRecorder.h"
+
+#include <algorithm>
+#include <thread>
+
+D3D12CommandListBackend::D3D12CommandListBackend(CommandContextPool* pool, ID3D12CommandQueue* queue)
+    : pool_(pool),
+      queue_(queue) {}
+
+CommandListBackend::List D3D12CommandListBackend::Open() {
+    CommandContext* context = pool_->Acquire(D3D12_COMMAND_LIST_TYPE_DIRECT, initialState_);
+
+    std::lock_guard lock(mutex_);
+    auto slot = static_cast<UINT>(slots_.size());
+    slots_.push_back(context);
+    return {slot, context->commandList.Get()};
+}
+
+void D3D12CommandListBackend::Close(UINT slot) {
+    CommandContext* context = nullptr;
+    {
+        std::lock_guard lock(mutex_);
+        context = slots_[slot];
+    }
+    ThrowIfFailed(context->commandList->Close());
+}
+
+void D3D12CommandListBackend::Submit(const std::vector<UINT>& slots) {
+    std::vector<ID3D12CommandList*> lists;
+    lists.reserve(slots.size());
+    {
+        std::lock_guard lock(mutex_);
+        for (UINT slot : slots) {
+            lists.push_back(slots_[slot]->commandList.Get());
+            submitted_.push_back(slots_[slot]);
+        }
+    }
+
+    if (!lists.empty()) {
+        queue_->ExecuteCommandLists(static_cast<UINT>(lists.size()), lists.data());
+    }
+}
+
+void D3D12CommandListBackend::EndFrame(UINT64 fenceValue) {
+    std::lock_guard lock(mutex_);
+    assert(submitted_.size() == slots_.size() && "Every list opened this frame must be submitted.");
+
+    for (CommandContext* context : submitted_) {
+        pool_->Release(context, fenceValue);
+    }
+    submitted_.clear();
+    slots_.clear();
+}
+
+ParallelRecorder::ParallelRecorder(CommandListBackend* backend,
+                                   unsigned int workerCount,
+                                   size_t minItemsPerList)
+    : backend_(backend),
+      workerCount_(workerCount),
+      minItemsPerList_(std::max<size_t>(minItemsPerList, 1)) {
+    if (workerCount_ == 0) {
+        workerCount_ = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+ParallelRecorder::List ParallelRecorder::Begin() {
+    return backend_->Open();
+}
+
+void ParallelRecorder::End(const List& list) {
+    backend_->Close(list.slot);
+    queued_.push_back(list.slot);
+}
+
+void ParallelRecorder::Submit() {
+    backend_->Submit(queued_);
+    queued_.clear();
+}
+
+std::vector<ParallelRecorder::Chunk> ParallelRecorder::Partition(size_t itemCount) const {
+    std::vector<Chunk> chunks;
+    if (itemCount == 0) {
+        return chunks;
+    }
+
+    // A list costs a reset, state setup and a slot in the submission; small chunks don't pay.
+    size_t listCount = std::max<size_t>(itemCount / minItemsPerList_, 1);
+    listCount = std::min<size_t>(listCount, workerCount_);
+
+    size_t base = itemCount / listCount;
+    size_t remainder = itemCount % listCount;
+    size_t first = 0;
+    for (size_t i = 0; i < listCount; ++i) {
+        size_t count = base + (i < remainder ? 1 : 0);
+        chunks.push_back({first, count});
+        first += count;
+    }
+    return chunks;
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include "Common/ParallelFor.h"
+#include "Common/d3dUtil.h"
+#include "CommandContextPool.h"
+
+// Source of command lists for ParallelRecorder. Open() and Close() are called from worker
+// threads; Submit() and EndFrame() from the thread that owns the queue. A mock can hand out
+// null lists and record which slots were opened, closed and submitted.
+class CommandListBackend {
+  public:
+    struct List {
+        UINT slot = 0;
+        ID3D12GraphicsCommandList* commandList = nullptr;
+    };
+
+    virtual ~CommandListBackend() = default;
+
+    // Returns a list ready for recording.
+    virtual List Open() = 0;
+
+    virtual void Close(UINT slot) = 0;
+
+    // Executes the slots in the given order in one submission.
+    virtual void Submit(const std::vector<UINT>& slots) = 0;
+
+    // Call right after the queue has been asked to signal fenceValue; the slots submitted since
+    // the last call are reused once it completes.
+    virtual void EndFrame(UINT64 fenceValue) = 0;
+};
+
+// Direct lists from a CommandContextPool, returned to it at EndFrame().
+class D3D12CommandListBackend final : public CommandListBackend {
+  public:
+    D3D12CommandListBackend(CommandContextPool* pool, ID3D12CommandQueue* queue);
+
+    // Pipeline state lists start with after Open().
+    void SetInitialState(ID3D12PipelineState* pso) { initialState_ = pso; }
+
+    List Open() override;
+
+    void Close(UINT slot) override;
+
+    void Submit(const std::vector<UINT>& slots) override;
+
+    void EndFrame(UINT64 fenceValue) override;
+
+  private:
+    CommandContextPool* pool_ = nullptr;
+    Microsoft::WRL::ComPtr<ID3D12CommandQueue> queue_;
+    ID3D12PipelineState* initialState_ = nullptr;
+
+    std::mutex mutex_;
+    std::vector<CommandContext*> slots_;  // contexts opened this frame
+    std::vector<CommandContext*> submitted_;
+};
+
+// Records draws in parallel, one command list per worker, and submits them in order.
+//
+// Record() splits the items into contiguous chunks of at least minItemsPerList, records each
+// chunk into its own list on a worker thread, and queues the lists in chunk order. Lists from
+// Begin()/End() on the calling thread queue in sequence with them, for work such as barriers
+// and clears before the draws and the present transition after. Submit() executes everything
+// queued in one ExecuteCommandLists, so the GPU sees the same order as a single list.
+//
+// Each list starts with no state; record() must set render targets, root signature, descriptor
+// heaps and anything else its draws depend on.
+class ParallelRecorder {
+  public:
+    using List = CommandListBackend::List;
+
+    struct Chunk {
+        size_t first = 0;
+        size_t count = 0;
+    };
+
+    // workerCount 0 uses the hardware concurrency.
+    ParallelRecorder(CommandListBackend* backend, unsigned int workerCount = 0, size_t minItemsPerList = 64);
+
+    [[nodiscard]]
+    List Begin();
+
+    void End(const List& list);
+
+    // Calls record(list, first, count) once per chunk, concurrently.
+    template <typename Fn>
+    void Record(size_t itemCount, Fn&& record) {
+        auto chunks = Partition(itemCount);
+        std::vector<List> lists(chunks.size());
+        ParallelFor(
+            chunks.size(),
+            [&](size_t i) {
+                lists[i] = backend_->Open();
+                record(lists[i], chunks[i].first, chunks[i].count);
+                backend_->Close(lists[i].slot);
+            },
+            workerCount_);
+
+        for (const auto& list : lists) {
+            queued_.push_back(list.slot);
+        }
+    }
+
+    void Submit();
+
+    // Balanced contiguous chunks; no more than one per worker.
+    [[nodiscard]]
+    std::vector<Chunk> Partition(size_t itemCount) const;
+
+    [[nodiscard]]
+    unsigned int GetWorkerCount() const { return workerCount_; }
+
+  private:
+    CommandListBackend* backend_ = nullptr;
+    unsigned int workerCount_ = 1;
+    size_t minItemsPerList_ = 1;
+
+    std::vector<UINT> queued_;
+};
@@ -0,0 +1,107 @@
+#include "PresentPacingPolicy.h"
+
+#undef max
+#undef min
+#include <algorithm>
+#include <cmath>
+
+#include "Timer.h"
+
+PresentPacingPolicy::PresentPacingPolicy(FrameLatencyMode mode,
+                                         Clock clock,
+                                         size_t historySize,
+                                         double safetyMargin)
+    : mode_(mode),
+      clock_(std::move(clock)),
+      safetyMargin_(safetyMargin),
+      intervals_(historySize),
+      costs_(historySize) {
+    assert(historySize > 0);
+    if (!clock_) {
+        clock_ = &Timer::GetCurrentSeconds;
+    }
+}
+
+void PresentPacingPolicy::OnFrameReady() {
+    double now = clock_();
+    if (lastReady_ >= 0.0) {
+        double interval = now - lastReady_;
+        double predicted = GetPresentInterval();
+        if (predicted > 0.0 && interval > s_missedIntervalRatio * predicted) {
+            ++stats_.missedPresents;
+        }
+        intervals_.Add(interval);
+    }
+    lastReady_ = now;
+}
+
+void PresentPacingPolicy::OnFrameStart() {
+    frameStart_ = clock_();
+    ++stats_.frames;
+    if (lastReady_ >= 0.0) {
+        stats_.delaySeconds += frameStart_ - lastReady_;
+    }
+}
+
+void PresentPacingPolicy::OnPresent() {
+    if (frameStart_ >= 0.0) {
+        costs_.Add(clock_() - frameStart_);
+    }
+}
+
+double PresentPacingPolicy::GetPresentInterval() const {
+    return intervals_.Percentile(0.5);
+}
+
+double PresentPacingPolicy::GetFrameCost() const {
+    return costs_.Percentile(s_costPercentile);
+}
+
+double PresentPacingPolicy::PredictNextPresent() const {
+    double interval = GetPresentInterval();
+    if (interval <= 0.0 || lastReady_ < 0.0) {
+        return 0.0;
+    }
+
+    // The swap chain becomes ready as a frame is shown, so a frame presented before the next
+    // ready is shown then. Past that, it is shown on the first one still ahead.
+    double now = clock_();
+    double next = lastReady_ + interval;
+    if (next < now) {
+        next += std::ceil((now - next) / interval) * interval;
+    }
+    return next;
+}
+
+double PresentPacingPolicy::GetStartDelay() const {
+    if (mode_ != FrameLatencyMode::LowLatency) {
+        return 0.0;
+    }
+
+    double cost = GetFrameCost();
+    double next = PredictNextPresent();
+    if (cost <= 0.0 || next <= 0.0) {
+        return 0.0;
+    }
+
+    double interval = GetPresentInterval();
+    double delay = next - cost - safetyMargin_ - clock_();
+    return std::clamp(delay, 0.0, interval);
+}
+
+void PresentPacingPolicy::History::Add(double sample) {
+    samples_[next_] = sample;
+    next_ = (next_ + 1) % samples_.size();
+    count_ = std::min(count_ + 1, samples_.size());
+}
+
+double PresentPacingPolicy::History::Percentile(double p) const {
+    if (count_ == 0 || count_ * 2 < samples_.size()) {
+        return 0.0;
+    }
+
+    std::vector<double> sorted(samples_.begin(), samples_.begin() + count_);
+    auto nth = sorted.begin() + static_cast<size_t>(p * static_cast<double>(count_ - 1));
+    std::nth_element(sorted.begin(), nth, sorted.end());
+    return *nth;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "SwapChain.h"
+
+// Decides when a frame should start so that it reaches the screen with the freshest input.
+//
+// The policy only sees timestamps. OnFrameReady() marks when the swap chain can take another
+// frame: its waitable object fired, or in throughput mode Present() returned. The gaps between
+// those are the present interval, normally the refresh period. OnFrameStart() and OnPresent()
+// bracket the CPU work of a frame, which is its cost.
+//
+// In low-latency mode GetStartDelay() holds the next frame back so that, costing what recent
+// frames cost, it is presented just before the predicted next present instead of waiting in the
+// queue with old input. Predictions take the median interval and a high percentile of the cost
+// over the last historySize frames, plus safetyMargin, so that one slow frame does not make the
+// following ones miss their present. In throughput mode the delay is always zero.
+class PresentPacingPolicy {
+  public:
+    struct Stats {
+        UINT64 frames = 0;
+        double delaySeconds = 0.0;  // from ready to frame start, summed
+        UINT64 missedPresents = 0;  // ready more than 1.5 predicted intervals after the last one
+    };
+
+    // Returns seconds from an arbitrary origin; defaults to Timer::GetCurrentSeconds().
+    using Clock = std::function<double()>;
+
+    explicit PresentPacingPolicy(FrameLatencyMode mode,
+                                 Clock clock = {},
+                                 size_t historySize = 32,
+                                 double safetyMargin = 0.002);
+
+    void OnFrameReady();
+
+    void OnFrameStart();
+
+    void OnPresent();
+
+    // Zero until enough frames have been seen.
+    [[nodiscard]]
+    double GetPresentInterval() const;
+
+    // Zero until enough frames have been seen.
+    [[nodiscard]]
+    double GetFrameCost() const;
+
+    // When the frame started now will be presented; zero until the interval is known.
+    [[nodiscard]]
+    double PredictNextPresent() const;
+
+    // Seconds to wait from now before starting the next frame.
+    [[nodiscard]]
+    double GetStartDelay() const;
+
+    [[nodiscard]]
+    FrameLatencyMode GetMode() const { return mode_; }
+
+    [[nodiscard]]
+    const Stats& GetStats() const { return stats_; }
+
+    void ResetStats() { stats_ = {}; }
+
+  private:
+    // Last historySize samples in a ring.
+    class History {
+      public:
+        explicit History(size_t size) : samples_(size) {}
+
+        void Add(double sample);
+
+        // Zero until half the ring is filled.
+        [[nodiscard]]
+        double Percentile(double p) const;
+
+      private:
+        std::vector<double> samples_;
+        size_t count_ = 0;
+        size_t next_ = 0;
+    };
+
+    static constexpr double s_costPercentile = 0.9;
+    static constexpr double s_missedIntervalRatio = 1.5;
+
+    FrameLatencyMode mode_;
+    Clock clock_;
+    double safetyMargin_;
+
+    History intervals_;
+    History costs_;
+
+    double lastReady_ = -1.0;
+    double frameStart_ = -1.0;
+
+    Stats stats_;
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Common/d3dUtil.h"
+
+// Buffers a frame is rendered into and presented from. The frame loop only goes through this
+// interface, so offscreen buffers (see OffscreenTarget) or a null target can stand in for the
+// window's swap chain.
+class PresentTarget {
+  public:
+    virtual ~PresentTarget() = default;
+
+    virtual int BufferCount() const = 0;
+
+    virtual DXGI_FORMAT GetFormat() const = 0;
+
+    virtual ID3D12Resource* GetCurrentBackBuffer() const = 0;
+
+    virtual ID3D12Resource* GetBuffer(int i) const = 0;
+
+    virtual D3D12_CPU_DESCRIPTOR_HANDLE GetCurrentBackBufferView() const = 0;
+
+    // A resize releases the buffers, resizes, then recreates the buffers and their views. The
+    // GPU must be done with the old buffers first.
+    virtual void ResetAllBuffers() = 0;
+
+    virtual HRESULT Resize(int clientWidth, int clientHeight) = 0;
+
+    virtual void CreateRtvs(ID3D12Device* device) = 0;
+
+    virtual HRESULT Present() = 0;
+
+    // Moves to the buffer the next frame renders into.
+    virtual void SwapBuffers() = 0;
+
+    // Blocks until another frame can be queued.
+    virtual void WaitForNextFrame() = 0;
+};
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "Common/d3dUtil.h"
+#include "SpscQueue.h"
+
+// Hands frames from a game thread to a render thread, so one frame is simulated while the
+// previous one is recorded and a frame costs the longer of the two instead of their sum.
+//
+// A frame is a Snapshot of the scene plus the packets pushed while it was being written, e.g.
+// the items that moved. The game thread fills the snapshot from BeginFrame(), pushes packets,
+// and calls Publish(). The render thread Acquire()s the oldest published frame, Drain()s its
+// packets and calls Release() when done with both. There are two snapshots, so the game thread
+// runs at most one frame ahead: BeginFrame() waits while the render thread still reads the
+// snapshot it would overwrite. Packets go through a lock-free queue and keep their order.
+//
+// Waits spin, then yield, then sleep once they have lasted a millisecond, so a side that is
+// idle for long (a minimized window) does not hold a core. Each side waits at most once per
+// frame. Close() stops both sides; the render thread still gets the frames published before
+// it, then Acquire() returns null.
+//
+// The queue must hold every packet of two frames. A frame cannot be published until all its
+// packets are pushed, and the render thread cannot make room before then.
+template <typename Snapshot, typename Packet>
+class RenderChannel {
+  public:
+    struct Stats {
+        UINT64 frames = 0;
+        UINT64 packets = 0;
+        UINT64 gameWaits = 0;    // BeginFrame() or Push() found no room
+        UINT64 renderWaits = 0;  // Acquire() found no frame
+    };
+
+    explicit RenderChannel(size_t packetCapacity) : packets_(packetCapacity) {}
+
+    RenderChannel(const RenderChannel& other) = delete;
+    RenderChannel& operator=(const RenderChannel& other) = delete;
+
+    // Game thread. The snapshot for the next frame, holding what was written into it two frames
+    // ago; null once closed.
+    [[nodiscard]]
+    Snapshot* BeginFrame() {
+        if (IsClosed()) {
+            return nullptr;
+        }
+        UINT64 frame = published_.load(std::memory_order_relaxed);
+        bool ready = Wait(gameWaits_, [&] {
+            return frame < 2 || released_.load(std::memory_order_acquire) >= frame - 1;
+        });
+        return ready ? &slots_[frame % 2].snapshot : nullptr;
+    }
+
+    // Game thread. Returns false once closed.
+    bool Push(const Packet& packet) {
+        if (IsClosed()) {
+            return false;
+        }
+        if (packets_.TryPush(packet)) {
+            ++pushed_;
+            return true;
+        }
+
+        // Only releasing a published frame makes room; without one, this frame filled the queue.
+        assert(released_.load(std::memory_order_acquire) < published_.load(std::memory_order_relaxed) &&
+               "More packets in a frame than the queue holds.");
+
+        bool pushed = Wait(gameWaits_, [&] { return packets_.TryPush(packet); });
+        pushed_ += pushed ? 1 : 0;
+        return pushed;
+    }
+
+    // Game thread, after a successful BeginFrame(). Makes the snapshot and the packets pushed
+    // since the last frame visible.
+    void Publish() {
+        UINT64 frame = published_.load(std::memory_order_relaxed);
+        slots_[frame % 2].packetEnd = pushed_;
+        packetCount_.store(pushed_, std::memory_order_relaxed);
+        published_.store(frame + 1, std::memory_order_release);
+    }
+
+    // Render thread. The oldest published frame not yet released; null once closed and every
+    // published frame has been released.
+    [[nodiscard]]
+    const Snapshot* Acquire() {
+        UINT64 frame = released_.load(std::memory_order_relaxed);
+        Wait(renderWaits_, [&] { return published_.load(std::memory_order_acquire) > frame; });
+        if (published_.load(std::memory_order_acquire) <= frame) {
+            return nullptr;
+        }
+        return &slots_[frame % 2].snapshot;
+    }
+
+    // Render thread. Calls apply(packet) for each packet of the acquired frame, in push order.
+    template <typename Fn>
+    void Drain(Fn&& apply) {
+        UINT64 frame = released_.load(std::memory_order_relaxed);
+        UINT64 end = slots_[frame % 2].packetEnd;
+
+        Packet packet;
+        while (popped_ < end) {
+            bool popped = packets_.TryPop(packet);
+            assert(popped && "Published packets must be in the queue.");
+            (void)popped;
+            ++popped_;
+            apply(packet);
+        }
+    }
+
+    // Render thread. Done with the acquired frame's snapshot and packets.
+    void Release() {
+        Drain([](const Packet&) {});
+        UINT64 frame = released_.load(std::memory_order_relaxed);
+        released_.store(frame + 1, std::memory_order_release);
+    }
+
+    // Either thread.
+    void Close() { closed_.store(true, std::memory_order_release); }
+
+    [[nodiscard]]
+    bool IsClosed() const { return closed_.load(std::memory_order_acquire); }
+
+    // Approximate while both threads run.
+    [[nodiscard]]
+    Stats GetStats() const {
+        Stats stats;
+        stats.frames = released_.load(std::memory_order_relaxed);
+        stats.packets = packetCount_.load(std::memory_order_relaxed);
+        stats.gameWaits = gameWaits_.load(std::memory_order_relaxed);
+        stats.renderWaits = renderWaits_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+  private:
+    struct Slot {
+        Snapshot snapshot{};
+        UINT64 packetEnd = 0;  // packets pushed up to and including this frame
+    };
+
+    static constexpr int s_spinCount = 256;
+    static constexpr std::chrono::microseconds s_yieldTime{1000};
+
+    // Returns ready() once it holds, or false once closed.
+    template <typename Ready>
+    bool Wait(std::atomic<UINT64>& waits, Ready&& ready) {
+        if (ready()) {
+            return true;
+        }
+
+        waits.fetch_add(1, std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+        for (int spin = 0;;) {
+            if (ready()) {
+                return true;
+            }
+            if (closed_.load(std::memory_order_acquire)) {
+                return ready();
+            }
+            if (spin < s_spinCount) {
+                ++spin;
+                continue;
+            }
+            if (std::chrono::steady_clock::now() - start < s_yieldTime) {
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    }
+
+    std::array<Slot, 2> slots_;
+    SpscQueue<Packet> packets_;
+
+    std::atomic<UINT64> published_{0};
+    std::atomic<UINT64> released_{0};
+    std::atomic<bool> closed_{false};
+
+    UINT64 pushed_ = 0;  // game thread
+    UINT64 popped_ = 0;  // render thread
+
+    std::atomic<UINT64> packetCount_{0};
+    std::atomic<UINT64> gameWaits_{0};
+    std::atomic<UINT64> renderWaits_{0};
+};
@@ -0,0 +1,243 @@
+#include "ResourceStateTracker.h"
+
+#include <algorithm>
+
+namespace {
+
+constexpr D3D12_RESOURCE_STATES s_readOnlyStates =
+    D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER | D3D12_RESOURCE_STATE_INDEX_BUFFER |
+    D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE |
+    D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT | D3D12_RESOURCE_STATE_COPY_SOURCE |
+    D3D12_RESOURCE_STATE_DEPTH_READ;
+
+bool IsReadOnly(D3D12_RESOURCE_STATES state) {
+    return state != 0 && (state & ~s_readOnlyStates) == 0;
+}
+
+}  // namespace
+
+void ResourceStateTracker::Register(ID3D12Resource* resource,
+                                    D3D12_RESOURCE_STATES state,
+                                    UINT subresourceCount) {
+    assert(resource && subresourceCount > 0);
+    Unregister(resource);
+
+    TrackedResource tracked;
+    tracked.state = state;
+    tracked.subresourceCount = subresourceCount;
+    resources_[resource] = std::move(tracked);
+}
+
+void ResourceStateTracker::Unregister(ID3D12Resource* resource) {
+    if (resources_.erase(resource) == 0) {
+        return;
+    }
+
+    auto queued = [resource](const D3D12_RESOURCE_BARRIER& barrier) {
+        return barrier.Transition.pResource == resource;
+    };
+    pending_.erase(std::remove_if(pending_.begin(), pending_.end(), queued), pending_.end());
+
+    auto begun = [resource](const Split& split) { return split.resource == resource; };
+    splits_.erase(std::remove_if(splits_.begin(), splits_.end(), begun), splits_.end());
+}
+
+void ResourceStateTracker::Transition(ID3D12Resource* resource,
+                                      D3D12_RESOURCE_STATES after,
+                                      UINT subresource) {
+    TrackedResource& tracked = Find(resource);
+    ++stats_.requested;
+
+    if (EndSplits(resource, subresource, after)) {
+        return;
+    }
+
+    if (subresource != D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES) {
+        D3D12_RESOURCE_STATES current = GetState(tracked, subresource);
+        if (IsSatisfied(current, after)) {
+            ++stats_.skipped;
+            return;
+        }
+        Queue(resource, subresource, current, after);
+        SetState(tracked, subresource, after);
+        return;
+    }
+
+    if (tracked.subresourceStates.empty()) {
+        if (IsSatisfied(tracked.state, after)) {
+            ++stats_.skipped;
+            return;
+        }
+        Queue(resource, subresource, tracked.state, after);
+        tracked.state = after;
+        return;
+    }
+
+    // Subresources in different states each need a barrier of their own.
+    bool queued = false;
+    for (UINT i = 0; i < tracked.subresourceCount; ++i) {
+        D3D12_RESOURCE_STATES current = tracked.subresourceStates[i];
+        if (!IsSatisfied(current, after)) {
+            Queue(resource, i, current, after);
+            SetState(tracked, i, after);
+            queued = true;
+        }
+    }
+    if (!queued) {
+        ++stats_.skipped;
+    }
+}
+
+void ResourceStateTracker::BeginTransition(ID3D12Resource* resource,
+                                           D3D12_RESOURCE_STATES after,
+                                           UINT subresource) {
+    TrackedResource& tracked = Find(resource);
+    EndSplits(resource, subresource, after);
+
+    // One split per subresource would be needed; a plain barrier does the same job.
+    if (subresource == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES && !tracked.subresourceStates.empty()) {
+        Transition(resource, after, subresource);
+        return;
+    }
+
+    ++stats_.requested;
+    D3D12_RESOURCE_STATES current = GetState(tracked, subresource);
+    if (IsSatisfied(current, after)) {
+        ++stats_.skipped;
+        return;
+    }
+
+    auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(resource,
+                                                        current,
+                                                        after,
+                                                        subresource,
+                                                        D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY);
+    pending_.push_back(barrier);
+    splits_.push_back({resource, subresource, current, after});
+    SetState(tracked, subresource, after);
+    ++stats_.splits;
+}
+
+void ResourceStateTracker::Flush(ID3D12GraphicsCommandList* commandList) {
+    if (pending_.empty()) {
+        return;
+    }
+
+    commandList->ResourceBarrier(static_cast<UINT>(pending_.size()), pending_.data());
+    stats_.barriers += pending_.size();
+    ++stats_.flushes;
+    pending_.clear();
+}
+
+std::vector<D3D12_RESOURCE_BARRIER> ResourceStateTracker::TakeBarriers() {
+    std::vector<D3D12_RESOURCE_BARRIER> barriers;
+    barriers.swap(pending_);
+    return barriers;
+}
+
+D3D12_RESOURCE_STATES ResourceStateTracker::GetState(ID3D12Resource* resource, UINT subresource) const {
+    auto it = resources_.find(resource);
+    assert(it != resources_.end() && "Resource is not tracked.");
+    return GetState(it->second, subresource);
+}
+
+ResourceStateTracker::TrackedResource& ResourceStateTracker::Find(ID3D12Resource* resource) {
+    auto it = resources_.find(resource);
+    assert(it != resources_.end() && "Register() the resource first.");
+    return it->second;
+}
+
+D3D12_RESOURCE_STATES ResourceStateTracker::GetState(const TrackedResource& tracked, UINT subresource) {
+    if (tracked.subresourceStates.empty() || subresource == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES) {
+        return tracked.state;
+    }
+    return tracked.subresourceStates[subresource];
+}
+
+void ResourceStateTracker::SetState(TrackedResource& tracked,
+                                    UINT subresource,
+                                    D3D12_RESOURCE_STATES state) {
+    if (subresource == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES) {
+        tracked.state = state;
+        tracked.subresourceStates.clear();
+        return;
+    }
+
+    assert(subresource < tracked.subresourceCount);
+    if (tracked.subresourceStates.empty()) {
+        if (tracked.subresourceCount == 1) {
+            tracked.state = state;
+            return;
+        }
+        tracked.subresourceStates.assign(tracked.subresourceCount, tracked.state);
+    }
+    tracked.subresourceStates[subresource] = state;
+
+    // Back to one state for the whole resource, so whole-resource barriers can be used again.
+    const auto& states = tracked.subresourceStates;
+    if (std::all_of(states.begin(), states.end(), [state](auto s) { return s == state; })) {
+        tracked.state = state;
+        tracked.subresourceStates.clear();
+    }
+}
+
+bool ResourceStateTracker::IsSatisfied(D3D12_RESOURCE_STATES current, D3D12_RESOURCE_STATES after) {
+    if (current == after) {
+        return true;
+    }
+    return IsReadOnly(current) && IsReadOnly(after) && (current & after) == after;
+}
+
+bool ResourceStateTracker::EndSplits(ID3D12Resource* resource,
+                                     UINT subresource,
+                                     D3D12_RESOURCE_STATES after) {
+    constexpr UINT all = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+
+    bool reached = false;
+    for (auto it = splits_.begin(); it != splits_.end();) {
+        bool overlaps = it->resource == resource &&
+                        (subresource == all || it->subresource == all || it->subresource == subresource);
+        if (!overlaps) {
+            ++it;
+            continue;
+        }
+
+        auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(resource,
+                                                            it->before,
+                                                            it->after,
+                                                            it->subresource,
+                                                            D3D12_RESOURCE_BARRIER_FLAG_END_ONLY);
+        pending_.push_back(barrier);
+        reached |= it->subresource == subresource && it->after == after;
+        it = splits_.erase(it);
+    }
+    return reached;
+}
+
+void ResourceStateTracker::Queue(ID3D12Resource* resource,
+                                 UINT subresource,
+                                 D3D12_RESOURCE_STATES before,
+                                 D3D12_RESOURCE_STATES after) {
+    // A barrier still queued for this subresource can take it straight to the new state.
+    for (auto it = pending_.rbegin(); it != pending_.rend(); ++it) {
+        auto& transition = it->Transition;
+        if (it->Type != D3D12_RESOURCE_BARRIER_TYPE_TRANSITION || transition.pResource != resource ||
+            transition.Subresource != subresource) {
+            continue;
+        }
+        if (it->Flags != D3D12_RESOURCE_BARRIER_FLAG_NONE) {
+            break;
+        }
+
+        assert(transition.StateAfter == before);
+        ++stats_.combined;
+        if (transition.StateBefore == after) {
+            pending_.erase(std::next(it).base());
+        } else {
+            transition.StateAfter = after;
+        }
+        return;
+    }
+
+    pending_.push_back(CD3DX12_RESOURCE_BARRIER::Transition(resource, before, after, subresource));
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "Common/d3dUtil.h"
+
+// Tracks the state of each registered resource (and subresource) on one queue and turns
+// requests for a target state into batched barriers.
+//
+// Transition() only names the state a resource is needed in. It is dropped when the resource is
+// already there, or when both states are read-only and the current one includes the target.
+// Otherwise a barrier from the tracked state is queued; a queued barrier for the same
+// subresource is extended instead of adding a second one, and removed if the resource ends up
+// back where it started. Flush() records everything queued in one ResourceBarrier call, and
+// must come before the draws and copies that depend on it.
+//
+// BeginTransition() starts a split barrier so the GPU can overlap the transition with work
+// recorded in between. The next Transition() of that subresource ends it.
+//
+// States change in recording order, so the lists must be executed in the order their barriers
+// were flushed. Resources that rely on implicit promotion and decay need not be registered.
+// Nothing here touches the device; resources are only used as keys until Flush().
+class ResourceStateTracker {
+  public:
+    struct Stats {
+        UINT64 requested = 0;
+        UINT64 skipped = 0;   // already in the state
+        UINT64 combined = 0;  // folded into or cancelling a queued barrier
+        UINT64 splits = 0;
+        UINT64 barriers = 0;  // recorded by Flush()
+        UINT64 flushes = 0;
+    };
+
+    // Starts tracking a resource in the given state, e.g. the one it was created in.
+    void Register(ID3D12Resource* resource, D3D12_RESOURCE_STATES state, UINT subresourceCount = 1);
+
+    // Stops tracking a resource about to be released, dropping its queued barriers.
+    void Unregister(ID3D12Resource* resource);
+
+    void Transition(ID3D12Resource* resource,
+                    D3D12_RESOURCE_STATES after,
+                    UINT subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES);
+
+    void BeginTransition(ID3D12Resource* resource,
+                         D3D12_RESOURCE_STATES after,
+                         UINT subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES);
+
+    // Records the queued barriers on commandList, if there are any.
+    void Flush(ID3D12GraphicsCommandList* commandList);
+
+    // The queued barriers, in the order Flush() would record them.
+    [[nodiscard]]
+    std::vector<D3D12_RESOURCE_BARRIER> TakeBarriers();
+
+    [[nodiscard]]
+    D3D12_RESOURCE_STATES GetState(ID3D12Resource* resource, UINT subresource = 0) const;
+
+    [[nodiscard]]
+    bool IsTracked(ID3D12Resource* resource) const { return resources_.count(resource) > 0; }
+
+    [[nodiscard]]
+    const Stats& GetStats() const { return stats_; }
+
+  private:
+    struct TrackedResource {
+        D3D12_RESOURCE_STATES state = D3D12_RESOURCE_STATE_COMMON;  // when uniform
+        std::vector<D3D12_RESOURCE_STATES> subresourceStates;       // empty when uniform
+        UINT subresourceCount = 1;
+    };
+
+    struct Split {
+        ID3D12Resource* resource = nullptr;
+        UINT subresource = 0;
+        D3D12_RESOURCE_STATES before = D3D12_RESOURCE_STATE_COMMON;
+        D3D12_RESOURCE_STATES after = D3D12_RESOURCE_STATE_COMMON;
+    };
+
+    TrackedResource& Find(ID3D12Resource* resource);
+
+    static D3D12_RESOURCE_STATES GetState(const TrackedResource& tracked, UINT subresource);
+    static void SetState(TrackedResource& tracked, UINT subresource, D3D12_RESOURCE_STATES state);
+
+    // True when a resource in current can be used as after without a barrier.
+    static bool IsSatisfied(D3D12_RESOURCE_STATES current, D3D12_RESOURCE_STATES after);
+
+    // Ends splits overlapping subresource; returns whether one of them was to after.
+    bool EndSplits(ID3D12Resource* resource, UINT subresource, D3D12_RESOURCE_STATES after);
+
+    void Queue(ID3D12Resource* resource,
+               UINT subresource,
+               D3D12_RESOURCE_STATES before,
+               D3D12_RESOURCE_STATES after);
+
+    std::unordered_map<ID3D12Resource*, TrackedResource> resources_;
+    std::vector<D3D12_RESOURCE_BARRIER> pending_;
+    std::vector<Split> splits_;  // begun, not yet ended
+
+    Stats stats_;
+};
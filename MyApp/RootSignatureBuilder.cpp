@@ -0,0 +1,220 @@
+#include "RootSignatureBuilder.h"
+
+#include <cstring>
+
+namespace {
+
+// Layout of one constant-buffer member: rows (or columns) each start a new 16-byte register.
+struct HlslTypeLayout {
+    UINT registers = 1;
+    UINT components = 1;
+    bool matrix = false;
+};
+
+bool StartsWith(const std::string& s, const std::string& prefix) {
+    return s.compare(0, prefix.size(), prefix) == 0;
+}
+
+HlslTypeLayout ParseType(std::string type) {
+    bool rowMajor = false;
+    if (StartsWith(type, "row_major ")) {
+        rowMajor = true;
+        type = type.substr(10);
+    } else if (StartsWith(type, "column_major ")) {
+        type = type.substr(13);
+    }
+
+    std::string dims;
+    for (const char* scalar : {"float", "uint", "int", "bool"}) {
+        if (StartsWith(type, scalar)) {
+            dims = type.substr(strlen(scalar));
+            break;
+        }
+    }
+
+    auto isDim = [](char c) { return c >= '1' && c <= '4'; };
+
+    HlslTypeLayout layout;
+    if (dims.empty() && type != "float" && type != "uint" && type != "int" && type != "bool") {
+        ThrowIfFailed(E_INVALIDARG);
+    } else if (dims.size() == 1 && isDim(dims[0])) {
+        layout.components = dims[0] - '0';
+    } else if (dims.size() == 3 && isDim(dims[0]) && dims[1] == 'x' && isDim(dims[2])) {
+        // Column-major (the default) stores each column in a register.
+        UINT rows = dims[0] - '0';
+        UINT cols = dims[2] - '0';
+        layout.registers = rowMajor ? rows : cols;
+        layout.components = rowMajor ? cols : rows;
+        layout.matrix = true;
+    } else if (!dims.empty()) {
+        ThrowIfFailed(E_INVALIDARG);
+    }
+    return layout;
+}
+
+}  // namespace
+
+UINT RootSignatureBuilder::AddConstants(const std::string& name,
+                                        UINT shaderRegister,
+                                        UINT byteSize,
+                                        UpdateFrequency frequency,
+                                        std::vector<ConstantField> fields,
+                                        D3D12_SHADER_VISIBILITY visibility,
+                                        UINT registerSpace) {
+    assert((fields.empty() || GetPackedSize(fields) == byteSize) &&
+           "C++ struct does not match the HLSL packing of its fields.");
+
+    Parameter parameter;
+    parameter.name = name;
+    parameter.frequency = frequency;
+    parameter.shaderRegister = shaderRegister;
+    parameter.registerSpace = registerSpace;
+    parameter.visibility = visibility;
+    parameter.fields = std::move(fields);
+
+    // Root constants are copied into the command list on every set, so they only pay off for
+    // small blocks that would otherwise need a fresh constant-buffer slot per draw.
+    UINT dwords = (byteSize + 3) / 4;
+    if (frequency == UpdateFrequency::PerDraw && dwords <= s_maxRootConstantDwords &&
+        cost_ + dwords <= s_maxRootDwords) {
+        parameter.kind = RootParameterKind::Constants;
+        parameter.num32BitValues = dwords;
+        return Add(std::move(parameter), dwords);
+    }
+
+    parameter.kind = RootParameterKind::ConstantBufferView;
+    return Add(std::move(parameter), 2);
+}
+
+UINT RootSignatureBuilder::AddShaderResourceView(const std::string& name,
+                                                 UINT shaderRegister,
+                                                 UpdateFrequency frequency,
+                                                 D3D12_SHADER_VISIBILITY visibility,
+                                                 UINT registerSpace) {
+    Parameter parameter;
+    parameter.name = name;
+    parameter.kind = RootParameterKind::ShaderResourceView;
+    parameter.frequency = frequency;
+    parameter.shaderRegister = shaderRegister;
+    parameter.registerSpace = registerSpace;
+    parameter.visibility = visibility;
+    return Add(std::move(parameter), 2);
+}
+
+UINT RootSignatureBuilder::AddTable(const std::string& name,
+                                    D3D12_DESCRIPTOR_RANGE_TYPE type,
+                                    UINT count,
+                                    UINT baseShaderRegister,
+                                    UpdateFrequency frequency,
+                                    D3D12_SHADER_VISIBILITY visibility,
+                                    UINT registerSpace) {
+    auto& range = ranges_.emplace_back();
+    range.Init(type, count, baseShaderRegister, registerSpace);
+
+    Parameter parameter;
+    parameter.name = name;
+    parameter.kind = RootParameterKind::DescriptorTable;
+    parameter.frequency = frequency;
+    parameter.shaderRegister = baseShaderRegister;
+    parameter.registerSpace = registerSpace;
+    parameter.visibility = visibility;
+    parameter.range = &range;
+    return Add(std::move(parameter), 1);
+}
+
+UINT RootSignatureBuilder::Add(Parameter parameter, UINT cost) {
+    if (cost_ + cost > s_maxRootDwords) {
+        ThrowIfFailed(E_INVALIDARG);
+    }
+
+    cost_ += cost;
+    parameters_.push_back(std::move(parameter));
+    return static_cast<UINT>(parameters_.size() - 1);
+}
+
+Microsoft::WRL::ComPtr<ID3D12RootSignature> RootSignatureBuilder::Build(
+    ID3D12Device* device,
+    UINT staticSamplerCount,
+    const D3D12_STATIC_SAMPLER_DESC* staticSamplers,
+    D3D12_ROOT_SIGNATURE_FLAGS flags) const {
+    std::vector<CD3DX12_ROOT_PARAMETER> rootParams(parameters_.size());
+    for (size_t i = 0; i < parameters_.size(); ++i) {
+        const auto& p = parameters_[i];
+        switch (p.kind) {
+        case RootParameterKind::Constants:
+            rootParams[i].InitAsConstants(p.num32BitValues, p.shaderRegister, p.registerSpace, p.visibility);
+            break;
+        case RootParameterKind::ConstantBufferView:
+            rootParams[i].InitAsConstantBufferView(p.shaderRegister, p.registerSpace, p.visibility);
+            break;
+        case RootParameterKind::ShaderResourceView:
+            rootParams[i].InitAsShaderResourceView(p.shaderRegister, p.registerSpace, p.visibility);
+            break;
+        case RootParameterKind::DescriptorTable:
+            rootParams[i].InitAsDescriptorTable(1, p.range, p.visibility);
+            break;
+        }
+    }
+
+    CD3DX12_ROOT_SIGNATURE_DESC desc = {static_cast<UINT>(rootParams.size()),
+                                        rootParams.data(),
+                                        staticSamplerCount,
+                                        staticSamplers,
+                                        flags};
+
+    Microsoft::WRL::ComPtr<ID3DBlob> serializedRootSignature;
+    Microsoft::WRL::ComPtr<ID3DBlob> error;
+    auto hr = D3D12SerializeRootSignature(&desc,
+                                          D3D_ROOT_SIGNATURE_VERSION_1,
+                                          serializedRootSignature.GetAddressOf(),
+                                          error.GetAddressOf());
+    if (error) {
+        ::OutputDebugStringA(static_cast<LPCSTR>(error->GetBufferPointer()));
+    }
+    ThrowIfFailed(hr);
+
+    Microsoft::WRL::ComPtr<ID3D12RootSignature> rootSignature;
+    ThrowIfFailed(device->CreateRootSignature(0,
+                                              serializedRootSignature->GetBufferPointer(),
+                                              serializedRootSignature->GetBufferSize(),
+                                              IID_PPV_ARGS(rootSignature.GetAddressOf())));
+    return rootSignature;
+}
+
+std::string RootSignatureBuilder::GetHlslDeclarations() const {
+    std::string declarations;
+    for (const auto& p : parameters_) {
+        if (p.fields.empty()) {
+            continue;
+        }
+
+        if (!declarations.empty()) {
+            declarations += ' ';
+        }
+        declarations += "cbuffer " + p.name + " : register(b" + std::to_string(p.shaderRegister);
+        if (p.registerSpace != 0) {
+            declarations += ", space" + std::to_string(p.registerSpace);
+        }
+        declarations += ") {";
+        for (const auto& field : p.fields) {
+            declarations += ' ' + field.type + ' ' + field.name + ';';
+        }
+        declarations += " };";
+    }
+    return declarations;
+}
+
+UINT RootSignatureBuilder::GetPackedSize(const std::vector<ConstantField>& fields) {
+    UINT offset = 0;
+    for (const auto& field : fields) {
+        auto layout = ParseType(field.type);
+        UINT size = (layout.registers - 1) * 16 + layout.components * 4;
+
+        // Matrices start a new register; other members only when they would straddle one.
+        if (layout.matrix || offset % 16 + size > 16) {
+            offset = (offset + 15) / 16 * 16;
+        }
+        offset += size;
+    }
+    return offset;
+}
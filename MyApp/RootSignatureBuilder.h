@@ -0,0 +1,120 @@
+#pragma once
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "Common/d3dUtil.h"
+
+enum class UpdateFrequency { PerFrame, PerMaterial, PerDraw };
+
+enum class RootParameterKind { Constants, ConstantBufferView, ShaderResourceView, DescriptorTable };
+
+// One member of a constant buffer as declared in HLSL, e.g. {"row_major float3x4", "gWorld"}.
+// Scalars, vectors and matrices of float/int/uint/bool are supported; arrays and structs are not.
+struct ConstantField {
+    std::string type;
+    std::string name;
+};
+
+// Builds a root signature from what each parameter holds instead of hand-picked slot types.
+//
+// AddConstants() picks the binding for a block of constant data. Per-draw data that is small
+// enough becomes root constants, written into the command list with no constant-buffer slot
+// behind it; everything else becomes a root CBV. Descriptor ranges always go in a table. The
+// 64-DWORD root signature limit is checked as parameters are added.
+//
+// Constant blocks added with fields get a generated cbuffer declaration, identical for both
+// bindings, so the shader cannot drift from the C++ layout. GetHlslDeclarations() returns them
+// on one line so they can be passed to the compiler as a macro.
+class RootSignatureBuilder {
+  public:
+    static constexpr UINT s_maxRootDwords = 64;
+
+    // Per-draw constant blocks up to this size are passed as root constants.
+    static constexpr UINT s_maxRootConstantDwords = 32;
+
+    struct Parameter {
+        std::string name;
+        RootParameterKind kind = RootParameterKind::Constants;
+        UpdateFrequency frequency = UpdateFrequency::PerFrame;
+        UINT shaderRegister = 0;
+        UINT registerSpace = 0;
+        UINT num32BitValues = 0;  // Constants only
+        D3D12_SHADER_VISIBILITY visibility = D3D12_SHADER_VISIBILITY_ALL;
+        std::vector<ConstantField> fields;
+        const CD3DX12_DESCRIPTOR_RANGE* range = nullptr;  // DescriptorTable only
+    };
+
+    // byteSize is sizeof the C++ struct; it must match the HLSL packing of fields. Leave fields
+    // empty for a cbuffer the shader declares by hand. Returns the root parameter index.
+    UINT AddConstants(const std::string& name,
+                      UINT shaderRegister,
+                      UINT byteSize,
+                      UpdateFrequency frequency,
+                      std::vector<ConstantField> fields = {},
+                      D3D12_SHADER_VISIBILITY visibility = D3D12_SHADER_VISIBILITY_ALL,
+                      UINT registerSpace = 0);
+
+    template <typename T>
+    UINT AddConstants(const std::string& name,
+                      UINT shaderRegister,
+                      UpdateFrequency frequency,
+                      std::vector<ConstantField> fields = {},
+                      D3D12_SHADER_VISIBILITY visibility = D3D12_SHADER_VISIBILITY_ALL,
+                      UINT registerSpace = 0) {
+        return AddConstants(name,
+                            shaderRegister,
+                            sizeof(T),
+                            frequency,
+                            std::move(fields),
+                            visibility,
+                            registerSpace);
+    }
+
+    // Root SRV for a buffer whose address changes at the given frequency.
+    UINT AddShaderResourceView(const std::string& name,
+                               UINT shaderRegister,
+                               UpdateFrequency frequency,
+                               D3D12_SHADER_VISIBILITY visibility = D3D12_SHADER_VISIBILITY_ALL,
+                               UINT registerSpace = 0);
+
+    // Table with one range; count may be UINT_MAX for an unbounded range.
+    UINT AddTable(const std::string& name,
+                  D3D12_DESCRIPTOR_RANGE_TYPE type,
+                  UINT count,
+                  UINT baseShaderRegister,
+                  UpdateFrequency frequency,
+                  D3D12_SHADER_VISIBILITY visibility = D3D12_SHADER_VISIBILITY_ALL,
+                  UINT registerSpace = 0);
+
+    [[nodiscard]]
+    Microsoft::WRL::ComPtr<ID3D12RootSignature> Build(ID3D12Device* device,
+                                                      UINT staticSamplerCount,
+                                                      const D3D12_STATIC_SAMPLER_DESC* staticSamplers,
+                                                      D3D12_ROOT_SIGNATURE_FLAGS flags) const;
+
+    [[nodiscard]]
+    std::string GetHlslDeclarations() const;
+
+    [[nodiscard]]
+    const Parameter& GetParameter(UINT index) const { return parameters_[index]; }
+
+    [[nodiscard]]
+    UINT GetParameterCount() const { return static_cast<UINT>(parameters_.size()); }
+
+    // Root signature size in DWORDs.
+    [[nodiscard]]
+    UINT GetCost() const { return cost_; }
+
+    // Bytes fields occupy under HLSL constant buffer packing, up to the end of the last field.
+    [[nodiscard]]
+    static UINT GetPackedSize(const std::vector<ConstantField>& fields);
+
+  private:
+    UINT Add(Parameter parameter, UINT cost);
+
+    std::vector<Parameter> parameters_;
+    std::deque<CD3DX12_DESCRIPTOR_RANGE> ranges_;  // stable addresses for Parameter::range
+    UINT cost_ = 0;
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+
+// Bounded queue for one producer thread and one consumer thread, without locks.
+//
+// Each side owns one index and only reads the other's, with acquire/release ordering so an
+// element is fully written before the consumer can see it. Both also cache the other's index
+// and reload it only when the queue looks full or empty, so a push or pop normally touches no
+// cache line the other thread writes. The indices sit on separate cache lines for the same reason.
+template <typename T>
+class SpscQueue {
+  public:
+    // capacity is rounded up to a power of two.
+    explicit SpscQueue(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        slots_ = std::make_unique<T[]>(size);
+        mask_ = size - 1;
+    }
+
+    SpscQueue(const SpscQueue& other) = delete;
+    SpscQueue& operator=(const SpscQueue& other) = delete;
+
+    // Producer only. Fails when full.
+    bool TryPush(const T& value) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cachedHead_ > mask_) {
+            cachedHead_ = head_.load(std::memory_order_acquire);
+            if (tail - cachedHead_ > mask_) {
+                return false;
+            }
+        }
+
+        slots_[tail & mask_] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. Fails when empty.
+    bool TryPop(T& value) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cachedTail_) {
+            cachedTail_ = tail_.load(std::memory_order_acquire);
+            if (head == cachedTail_) {
+                return false;
+            }
+        }
+
+        value = slots_[head & mask_];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    [[nodiscard]]
+    size_t GetCapacity() const { return mask_ + 1; }
+
+  private:
+    static constexpr size_t s_cacheLineSize = 64;
+
+    std::unique_ptr<T[]> slots_;
+    size_t mask_ = 0;
+
+    // Written by the consumer.
+    alignas(s_cacheLineSize) std::atomic<size_t> head_{0};
+    size_t cachedTail_ = 0;
+
+    // Written by the producer.
+    alignas(s_cacheLineSize) std::atomic<size_t> tail_{0};
+    size_t cachedHead_ = 0;
+};
@@ -0,0 +1,44 @@
+#include "StructuredBufferMirror.h"
+
+StructuredBufferMirror::StructuredBufferMirror(UINT stride, UINT capacity, UINT copyCount)
+    : stride_(stride),
+      capacity_(capacity),
+      data_(static_cast<size_t>(stride) * capacity),
+      dirty_(copyCount),
+      isDirty_(copyCount, std::vector<bool>(capacity, false)) {
+    assert(stride_ > 0 && copyCount > 0);
+}
+
+void StructuredBufferMirror::Set(UINT index, const void* data) {
+    assert(index < capacity_);
+    memcpy(data_.data() + static_cast<size_t>(index) * stride_, data, stride_);
+
+    for (size_t copy = 0; copy < dirty_.size(); ++copy) {
+        if (!isDirty_[copy][index]) {
+            isDirty_[copy][index] = true;
+            dirty_[copy].push_back(index);
+        }
+    }
+}
+
+std::vector<StructuredBufferMirror::Range> StructuredBufferMirror::TakeDirtyRanges(UINT copy) {
+    auto& dirty = dirty_[copy];
+    std::sort(dirty.begin(), dirty.end());
+
+    std::vector<Range> ranges;
+    for (UINT index : dirty) {
+        isDirty_[copy][index] = false;
+        if (!ranges.empty() && ranges.back().first + ranges.back().count == index) {
+            ++ranges.back().count;
+        } else {
+            ranges.push_back({index, 1});
+        }
+    }
+
+    stats_.elementsUploaded += dirty.size();
+    stats_.rangesUploaded += ranges.size();
+    stats_.bytesUploaded += static_cast<UINT64>(dirty.size()) * stride_;
+
+    dirty.clear();
+    return ranges;
+}
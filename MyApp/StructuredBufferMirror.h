@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vector>
+
+#include "Common/d3dUtil.h"
+
+// Tightly packed CPU copy of a structured buffer that has one GPU copy per frame resource.
+//
+// Set() writes an element into the mirror and marks it out of date in every GPU copy. When a
+// frame resource comes up, TakeDirtyRanges() hands back what its copy is missing as sorted,
+// coalesced index ranges, so the upload is one memcpy per run of neighbouring changes. Cost is
+// proportional to what changed, not to the element count. Pure CPU; it never touches a device.
+class StructuredBufferMirror {
+  public:
+    struct Range {
+        UINT first = 0;
+        UINT count = 0;
+    };
+
+    struct Stats {
+        UINT64 elementsUploaded = 0;
+        UINT64 rangesUploaded = 0;
+        UINT64 bytesUploaded = 0;
+    };
+
+    StructuredBufferMirror(UINT stride, UINT capacity, UINT copyCount);
+
+    void Set(UINT index, const void* data);
+
+    template <typename T>
+    void Set(UINT index, const T& data) {
+        assert(sizeof(T) == stride_);
+        Set(index, static_cast<const void*>(&data));
+    }
+
+    // Ranges copy is missing since its last call, sorted by index. Clears them.
+    [[nodiscard]]
+    std::vector<Range> TakeDirtyRanges(UINT copy);
+
+    [[nodiscard]]
+    bool IsDirty(UINT copy) const { return !dirty_[copy].empty(); }
+
+    [[nodiscard]]
+    const BYTE* GetData(UINT index = 0) const { return data_.data() + static_cast<size_t>(index) * stride_; }
+
+    [[nodiscard]]
+    UINT GetStride() const { return stride_; }
+
+    [[nodiscard]]
+    UINT GetCapacity() const { return capacity_; }
+
+    [[nodiscard]]
+    UINT GetCopyCount() const { return static_cast<UINT>(dirty_.size()); }
+
+    [[nodiscard]]
+    const Stats& GetStats() const { return stats_; }
+
+  private:
+    UINT stride_ = 0;
+    UINT capacity_ = 0;
+
+    std::vector<BYTE> data_;
+    std::vector<std::vector<UINT>> dirty_;     // per copy, unsorted indices
+    std::vector<std::vector<bool>> isDirty_;  // per copy, by index; keeps dirty_ free of duplicates
+
+    Stats stats_;
+};
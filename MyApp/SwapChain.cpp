@@ -0,0 +1,85 @@
+#include "SwapChain.h"
+
+SwapChain::SwapChain(ID3D12Device* device,
+                     IDXGIFactory* dxgiFactory,
+                     ID3D12CommandQueue* commandQueue,
+                     DXGI_SWAP_CHAIN_DESC desc,
+                     const Settings& settings)
+    : settings_(settings),
+      buffers_(settings.bufferCount) {
+    assert(settings_.bufferCount >= 2 && settings_.bufferCount <= DXGI_MAX_SWAP_CHAIN_BUFFERS);
+
+    desc.BufferCount = settings_.bufferCount;
+    if (settings_.latencyMode == FrameLatencyMode::LowLatency) {
+        desc.Flags |= DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT;
+    }
+    flags_ = desc.Flags;
+    backBufferFormat_ = desc.BufferDesc.Format;
+
+    Microsoft::WRL::ComPtr<IDXGISwapChain> swapChain;
+    ThrowIfFailed(dxgiFactory->CreateSwapChain(commandQueue, &desc, swapChain.GetAddressOf()));
+    ThrowIfFailed(swapChain.As(&dxgiSwapChain_));
+
+    if (settings_.latencyMode == FrameLatencyMode::LowLatency) {
+        assert(settings_.maxFrameLatency > 0);
+        ThrowIfFailed(dxgiSwapChain_->SetMaximumFrameLatency(settings_.maxFrameLatency));
+        frameLatencyWaitable_ = dxgiSwapChain_->GetFrameLatencyWaitableObject();
+    }
+
+    D3D12_DESCRIPTOR_HEAP_DESC rtvHeapDesc{};
+    rtvHeapDesc.NumDescriptors = settings_.bufferCount;
+    rtvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
+    rtvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+    rtvHeapDesc.NodeMask = 0;
+    rtvHeap_ = std::make_unique<DescriptorHeap>(device, rtvHeapDesc);
+
+    CreateRtvs(device);
+}
+
+SwapChain::~SwapChain() {
+    if (frameLatencyWaitable_) {
+        CloseHandle(frameLatencyWaitable_);
+    }
+}
+
+void SwapChain::CreateRtvs(ID3D12Device* device) {
+    for (int i = 0; i < settings_.bufferCount; ++i) {
+        ThrowIfFailed(dxgiSwapChain_->GetBuffer(i, IID_PPV_ARGS(buffers_[i].ReleaseAndGetAddressOf())));
+
+        device->CreateRenderTargetView(buffers_[i].Get(), nullptr, rtvHeap_->GetDescriptorHandleCpu(i));
+    }
+    currentBackBuffer_ = static_cast<int>(dxgiSwapChain_->GetCurrentBackBufferIndex());
+}
+
+void SwapChain::WaitForNextFrame() {
+    if (!frameLatencyWaitable_) {
+        return;
+    }
+
+    // Every frame takes one signal. A frame that went ahead after a timeout did not, so the next
+    // frame takes two; otherwise frames would queue one deeper from then on.
+    UINT waits = frameWaitOwed_ ? 2 : 1;
+    while (waits > 0) {
+        DWORD result = WaitForSingleObjectEx(frameLatencyWaitable_, settings_.frameWaitTimeoutMs, true);
+        if (result == WAIT_OBJECT_0) {
+            --waits;
+        } else if (result == WAIT_TIMEOUT) {
+            ++frameWaitTimeouts_;
+            frameWaitOwed_ = true;
+            return;
+        } else if (result == WAIT_FAILED) {
+            ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
+        }
+        // WAIT_IO_COMPLETION: an APC ran on this thread; keep waiting.
+    }
+    frameWaitOwed_ = false;
+}
+
+HRESULT SwapChain::Resize(int clientWidth, int clientHeight) {
+    // The flags have to match the ones the swap chain was created with.
+    return dxgiSwapChain_->ResizeBuffers(settings_.bufferCount,
+                                         clientWidth,
+                                         clientHeight,
+                                         backBufferFormat_,
+                                         flags_);
+}
@@ -1,77 +1,98 @@
 #pragma once
 
-#include <queue>
-
 #include "Common/d3dUtil.h"
 
 #include "DescriptorHeap.h"
+#include "PresentTarget.h"
+
+// How far the CPU may run ahead of the display.
+enum class FrameLatencyMode {
+    // Frames queue up to DXGI's default latency and Present() blocks once the queue is full.
+    // Keeps the GPU busiest, at the cost of input being several frames old when it is shown.
+    Throughput,
+
+    // A waitable swap chain limited to maxFrameLatency queued frames. WaitForNextFrame() blocks
+    // until one can be queued, so the frame after it starts from fresh input.
+    LowLatency,
+};
 
-template <int bufferCount>
-class SwapChain {
+class SwapChain final : public PresentTarget {
   public:
-    static int BufferCount() { return bufferCount; }
-
-    explicit SwapChain(ID3D12Device* device,
-                       IDXGIFactory* dxgiFactory,
-                       ID3D12CommandQueue* commandQueue,
-                       DXGI_SWAP_CHAIN_DESC desc) {
-        ThrowIfFailed(
-            dxgiFactory->CreateSwapChain(commandQueue, &desc, dxgiSwapChain_.GetAddressOf()));
-
-        D3D12_DESCRIPTOR_HEAP_DESC rtvHeapDesc{};
-        rtvHeapDesc.NumDescriptors = bufferCount;
-        rtvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
-        rtvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
-        rtvHeapDesc.NodeMask = 0;
-        rtvHeap_ = std::make_unique<DescriptorHeap>(device, rtvHeapDesc);
-
-        CreateRtvs(device);
-    }
+    struct Settings {
+        int bufferCount = 2;
+        FrameLatencyMode latencyMode = FrameLatencyMode::Throughput;
+        UINT maxFrameLatency = 1;  // LowLatency only
+        UINT syncInterval = 0;
 
-    void CreateRtvs(ID3D12Device* device) {
-        for (int i = 0; i < bufferCount; ++i) {
-            ThrowIfFailed(
-                dxgiSwapChain_->GetBuffer(i, IID_PPV_ARGS(buffers_[i].ReleaseAndGetAddressOf())));
+        // LowLatency only. Bounds WaitForNextFrame(), so a swap chain that stops signalling
+        // (e.g. while occluded) cannot hang the app.
+        DWORD frameWaitTimeoutMs = 1000;
+    };
 
-            device->CreateRenderTargetView(buffers_[i].Get(), nullptr, rtvHeap_->GetDescriptorHandleCpu(i));
-        }
-    }
+    SwapChain(ID3D12Device* device,
+              IDXGIFactory* dxgiFactory,
+              ID3D12CommandQueue* commandQueue,
+              DXGI_SWAP_CHAIN_DESC desc,
+              const Settings& settings);
+
+    SwapChain(const SwapChain& other) = delete;
+    SwapChain& operator=(const SwapChain& other) = delete;
+
+    ~SwapChain() override;
+
+    int BufferCount() const override { return settings_.bufferCount; }
+
+    const Settings& GetSettings() const { return settings_; }
+
+    void CreateRtvs(ID3D12Device* device) override;
 
     void ResetDxgiSwapChain() { dxgiSwapChain_.Reset(); }
 
-    void ResetAllBuffers() {
+    void ResetAllBuffers() override {
         for (auto& buf : buffers_) {
             buf.Reset();
         }
     }
 
-    HRESULT Present() const { return dxgiSwapChain_->Present(0, 0); }
+    HRESULT Present() override { return dxgiSwapChain_->Present(settings_.syncInterval, 0); }
 
-    DXGI_FORMAT GetFormat() const { return backBufferFormat_; }
+    // Blocks until another frame can be queued, or frameWaitTimeoutMs has passed; returns at
+    // once in throughput mode.
+    void WaitForNextFrame() override;
 
-    void SwapBuffers() { currentBackBuffer_ = (currentBackBuffer_ + 1) % bufferCount; }
+    // Waits in WaitForNextFrame() that gave up after frameWaitTimeoutMs.
+    [[nodiscard]]
+    UINT64 GetFrameWaitTimeouts() const { return frameWaitTimeouts_; }
 
-    ID3D12Resource* GetCurrentBackBuffer() const { return buffers_[currentBackBuffer_].Get(); }
+    DXGI_FORMAT GetFormat() const override { return backBufferFormat_; }
 
-    D3D12_CPU_DESCRIPTOR_HANDLE GetCurrentBackBufferView() const {
-        return rtvHeap_->GetDescriptorHandleCpu(currentBackBuffer_);
+    void SwapBuffers() override {
+        currentBackBuffer_ = static_cast<int>(dxgiSwapChain_->GetCurrentBackBufferIndex());
     }
 
-    HRESULT Resize(int clientWidth, int clientHeight) {
-        return dxgiSwapChain_->ResizeBuffers(bufferCount,
-                                             clientWidth,
-                                             clientHeight,
-                                             backBufferFormat_,
-                                             DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH);
+    ID3D12Resource* GetCurrentBackBuffer() const override { return buffers_[currentBackBuffer_].Get(); }
+
+    ID3D12Resource* GetBuffer(int i) const override { return buffers_[i].Get(); }
+
+    D3D12_CPU_DESCRIPTOR_HANDLE GetCurrentBackBufferView() const override {
+        return rtvHeap_->GetDescriptorHandleCpu(currentBackBuffer_);
     }
 
+    HRESULT Resize(int clientWidth, int clientHeight) override;
+
   private:
-    Microsoft::WRL::ComPtr<IDXGISwapChain> dxgiSwapChain_;
+    Microsoft::WRL::ComPtr<IDXGISwapChain3> dxgiSwapChain_;
+
+    Settings settings_;
+    UINT flags_ = 0;
+    HANDLE frameLatencyWaitable_ = nullptr;  // LowLatency only
+    UINT64 frameWaitTimeouts_ = 0;
+    bool frameWaitOwed_ = false;  // the last frame went ahead without its signal
 
-    std::array<Microsoft::WRL::ComPtr<ID3D12Resource>, bufferCount> buffers_;
+    std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> buffers_;
 
     std::unique_ptr<DescriptorHeap> rtvHeap_;
 
     int currentBackBuffer_ = 0;
     DXGI_FORMAT backBufferFormat_ = DXGI_FORMAT_R8G8B8A8_UNORM;
-};
\ No newline at end of file
+};
@@ -60,4 +60,13 @@ Timer::TimeCount Timer::GetCurrentCount() {
     TimeCount t;
     QueryPerformanceCounter(reinterpret_cast<LARGE_INTEGER*>(&t));
     return t;
+}
+
+double Timer::GetCurrentSeconds() {
+    static const double secondsPerCount = [] {
+        TimeCount countsPerSeconds;
+        QueryPerformanceFrequency(reinterpret_cast<LARGE_INTEGER*>(&countsPerSeconds));
+        return 1.0 / static_cast<double>(countsPerSeconds);
+    }();
+    return static_cast<double>(GetCurrentCount()) * secondsPerCount;
 }
\ No newline at end of file
@@ -8,6 +8,9 @@ class Timer {
 
     static TimeCount GetCurrentCount();
 
+    // The performance counter in seconds, from an arbitrary origin.
+    static double GetCurrentSeconds();
+
     Timer();
 
     float TotalTimeFromStart() const;
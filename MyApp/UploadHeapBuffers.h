@@ -2,6 +2,7 @@
 
 #include "Common/d3dUtil.h"
 #include "DescriptorHeap.h"
+#include "MappedWriter.h"
 
 template <typename T>
 class UploadBuffer {
@@ -19,7 +20,8 @@ class UploadBuffer {
                                                       nullptr,
                                                       IID_PPV_ARGS(&uploadBuffer_)));
 
-        ThrowIfFailed(uploadBuffer_->Map(0, nullptr, reinterpret_cast<void**>(&mappedData_)));
+        CD3DX12_RANGE noReads(0, 0);  // write-only; see MappedWriter
+        ThrowIfFailed(uploadBuffer_->Map(0, &noReads, reinterpret_cast<void**>(&mappedData_)));
     }
 
     UploadBuffer(const UploadBuffer& other) = delete;
@@ -48,7 +50,15 @@ class UploadBuffer {
     UINT GetBufferByteSize() const { return elementCount_ * elementByteSize_; }
 
     void Load(int elementIndex, const T& data) {
-        memcpy(&mappedData_[elementIndex * elementByteSize_], &data, sizeof(T));
+        MappedWriter(&mappedData_[elementIndex * elementByteSize_], sizeof(T)).Write(data);
+    }
+
+    // Elements are tightly packed, so a run of them is a single sequential write. Prefer this
+    // over per-element Load() when refreshing many elements.
+    void Load(int firstElement, const T* data, UINT count) {
+        assert(static_cast<UINT>(firstElement) + count <= elementCount_);
+        MappedWriter writer(&mappedData_[firstElement * elementByteSize_], count * elementByteSize_);
+        writer.Write(data, count);
     }
 
   private:
@@ -84,7 +94,8 @@ class ConstantBuffer {
                                                       nullptr,
                                                       IID_PPV_ARGS(&uploadBuffer_)));
 
-        ThrowIfFailed(uploadBuffer_->Map(0, nullptr, reinterpret_cast<void**>(&mappedData_)));
+        CD3DX12_RANGE noReads(0, 0);  // write-only; see MappedWriter
+        ThrowIfFailed(uploadBuffer_->Map(0, &noReads, reinterpret_cast<void**>(&mappedData_)));
     }
 
     ConstantBuffer(const ConstantBuffer& other) = delete;
@@ -113,7 +124,7 @@ class ConstantBuffer {
     UINT GetBufferByteSize() const { return elementCount_ * elementByteSize_; }
 
     void Load(int elementIndex, const T& data) {
-        memcpy(&mappedData_[elementIndex * elementByteSize_], &data, sizeof(T));
+        MappedWriter(&mappedData_[elementIndex * elementByteSize_], sizeof(T)).Write(data);
     }
 
   private:
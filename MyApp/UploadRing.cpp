@@ -0,0 +1,128 @@
+#include "UploadRing.h"
+
+using Microsoft::WRL::ComPtr;
+
+namespace {
+
+ComPtr<ID3D12Resource> CreateUploadBuffer(ID3D12Device* device, UINT64 size) {
+    ComPtr<ID3D12Resource> buffer;
+    auto heapProp = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+    auto desc = CD3DX12_RESOURCE_DESC::Buffer(size);
+    ThrowIfFailed(device->CreateCommittedResource(&heapProp,
+                                                  D3D12_HEAP_FLAG_NONE,
+                                                  &desc,
+                                                  D3D12_RESOURCE_STATE_GENERIC_READ,
+                                                  nullptr,
+                                                  IID_PPV_ARGS(&buffer)));
+    return buffer;
+}
+
+}  // namespace
+
+UploadRing::UploadRing(ID3D12Device* device, ID3D12Fence* fence, UINT64 capacity)
+    : device_(device),
+      fence_(fence),
+      capacity_(capacity) {
+    fenceEvent_ = CreateEventEx(nullptr, nullptr, false, EVENT_ALL_ACCESS);
+    if (!fenceEvent_) {
+        ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
+    }
+
+    buffer_ = CreateUploadBuffer(device, capacity_);
+    CD3DX12_RANGE noReads(0, 0);  // write-only; see MappedWriter
+    ThrowIfFailed(buffer_->Map(0, &noReads, reinterpret_cast<void**>(&cpu_)));
+}
+
+UploadRing::~UploadRing() {
+    buffer_->Unmap(0, nullptr);
+    CloseHandle(fenceEvent_);
+}
+
+UploadRing::Allocation UploadRing::Allocate(UINT64 size, UINT64 alignment) {
+    ++stats_.allocations;
+    stats_.bytesAllocated += size;
+
+    Reclaim();
+    if (size > capacity_) {
+        return AllocateOverflow(size);
+    }
+
+    for (;;) {
+        // Try the aligned head first, otherwise skip the rest of the ring and start over at 0.
+        UINT64 offset = (head_ + alignment - 1) & ~(alignment - 1);
+        bool wrap = offset + size > capacity_;
+        if (wrap) {
+            offset = 0;
+        }
+        UINT64 padding = wrap ? capacity_ - head_ : offset - head_;
+
+        if (used_ + padding + size <= capacity_) {
+            if (wrap) {
+                ++stats_.wraparounds;
+            }
+            head_ = offset + size;
+            used_ += padding + size;
+            open_.end = head_;
+            open_.bytes += padding + size;
+
+            stats_.bytesInFlight = used_;
+            stats_.peakBytesInFlight = std::max(stats_.peakBytesInFlight, used_);
+            return {buffer_.Get(), offset, cpu_ + offset};
+        }
+
+        // Waiting on the open batch would never return: its copies have not been submitted.
+        if (submitted_.empty()) {
+            return AllocateOverflow(size);
+        }
+
+        ++stats_.stalls;
+        WaitForFence(submitted_.front().fenceValue);
+        Reclaim();
+    }
+}
+
+void UploadRing::Submit(UINT64 fenceValue) {
+    if (open_.bytes == 0 && open_.overflow.empty()) {
+        return;
+    }
+
+    open_.fenceValue = fenceValue;
+    submitted_.push_back(std::move(open_));
+    open_ = Batch{};
+}
+
+void UploadRing::Reclaim() {
+    UINT64 completed = fence_->GetCompletedValue();
+    while (!submitted_.empty() && submitted_.front().fenceValue <= completed) {
+        const Batch& batch = submitted_.front();
+        if (batch.bytes > 0) {
+            tail_ = batch.end;
+            used_ -= batch.bytes;
+        }
+        submitted_.pop_front();
+    }
+
+    if (used_ == 0) {
+        head_ = 0;
+        tail_ = 0;
+    }
+    stats_.bytesInFlight = used_;
+}
+
+UploadRing::Allocation UploadRing::AllocateOverflow(UINT64 size) {
+    ++stats_.overflows;
+
+    auto buffer = CreateUploadBuffer(device_.Get(), size);
+    BYTE* cpu = nullptr;
+    CD3DX12_RANGE noReads(0, 0);  // write-only; see MappedWriter
+    ThrowIfFailed(buffer->Map(0, &noReads, reinterpret_cast<void**>(&cpu)));
+    open_.overflow.push_back(buffer);
+    return {buffer.Get(), 0, cpu};
+}
+
+void UploadRing::WaitForFence(UINT64 fenceValue) {
+    if (fence_->GetCompletedValue() < fenceValue) {
+        ThrowIfFailed(fence_->SetEventOnCompletion(fenceValue, fenceEvent_));
+        WaitForSingleObject(fenceEvent_, INFINITE);
+    }
+}
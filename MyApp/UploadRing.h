@@ -0,0 +1,86 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+
+#include "Common/d3dUtil.h"
+
+// Shared staging memory for copies into default-heap resources.
+//
+// One persistently mapped upload buffer is carved up as a ring. Allocations made since the last
+// Submit() form an open batch; Submit() stamps that batch with the fence value the queue will
+// signal once the command list recording the copies has executed. Reclaim() releases every batch
+// whose fence has completed, so callers never hold on to staging resources themselves.
+//
+// When the ring is full, Allocate() waits on the oldest submitted batch (a stall). If only the
+// open batch is in the way, or a single request is larger than the ring, the allocation falls
+// back to a dedicated upload buffer that is released with its batch (an overflow).
+class UploadRing {
+  public:
+    struct Allocation {
+        ID3D12Resource* resource = nullptr;
+        UINT64 offset = 0;
+        BYTE* cpu = nullptr;
+    };
+
+    struct Stats {
+        UINT64 allocations = 0;
+        UINT64 bytesAllocated = 0;
+        UINT64 wraparounds = 0;
+        UINT64 stalls = 0;
+        UINT64 overflows = 0;
+        UINT64 bytesInFlight = 0;  // including alignment and wrap padding
+        UINT64 peakBytesInFlight = 0;
+    };
+
+    UploadRing(ID3D12Device* device, ID3D12Fence* fence, UINT64 capacity);
+
+    UploadRing(const UploadRing& other) = delete;
+    UploadRing& operator=(const UploadRing& other) = delete;
+
+    // The GPU must be done with all submitted batches.
+    ~UploadRing();
+
+    // alignment must be a power of two.
+    [[nodiscard]]
+    Allocation Allocate(UINT64 size, UINT64 alignment = 16);
+
+    // Call right after the queue has been asked to signal fenceValue.
+    void Submit(UINT64 fenceValue);
+
+    void Reclaim();
+
+    [[nodiscard]]
+    UINT64 GetCapacity() const { return capacity_; }
+
+    [[nodiscard]]
+    const Stats& GetStats() const { return stats_; }
+
+  private:
+    struct Batch {
+        UINT64 fenceValue = 0;
+        UINT64 end = 0;    // head_ after the batch's last ring allocation
+        UINT64 bytes = 0;  // ring bytes, padding included
+        std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> overflow;
+    };
+
+    Allocation AllocateOverflow(UINT64 size);
+    void WaitForFence(UINT64 fenceValue);
+
+    Microsoft::WRL::ComPtr<ID3D12Device> device_;
+    Microsoft::WRL::ComPtr<ID3D12Fence> fence_;
+    HANDLE fenceEvent_ = nullptr;
+
+    Microsoft::WRL::ComPtr<ID3D12Resource> buffer_;
+    BYTE* cpu_ = nullptr;
+    UINT64 capacity_ = 0;
+
+    UINT64 head_ = 0;  // next free byte
+    UINT64 tail_ = 0;  // oldest byte still in flight
+    UINT64 used_ = 0;  // bytes between tail_ and head_
+
+    Batch open_;
+    std::deque<Batch> submitted_;  // oldest first
+
+    Stats stats_;
+};
@@ -0,0 +1,94 @@
+#include <cstring>
+
+#include "Check.h"
+
+#include "Common/BCTranscoder.h"
+
+namespace {
+
+void SetTexel(uint8_t rgba[64], int i, uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+    rgba[i * 4 + 0] = r;
+    rgba[i * 4 + 1] = g;
+    rgba[i * 4 + 2] = b;
+    rgba[i * 4 + 3] = a;
+}
+
+// Colors exactly representable in 5:6:5, so a block made of them should survive a round trip.
+void TestBC1Opaque() {
+    uint8_t rgba[64];
+    for (int i = 0; i < 16; ++i) {
+        if (i % 2 == 0) {
+            SetTexel(rgba, i, 255, 0, 0, 255);
+        } else {
+            SetTexel(rgba, i, 0, 0, 255, 255);
+        }
+    }
+
+    uint8_t block[8];
+    uint8_t decoded[64];
+    BCTranscoder::EncodeBlockBC1(rgba, block);
+    BCTranscoder::DecodeBlockBC1(block, decoded);
+    CHECK(std::memcmp(rgba, decoded, sizeof(rgba)) == 0);
+}
+
+// A block with transparent texels must be encoded in three-color mode, which is what the decoder
+// sees for c0 <= c1: index 3 is transparent black and index 2 the midpoint.
+void TestBC1Transparent() {
+    uint8_t rgba[64];
+    for (int i = 0; i < 16; ++i) {
+        switch (i % 4) {
+            case 0:
+                SetTexel(rgba, i, 255, 0, 0, 255);
+                break;
+            case 1:
+                SetTexel(rgba, i, 0, 0, 255, 255);
+                break;
+            default:
+                SetTexel(rgba, i, 0, 0, 0, 0);
+                break;
+        }
+    }
+
+    uint8_t block[8];
+    uint8_t decoded[64];
+    BCTranscoder::EncodeBlockBC1(rgba, block);
+    BCTranscoder::DecodeBlockBC1(block, decoded);
+    CHECK(std::memcmp(rgba, decoded, sizeof(rgba)) == 0);
+
+    uint16_t c0 = static_cast<uint16_t>(block[0] | (block[1] << 8));
+    uint16_t c1 = static_cast<uint16_t>(block[2] | (block[3] << 8));
+    CHECK(c0 <= c1);
+}
+
+// Opaque texels close to the midpoint of the endpoints next to transparent ones.
+void TestBC1TransparentGradient() {
+    uint8_t rgba[64];
+    for (int i = 0; i < 16; ++i) {
+        if (i < 4) {
+            SetTexel(rgba, i, 0, 0, 0, 0);
+        } else {
+            auto v = static_cast<uint8_t>((i - 4) * 255 / 11);
+            SetTexel(rgba, i, v, v, v, 255);
+        }
+    }
+
+    uint8_t block[8];
+    uint8_t decoded[64];
+    BCTranscoder::EncodeBlockBC1(rgba, block);
+    BCTranscoder::DecodeBlockBC1(block, decoded);
+    for (int i = 0; i < 16; ++i) {
+        CHECK(decoded[i * 4 + 3] == rgba[i * 4 + 3]);
+        for (int c = 0; c < 3; ++c) {
+            int diff = decoded[i * 4 + c] - rgba[i * 4 + c];
+            CHECK(diff >= -64 && diff <= 64);
+        }
+    }
+}
+
+}  // namespace
+
+void TestBCTranscoder() {
+    TestBC1Opaque();
+    TestBC1Transparent();
+    TestBC1TransparentGradient();
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdio>
+
+// Checks for the CPU-side code that can run without a device. A failed check is reported and
+// counted, and the test carries on; main() returns nonzero if any check failed.
+inline int g_checkFailures = 0;
+
+#define CHECK(expr)                                                                              \
+    do {                                                                                         \
+        if (!(expr)) {                                                                           \
+            std::fprintf(stderr, "%s(%d): CHECK(%s) failed\n", __FILE__, __LINE__, #expr);       \
+            ++g_checkFailures;                                                                   \
+        }                                                                                        \
+    } while (false)
+
+void TestBCTranscoder();
+void TestCommandContextPool();
+void TestCopyUploader();
+void TestDefaultHeapAllocator();
+void TestDeferredReleaseQueue();
+void TestDescriptorAllocator();
+void TestFrameGraph();
+void TestFramePacer();
+void TestLinearUploadAllocator();
+void TestMappedWriter();
+void TestMaterialTable();
+void TestMipGenerator();
+void TestNullFrameLoop();
+void TestParallelRecorder();
+void TestPresentPacingPolicy();
+void TestRenderChannel();
+void TestResourceStateTracker();
+void TestTextureCache();
+void TestUploadRing();
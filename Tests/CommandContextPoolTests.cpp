@@ -0,0 +1,130 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "Check.h"
+
+#include "CommandContextPool.h"
+
+namespace {
+
+// A fence the test completes by hand.
+class FakeFence final : public FenceBackend {
+  public:
+    void Complete(UINT64 value) { completed_ = value; }
+
+    UINT64 GetCompletedValue() override { return completed_; }
+
+    void Wait(UINT64 value) override { completed_ = std::max<UINT64>(completed_, value); }
+
+  private:
+    std::atomic<UINT64> completed_{0};
+};
+
+// Leaves the allocator and list null and counts what the pool asks of it. Called from several
+// threads.
+class FakeContextBackend final : public CommandContextBackend {
+  public:
+    void Create(CommandContext& context, ID3D12PipelineState*) override { ++creates; }
+
+    void Reset(CommandContext& context, ID3D12PipelineState*) override { ++resets; }
+
+    std::atomic<UINT64> creates{0};
+    std::atomic<UINT64> resets{0};
+};
+
+constexpr UINT64 s_framesInFlight = 3;
+constexpr UINT64 s_frameCount = 30;
+
+void TestRecycling() {
+    FakeContextBackend backend;
+    FakeFence fence;
+    CommandContextPool pool(&backend, &fence);
+
+    CommandContext* first = pool.Acquire(D3D12_COMMAND_LIST_TYPE_DIRECT);
+    CHECK(first->type == D3D12_COMMAND_LIST_TYPE_DIRECT);
+    pool.Release(first, 1);
+
+    // Still in flight: a second context is created rather than waiting.
+    CommandContext* second = pool.Acquire(D3D12_COMMAND_LIST_TYPE_DIRECT);
+    CHECK(second != first);
+    CHECK(backend.creates == 2);
+    pool.Release(second, 2);
+
+    // Only the oldest has completed, so only it comes back, reset.
+    fence.Complete(1);
+    CommandContext* reused = pool.Acquire(D3D12_COMMAND_LIST_TYPE_DIRECT);
+    CHECK(reused == first);
+    CHECK(backend.resets == 1);
+    CommandContext* third = pool.Acquire(D3D12_COMMAND_LIST_TYPE_DIRECT);
+    CHECK(third != second);
+    CHECK(backend.creates == 3);
+
+    CHECK(pool.GetContextCount(D3D12_COMMAND_LIST_TYPE_DIRECT) == 3);
+    CHECK(pool.GetStats().acquired == 4);
+    CHECK(pool.GetStats().created == 3);
+}
+
+// Each queue type is recycled by its own fence.
+void TestPerTypeFence() {
+    FakeContextBackend backend;
+    FakeFence directFence;
+    FakeFence copyFence;
+    CommandContextPool pool(&backend, &directFence);
+    pool.SetFence(D3D12_COMMAND_LIST_TYPE_COPY, &copyFence);
+
+    CommandContext* direct = pool.Acquire(D3D12_COMMAND_LIST_TYPE_DIRECT);
+    CommandContext* copy = pool.Acquire(D3D12_COMMAND_LIST_TYPE_COPY);
+    CHECK(copy->type == D3D12_COMMAND_LIST_TYPE_COPY);
+    pool.Release(direct, 1);
+    pool.Release(copy, 1);
+
+    // The copy fence passing 1 says nothing about the direct queue.
+    copyFence.Complete(1);
+    CHECK(pool.Acquire(D3D12_COMMAND_LIST_TYPE_COPY) == copy);
+    CHECK(pool.Acquire(D3D12_COMMAND_LIST_TYPE_DIRECT) != direct);
+
+    CHECK(pool.GetContextCount(D3D12_COMMAND_LIST_TYPE_DIRECT) == 2);
+    CHECK(pool.GetContextCount(D3D12_COMMAND_LIST_TYPE_COPY) == 1);
+    CHECK(pool.GetContextCount(D3D12_COMMAND_LIST_TYPE_COMPUTE) == 0);
+}
+
+// Several threads acquire a context each per frame, with the GPU s_framesInFlight frames behind:
+// the pool settles at the contexts of the frames in flight and then only reuses.
+void TestFramesInFlight() {
+    FakeContextBackend backend;
+    FakeFence fence;
+    CommandContextPool pool(&backend, &fence);
+
+    constexpr UINT64 threadCount = 4;
+    for (UINT64 frame = 1; frame <= s_frameCount; ++frame) {
+        if (frame > s_framesInFlight) {
+            fence.Complete(frame - s_framesInFlight);
+        }
+
+        std::vector<std::thread> threads;
+        for (UINT64 i = 0; i < threadCount; ++i) {
+            threads.emplace_back([&] {
+                CommandContext* context = pool.Acquire(D3D12_COMMAND_LIST_TYPE_DIRECT);
+                pool.Release(context, frame);
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    auto stats = pool.GetStats();
+    CHECK(stats.acquired == threadCount * s_frameCount);
+    CHECK(stats.created == threadCount * s_framesInFlight);
+    CHECK(pool.GetContextCount(D3D12_COMMAND_LIST_TYPE_DIRECT) == threadCount * s_framesInFlight);
+    CHECK(backend.resets == threadCount * (s_frameCount - s_framesInFlight));
+}
+
+}  // namespace
+
+void TestCommandContextPool() {
+    TestRecycling();
+    TestPerTypeFence();
+    TestFramesInFlight();
+}
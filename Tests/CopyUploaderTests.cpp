@@ -0,0 +1,179 @@
+#include <algorithm>
+#include <vector>
+
+#include "Check.h"
+
+#include "CopyUploader.h"
+#include "NullDevice.h"
+
+namespace {
+
+// A copy queue whose batches complete only when the test says so. It hands out null lists and
+// records every submission and every wait the consuming queue was asked to insert.
+class SimulatedCopyQueue final : public CopyQueueBackend {
+  public:
+    ID3D12GraphicsCommandList* Open() override {
+        ++opens;
+        return nullptr;
+    }
+
+    void Submit(UINT64 fenceValue) override { submitted.push_back(fenceValue); }
+
+    void InsertWait(ID3D12CommandQueue*, UINT64 fenceValue) override { gpuWaits.push_back(fenceValue); }
+
+    UINT64 GetCompletedValue() override { return completed; }
+
+    void Wait(UINT64 value) override {
+        ++cpuWaits;
+        completed = std::max(completed, value);
+    }
+
+    UINT64 completed = 0;
+    UINT64 opens = 0;
+    UINT64 cpuWaits = 0;
+    std::vector<UINT64> submitted;
+    std::vector<UINT64> gpuWaits;
+};
+
+constexpr UINT64 s_batchBytes = 1000;
+
+Microsoft::WRL::ComPtr<ID3D12Resource> MakeResource() {
+    Microsoft::WRL::ComPtr<ID3D12Resource> resource;
+    resource.Attach(new NullResource(CD3DX12_RESOURCE_DESC::Buffer(256)));
+    return resource;
+}
+
+ULONG GetRefCount(IUnknown* object) {
+    object->AddRef();
+    return object->Release();
+}
+
+// Uploads share a batch until it holds batchBytes; the one that crosses it submits the batch.
+void TestBatching() {
+    SimulatedCopyQueue queue;
+    CopyUploader uploader(&queue, s_batchBytes);
+
+    (void)uploader.GetCommandList();
+    auto first = uploader.Commit(400);
+    (void)uploader.GetCommandList();
+    auto second = uploader.Commit(400);
+    CHECK(first.fenceValue == 1 && second.fenceValue == 1);
+    CHECK(queue.submitted.empty());
+
+    (void)uploader.GetCommandList();
+    auto third = uploader.Commit(300);
+    CHECK(third.fenceValue == 1);
+    CHECK(queue.submitted == std::vector<UINT64>{1});
+
+    (void)uploader.GetCommandList();
+    auto fourth = uploader.Commit(100);
+    CHECK(fourth.fenceValue == 2);
+    CHECK(queue.opens == 2);
+
+    uploader.Flush();
+    uploader.Flush();
+    CHECK((queue.submitted == std::vector<UINT64>{1, 2}));
+
+    const auto& stats = uploader.GetStats();
+    CHECK(stats.uploads == 4);
+    CHECK(stats.bytes == 1200);
+    CHECK(stats.batches == 2);
+}
+
+// The consuming queue waits on the GPU only for the newest batch it requires, only once, and
+// not at all if that batch has already completed.
+void TestDependencies() {
+    SimulatedCopyQueue queue;
+    CopyUploader uploader(&queue, s_batchBytes);
+
+    (void)uploader.GetCommandList();
+    auto first = uploader.Commit(100);
+    uploader.Flush();
+    (void)uploader.GetCommandList();
+    auto second = uploader.Commit(100);
+    uploader.Flush();
+
+    queue.completed = 1;
+    CHECK(uploader.IsComplete(first));
+    CHECK(!uploader.IsComplete(second));
+    CHECK(uploader.IsComplete({}));
+
+    uploader.Require({});
+    uploader.InsertWaits(nullptr);
+    CHECK(queue.gpuWaits.empty());
+
+    uploader.Require(first);
+    uploader.InsertWaits(nullptr);
+    CHECK(queue.gpuWaits.empty());
+    CHECK(uploader.GetStats().skippedWaits == 1);
+
+    uploader.Require(second);
+    uploader.Require(first);
+    uploader.InsertWaits(nullptr);
+    uploader.InsertWaits(nullptr);
+    CHECK(queue.gpuWaits == std::vector<UINT64>{2});
+
+    // A required batch that is still open is submitted first, or the wait would never end.
+    (void)uploader.GetCommandList();
+    auto open = uploader.Commit(100);
+    uploader.Require(open);
+    uploader.InsertWaits(nullptr);
+    CHECK((queue.submitted == std::vector<UINT64>{1, 2, 3}));
+    CHECK((queue.gpuWaits == std::vector<UINT64>{2, 3}));
+    CHECK(uploader.GetStats().gpuWaits == 2);
+
+    // The destructor waits for every batch; none of these needs the CPU to block before.
+    CHECK(queue.cpuWaits == 0);
+}
+
+// Retained resources live until their batch completes.
+void TestRetain() {
+    SimulatedCopyQueue queue;
+    auto staging = MakeResource();
+    auto late = MakeResource();
+    auto unused = MakeResource();
+    {
+        CopyUploader uploader(&queue, s_batchBytes);
+
+        // Nothing submitted and no open batch: the GPU cannot be using it.
+        uploader.Retain(unused);
+        CHECK(GetRefCount(unused.Get()) == 1);
+
+        (void)uploader.GetCommandList();
+        uploader.Retain(staging);
+        (void)uploader.Commit(100);
+        uploader.Flush();
+        CHECK(GetRefCount(staging.Get()) == 2);
+
+        // After the batch was submitted, it is held for that batch.
+        uploader.Retain(late);
+        CHECK(GetRefCount(late.Get()) == 2);
+
+        uploader.Reclaim();
+        CHECK(GetRefCount(staging.Get()) == 2);
+
+        queue.completed = 1;
+        uploader.Reclaim();
+        CHECK(GetRefCount(staging.Get()) == 1);
+        CHECK(GetRefCount(late.Get()) == 1);
+
+        (void)uploader.GetCommandList();
+        uploader.Retain(staging);
+        (void)uploader.Commit(100);
+        uploader.Flush();
+        CHECK(GetRefCount(staging.Get()) == 2);
+    }
+
+    // Destroying the uploader waited for the last batch and let go of everything.
+    CHECK(queue.cpuWaits == 1);
+    CHECK(queue.completed == 2);
+    CHECK(GetRefCount(staging.Get()) == 1);
+}
+
+}  // namespace
+
+void TestCopyUploader() {
+    TestBatching();
+    TestDependencies();
+    TestRetain();
+}
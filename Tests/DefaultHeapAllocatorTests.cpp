@@ -0,0 +1,150 @@
+#include <vector>
+
+#include "Check.h"
+
+#include "DefaultHeapAllocator.h"
+
+namespace {
+
+// Blocks without memory behind them: distinct GPU addresses and a record of what was released.
+class FakeHeapBackend final : public DefaultHeapBackend {
+  public:
+    Block CreateBlock(UINT64 size) override {
+        Block block;
+        block.gpu = nextGpu_;
+        block.size = size;
+        nextGpu_ += size + (1ull << 32);
+        created.push_back(block);
+        return block;
+    }
+
+    void ReleaseBlock(const Block& block) override { released.push_back(block); }
+
+    std::vector<Block> created;
+    std::vector<Block> released;
+
+  private:
+    D3D12_GPU_VIRTUAL_ADDRESS nextGpu_ = 1ull << 32;
+};
+
+constexpr UINT64 s_blockSize = 64 * 1024;
+
+void TestBuddySplitAndMerge() {
+    BuddyAllocator buddy(1024, 256);
+    CHECK(buddy.RoundedSize(1) == 256);
+    CHECK(buddy.RoundedSize(257) == 512);
+
+    UINT64 a = buddy.Allocate(200);
+    UINT64 b = buddy.Allocate(256);
+    UINT64 c = buddy.Allocate(300);
+    CHECK(a == 0);
+    CHECK(b == 256);
+    CHECK(c == 512);
+    CHECK(buddy.GetBytesAllocated() == 1024);
+    CHECK(buddy.Allocate(1) == BuddyAllocator::s_invalidOffset);
+
+    // a alone cannot merge while its buddy b is allocated.
+    buddy.Free(a);
+    CHECK(buddy.GetLargestFreeRange() == 256);
+    buddy.Free(b);
+    CHECK(buddy.GetLargestFreeRange() == 512);
+    buddy.Free(c);
+    CHECK(buddy.GetLargestFreeRange() == 1024);
+    CHECK(buddy.GetAllocationCount() == 0);
+
+    // A larger alignment is served by a larger, self-aligned range.
+    UINT64 small = buddy.Allocate(256);
+    UINT64 aligned = buddy.Allocate(256, 512);
+    CHECK(small == 0);
+    CHECK(aligned == 512);
+    CHECK(buddy.Allocate(2048) == BuddyAllocator::s_invalidOffset);
+}
+
+void TestBlocks() {
+    FakeHeapBackend backend;
+    {
+        DefaultHeapAllocator allocator(&backend, s_blockSize);
+        auto first = allocator.Allocate(1000);
+        auto second = allocator.Allocate(1000);
+        CHECK(backend.created.size() == 1);
+        CHECK(first.block == 0 && second.block == 0);
+        CHECK(first.offset == 0);
+        CHECK(second.offset == 1024);
+        CHECK(second.gpu == backend.created[0].gpu + second.offset);
+
+        // Larger than a block: it gets one of its own, rounded up to a power of two.
+        auto large = allocator.Allocate(3 * s_blockSize);
+        CHECK(backend.created.size() == 2);
+        CHECK(large.block == 1);
+        CHECK(backend.created[1].size == 4 * s_blockSize);
+
+        auto stats = allocator.GetStats();
+        CHECK(stats.blockCount == 2);
+        CHECK(stats.allocationCount == 3);
+        CHECK(stats.bytesReserved == 5 * s_blockSize);
+        CHECK(stats.bytesRequested == 2000 + 3 * s_blockSize);
+        CHECK(stats.bytesAllocated == 2048 + 4 * s_blockSize);
+        CHECK(stats.largestFreeRange == s_blockSize / 2);
+        CHECK(stats.blockFreeRanges == s_blockSize / 2);
+        CHECK(stats.Fragmentation() > 0.0);
+    }
+    CHECK(backend.released.size() == 2);
+}
+
+void TestDeferredFree() {
+    FakeHeapBackend backend;
+    DefaultHeapAllocator allocator(&backend, s_blockSize);
+
+    auto half = allocator.Allocate(s_blockSize / 2);
+    auto other = allocator.Allocate(s_blockSize / 2);
+    CHECK(half.offset == 0);
+
+    // Freed during the frame that will signal 5: not reused before that completes.
+    allocator.Free(half);
+    CHECK(allocator.GetStats().pendingFreeCount == 1);
+    allocator.EndFrame(5);
+    allocator.Reclaim(4);
+    CHECK(allocator.GetStats().pendingFreeCount == 1);
+
+    auto next = allocator.Allocate(s_blockSize / 2);
+    CHECK(next.block == 1);
+    CHECK(backend.created.size() == 2);
+
+    allocator.Reclaim(5);
+    auto stats = allocator.GetStats();
+    CHECK(stats.pendingFreeCount == 0);
+    CHECK(stats.allocationCount == 2);
+    CHECK(stats.bytesRequested == s_blockSize);
+
+    auto reused = allocator.Allocate(s_blockSize / 2);
+    CHECK(reused.block == 0 && reused.offset == 0);
+    CHECK(backend.created.size() == 2);
+
+    // Frees of one frame come back together, in frame order.
+    allocator.Free(other);
+    allocator.EndFrame(6);
+    allocator.Free(next);
+    allocator.Free(reused);
+    allocator.EndFrame(7);
+    allocator.Reclaim(6);
+    CHECK(allocator.GetStats().pendingFreeCount == 2);
+    allocator.Reclaim(7);
+    stats = allocator.GetStats();
+    CHECK(stats.pendingFreeCount == 0);
+    CHECK(stats.allocationCount == 0);
+    CHECK(stats.bytesAllocated == 0);
+    CHECK(stats.largestFreeRange == s_blockSize);
+
+    // Both blocks are empty again; free space split across blocks is not fragmentation.
+    CHECK(stats.blockCount == 2);
+    CHECK(stats.blockFreeRanges == 2 * s_blockSize);
+    CHECK(stats.Fragmentation() == 0.0);
+}
+
+}  // namespace
+
+void TestDefaultHeapAllocator() {
+    TestBuddySplitAndMerge();
+    TestBlocks();
+    TestDeferredFree();
+}
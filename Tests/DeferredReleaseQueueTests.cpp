@@ -0,0 +1,123 @@
+#include <algorithm>
+
+#include "Check.h"
+
+#include "DeferredReleaseQueue.h"
+#include "NullDevice.h"
+
+namespace {
+
+using Microsoft::WRL::ComPtr;
+
+// A fence the test completes by hand, counting how often it is asked.
+class FakeFence final : public FenceBackend {
+  public:
+    UINT64 GetCompletedValue() override {
+        ++queries;
+        return completed;
+    }
+
+    void Wait(UINT64 value) override {
+        ++waits;
+        lastWait = value;
+        completed = std::max(completed, value);
+    }
+
+    UINT64 completed = 0;
+    UINT64 queries = 0;
+    UINT64 waits = 0;
+    UINT64 lastWait = 0;
+};
+
+ComPtr<ID3D12Resource> MakeResource() {
+    ComPtr<ID3D12Resource> resource;
+    resource.Attach(new NullResource(CD3DX12_RESOURCE_DESC::Buffer(256)));
+    return resource;
+}
+
+ULONG GetRefCount(IUnknown* object) {
+    object->AddRef();
+    return object->Release();
+}
+
+void TestCollect() {
+    FakeFence fence;
+    DeferredReleaseQueue queue(&fence);
+    auto first = MakeResource();
+    auto second = MakeResource();
+
+    queue.Release(nullptr, 1);
+    queue.Release(first, 1);
+    queue.Release(second, 2);
+    CHECK(queue.GetPendingCount() == 2);
+    CHECK(GetRefCount(first.Get()) == 2);
+
+    queue.Collect();
+    CHECK(queue.GetPendingCount() == 2);
+
+    // Only what the fence has passed goes, oldest first.
+    fence.completed = 1;
+    queue.Collect();
+    CHECK(queue.GetPendingCount() == 1);
+    CHECK(GetRefCount(first.Get()) == 1);
+    CHECK(GetRefCount(second.Get()) == 2);
+
+    // Still waiting on 2: one fence query, nothing released.
+    UINT64 queries = fence.queries;
+    queue.Collect();
+    CHECK(fence.queries == queries + 1);
+    CHECK(queue.GetPendingCount() == 1);
+
+    fence.completed = 2;
+    queue.Collect();
+    CHECK(queue.GetPendingCount() == 0);
+    CHECK(GetRefCount(second.Get()) == 1);
+
+    // Nothing pending: the fence is not queried at all.
+    queries = fence.queries;
+    queue.Collect();
+    CHECK(fence.queries == queries);
+
+    // Already known to be complete: released at once, without asking the fence.
+    auto late = MakeResource();
+    queue.Release(late, 2);
+    CHECK(GetRefCount(late.Get()) == 1);
+    CHECK(queue.GetPendingCount() == 0);
+    CHECK(fence.queries == queries);
+
+    const auto& stats = queue.GetStats();
+    CHECK(stats.deferred == 3);
+    CHECK(stats.released == 3);
+    CHECK(fence.waits == 0);
+}
+
+void TestFlush() {
+    FakeFence fence;
+    auto resource = MakeResource();
+    {
+        DeferredReleaseQueue queue(&fence);
+        queue.Flush();
+        CHECK(fence.waits == 0);
+
+        queue.Release(resource, 3);
+        queue.Release(MakeResource(), 5);
+        queue.Flush();
+        CHECK(fence.waits == 1);
+        CHECK(fence.lastWait == 5);
+        CHECK(queue.GetPendingCount() == 0);
+        CHECK(GetRefCount(resource.Get()) == 1);
+
+        // Left pending: the destructor releases it without waiting.
+        queue.Release(resource, 7);
+        CHECK(GetRefCount(resource.Get()) == 2);
+    }
+    CHECK(GetRefCount(resource.Get()) == 1);
+    CHECK(fence.waits == 1);
+}
+
+}  // namespace
+
+void TestDeferredReleaseQueue() {
+    TestCollect();
+    TestFlush();
+}
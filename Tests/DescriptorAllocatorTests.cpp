@@ -0,0 +1,87 @@
+#include "Check.h"
+
+#include "DescriptorAllocator.h"
+
+namespace {
+
+// Persistent ranges are first-fit, merge when freed, and stale handles are caught.
+void TestPersistent() {
+    DescriptorIndexAllocator allocator(16, 0);
+
+    auto a = allocator.Allocate(4);
+    auto b = allocator.Allocate(2);
+    auto c = allocator.Allocate(4);
+    CHECK(a.index == 0);
+    CHECK(b.index == 4);
+    CHECK(c.index == 6);
+    CHECK(allocator.IsValid(b));
+
+    auto stats = allocator.GetStats();
+    CHECK(stats.persistentUsed == 10);
+    CHECK(stats.persistentFree == 6);
+    CHECK(stats.largestFreeRange == 6);
+    CHECK(stats.freeRangeCount == 1);
+
+    allocator.Free(b);
+    CHECK(!allocator.IsValid(b));
+    CHECK(allocator.GetStats().freeRangeCount == 2);
+
+    // Too big for the hole b left, so it goes after c; the next one fits in the hole.
+    auto d = allocator.Allocate(3);
+    CHECK(d.index == 10);
+    auto e = allocator.Allocate(2);
+    CHECK(e.index == 4);
+    CHECK(allocator.IsValid(e));
+    CHECK(!allocator.IsValid(b));
+    CHECK(allocator.GetStats().freeRangeCount == 1);
+
+    // Freeing everything merges back into a single range.
+    allocator.Free(a);
+    allocator.Free(e);
+    CHECK(allocator.GetStats().largestFreeRange == 6);
+    allocator.Free(c);
+    allocator.Free(d);
+    stats = allocator.GetStats();
+    CHECK(stats.persistentUsed == 0);
+    CHECK(stats.freeRangeCount == 1);
+    CHECK(stats.largestFreeRange == 16);
+
+    CHECK(allocator.Allocate(17).IsNull());
+    CHECK(allocator.Allocate(16).index == 0);
+    CHECK(allocator.Allocate(1).IsNull());
+}
+
+// Transient ranges follow the persistent region and come back when their frame's fence does.
+void TestTransient() {
+    DescriptorIndexAllocator allocator(16, 8);
+
+    CHECK(allocator.AllocateTransient(3) == 16);
+    allocator.EndFrame(1);
+    CHECK(allocator.AllocateTransient(3) == 19);
+    allocator.EndFrame(2);
+    CHECK(allocator.GetStats().transientInFlight == 6);
+
+    // A range never straddles the end: the two slots left are skipped, and count as in flight.
+    allocator.Reclaim(1);
+    CHECK(allocator.AllocateTransient(3) == 16);
+    CHECK(allocator.GetStats().transientInFlight == 8);
+    CHECK(allocator.AllocateTransient(1) == DescriptorIndexAllocator::s_invalidIndex);
+    allocator.EndFrame(3);
+
+    // A frame without transient ranges is not tracked.
+    allocator.EndFrame(4);
+    allocator.Reclaim(3);
+    CHECK(allocator.GetStats().transientInFlight == 0);
+    CHECK(allocator.AllocateTransient(8) == 16);
+    CHECK(allocator.AllocateTransient(9) == DescriptorIndexAllocator::s_invalidIndex);
+
+    // The persistent region is untouched.
+    CHECK(allocator.GetStats().persistentUsed == 0);
+}
+
+}  // namespace
+
+void TestDescriptorAllocator() {
+    TestPersistent();
+    TestTransient();
+}
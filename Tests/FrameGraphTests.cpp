@@ -0,0 +1,173 @@
+#include "Check.h"
+
+#include "FrameGraph.h"
+#include "NullDevice.h"
+
+namespace {
+
+using Microsoft::WRL::ComPtr;
+
+constexpr UINT s_size = 256;
+
+D3D12_RESOURCE_DESC TargetDesc(UINT size = s_size) {
+    auto desc = CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R8G8B8A8_UNORM, size, size, 1, 1);
+    desc.Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
+    return desc;
+}
+
+ComPtr<ID3D12Resource> MakeBackBuffer() {
+    ComPtr<ID3D12Resource> resource;
+    resource.Attach(new NullResource(TargetDesc()));
+    return resource;
+}
+
+// Only passes that lead to the back buffer, or have side effects, survive.
+void TestCulling() {
+    NullFrameGraphBackend backend;
+    FrameGraph graph(&backend);
+    auto backBuffer = MakeBackBuffer();
+
+    auto back = graph.Import("BackBuffer", backBuffer.Get(), D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_PRESENT);
+    auto gbuffer = graph.Create("GBuffer", TargetDesc());
+    auto lit = graph.Create("Lit", TargetDesc());
+    auto overlay = graph.Create("Overlay", TargetDesc());
+    auto composite = graph.Create("DebugComposite", TargetDesc());
+    auto capture = graph.Create("Capture", TargetDesc());
+
+    graph.AddPass("GBuffer", {}).Write(gbuffer, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    graph.AddPass("Overlay", {}).Write(overlay, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    graph.AddPass("Lighting", {}).Read(gbuffer).Write(lit, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    // Reads the overlay, but nothing reads what it writes: both passes go.
+    graph.AddPass("DebugComposite", {}).Read(overlay).Write(composite, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    graph.AddPass("Present", {}).Read(lit).Write(back, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    graph.AddPass("Capture", {}).Read(lit).Write(capture, D3D12_RESOURCE_STATE_RENDER_TARGET).SetSideEffect();
+
+    CHECK(graph.Compile());
+    const auto& compiled = graph.GetCompiled();
+    CHECK(compiled.culledPasses == 2);
+    CHECK(compiled.passes.size() == 4);
+    CHECK(graph.GetPassName(compiled.passes[0].pass) == "GBuffer");
+    CHECK(graph.GetPassName(compiled.passes[1].pass) == "Lighting");
+    CHECK(graph.GetPassName(compiled.passes[2].pass) == "Present");
+    CHECK(graph.GetPassName(compiled.passes[3].pass) == "Capture");
+
+    // Culled transients get no memory.
+    CHECK(compiled.placements[overlay.index].firstPass == UINT_MAX);
+    CHECK(compiled.placements[overlay.index].size == 0);
+    CHECK(compiled.placements[composite.index].size == 0);
+    CHECK(compiled.placements[capture.index].size > 0);
+
+    // The back buffer goes to RENDER_TARGET in Present and back to PRESENT after the last pass.
+    CHECK(compiled.passes[2].transitions.size() == 2);
+    CHECK(compiled.finalTransitions.size() == 1);
+    CHECK(compiled.finalTransitions[0].resource == back.index);
+    CHECK(compiled.finalTransitions[0].before == D3D12_RESOURCE_STATE_RENDER_TARGET);
+    CHECK(compiled.finalTransitions[0].after == D3D12_RESOURCE_STATE_PRESENT);
+}
+
+// A chain of passes each reading the previous transient: transients two passes apart never
+// live at once and share memory, so the heap holds two of them instead of four.
+void TestAliasing() {
+    NullFrameGraphBackend backend;
+    FrameGraph graph(&backend);
+    auto backBuffer = MakeBackBuffer();
+
+    auto back = graph.Import("BackBuffer", backBuffer.Get(), D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_PRESENT);
+    FrameGraph::Handle chain[4];
+    for (UINT i = 0; i < 4; ++i) {
+        chain[i] = graph.Create("Chain" + std::to_string(i), TargetDesc());
+    }
+
+    graph.AddPass("Pass0", {}).Write(chain[0], D3D12_RESOURCE_STATE_RENDER_TARGET);
+    for (UINT i = 1; i < 4; ++i) {
+        graph.AddPass("Pass" + std::to_string(i), {})
+            .Read(chain[i - 1])
+            .Write(chain[i], D3D12_RESOURCE_STATE_RENDER_TARGET);
+    }
+    graph.AddPass("Present", {}).Read(chain[3]).Write(back, D3D12_RESOURCE_STATE_RENDER_TARGET);
+
+    CHECK(graph.Compile());
+    const auto& compiled = graph.GetCompiled();
+    const auto& placements = compiled.placements;
+    UINT64 size = placements[chain[0].index].size;
+    CHECK(size > 0);
+
+    for (UINT i = 0; i < 4; ++i) {
+        CHECK(placements[chain[i].index].firstPass == i);
+        CHECK(placements[chain[i].index].lastPass == i + 1);
+        CHECK(placements[chain[i].index].offset % compiled.heapAlignment == 0);
+    }
+    CHECK(placements[chain[0].index].offset == placements[chain[2].index].offset);
+    CHECK(placements[chain[1].index].offset == placements[chain[3].index].offset);
+    CHECK(placements[chain[0].index].offset != placements[chain[1].index].offset);
+    CHECK(compiled.heapSize == 2 * size);
+
+    // Every transient shares memory, so each needs an aliasing barrier when it starts.
+    for (UINT i = 0; i < 4; ++i) {
+        CHECK(compiled.passes[i].activated.size() == 1);
+        CHECK(compiled.passes[i].aliased.size() == 1);
+    }
+    CHECK(compiled.passes[4].activated.empty());
+
+    // Read after written: one transition per pass from RENDER_TARGET.
+    for (UINT i = 1; i < 4; ++i) {
+        const auto& transitions = compiled.passes[i].transitions;
+        CHECK(transitions.size() == 1);
+        CHECK(transitions[0].resource == chain[i - 1].index);
+        CHECK(transitions[0].before == D3D12_RESOURCE_STATE_RENDER_TARGET);
+        CHECK(transitions[0].after == D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    }
+}
+
+void DeclareFrame(FrameGraph& graph, ID3D12Resource* backBuffer, UINT size) {
+    graph.Reset();
+    auto back = graph.Import("BackBuffer", backBuffer, D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_PRESENT);
+    auto color = graph.Create("Color", TargetDesc(size));
+    graph.AddPass("Scene", {}).Write(color, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    graph.AddPass("Present", {}).Read(color).Write(back, D3D12_RESOURCE_STATE_RENDER_TARGET);
+}
+
+// The same declaration compiles once; a change in any transient recompiles.
+void TestRecompile() {
+    NullFrameGraphBackend backend;
+    FrameGraph graph(&backend);
+    auto backBuffer = MakeBackBuffer();
+
+    DeclareFrame(graph, backBuffer.Get(), s_size);
+    CHECK(graph.Compile());
+    DeclareFrame(graph, backBuffer.Get(), s_size);
+    CHECK(!graph.Compile());
+    DeclareFrame(graph, backBuffer.Get(), 2 * s_size);
+    CHECK(graph.Compile());
+    CHECK(graph.GetStats().compiles == 2);
+    CHECK(graph.GetStats().reuses == 1);
+    CHECK(graph.GetCompiled().heapSize == 4 * s_size * s_size * 8);
+}
+
+// A transient's first use must write it: its contents are undefined until then.
+void TestReadBeforeWrite() {
+    NullFrameGraphBackend backend;
+    FrameGraph graph(&backend);
+    auto backBuffer = MakeBackBuffer();
+
+    auto back = graph.Import("BackBuffer", backBuffer.Get(), D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_PRESENT);
+    auto color = graph.Create("Color", TargetDesc());
+    graph.AddPass("Present", {}).Read(color).Write(back, D3D12_RESOURCE_STATE_RENDER_TARGET);
+
+    bool threw = false;
+    try {
+        graph.Compile();
+    } catch (...) {
+        threw = true;
+    }
+    CHECK(threw);
+}
+
+}  // namespace
+
+void TestFrameGraph() {
+    TestCulling();
+    TestAliasing();
+    TestRecompile();
+    TestReadBeforeWrite();
+}
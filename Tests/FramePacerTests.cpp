@@ -0,0 +1,134 @@
+#include <cmath>
+
+#include "Check.h"
+
+#include "FramePacer.h"
+
+namespace {
+
+// A fence the test completes by hand. Wait() stands for blocking until the GPU catches up: it
+// completes the value and moves the clock on by a GPU frame for every frame it had to finish.
+class SimulatedFence final : public FenceBackend {
+  public:
+    SimulatedFence(double& clock, double gpuFrameSeconds) : clock_(clock), gpuFrameSeconds_(gpuFrameSeconds) {}
+
+    void Complete(UINT64 value) { completed_ = value; }
+
+    UINT64 GetCompletedValue() override { return completed_; }
+
+    void Wait(UINT64 value) override {
+        if (completed_ < value) {
+            clock_ += (value - completed_) * gpuFrameSeconds_;
+            completed_ = value;
+            ++waits;
+        }
+    }
+
+    UINT64 waits = 0;
+
+  private:
+    double& clock_;
+    double gpuFrameSeconds_ = 0.0;
+    UINT64 completed_ = 0;
+};
+
+constexpr UINT s_framesInFlight = 3;
+constexpr UINT64 s_frameCount = 9;
+constexpr double s_cpuFrameSeconds = 0.004;
+constexpr double s_gpuFrameSeconds = 0.016;
+
+bool NearlyEqual(double a, double b) {
+    return std::abs(a - b) < 1e-9;
+}
+
+// The GPU only makes progress when the CPU waits for it: once the ring is full, every frame
+// blocks on the slot it reuses and the GPU is never seen idle.
+void TestGpuBound() {
+    double clock = 0.0;
+    SimulatedFence fence(clock, s_gpuFrameSeconds);
+    FramePacer pacer(&fence, s_framesInFlight, [&] { return clock; });
+    CHECK(pacer.GetFramesInFlight() == s_framesInFlight);
+
+    for (UINT64 fenceValue = 1; fenceValue <= s_frameCount; ++fenceValue) {
+        UINT frameIndex = pacer.BeginFrame();
+        CHECK(frameIndex == (fenceValue - 1) % s_framesInFlight);
+        CHECK(pacer.GetFrameIndex() == frameIndex);
+
+        // A slot is only handed out once the frame that last used it has completed.
+        if (fenceValue > s_framesInFlight) {
+            CHECK(fence.GetCompletedValue() == fenceValue - s_framesInFlight);
+        }
+        clock += s_cpuFrameSeconds;
+        pacer.EndFrame(fenceValue);
+    }
+
+    const auto& stats = pacer.GetStats();
+    CHECK(stats.frames == s_frameCount);
+    CHECK(stats.cpuWaitFrames == s_frameCount - s_framesInFlight);
+    CHECK(NearlyEqual(stats.cpuWaitSeconds, (s_frameCount - s_framesInFlight) * s_gpuFrameSeconds));
+    CHECK(stats.gpuIdleFrames == 0);
+    CHECK(fence.waits == s_frameCount - s_framesInFlight);
+
+    pacer.WaitForIdle();
+    CHECK(fence.GetCompletedValue() == s_frameCount);
+
+    pacer.ResetStats();
+    CHECK(pacer.GetStats().frames == 0);
+    CHECK(pacer.GetStats().cpuWaitFrames == 0);
+}
+
+// The GPU finishes each frame before the CPU submits the next: the CPU never waits, and the GPU
+// sits idle for the CPU time of every frame after the first.
+void TestCpuBound() {
+    double clock = 0.0;
+    SimulatedFence fence(clock, s_gpuFrameSeconds);
+    FramePacer pacer(&fence, s_framesInFlight, [&] { return clock; });
+
+    for (UINT64 fenceValue = 1; fenceValue <= s_frameCount; ++fenceValue) {
+        pacer.BeginFrame();
+        clock += s_cpuFrameSeconds;
+        pacer.EndFrame(fenceValue);
+        fence.Complete(fenceValue);
+    }
+
+    const auto& stats = pacer.GetStats();
+    CHECK(stats.frames == s_frameCount);
+    CHECK(stats.cpuWaitFrames == 0);
+    CHECK(stats.cpuWaitSeconds == 0.0);
+    CHECK(stats.gpuIdleFrames == s_frameCount - 1);
+    CHECK(NearlyEqual(stats.gpuIdleSeconds, (s_frameCount - 1) * s_cpuFrameSeconds));
+
+    pacer.WaitForIdle();
+    CHECK(fence.waits == 0);
+}
+
+// The GPU runs one frame behind, within the ring: no stalls on either side.
+void TestBalanced() {
+    double clock = 0.0;
+    SimulatedFence fence(clock, s_gpuFrameSeconds);
+    FramePacer pacer(&fence, s_framesInFlight, [&] { return clock; });
+
+    for (UINT64 fenceValue = 1; fenceValue <= s_frameCount; ++fenceValue) {
+        pacer.BeginFrame();
+        clock += s_cpuFrameSeconds;
+        pacer.EndFrame(fenceValue);
+        fence.Complete(fenceValue - 1);
+    }
+
+    const auto& stats = pacer.GetStats();
+    CHECK(stats.cpuWaitFrames == 0);
+    CHECK(stats.gpuIdleFrames == 0);
+    CHECK(fence.waits == 0);
+
+    pacer.WaitForIdle();
+    CHECK(fence.waits == 1);
+    CHECK(fence.GetCompletedValue() == s_frameCount);
+}
+
+}  // namespace
+
+void TestFramePacer() {
+    TestGpuBound();
+    TestCpuBound();
+    TestBalanced();
+}
@@ -0,0 +1,135 @@
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "Check.h"
+
+#include "LinearUploadAllocator.h"
+
+namespace {
+
+// Pages of host memory with made-up GPU addresses. The addresses start 64 bytes past a 256-byte
+// boundary, so alignment has to be worked out on the GPU address rather than the offset.
+class MockUploadBackend final : public UploadMemoryBackend {
+  public:
+    Page CreatePage(UINT64 size) override {
+        auto& memory = memory_.emplace_back(std::make_unique<BYTE[]>(size));
+        Page page;
+        page.cpu = memory.get();
+        page.gpu = nextGpu_;
+        page.size = size;
+        nextGpu_ += (size + 0xffff) & ~0xffffull;
+        created.push_back(page);
+        return page;
+    }
+
+    void ReleasePage(const Page& page) override { released.push_back(page); }
+
+    std::vector<Page> created;
+    std::vector<Page> released;
+
+  private:
+    std::vector<std::unique_ptr<BYTE[]>> memory_;
+    D3D12_GPU_VIRTUAL_ADDRESS nextGpu_ = 0x10000 + 64;
+};
+
+constexpr UINT64 s_pageSize = 1024;
+constexpr UINT64 s_alignment = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT;
+
+void TestAlignment() {
+    MockUploadBackend backend;
+    LinearUploadAllocator allocator(&backend, s_pageSize);
+    CHECK(backend.created.size() == 1);
+    const auto& page = backend.created[0];
+
+    auto first = allocator.Allocate(100);
+    auto second = allocator.Allocate(100);
+    auto packed = allocator.Allocate(8, 4);
+    CHECK(first.gpu % s_alignment == 0);
+    CHECK(second.gpu % s_alignment == 0);
+    CHECK(second.gpu == first.gpu + s_alignment);
+    CHECK(packed.gpu == second.gpu + 100);
+
+    // The CPU pointer is at the same offset into the page as the GPU address.
+    CHECK(first.cpu - page.cpu == static_cast<ptrdiff_t>(first.gpu - page.gpu));
+    CHECK(first.gpu - page.gpu == s_alignment - 64);
+
+    // Padding counts as used.
+    CHECK(allocator.GetBytesUsed() == (second.gpu - page.gpu) + 100 + 8);
+    CHECK(allocator.GetPageCount() == 1);
+}
+
+// A frame that outgrows its page gets more; Reset() folds them into one page that fits it.
+void TestOverflowAndReset() {
+    MockUploadBackend backend;
+    {
+        LinearUploadAllocator allocator(&backend, s_pageSize);
+
+        // 192 bytes of padding up front leave room for three aligned allocations.
+        for (int i = 0; i < 3; ++i) {
+            (void)allocator.Allocate(s_alignment);
+        }
+        CHECK(allocator.GetPageCount() == 1);
+
+        auto spilled = allocator.Allocate(s_alignment);
+        CHECK(allocator.GetPageCount() == 2);
+        CHECK(spilled.gpu % s_alignment == 0);
+        CHECK(spilled.gpu >= backend.created[1].gpu);
+        CHECK(spilled.gpu + spilled.size <= backend.created[1].gpu + backend.created[1].size);
+
+        // Larger than a page: a page of its own, with room to align it.
+        auto large = allocator.Allocate(4 * s_pageSize);
+        CHECK(allocator.GetPageCount() == 3);
+        CHECK(backend.created[2].size == 4 * s_pageSize + s_alignment);
+        CHECK(large.gpu % s_alignment == 0);
+
+        UINT64 used = allocator.GetBytesUsed();
+        CHECK(used > 5 * s_pageSize);
+
+        allocator.Reset();
+        CHECK(backend.released.size() == 3);
+        CHECK(allocator.GetPageCount() == 1);
+        CHECK(allocator.GetBytesUsed() == 0);
+        CHECK(backend.created.back().size == used);
+
+        // The next frame of the same size stays in that page.
+        for (int i = 0; i < 4; ++i) {
+            (void)allocator.Allocate(s_alignment);
+        }
+        (void)allocator.Allocate(4 * s_pageSize);
+        CHECK(allocator.GetPageCount() == 1);
+
+        // A frame in one page keeps it.
+        allocator.Reset();
+        CHECK(backend.released.size() == 3);
+    }
+    CHECK(backend.released.size() == 4);
+    CHECK(backend.released.back().cpu == backend.created.back().cpu);
+}
+
+void TestPushConstants() {
+    struct Constants {
+        float values[5];
+    };
+
+    MockUploadBackend backend;
+    LinearUploadAllocator allocator(&backend, s_pageSize);
+
+    Constants constants = {{1.0f, 2.0f, 3.0f, 4.0f, 5.0f}};
+    D3D12_GPU_VIRTUAL_ADDRESS first = allocator.PushConstants(constants);
+    D3D12_GPU_VIRTUAL_ADDRESS second = allocator.PushConstants(constants);
+    CHECK(first % s_alignment == 0);
+    CHECK(second == first + s_alignment);
+
+    const auto& page = backend.created[0];
+    CHECK(std::memcmp(page.cpu + (first - page.gpu), &constants, sizeof(constants)) == 0);
+    CHECK(std::memcmp(page.cpu + (second - page.gpu), &constants, sizeof(constants)) == 0);
+}
+
+}  // namespace
+
+void TestLinearUploadAllocator() {
+    TestAlignment();
+    TestOverflowAndReset();
+    TestPushConstants();
+}
@@ -0,0 +1,95 @@
+#include <cstring>
+#include <vector>
+
+#include "Check.h"
+
+#include "MaterialTable.h"
+
+namespace {
+
+Material MakeMaterial(float red, int diffuseSrvHeapIndex) {
+    Material mat;
+    mat.DiffuseAlbedo = {red, 0.5f, 0.25f, 1.0f};
+    mat.FresnelR0 = {0.02f, 0.03f, 0.04f};
+    mat.Roughness = red / 2.0f;
+    mat.MatTransform._41 = red;
+    mat.DiffuseSrvHeapIndex = diffuseSrvHeapIndex;
+    return mat;
+}
+
+bool SameData(const MaterialData& a, const MaterialData& b) {
+    return std::memcmp(&a, &b, sizeof(MaterialData)) == 0;
+}
+
+// Slots go out in order, are written to MatCBIndex, and holes are filled before the table grows.
+void TestSlots() {
+    Material a = MakeMaterial(0.1f, 0);
+    Material b = MakeMaterial(0.2f, 1);
+    Material c = MakeMaterial(0.3f, 2);
+    Material d = MakeMaterial(0.4f, 3);
+
+    MaterialTable table;
+    CHECK(table.Add(&a) == 0);
+    CHECK(table.Add(&b) == 1);
+    CHECK(table.Add(&c) == 2);
+    CHECK(b.MatCBIndex == 1);
+    CHECK(table.Get(1) == &b);
+
+    table.Remove(&b);
+    CHECK(b.MatCBIndex == -1);
+    CHECK(table.Get(1) == nullptr);
+    CHECK(table.GetCount() == 3);
+
+    CHECK(table.Add(&d) == 1);
+    CHECK(d.MatCBIndex == 1);
+    CHECK(table.GetCount() == 3);
+    CHECK(table.Add(&b) == 3);
+    CHECK(table.GetCount() == 4);
+    CHECK(table.Get(4) == nullptr);
+}
+
+void TestToData() {
+    Material mat = MakeMaterial(0.5f, 7);
+    MaterialData data = MaterialTable::ToData(mat);
+    CHECK(data.DiffuseAlbedo.x == 0.5f);
+    CHECK(data.FresnelR0.z == 0.04f);
+    CHECK(data.Roughness == 0.25f);
+    CHECK(data.MatTransform._41 == 0.5f);
+    CHECK(data.DiffuseMapIndex == 7);
+
+    // No texture reads slot 0 rather than wrapping around to the top of the range.
+    mat.DiffuseSrvHeapIndex = -1;
+    CHECK(MaterialTable::ToData(mat).DiffuseMapIndex == 0);
+}
+
+// Pack() writes every slot at its index, with default data in the holes.
+void TestPack() {
+    Material a = MakeMaterial(0.1f, 4);
+    Material b = MakeMaterial(0.2f, 5);
+    Material c = MakeMaterial(0.3f, 6);
+
+    MaterialTable table;
+    table.Add(&a);
+    table.Add(&b);
+    table.Add(&c);
+    table.Remove(&b);
+
+    std::vector<MaterialData> buffer(4);
+    {
+        MappedWriter writer(buffer.data(), buffer.size() * sizeof(MaterialData));
+        table.Pack(writer);
+        CHECK(writer.GetOffset() == table.GetCount() * sizeof(MaterialData));
+    }
+    CHECK(SameData(buffer[0], MaterialTable::ToData(a)));
+    CHECK(SameData(buffer[1], MaterialData{}));
+    CHECK(SameData(buffer[2], MaterialTable::ToData(c)));
+    CHECK(buffer[2].DiffuseMapIndex == 6);
+}
+
+}  // namespace
+
+void TestMaterialTable() {
+    TestSlots();
+    TestToData();
+    TestPack();
+}
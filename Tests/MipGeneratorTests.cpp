@@ -0,0 +1,160 @@
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "Check.h"
+
+#include "Common/MipGenerator.h"
+
+namespace {
+
+std::vector<uint8_t> MakeImage(size_t width, size_t height, size_t arraySize, uint32_t seed) {
+    std::vector<uint8_t> image(width * height * 4 * arraySize);
+    for (auto& texel : image) {
+        seed = seed * 1664525u + 1013904223u;
+        texel = static_cast<uint8_t>(seed >> 24);
+    }
+    return image;
+}
+
+bool Near(const uint8_t* a, const uint8_t* b, size_t bytes, int tolerance) {
+    for (size_t i = 0; i < bytes; ++i) {
+        if (std::abs(a[i] - b[i]) > tolerance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void TestLayout() {
+    CHECK(MipGenerator::FullMipCount(1, 1) == 1);
+    CHECK(MipGenerator::FullMipCount(256, 256) == 9);
+    CHECK(MipGenerator::FullMipCount(5, 3) == 3);
+    CHECK(MipGenerator::ChainBytes(5, 3, 3, 2) == (15 + 2 + 1) * 4 * 2);
+
+    // Too many levels, or a destination too small for the chain.
+    std::vector<uint8_t> top(4 * 4 * 4);
+    std::vector<uint8_t> chain(MipGenerator::ChainBytes(4, 4, 3, 1));
+    MipGenerator generator;
+    CHECK(!generator.GenerateChain(top.data(), top.size(), 4, 4, 1, 4, chain.data(), chain.size()));
+    CHECK(!generator.GenerateChain(top.data(), top.size(), 4, 4, 1, 3, chain.data(), chain.size() - 1));
+    CHECK(generator.GenerateChain(top.data(), top.size(), 4, 4, 1, 3, chain.data(), chain.size()));
+}
+
+// A flat image stays flat at every level, with either filter, for every slice on its own.
+void TestConstant() {
+    const size_t width = 40;
+    const size_t height = 24;
+    const size_t mipCount = MipGenerator::FullMipCount(width, height);
+    const uint8_t colors[2][4] = {{200, 100, 50, 255}, {10, 20, 30, 128}};
+
+    std::vector<uint8_t> top(width * height * 4 * 2);
+    for (size_t i = 0; i < top.size(); i += 4) {
+        std::memcpy(&top[i], colors[i < top.size() / 2 ? 0 : 1], 4);
+    }
+
+    for (auto filter : {MipGenerator::Filter::Box, MipGenerator::Filter::Kaiser}) {
+        for (bool srgb : {false, true}) {
+            MipGenerator::Settings settings;
+            settings.filter = filter;
+            settings.srgb = srgb;
+            std::vector<uint8_t> chain(MipGenerator::ChainBytes(width, height, mipCount, 2));
+            CHECK(MipGenerator(settings).GenerateChain(top.data(), top.size(), width, height, 2, mipCount,
+                                                       chain.data(), chain.size()));
+
+            bool flat = true;
+            for (size_t i = 0; i < chain.size(); i += 4) {
+                flat = flat && Near(&chain[i], colors[i < chain.size() / 2 ? 0 : 1], 4, 1);
+            }
+            CHECK(flat);
+        }
+    }
+}
+
+// Box levels of a power-of-two image are block averages of the top level, whether each level is
+// filtered from the one above it or not; only the 8-bit rounding in between can differ.
+void TestBoxAverages() {
+    const size_t size = 16;
+    const size_t mipCount = MipGenerator::FullMipCount(size, size);
+    auto top = MakeImage(size, size, 1, 1);
+    std::vector<uint8_t> chain(MipGenerator::ChainBytes(size, size, mipCount, 1));
+    CHECK(MipGenerator().GenerateChain(top.data(), top.size(), size, size, 1, mipCount, chain.data(), chain.size()));
+    CHECK(std::memcmp(chain.data(), top.data(), top.size()) == 0);
+
+    const uint8_t* level = chain.data();
+    for (size_t mip = 0, w = size; mip < mipCount; ++mip, w /= 2) {
+        size_t block = size / w;
+        bool averaged = true;
+        for (size_t y = 0; y < w; ++y) {
+            for (size_t x = 0; x < w; ++x) {
+                for (size_t c = 0; c < 4; ++c) {
+                    unsigned sum = 0;
+                    for (size_t by = 0; by < block; ++by) {
+                        for (size_t bx = 0; bx < block; ++bx) {
+                            sum += top[((y * block + by) * size + x * block + bx) * 4 + c];
+                        }
+                    }
+                    int expected = static_cast<int>((sum + block * block / 2) / (block * block));
+                    averaged = averaged && std::abs(level[(y * w + x) * 4 + c] - expected) <= 1;
+                }
+            }
+        }
+        CHECK(averaged);
+        level += w * w * 4;
+    }
+}
+
+// Bands are independent, so the worker count does not change the result.
+void TestWorkers() {
+    const size_t width = 300;
+    const size_t height = 200;
+    const size_t mipCount = MipGenerator::FullMipCount(width, height);
+    auto top = MakeImage(width, height, 2, 7);
+
+    MipGenerator::Settings settings;
+    settings.filter = MipGenerator::Filter::Kaiser;
+    settings.srgb = true;
+    settings.workerCount = 1;
+    std::vector<uint8_t> serial(MipGenerator::ChainBytes(width, height, mipCount, 2));
+    CHECK(MipGenerator(settings).GenerateChain(top.data(), top.size(), width, height, 2, mipCount,
+                                               serial.data(), serial.size()));
+
+    settings.workerCount = 4;
+    std::vector<uint8_t> parallel(serial.size());
+    CHECK(MipGenerator(settings).GenerateChain(top.data(), top.size(), width, height, 2, mipCount,
+                                               parallel.data(), parallel.size()));
+    CHECK(serial == parallel);
+}
+
+void Benchmark() {
+    for (size_t size : {256, 1024, 2048, 4096}) {
+        const size_t mipCount = MipGenerator::FullMipCount(size, size);
+        auto top = MakeImage(size, size, 1, 3);
+        std::vector<uint8_t> chain(MipGenerator::ChainBytes(size, size, mipCount, 1));
+
+        for (auto filter : {MipGenerator::Filter::Box, MipGenerator::Filter::Kaiser}) {
+            MipGenerator::Settings settings;
+            settings.filter = filter;
+            settings.srgb = true;
+            MipGenerator::Stats stats;
+            CHECK(MipGenerator(settings).GenerateChain(top.data(), top.size(), size, size, 1, mipCount,
+                                                       chain.data(), chain.size(), &stats));
+            std::printf("Mip chain %zux%zu %s sRGB: %.2f ms, %.0f MP/s\n",
+                        size,
+                        size,
+                        filter == MipGenerator::Filter::Box ? "box" : "Kaiser",
+                        stats.seconds * 1000.0,
+                        stats.megapixelsPerSecond);
+        }
+    }
+}
+
+}  // namespace
+
+void TestMipGenerator() {
+    TestLayout();
+    TestConstant();
+    TestBoxAverages();
+    TestWorkers();
+    Benchmark();
+}
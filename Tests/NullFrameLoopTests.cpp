@@ -0,0 +1,145 @@
+#include <chrono>
+#include <cstdio>
+
+#include "Check.h"
+
+#include "FrameGraph.h"
+#include "FramePacer.h"
+#include "NullDevice.h"
+#include "ParallelRecorder.h"
+#include "PresentPacingPolicy.h"
+#include "ResourceStateTracker.h"
+
+namespace {
+
+constexpr UINT s_framesInFlight = 3;
+constexpr UINT64 s_frameCount = 240;
+constexpr size_t s_itemCount = 4096;
+constexpr UINT s_width = 1280;
+constexpr UINT s_height = 720;
+
+}  // namespace
+
+// The frame loop of the sample apps on the null backends, timed. The GPU runs two frames behind,
+// so the CPU never has to wait; what is left is the cost of recording and scheduling alone.
+void TestNullFrameLoop() {
+    NullFenceBackend fence(s_framesInFlight - 1);
+    FramePacer pacer(&fence, s_framesInFlight);
+    NullCommandListBackend listBackend;
+    ParallelRecorder recorder(&listBackend);
+    NullFrameGraphBackend graphBackend;
+    FrameGraph graph(&graphBackend);
+    ResourceStateTracker tracker;
+    NullPresentTarget target(DXGI_FORMAT_R8G8B8A8_UNORM, s_width, s_height, s_framesInFlight);
+    PresentPacingPolicy pacing(FrameLatencyMode::Throughput);
+
+    for (int i = 0; i < target.BufferCount(); ++i) {
+        tracker.Register(target.GetBuffer(i), D3D12_RESOURCE_STATE_PRESENT);
+    }
+
+    auto colorDesc = CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R16G16B16A16_FLOAT, s_width, s_height, 1, 1);
+    colorDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
+    auto depthDesc = CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_D24_UNORM_S8_UINT, s_width, s_height, 1, 1);
+    depthDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL;
+    auto depthClear = CD3DX12_CLEAR_VALUE(DXGI_FORMAT_D24_UNORM_S8_UINT, 1.0f, 0);
+
+    auto start = std::chrono::steady_clock::now();
+    pacing.OnFrameReady();
+    pacing.OnFrameStart();
+    for (UINT64 fenceValue = 1; fenceValue <= s_frameCount; ++fenceValue) {
+        pacer.BeginFrame();
+
+        graph.Reset();
+        auto* backBuffer = target.GetCurrentBackBuffer();
+        auto back = graph.Import("BackBuffer",
+                                 backBuffer,
+                                 tracker.GetState(backBuffer),
+                                 D3D12_RESOURCE_STATE_PRESENT);
+        auto color = graph.Create("SceneColor", colorDesc);
+        auto depth = graph.Create("SceneDepth", depthDesc, &depthClear);
+        auto unused = graph.Create("Unused", colorDesc);
+
+        graph.AddPass("Scene", [&](FrameGraph::PassContext& context) {
+            auto& passRecorder = context.GetRecorder();
+            auto clear = passRecorder.Begin();
+            FLOAT black[4] = {};
+            clear.commandList->ClearRenderTargetView(context.GetView(color), black, 0, nullptr);
+            clear.commandList->ClearDepthStencilView(context.GetView(depth),
+                                                     D3D12_CLEAR_FLAG_DEPTH,
+                                                     1.0f,
+                                                     0,
+                                                     0,
+                                                     nullptr);
+            passRecorder.End(clear);
+
+            passRecorder.Record(s_itemCount, [](const ParallelRecorder::List& list, size_t first, size_t count) {
+                auto* cmdList = list.commandList;
+                cmdList->SetGraphicsRootSignature(nullptr);
+                for (size_t i = first; i < first + count; ++i) {
+                    cmdList->SetGraphicsRootConstantBufferView(0, i * 256);
+                    cmdList->DrawIndexedInstanced(36, 1, 0, 0, 0);
+                }
+            });
+        })
+            .Write(color, D3D12_RESOURCE_STATE_RENDER_TARGET)
+            .Write(depth, D3D12_RESOURCE_STATE_DEPTH_WRITE);
+
+        graph.AddPass("Resolve", [&](FrameGraph::PassContext& context) {
+            auto list = context.GetRecorder().Begin();
+            list.commandList->DrawInstanced(3, 1, 0, 0);
+            context.GetRecorder().End(list);
+        })
+            .Read(color)
+            .Write(back, D3D12_RESOURCE_STATE_RENDER_TARGET);
+
+        // Nothing reads what it writes, so it is culled.
+        graph.AddPass("Debug", {}).Write(unused, D3D12_RESOURCE_STATE_RENDER_TARGET);
+
+        graph.Compile();
+        graph.Execute(recorder, tracker);
+        recorder.Submit();
+
+        fence.Signal(fenceValue);
+        listBackend.EndFrame(fenceValue);
+        graph.EndFrame(fenceValue);
+        pacer.EndFrame(fenceValue);
+
+        ThrowIfFailed(target.Present());
+        target.SwapBuffers();
+        pacing.OnPresent();
+        target.WaitForNextFrame();
+        pacing.OnFrameReady();
+        CHECK(pacing.GetStartDelay() == 0.0);
+        pacing.OnFrameStart();
+    }
+    pacer.WaitForIdle();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const auto& stats = listBackend.GetStats();
+    CHECK(stats.submissions == s_frameCount);
+    CHECK(stats.counts.draws == s_frameCount * (s_itemCount + 1));
+    // Two clears, and a discard of each transient before its first pass.
+    CHECK(stats.counts.clears == s_frameCount * 4);
+    CHECK(stats.counts.barriers > 0);
+    CHECK(target.GetPresentCount() == s_frameCount);
+    CHECK(pacer.GetStats().frames == s_frameCount);
+    CHECK(pacer.GetStats().cpuWaitFrames == 0);
+    CHECK(fence.GetCompletedValue() == s_frameCount);
+
+    // Same passes every frame: compiled once, and only the back buffer changes.
+    CHECK(graph.GetStats().compiles == 1);
+    CHECK(graph.GetStats().reuses == s_frameCount - 1);
+    CHECK(graph.GetCompiled().culledPasses == 1);
+    CHECK(graphBackend.GetHeapSize() > 0);
+    CHECK(tracker.GetState(target.GetBuffer(0)) == D3D12_RESOURCE_STATE_PRESENT);
+
+    std::printf("Null frame loop: %llu frames of %zu draws on %u workers, %.0f frames/s, %.1f M draws/s, "
+                "%llu lists, frame cost %.3f ms\n",
+                static_cast<unsigned long long>(s_frameCount),
+                s_itemCount,
+                recorder.GetWorkerCount(),
+                s_frameCount / seconds,
+                stats.counts.draws / seconds / 1e6,
+                static_cast<unsigned long long>(stats.lists),
+                pacing.GetFrameCost() * 1000.0);
+}
@@ -0,0 +1,149 @@
+#include <mutex>
+#include <vector>
+
+#include "Check.h"
+
+#include "ParallelRecorder.h"
+
+namespace {
+
+// Hands out null lists and records what happened to each slot, so the order ParallelRecorder
+// opens, closes and submits them in can be checked.
+class MockCommandListBackend final : public CommandListBackend {
+  public:
+    struct Slot {
+        bool closed = false;
+        size_t first = 0;  // of the chunk recorded into it
+        size_t count = 0;
+    };
+
+    List Open() override {
+        std::lock_guard lock(mutex_);
+        slots.emplace_back();
+        return {static_cast<UINT>(slots.size() - 1), nullptr};
+    }
+
+    void Close(UINT slot) override {
+        std::lock_guard lock(mutex_);
+        slots[slot].closed = true;
+    }
+
+    void Submit(const std::vector<UINT>& submitted) override {
+        for (UINT slot : submitted) {
+            unclosedSubmits += slots[slot].closed ? 0 : 1;
+        }
+        submissions.push_back(submitted);
+    }
+
+    void EndFrame(UINT64 fenceValue) override {
+        lastFenceValue = fenceValue;
+        slots.clear();
+    }
+
+    // Worker threads; the recorded chunk.
+    void SetChunk(UINT slot, size_t first, size_t count) {
+        std::lock_guard lock(mutex_);
+        slots[slot].first = first;
+        slots[slot].count = count;
+    }
+
+    std::vector<Slot> slots;
+    std::vector<std::vector<UINT>> submissions;
+    UINT64 unclosedSubmits = 0;
+    UINT64 lastFenceValue = 0;
+
+  private:
+    std::mutex mutex_;
+};
+
+// Chunks must be contiguous, in order, and cover every item once.
+bool Covers(const std::vector<ParallelRecorder::Chunk>& chunks, size_t itemCount) {
+    size_t next = 0;
+    for (const auto& chunk : chunks) {
+        if (chunk.first != next || chunk.count == 0) {
+            return false;
+        }
+        next += chunk.count;
+    }
+    return next == itemCount;
+}
+
+void TestPartition() {
+    MockCommandListBackend backend;
+    ParallelRecorder recorder(&backend, 4, 64);
+    CHECK(recorder.GetWorkerCount() == 4);
+
+    CHECK(recorder.Partition(0).empty());
+
+    // Too few items to be worth a second list.
+    auto chunks = recorder.Partition(100);
+    CHECK(chunks.size() == 1);
+    CHECK(Covers(chunks, 100));
+
+    chunks = recorder.Partition(130);
+    CHECK(chunks.size() == 2);
+    CHECK(chunks[0].count == 65 && chunks[1].count == 65);
+
+    // No more lists than workers, and the remainder spread over the first chunks.
+    chunks = recorder.Partition(1003);
+    CHECK(chunks.size() == 4);
+    CHECK(Covers(chunks, 1003));
+    CHECK(chunks[0].count == 251 && chunks[2].count == 251 && chunks[3].count == 250);
+
+    ParallelRecorder defaultWorkers(&backend);
+    CHECK(defaultWorkers.GetWorkerCount() >= 1);
+}
+
+// Lists from Begin()/End() and from Record() are submitted in the order they were queued, with
+// Record()'s lists in chunk order however the workers happened to open them.
+void TestRecordOrder() {
+    MockCommandListBackend backend;
+    ParallelRecorder recorder(&backend, 4, 16);
+
+    auto before = recorder.Begin();
+    recorder.End(before);
+
+    constexpr size_t itemCount = 1000;
+    recorder.Record(itemCount, [&](const ParallelRecorder::List& list, size_t first, size_t count) {
+        backend.SetChunk(list.slot, first, count);
+    });
+
+    auto after = recorder.Begin();
+    recorder.End(after);
+    recorder.Submit();
+
+    CHECK(backend.submissions.size() == 1);
+    const auto& submitted = backend.submissions[0];
+    CHECK(submitted.size() == 6);
+    CHECK(backend.unclosedSubmits == 0);
+    CHECK(submitted.front() == before.slot);
+    CHECK(submitted.back() == after.slot);
+
+    size_t next = 0;
+    for (size_t i = 1; i + 1 < submitted.size(); ++i) {
+        const auto& slot = backend.slots[submitted[i]];
+        CHECK(slot.first == next);
+        CHECK(slot.count > 0);
+        next += slot.count;
+    }
+    CHECK(next == itemCount);
+
+    // Submit() empties the queue; the next frame starts from nothing.
+    recorder.Submit();
+    CHECK(backend.submissions.size() == 2);
+    CHECK(backend.submissions[1].empty());
+    backend.EndFrame(1);
+    CHECK(backend.lastFenceValue == 1);
+
+    recorder.Record(0, [&](const ParallelRecorder::List&, size_t, size_t) { CHECK(false); });
+    recorder.Submit();
+    CHECK(backend.slots.empty());
+    CHECK(backend.submissions[2].empty());
+}
+
+}  // namespace
+
+void TestParallelRecorder() {
+    TestPartition();
+    TestRecordOrder();
+}
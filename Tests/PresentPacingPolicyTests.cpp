@@ -0,0 +1,121 @@
+#include <cmath>
+
+#include "Check.h"
+
+#include "PresentPacingPolicy.h"
+
+namespace {
+
+constexpr size_t s_historySize = 8;
+constexpr double s_interval = 0.016;
+constexpr double s_cost = 0.004;
+constexpr double s_margin = 0.002;
+
+bool NearlyEqual(double a, double b) {
+    return std::abs(a - b) < 1e-9;
+}
+
+// Frames that start as soon as the swap chain is ready and cost s_cost each. The clock is left
+// at the last frame's present.
+void RunFrames(PresentPacingPolicy& policy, double& clock, UINT count, double cost = s_cost) {
+    for (UINT i = 0; i < count; ++i) {
+        policy.OnFrameReady();
+        policy.OnFrameStart();
+        clock += cost;
+        policy.OnPresent();
+        clock += s_interval - cost;
+    }
+}
+
+// Nothing is predicted until half the history is filled.
+void TestWarmUp() {
+    double clock = 0.0;
+    PresentPacingPolicy policy(FrameLatencyMode::LowLatency, [&] { return clock; }, s_historySize, s_margin);
+
+    RunFrames(policy, clock, s_historySize / 2);
+    CHECK(policy.GetPresentInterval() == 0.0);
+    CHECK(policy.PredictNextPresent() == 0.0);
+    CHECK(policy.GetStartDelay() == 0.0);
+    CHECK(NearlyEqual(policy.GetFrameCost(), s_cost));
+
+    RunFrames(policy, clock, 1);
+    CHECK(NearlyEqual(policy.GetPresentInterval(), s_interval));
+}
+
+// Low latency holds the frame back so that it finishes s_margin before the next present.
+void TestStartDelay() {
+    double clock = 0.0;
+    PresentPacingPolicy policy(FrameLatencyMode::LowLatency, [&] { return clock; }, s_historySize, s_margin);
+    PresentPacingPolicy throughput(FrameLatencyMode::Throughput, [&] { return clock; }, s_historySize, s_margin);
+
+    RunFrames(policy, clock, s_historySize);
+    policy.OnFrameReady();
+    double ready = clock;
+    CHECK(NearlyEqual(policy.PredictNextPresent(), ready + s_interval));
+    CHECK(NearlyEqual(policy.GetStartDelay(), s_interval - s_cost - s_margin));
+
+    // Part of the way there, only the rest is left to wait.
+    clock += 0.005;
+    CHECK(NearlyEqual(policy.GetStartDelay(), s_interval - s_cost - s_margin - 0.005));
+
+    // Past the last chance for this present: aim for the one after.
+    clock = ready + 1.5 * s_interval;
+    CHECK(NearlyEqual(policy.PredictNextPresent(), ready + 2 * s_interval));
+
+    // The time from ready to start is recorded.
+    clock = ready + 0.003;
+    policy.OnFrameStart();
+    CHECK(NearlyEqual(policy.GetStats().delaySeconds, 0.003));
+    CHECK(policy.GetStats().frames == s_historySize + 1);
+
+    RunFrames(throughput, clock, s_historySize);
+    CHECK(throughput.GetPresentInterval() > 0.0);
+    CHECK(throughput.GetStartDelay() == 0.0);
+}
+
+// The cost is a high percentile: one slow frame in the history does not move it, two do.
+void TestCostSpikes() {
+    double clock = 0.0;
+    PresentPacingPolicy policy(FrameLatencyMode::LowLatency, [&] { return clock; }, s_historySize, s_margin);
+
+    RunFrames(policy, clock, s_historySize - 1);
+    RunFrames(policy, clock, 1, 0.012);
+    CHECK(NearlyEqual(policy.GetFrameCost(), s_cost));
+
+    RunFrames(policy, clock, 1, 0.012);
+    CHECK(NearlyEqual(policy.GetFrameCost(), 0.012));
+
+    // Costing more than an interval leaves nothing to wait.
+    RunFrames(policy, clock, s_historySize, s_interval);
+    policy.OnFrameReady();
+    CHECK(policy.GetStartDelay() == 0.0);
+}
+
+// A ready that comes more than 1.5 intervals after the last one means a present was missed.
+void TestMissedPresents() {
+    double clock = 0.0;
+    PresentPacingPolicy policy(FrameLatencyMode::LowLatency, [&] { return clock; }, s_historySize, s_margin);
+
+    RunFrames(policy, clock, s_historySize);
+    CHECK(policy.GetStats().missedPresents == 0);
+
+    clock += s_interval;
+    RunFrames(policy, clock, 1);
+    CHECK(policy.GetStats().missedPresents == 1);
+
+    // One long gap does not move the median interval.
+    CHECK(NearlyEqual(policy.GetPresentInterval(), s_interval));
+
+    policy.ResetStats();
+    CHECK(policy.GetStats().frames == 0);
+    CHECK(policy.GetStats().missedPresents == 0);
+}
+
+}  // namespace
+
+void TestPresentPacingPolicy() {
+    TestWarmUp();
+    TestStartDelay();
+    TestCostSpikes();
+    TestMissedPresents();
+}
@@ -0,0 +1,171 @@
+#include <chrono>
+#include <thread>
+
+#include "Check.h"
+
+#include "RenderChannel.h"
+#include "SpscQueue.h"
+
+namespace {
+
+struct FrameSnapshot {
+    UINT64 frame = 0;
+    UINT64 packetCount = 0;
+};
+
+constexpr UINT64 s_itemCount = 1 << 20;
+constexpr UINT64 s_frameCount = 20000;
+constexpr UINT64 s_maxPacketsPerFrame = 7;
+
+void TestSpscQueue() {
+    SpscQueue<UINT64> queue(5);
+    CHECK(queue.GetCapacity() == 8);
+
+    UINT64 value = 0;
+    CHECK(!queue.TryPop(value));
+    for (UINT64 i = 0; i < 8; ++i) {
+        CHECK(queue.TryPush(i));
+    }
+    CHECK(!queue.TryPush(8));
+    CHECK(queue.TryPop(value) && value == 0);
+    CHECK(queue.TryPush(8));
+    for (UINT64 i = 1; i <= 8; ++i) {
+        CHECK(queue.TryPop(value) && value == i);
+    }
+    CHECK(!queue.TryPop(value));
+}
+
+// A small queue between two threads wraps many times; every value must arrive once, in order.
+void TestSpscQueueStress() {
+    SpscQueue<UINT64> queue(64);
+
+    std::thread producer([&] {
+        for (UINT64 i = 0; i < s_itemCount; ++i) {
+            while (!queue.TryPush(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    UINT64 expected = 0;
+    UINT64 outOfOrder = 0;
+    UINT64 value = 0;
+    while (expected < s_itemCount) {
+        if (!queue.TryPop(value)) {
+            std::this_thread::yield();
+            continue;
+        }
+        outOfOrder += value != expected ? 1 : 0;
+        ++expected;
+    }
+    producer.join();
+
+    CHECK(outOfOrder == 0);
+    CHECK(!queue.TryPop(value));
+}
+
+// The game thread publishes frames with a varying number of packets and closes the channel; the
+// render thread must see every frame in order, with exactly its own packets, then a null frame.
+void TestRenderChannelHandoff() {
+    RenderChannel<FrameSnapshot, UINT64> channel(2 * s_maxPacketsPerFrame);
+
+    UINT64 staleSnapshots = 0;
+    std::thread game([&] {
+        UINT64 packet = 0;
+        for (UINT64 frame = 0; frame < s_frameCount; ++frame) {
+            FrameSnapshot* snapshot = channel.BeginFrame();
+            // The slot is reused every other frame, and only after the render thread let go.
+            if (snapshot == nullptr || (frame >= 2 && snapshot->frame != frame - 2)) {
+                ++staleSnapshots;
+                break;
+            }
+
+            snapshot->frame = frame;
+            snapshot->packetCount = frame % (s_maxPacketsPerFrame + 1);
+            for (UINT64 i = 0; i < snapshot->packetCount; ++i) {
+                channel.Push(packet++);
+            }
+            channel.Publish();
+        }
+        channel.Close();
+    });
+
+    UINT64 frames = 0;
+    UINT64 badFrames = 0;
+    UINT64 badPackets = 0;
+    UINT64 nextPacket = 0;
+    while (const FrameSnapshot* snapshot = channel.Acquire()) {
+        badFrames += snapshot->frame != frames ? 1 : 0;
+
+        UINT64 drained = 0;
+        channel.Drain([&](UINT64 packet) {
+            badPackets += packet != nextPacket ? 1 : 0;
+            ++nextPacket;
+            ++drained;
+        });
+        badPackets += drained != snapshot->packetCount ? 1 : 0;
+
+        channel.Release();
+        ++frames;
+    }
+    game.join();
+
+    CHECK(staleSnapshots == 0);
+    CHECK(badFrames == 0);
+    CHECK(badPackets == 0);
+    CHECK(frames == s_frameCount);
+
+    auto stats = channel.GetStats();
+    CHECK(stats.frames == s_frameCount);
+    CHECK(stats.packets == nextPacket);
+    CHECK(channel.BeginFrame() == nullptr);
+}
+
+void TestRenderChannelClose() {
+    RenderChannel<FrameSnapshot, UINT64> channel(4);
+
+    // Two frames published and none released: the game thread has to wait for the third.
+    for (UINT64 frame = 0; frame < 2; ++frame) {
+        FrameSnapshot* snapshot = channel.BeginFrame();
+        CHECK(snapshot != nullptr);
+        snapshot->frame = frame;
+        CHECK(channel.Push(frame));
+        channel.Publish();
+    }
+
+    FrameSnapshot* blocked = nullptr;
+    std::thread game([&] { blocked = channel.BeginFrame(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    channel.Close();
+    game.join();
+
+    // Closing wakes the waiting game thread without a frame, and turns away new work.
+    CHECK(blocked == nullptr);
+    CHECK(channel.GetStats().gameWaits == 1);
+    CHECK(channel.BeginFrame() == nullptr);
+    CHECK(!channel.Push(2));
+
+    // Frames published before Close() are still delivered, then Acquire() returns null.
+    for (UINT64 frame = 0; frame < 2; ++frame) {
+        const FrameSnapshot* snapshot = channel.Acquire();
+        CHECK(snapshot != nullptr && snapshot->frame == frame);
+        UINT64 drained = 0;
+        channel.Drain([&](UINT64 packet) {
+            CHECK(packet == frame);
+            ++drained;
+        });
+        CHECK(drained == 1);
+        channel.Release();
+    }
+    CHECK(channel.Acquire() == nullptr);
+    CHECK(channel.GetStats().frames == 2);
+}
+
+}  // namespace
+
+void TestRenderChannel() {
+    TestSpscQueue();
+    TestSpscQueueStress();
+    TestRenderChannelHandoff();
+    TestRenderChannelClose();
+}
@@ -0,0 +1,172 @@
+#include <vector>
+
+#include "Check.h"
+
+#include "NullDevice.h"
+#include "ResourceStateTracker.h"
+
+namespace {
+
+using Microsoft::WRL::ComPtr;
+
+// The tracker only uses resources as keys, so placeholders do.
+ComPtr<ID3D12Resource> MakeResource() {
+    ComPtr<ID3D12Resource> resource;
+    resource.Attach(new NullResource(CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R8G8B8A8_UNORM, 64, 64, 1, 4)));
+    return resource;
+}
+
+bool IsTransition(const D3D12_RESOURCE_BARRIER& barrier,
+                  ID3D12Resource* resource,
+                  D3D12_RESOURCE_STATES before,
+                  D3D12_RESOURCE_STATES after,
+                  UINT subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
+                  D3D12_RESOURCE_BARRIER_FLAGS flags = D3D12_RESOURCE_BARRIER_FLAG_NONE) {
+    const auto& transition = barrier.Transition;
+    return barrier.Type == D3D12_RESOURCE_BARRIER_TYPE_TRANSITION && barrier.Flags == flags &&
+           transition.pResource == resource && transition.Subresource == subresource &&
+           transition.StateBefore == before && transition.StateAfter == after;
+}
+
+void TestSkipAndCombine() {
+    ResourceStateTracker tracker;
+    auto texture = MakeResource();
+    auto buffer = MakeResource();
+    tracker.Register(texture.Get(), D3D12_RESOURCE_STATE_COMMON);
+    tracker.Register(buffer.Get(),
+                     D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+    CHECK(tracker.IsTracked(texture.Get()));
+
+    // Already there, or a read-only state that covers the request.
+    tracker.Transition(texture.Get(), D3D12_RESOURCE_STATE_COMMON);
+    tracker.Transition(buffer.Get(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    CHECK(tracker.GetStats().skipped == 2);
+    CHECK(tracker.TakeBarriers().empty());
+
+    // Two requests before a flush become one barrier straight to the last state.
+    tracker.Transition(texture.Get(), D3D12_RESOURCE_STATE_COPY_DEST);
+    tracker.Transition(texture.Get(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    auto barriers = tracker.TakeBarriers();
+    CHECK(barriers.size() == 1);
+    CHECK(IsTransition(barriers[0],
+                       texture.Get(),
+                       D3D12_RESOURCE_STATE_COMMON,
+                       D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
+    CHECK(tracker.GetState(texture.Get()) == D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+
+    // There and back again before a flush is no barrier at all.
+    tracker.Transition(texture.Get(), D3D12_RESOURCE_STATE_RENDER_TARGET);
+    tracker.Transition(texture.Get(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    CHECK(tracker.TakeBarriers().empty());
+    CHECK(tracker.GetStats().combined == 2);
+
+    // Unregistering drops what was queued for the resource.
+    tracker.Transition(buffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST);
+    tracker.Unregister(buffer.Get());
+    CHECK(!tracker.IsTracked(buffer.Get()));
+    CHECK(tracker.TakeBarriers().empty());
+}
+
+void TestSubresources() {
+    ResourceStateTracker tracker;
+    auto texture = MakeResource();
+    tracker.Register(texture.Get(), D3D12_RESOURCE_STATE_COMMON, 4);
+
+    tracker.Transition(texture.Get(), D3D12_RESOURCE_STATE_COPY_DEST, 2);
+    CHECK(tracker.GetState(texture.Get(), 2) == D3D12_RESOURCE_STATE_COPY_DEST);
+    CHECK(tracker.GetState(texture.Get(), 0) == D3D12_RESOURCE_STATE_COMMON);
+
+    // Subresources in different states each get a barrier; the queued one is extended.
+    tracker.Transition(texture.Get(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    auto barriers = tracker.TakeBarriers();
+    CHECK(barriers.size() == 4);
+    CHECK(IsTransition(barriers[0],
+                       texture.Get(),
+                       D3D12_RESOURCE_STATE_COMMON,
+                       D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
+                       2));
+    for (UINT i = 1; i < barriers.size(); ++i) {
+        CHECK(barriers[i].Transition.Subresource != D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES);
+        CHECK(barriers[i].Transition.StateAfter == D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    }
+
+    // Uniform again, so one barrier covers the whole resource.
+    tracker.Transition(texture.Get(), D3D12_RESOURCE_STATE_RENDER_TARGET);
+    barriers = tracker.TakeBarriers();
+    CHECK(barriers.size() == 1);
+    CHECK(IsTransition(barriers[0],
+                       texture.Get(),
+                       D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
+                       D3D12_RESOURCE_STATE_RENDER_TARGET));
+}
+
+void TestSplitBarriers() {
+    ResourceStateTracker tracker;
+    auto target = MakeResource();
+    auto other = MakeResource();
+    tracker.Register(target.Get(), D3D12_RESOURCE_STATE_RENDER_TARGET);
+    tracker.Register(other.Get(), D3D12_RESOURCE_STATE_RENDER_TARGET);
+
+    // Ended by the transition to the state it began.
+    tracker.BeginTransition(target.Get(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    tracker.Transition(target.Get(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    auto barriers = tracker.TakeBarriers();
+    CHECK(barriers.size() == 2);
+    CHECK(IsTransition(barriers[0],
+                       target.Get(),
+                       D3D12_RESOURCE_STATE_RENDER_TARGET,
+                       D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
+                       D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
+                       D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY));
+    CHECK(IsTransition(barriers[1],
+                       target.Get(),
+                       D3D12_RESOURCE_STATE_RENDER_TARGET,
+                       D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
+                       D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
+                       D3D12_RESOURCE_BARRIER_FLAG_END_ONLY));
+
+    // Needed in another state: the split ends, then a plain barrier follows from its target.
+    tracker.BeginTransition(other.Get(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    tracker.Transition(other.Get(), D3D12_RESOURCE_STATE_COPY_SOURCE);
+    barriers = tracker.TakeBarriers();
+    CHECK(barriers.size() == 3);
+    CHECK(IsTransition(barriers[2],
+                       other.Get(),
+                       D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
+                       D3D12_RESOURCE_STATE_COPY_SOURCE));
+    CHECK(tracker.GetStats().splits == 2);
+}
+
+void TestFlush() {
+    ResourceStateTracker tracker;
+    auto a = MakeResource();
+    auto b = MakeResource();
+    tracker.Register(a.Get(), D3D12_RESOURCE_STATE_COMMON);
+    tracker.Register(b.Get(), D3D12_RESOURCE_STATE_COMMON);
+
+    ComPtr<RecordingCommandList> commandList;
+    commandList.Attach(new RecordingCommandList());
+
+    tracker.Flush(commandList.Get());
+    CHECK(tracker.GetStats().flushes == 0);
+
+    tracker.Transition(a.Get(), D3D12_RESOURCE_STATE_RENDER_TARGET);
+    tracker.Transition(b.Get(), D3D12_RESOURCE_STATE_DEPTH_WRITE);
+    tracker.Flush(commandList.Get());
+    tracker.Flush(commandList.Get());
+
+    CHECK(commandList->GetCounts().barriers == 2);
+    const auto& stats = tracker.GetStats();
+    CHECK(stats.requested == 2);
+    CHECK(stats.barriers == 2);
+    CHECK(stats.flushes == 1);
+}
+
+}  // namespace
+
+void TestResourceStateTracker() {
+    TestSkipAndCombine();
+    TestSubresources();
+    TestSplitBarriers();
+    TestFlush();
+}
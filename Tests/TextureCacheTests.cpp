@@ -0,0 +1,152 @@
+#include <cstring>
+#include <vector>
+
+#include "Check.h"
+
+#include "Common/TextureCache.h"
+
+#pragma comment(lib, "D3D12.lib")
+#pragma comment(lib, "dxgi.lib")
+#pragma comment(lib, "d3dcompiler.lib")
+
+using Microsoft::WRL::ComPtr;
+
+namespace {
+
+// An uncompressed RGBA8 DDS with one mip, every texel set to color.
+std::vector<uint8_t> MakeDds(uint32_t width, uint32_t height, uint32_t color) {
+    uint32_t header[32] = {};
+    header[0] = 0x20534444;                        // "DDS "
+    header[1] = 124;                               // header size
+    header[2] = 0x1 | 0x2 | 0x4 | 0x8 | 0x1000;    // caps, height, width, pitch, pixel format
+    header[3] = height;
+    header[4] = width;
+    header[5] = width * 4;                         // pitch
+    header[7] = 1;                                 // mip count
+    header[19] = 32;                               // pixel format size
+    header[20] = 0x1 | 0x40;                       // alpha pixels, RGB
+    header[22] = 32;                               // bits per pixel
+    header[23] = 0x000000ff;
+    header[24] = 0x0000ff00;
+    header[25] = 0x00ff0000;
+    header[26] = 0xff000000;
+    header[27] = 0x1000;                           // texture
+
+    std::vector<uint8_t> dds(sizeof(header) + width * height * 4);
+    std::memcpy(dds.data(), header, sizeof(header));
+    for (size_t i = sizeof(header); i < dds.size(); i += 4) {
+        std::memcpy(dds.data() + i, &color, 4);
+    }
+    return dds;
+}
+
+// Uploads run on WARP, so the test needs no GPU.
+struct WarpDevice {
+    WarpDevice() {
+        ComPtr<IDXGIFactory4> factory;
+        ThrowIfFailed(CreateDXGIFactory1(IID_PPV_ARGS(factory.GetAddressOf())));
+        ComPtr<IDXGIAdapter> adapter;
+        ThrowIfFailed(factory->EnumWarpAdapter(IID_PPV_ARGS(adapter.GetAddressOf())));
+        ThrowIfFailed(D3D12CreateDevice(adapter.Get(),
+                                        D3D_FEATURE_LEVEL_11_0,
+                                        IID_PPV_ARGS(device.GetAddressOf())));
+
+        D3D12_COMMAND_QUEUE_DESC queueDesc{};
+        queueDesc.Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
+        ThrowIfFailed(device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(queue.GetAddressOf())));
+        ThrowIfFailed(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT,
+                                                     IID_PPV_ARGS(allocator.GetAddressOf())));
+        ThrowIfFailed(device->CreateCommandList(0,
+                                                D3D12_COMMAND_LIST_TYPE_DIRECT,
+                                                allocator.Get(),
+                                                nullptr,
+                                                IID_PPV_ARGS(commandList.GetAddressOf())));
+        ThrowIfFailed(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(fence.GetAddressOf())));
+    }
+
+    // Executes what was recorded and waits for it.
+    void Finish() {
+        ThrowIfFailed(commandList->Close());
+        ID3D12CommandList* lists[] = {commandList.Get()};
+        queue->ExecuteCommandLists(_countof(lists), lists);
+        ThrowIfFailed(queue->Signal(fence.Get(), 1));
+        HANDLE event = CreateEventEx(nullptr, nullptr, 0, EVENT_ALL_ACCESS);
+        ThrowIfFailed(fence->SetEventOnCompletion(1, event));
+        WaitForSingleObject(event, INFINITE);
+        CloseHandle(event);
+    }
+
+    ComPtr<ID3D12Device> device;
+    ComPtr<ID3D12CommandQueue> queue;
+    ComPtr<ID3D12CommandAllocator> allocator;
+    ComPtr<ID3D12GraphicsCommandList> commandList;
+    ComPtr<ID3D12Fence> fence;
+};
+
+bool IsResident(const TextureCache& cache, const std::vector<uint8_t>& dds) {
+    return !cache.Find(TextureCache::Hash(dds.data(), dds.size())).expired();
+}
+
+}  // namespace
+
+void TestTextureCache() {
+    WarpDevice warp;
+    auto* list = warp.commandList.Get();
+
+    std::vector<ComPtr<ID3D12Resource>> retired;
+    TextureCache cache(warp.device.Get(), 1ull << 30);
+    cache.SetRetireCallback([&retired](ComPtr<ID3D12Resource> resource) {
+        retired.push_back(std::move(resource));
+    });
+
+    auto red = MakeDds(64, 64, 0xff0000ff);
+    auto green = MakeDds(64, 64, 0xff00ff00);
+    auto blue = MakeDds(64, 64, 0xffff0000);
+
+    // The same content from another buffer is a hit.
+    auto redHandle = cache.LoadFromMemory(list, red.data(), red.size());
+    auto redCopy = red;
+    auto redAgain = cache.LoadFromMemory(list, redCopy.data(), redCopy.size());
+    CHECK(redAgain == redHandle);
+    CHECK(cache.GetStats().misses == 1);
+    CHECK(cache.GetStats().hits == 1);
+
+    uint64_t textureBytes = cache.GetStats().residentBytes;
+    CHECK(textureBytes > 0);
+
+    auto greenHandle = cache.LoadFromMemory(list, green.data(), green.size());
+    CHECK(greenHandle != redHandle);
+    CHECK(cache.GetStats().misses == 2);
+    CHECK(cache.GetStats().residentCount == 2);
+    CHECK(cache.GetStats().residentBytes == 2 * textureBytes);
+
+    // Touch red so that green is the least recently used, then drop every handle.
+    cache.LoadFromMemory(list, red.data(), red.size());
+    ID3D12Resource* greenResource = greenHandle->Resource.Get();
+    redHandle.reset();
+    redAgain.reset();
+    greenHandle.reset();
+
+    // Over budget by one texture: green goes first.
+    cache.SetBudget(2 * textureBytes);
+    auto blueHandle = cache.LoadFromMemory(list, blue.data(), blue.size());
+    CHECK(cache.GetStats().evictions == 1);
+    CHECK(cache.GetStats().residentBytes == 2 * textureBytes);
+    CHECK(!IsResident(cache, green));
+    CHECK(IsResident(cache, red));
+    CHECK(IsResident(cache, blue));
+
+    // Green's resource and its upload heap, which had not been released yet.
+    CHECK(retired.size() == 2);
+    CHECK(!retired.empty() && retired[0].Get() == greenResource);
+
+    // A referenced texture is never evicted, even below budget.
+    cache.Trim(0);
+    CHECK(cache.GetStats().evictions == 2);
+    CHECK(cache.GetStats().residentCount == 1);
+    CHECK(cache.GetStats().residentBytes == textureBytes);
+    CHECK(!IsResident(cache, red));
+    CHECK(IsResident(cache, blue));
+
+    warp.Finish();
+}
@@ -0,0 +1,122 @@
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include "Check.h"
+
+#include "UploadRing.h"
+
+using Microsoft::WRL::ComPtr;
+
+namespace {
+
+// The ring maps a real upload buffer, so it runs on WARP. Its fence is signalled from the CPU
+// to stand in for the queue finishing a batch.
+struct WarpDevice {
+    WarpDevice() {
+        ComPtr<IDXGIFactory4> factory;
+        ThrowIfFailed(CreateDXGIFactory1(IID_PPV_ARGS(factory.GetAddressOf())));
+        ComPtr<IDXGIAdapter> adapter;
+        ThrowIfFailed(factory->EnumWarpAdapter(IID_PPV_ARGS(adapter.GetAddressOf())));
+        ThrowIfFailed(D3D12CreateDevice(adapter.Get(),
+                                        D3D_FEATURE_LEVEL_11_0,
+                                        IID_PPV_ARGS(device.GetAddressOf())));
+        ThrowIfFailed(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(fence.GetAddressOf())));
+    }
+
+    ComPtr<ID3D12Device> device;
+    ComPtr<ID3D12Fence> fence;
+};
+
+constexpr UINT64 s_capacity = 1024;
+
+void TestWraparoundAndStall() {
+    WarpDevice warp;
+    UploadRing ring(warp.device.Get(), warp.fence.Get(), s_capacity);
+
+    // Batch 1: 300 bytes, then 300 more aligned to 16.
+    auto first = ring.Allocate(300);
+    auto second = ring.Allocate(300);
+    CHECK(first.offset == 0);
+    CHECK(second.offset == 304);
+    CHECK(second.resource == first.resource);
+    CHECK(second.cpu == first.cpu + second.offset);
+    std::memset(second.cpu, 0xab, 300);
+    ring.Submit(1);
+
+    // Batch 2 fills the ring up to 908.
+    auto third = ring.Allocate(300);
+    CHECK(third.offset == 608);
+    ring.Submit(2);
+    CHECK(ring.GetStats().bytesInFlight == 908);
+
+    // Batch 1 is done: the next allocation does not fit at the end, so it wraps to the start,
+    // which batch 1 has just freed.
+    ThrowIfFailed(warp.fence->Signal(1));
+    auto wrapped = ring.Allocate(300);
+    CHECK(wrapped.offset == 0);
+    CHECK(ring.GetStats().wraparounds == 1);
+    CHECK(ring.GetStats().stalls == 0);
+    ring.Submit(3);
+
+    // Batch 2 is still in flight and in the way: the allocation waits for it.
+    std::thread gpu([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        ThrowIfFailed(warp.fence->Signal(2));
+    });
+    auto stalled = ring.Allocate(400);
+    gpu.join();
+    CHECK(stalled.offset == 304);
+    CHECK(ring.GetStats().stalls == 1);
+    CHECK(ring.GetStats().overflows == 0);
+    ring.Submit(4);
+
+    const auto& stats = ring.GetStats();
+    CHECK(stats.allocations == 5);
+    CHECK(stats.bytesAllocated == 1600);
+    CHECK(stats.peakBytesInFlight <= s_capacity);
+    CHECK(stats.peakBytesInFlight >= 908);
+
+    // Everything done: the ring is empty and starts over at 0.
+    ThrowIfFailed(warp.fence->Signal(4));
+    ring.Reclaim();
+    CHECK(ring.GetStats().bytesInFlight == 0);
+    CHECK(ring.Allocate(16).offset == 0);
+    ring.Submit(5);
+    ThrowIfFailed(warp.fence->Signal(5));
+}
+
+// Requests the ring cannot hold get a buffer of their own, released with their batch.
+void TestOverflow() {
+    WarpDevice warp;
+    UploadRing ring(warp.device.Get(), warp.fence.Get(), s_capacity);
+
+    auto ringAllocation = ring.Allocate(16);
+    auto large = ring.Allocate(2 * s_capacity);
+    CHECK(large.resource != ringAllocation.resource);
+    CHECK(large.offset == 0);
+    CHECK(large.cpu != nullptr);
+    std::memset(large.cpu, 0, 2 * s_capacity);
+    CHECK(ring.GetStats().overflows == 1);
+
+    // Only the open batch is in the way; waiting for it would never return.
+    auto blocked = ring.Allocate(s_capacity - 8);
+    CHECK(blocked.resource != ringAllocation.resource);
+    CHECK(ring.GetStats().overflows == 2);
+    CHECK(ring.GetStats().stalls == 0);
+
+    ring.Submit(1);
+    ThrowIfFailed(warp.fence->Signal(1));
+    ring.Reclaim();
+    CHECK(ring.GetStats().bytesInFlight == 0);
+    CHECK(ring.Allocate(s_capacity - 8).resource == ringAllocation.resource);
+    ring.Submit(2);
+    ThrowIfFailed(warp.fence->Signal(2));
+}
+
+}  // namespace
+
+void TestUploadRing() {
+    TestWraparoundAndStall();
+    TestOverflow();
+}
@@ -0,0 +1,37 @@
+#include <cstdio>
+
+#include "Check.h"
+
+int main() {
+    try {
+        TestBCTranscoder();
+        TestCommandContextPool();
+        TestCopyUploader();
+        TestDefaultHeapAllocator();
+        TestDeferredReleaseQueue();
+        TestDescriptorAllocator();
+        TestFrameGraph();
+        TestFramePacer();
+        TestLinearUploadAllocator();
+        TestMappedWriter();
+        TestMaterialTable();
+        TestMipGenerator();
+        TestNullFrameLoop();
+        TestParallelRecorder();
+        TestPresentPacingPolicy();
+        TestRenderChannel();
+        TestResourceStateTracker();
+        TestTextureCache();
+        TestUploadRing();
+    } catch (...) {
+        std::fprintf(stderr, "Unexpected exception\n");
+        return 1;
+    }
+
+    if (g_checkFailures > 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", g_checkFailures);
+        return 1;
+    }
+    std::printf("All checks passed\n");
+    return 0;
+}